@@ -0,0 +1,501 @@
+/**
+ * frame_benchmark.cpp - Headless Deterministic Frame Benchmark (vibe-gi-bench)
+ *
+ * Renders a named scene through the full Renderer pipeline in a hidden window,
+ * replaying a camera/light path at a fixed timestep so that every run renders
+ * exactly the same frames. Each requested quality level gets a warm-up period
+ * followed by N measured frames; per-pass CPU and GPU timings are reduced to
+ * min/avg/p95/p99 and written as CSV and/or JSON, along with the heap
+ * allocations per measured frame (zero once the renderer has warmed up).
+ *
+ * Usage:
+ *   vibe-gi-bench [--scene teapot|stone|shadow|default|lights] [--frames N] [--warmup N]
+ *                 [--quality 0-4|all] [--width W] [--height H] [--path file]
+ *                 [--csv file] [--json file] [--target-fps N] [--occlusion-culling]
+ *                 [--depth-prepass off|on|auto] [--probe-cache]
+ *                 [--post-resolution full|half|checkerboard] [--ray-march hiz|linear] [--world-rays]
+ *                 [--gpu-driven] [--upscale native|quality|balanced|performance|ultra-performance]
+ *                 [--frames-in-flight 1-3] [--debug-sync] [--lod-error px] [--no-lod]
+ *                 [--mesh-budget MB] [--visible]
+ *
+ * Camera paths are recorded with `vibe-gi --record-path <file>`. Without
+ * --path a slow orbit around the scene's start camera is generated.
+ *
+ * Dynamic resolution is off unless --target-fps is given, so the default
+ * runs always render the same pixel count. Meshes and textures are fully
+ * loaded before the warm-up starts.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../include/Window.h"
+#include "../include/Scene.h"
+#include "../include/Renderer.h"
+#include "../include/PerformanceProfiler.h"
+#include "../include/CameraPath.h"
+#include "../include/TransformComponent.h"
+#include "../include/LightComponent.h"
+#include "../include/TextureStreamer.h"
+#include "../include/MeshStreamer.h"
+#include "../include/JobSystem.h"
+#include "../include/SyncMonitor.h"
+
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+
+namespace {
+
+struct BenchmarkOptions {
+    std::string scene = "teapot";
+    int frames = 300;                   ///< Measured frames per quality level
+    int warmupFrames = 60;              ///< Unmeasured frames before measuring (shader warm-up, GI convergence)
+    std::vector<int> qualityLevels = {0, 1, 2, 3, 4};
+    int width = 1280;
+    int height = 800;
+    float timestep = 1.0f / 60.0f;      ///< Fixed simulation step in seconds
+    std::string pathFile;
+    std::string csvFile;
+    std::string jsonFile;
+    float targetFps = 0.0f;             ///< Dynamic resolution target (0 = fixed resolution)
+    bool occlusionCulling = false;
+    int depthPrepassMode = 2;           ///< 0 = off, 1 = on, 2 = automatic
+    bool probeCache = false;
+    int postResolution = 1;             ///< SSAO/SSR: 0 = full, 1 = half, 2 = checkerboard
+    bool hierarchicalTracing = true;    ///< SSR/GI rays march the depth pyramid
+    bool worldSpaceRays = false;        ///< GI screen misses continue through the scene BVH
+    bool gpuDriven = false;             ///< GPU culling and multi-draw-indirect (GpuCuller)
+    int upscaleMode = 0;                ///< Temporal upscaling (Renderer::getUpscaleRatio)
+    int framesInFlight = 2;             ///< CPU run-ahead limit (FramePacer)
+    bool debugSync = false;             ///< Report GL calls that block on the GPU (SyncMonitor)
+    float lodErrorPixels = 1.0f;        ///< Level-of-detail error limit (0 = full detail)
+    int meshBudgetMB = 0;               ///< Mesh level memory budget (0 = MeshStreamer default)
+    bool visible = false;
+};
+
+struct SampleStats {
+    float min = 0.0f;
+    float avg = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+    size_t count = 0;
+};
+
+struct PassResult {
+    std::string name;
+    SampleStats cpu;
+    SampleStats gpu;
+};
+
+struct QualityResult {
+    int qualityLevel = 0;
+    double allocationsPerFrame = 0.0;   ///< operator new calls per measured frame (all threads)
+    std::vector<PassResult> passes;
+};
+
+void printUsage() {
+    std::cout << "Usage: vibe-gi-bench [options]\n"
+              << "  --scene <name>     Scene to load: teapot, stone, shadow, default, lights (default: teapot)\n"
+              << "  --frames <N>       Measured frames per quality level (default: 300)\n"
+              << "  --warmup <N>       Warm-up frames per quality level (default: 60)\n"
+              << "  --quality <0-4|all> Quality level(s) to run (default: all)\n"
+              << "  --width <W>        Render width (default: 1280)\n"
+              << "  --height <H>       Render height (default: 800)\n"
+              << "  --path <file>      Camera/light path recorded with vibe-gi --record-path\n"
+              << "  --csv <file>       Write per-pass results as CSV\n"
+              << "  --json <file>      Write per-pass results as JSON\n"
+              << "  --target-fps <N>   Enable dynamic resolution holding N frames per second\n"
+              << "  --occlusion-culling Cull objects hidden in the previous frames' depth\n"
+              << "  --depth-prepass <off|on|auto> Depth pre-pass mode (default: auto)\n"
+              << "  --probe-cache      Use the world-space probe cache as GI far field\n"
+              << "  --post-resolution <full|half|checkerboard> SSAO/SSR rate (default: half)\n"
+              << "  --ray-march <hiz|linear> SSR/GI ray marching (default: hiz)\n"
+              << "  --world-rays       Trace GI rays the screen misses through the scene BVH\n"
+              << "  --gpu-driven       Cull on the GPU and draw with multi-draw-indirect (GL 4.3)\n"
+              << "  --upscale <native|quality|balanced|performance|ultra-performance>\n"
+              << "                     Temporal upscaling through TAA (default: native)\n"
+              << "  --frames-in-flight <1-3> Frames the CPU may run ahead of the GPU (default: 2)\n"
+              << "  --debug-sync       Report GL calls that block on the GPU\n"
+              << "  --lod-error <px>   Largest on-screen level-of-detail error (default: 1)\n"
+              << "  --no-lod           Draw meshes at full detail (same as --lod-error 0)\n"
+              << "  --mesh-budget <MB> GPU memory for mesh levels of detail (default: 512)\n"
+              << "  --visible          Show the window while benchmarking\n";
+}
+
+bool parseArguments(int argc, char** argv, BenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--scene" && hasValue) {
+                options.scene = argv[++i];
+            } else if (arg == "--frames" && hasValue) {
+                options.frames = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--warmup" && hasValue) {
+                options.warmupFrames = std::max(0, std::stoi(argv[++i]));
+            } else if (arg == "--quality" && hasValue) {
+                std::string value = argv[++i];
+                options.qualityLevels.clear();
+                if (value == "all") {
+                    for (int q = 0; q < Renderer::QUALITY_LEVELS; ++q) options.qualityLevels.push_back(q);
+                } else {
+                    int q = std::stoi(value);
+                    if (q < 0 || q >= Renderer::QUALITY_LEVELS) {
+                        std::cerr << "Quality level must be 0-" << Renderer::QUALITY_LEVELS - 1 << " or 'all'" << std::endl;
+                        return false;
+                    }
+                    options.qualityLevels.push_back(q);
+                }
+            } else if (arg == "--width" && hasValue) {
+                options.width = std::max(64, std::stoi(argv[++i]));
+            } else if (arg == "--height" && hasValue) {
+                options.height = std::max(64, std::stoi(argv[++i]));
+            } else if (arg == "--path" && hasValue) {
+                options.pathFile = argv[++i];
+            } else if (arg == "--csv" && hasValue) {
+                options.csvFile = argv[++i];
+            } else if (arg == "--json" && hasValue) {
+                options.jsonFile = argv[++i];
+            } else if (arg == "--target-fps" && hasValue) {
+                options.targetFps = std::max(1.0f, std::stof(argv[++i]));
+            } else if (arg == "--occlusion-culling") {
+                options.occlusionCulling = true;
+            } else if (arg == "--depth-prepass" && hasValue) {
+                std::string value = argv[++i];
+                if (value == "off") {
+                    options.depthPrepassMode = 0;
+                } else if (value == "on") {
+                    options.depthPrepassMode = 1;
+                } else if (value == "auto") {
+                    options.depthPrepassMode = 2;
+                } else {
+                    std::cerr << "Depth pre-pass mode must be off, on or auto" << std::endl;
+                    return false;
+                }
+            } else if (arg == "--probe-cache") {
+                options.probeCache = true;
+            } else if (arg == "--post-resolution" && hasValue) {
+                std::string value = argv[++i];
+                if (value == "full") {
+                    options.postResolution = 0;
+                } else if (value == "half") {
+                    options.postResolution = 1;
+                } else if (value == "checkerboard") {
+                    options.postResolution = 2;
+                } else {
+                    std::cerr << "Post resolution must be full, half or checkerboard" << std::endl;
+                    return false;
+                }
+            } else if (arg == "--ray-march" && hasValue) {
+                std::string value = argv[++i];
+                if (value == "hiz" || value == "linear") {
+                    options.hierarchicalTracing = value == "hiz";
+                } else {
+                    std::cerr << "Ray march mode must be hiz or linear" << std::endl;
+                    return false;
+                }
+            } else if (arg == "--world-rays") {
+                options.worldSpaceRays = true;
+            } else if (arg == "--gpu-driven") {
+                options.gpuDriven = true;
+            } else if (arg == "--upscale" && hasValue) {
+                options.upscaleMode = Renderer::parseUpscaleMode(argv[++i]);
+                if (options.upscaleMode < 0) {
+                    std::cerr << "Upscale mode must be native, quality, balanced, performance or ultra-performance" << std::endl;
+                    return false;
+                }
+            } else if (arg == "--frames-in-flight" && hasValue) {
+                options.framesInFlight = std::max(1, std::min(std::stoi(argv[++i]), FramePacer::MAX_FRAMES_IN_FLIGHT));
+            } else if (arg == "--debug-sync") {
+                options.debugSync = true;
+            } else if (arg == "--lod-error" && hasValue) {
+                options.lodErrorPixels = std::max(0.0f, std::stof(argv[++i]));
+            } else if (arg == "--no-lod") {
+                options.lodErrorPixels = 0.0f;
+            } else if (arg == "--mesh-budget" && hasValue) {
+                options.meshBudgetMB = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--visible") {
+                options.visible = true;
+            } else if (arg == "--help" || arg == "-h") {
+                printUsage();
+                return false;
+            } else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                printUsage();
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (!Scene::isSceneName(options.scene)) {
+        std::cerr << "Unknown scene: " << options.scene << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Nearest-rank percentile of a sorted sample set
+float percentile(const std::vector<float>& sorted, float p) {
+    if (sorted.empty()) return 0.0f;
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0f * sorted.size()));
+    rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+    return sorted[rank - 1];
+}
+
+SampleStats computeStats(std::vector<float> samples) {
+    SampleStats stats;
+    if (samples.empty()) return stats;
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (float s : samples) sum += s;
+
+    stats.min = samples.front();
+    stats.avg = static_cast<float>(sum / samples.size());
+    stats.p95 = percentile(samples, 95.0f);
+    stats.p99 = percentile(samples, 99.0f);
+    stats.count = samples.size();
+    return stats;
+}
+
+TransformComponent* findLightTransform(Scene& scene) {
+    Entity light = scene.getPrimaryLight();
+    return light ? light.getComponent<TransformComponent>() : nullptr;
+}
+
+QualityResult runQualityLevel(const BenchmarkOptions& options, const CameraPath& recordedPath,
+                              Window& window, Renderer& renderer, int qualityLevel) {
+    // Fresh scene per run so behaviours start from the same state every time
+    Scene scene(options.scene);
+    // Textures and meshes stream in asynchronously; measure with everything loaded
+    TextureStreamer::instance().finishAll();
+    MeshStreamer::instance().finishAll();
+    TransformComponent* lightTransform = findLightTransform(scene);
+    // Simulation runs in parallel but synchronously, so every frame sees the same state
+    JobSystem jobs;
+    renderer.setJobSystem(&jobs);
+
+    CameraPath path = recordedPath;
+    if (path.empty()) {
+        glm::vec3 start = scene.camera.position;
+        float radius = glm::length(glm::vec2(start.x, start.z));
+        glm::vec3 lightRest = lightTransform ? lightTransform->position : glm::vec3(0.0f, 2.0f, 0.0f);
+        float duration = (options.warmupFrames + options.frames) * options.timestep;
+        path = CameraPath::createOrbit(glm::vec3(0.0f), std::max(radius, 1.0f), start.y, lightRest, duration);
+    }
+
+    RenderSettings settings;
+    settings.qualityLevel = qualityLevel;
+    settings.occlusionCulling = options.occlusionCulling;
+    settings.depthPrepassMode = options.depthPrepassMode;
+    settings.probeCache = options.probeCache;
+    settings.postResolution = options.postResolution;
+    settings.hierarchicalTracing = options.hierarchicalTracing;
+    settings.worldSpaceRays = options.worldSpaceRays;
+    settings.gpuDriven = options.gpuDriven;
+    settings.upscaleMode = options.upscaleMode;
+    settings.framesInFlight = options.framesInFlight;
+    settings.lodErrorPixels = options.lodErrorPixels;
+    if (options.targetFps > 0.0f) {
+        settings.dynamicResolution = true;
+        settings.targetFrameTimeMs = 1000.0f / options.targetFps;
+    }
+
+    PerformanceProfiler profiler;
+    renderer.resetTemporalAccumulation();
+
+    const int totalFrames = options.warmupFrames + options.frames;
+    const float pathDuration = path.getDuration();
+    uint64_t measuredAllocations = PerformanceProfiler::getAllocationCount();
+    for (int frame = 0; frame < totalFrames; ++frame) {
+        if (frame == options.warmupFrames) {
+            // Drop warm-up results so only measured frames reach the history
+            profiler.flushGpuTimers();
+            profiler.setHistoryRecording(true, options.frames);
+            measuredAllocations = PerformanceProfiler::getAllocationCount();
+        }
+
+        float time = frame * options.timestep;
+        float pathTime = pathDuration > 0.0f ? std::fmod(time, pathDuration) : 0.0f;
+        CameraKeyframe keyframe = path.sample(pathTime);
+        CameraPath::applyToCamera(keyframe, scene.camera);
+        if (lightTransform) {
+            lightTransform->position = keyframe.lightPosition;
+        }
+        scene.updateBehaviours(options.timestep, &jobs);
+        scene.updateWorldMatrices(&jobs);
+
+        profiler.beginFrame();
+        profiler.beginTimer("frame_total");
+        renderer.render(scene, settings, options.width, options.height, time, profiler);
+        window.swapBuffers();
+        profiler.endTimer("frame_total");
+        window.pollEvents();
+    }
+    measuredAllocations = PerformanceProfiler::getAllocationCount() - measuredAllocations;
+    profiler.flushGpuTimers();
+
+    renderer.setJobSystem(nullptr); // jobs ends with this run
+
+    QualityResult result;
+    result.qualityLevel = qualityLevel;
+    result.allocationsPerFrame = static_cast<double>(measuredAllocations) / options.frames;
+    for (const auto& name : profiler.getScopeNames()) {
+        PassResult pass;
+        pass.name = name;
+        pass.cpu = computeStats(profiler.getCpuHistory(name.c_str()));
+        pass.gpu = computeStats(profiler.getGpuHistory(name.c_str()));
+        if (pass.cpu.count > 0 || pass.gpu.count > 0) {
+            result.passes.push_back(pass);
+        }
+    }
+    return result;
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (static_cast<unsigned char>(c) < 0x20) out += ' ';
+        else out += c;
+    }
+    return out;
+}
+
+void writeStatsJson(std::ostream& out, const SampleStats& s) {
+    out << "{\"min\": " << s.min << ", \"avg\": " << s.avg << ", \"p95\": " << s.p95
+        << ", \"p99\": " << s.p99 << ", \"samples\": " << s.count << "}";
+}
+
+bool writeCsv(const std::string& file, const BenchmarkOptions& options, const std::vector<QualityResult>& results) {
+    std::ofstream out(file);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write " << file << std::endl;
+        return false;
+    }
+    out << std::fixed << std::setprecision(4);
+    out << "scene,quality,quality_name,pass,cpu_min_ms,cpu_avg_ms,cpu_p95_ms,cpu_p99_ms,"
+        << "gpu_min_ms,gpu_avg_ms,gpu_p95_ms,gpu_p99_ms,samples\n";
+    for (const auto& result : results) {
+        for (const auto& pass : result.passes) {
+            out << options.scene << "," << result.qualityLevel << "," << Renderer::getQualityName(result.qualityLevel) << ","
+                << pass.name << ","
+                << pass.cpu.min << "," << pass.cpu.avg << "," << pass.cpu.p95 << "," << pass.cpu.p99 << ","
+                << pass.gpu.min << "," << pass.gpu.avg << "," << pass.gpu.p95 << "," << pass.gpu.p99 << ","
+                << std::max(pass.cpu.count, pass.gpu.count) << "\n";
+        }
+    }
+    return true;
+}
+
+bool writeJson(const std::string& file, const BenchmarkOptions& options, const std::vector<QualityResult>& results) {
+    std::ofstream out(file);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write " << file << std::endl;
+        return false;
+    }
+    const char* glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* glVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"scene\": \"" << jsonEscape(options.scene) << "\",\n";
+    out << "  \"path\": \"" << jsonEscape(options.pathFile.empty() ? "orbit" : options.pathFile) << "\",\n";
+    out << "  \"width\": " << options.width << ",\n";
+    out << "  \"height\": " << options.height << ",\n";
+    out << "  \"frames\": " << options.frames << ",\n";
+    out << "  \"warmup_frames\": " << options.warmupFrames << ",\n";
+    out << "  \"timestep\": " << options.timestep << ",\n";
+    out << "  \"gl_renderer\": \"" << jsonEscape(glRenderer ? glRenderer : "unknown") << "\",\n";
+    out << "  \"gl_version\": \"" << jsonEscape(glVersion ? glVersion : "unknown") << "\",\n";
+    out << "  \"build_date\": \"" << __DATE__ << "\",\n";
+    out << "  \"results\": [\n";
+    for (size_t r = 0; r < results.size(); ++r) {
+        const auto& result = results[r];
+        out << "    {\n";
+        out << "      \"quality\": " << result.qualityLevel << ",\n";
+        out << "      \"quality_name\": \"" << Renderer::getQualityName(result.qualityLevel) << "\",\n";
+        out << "      \"allocations_per_frame\": " << result.allocationsPerFrame << ",\n";
+        out << "      \"passes\": {\n";
+        for (size_t p = 0; p < result.passes.size(); ++p) {
+            const auto& pass = result.passes[p];
+            out << "        \"" << jsonEscape(pass.name) << "\": {\"cpu_ms\": ";
+            writeStatsJson(out, pass.cpu);
+            out << ", \"gpu_ms\": ";
+            writeStatsJson(out, pass.gpu);
+            out << "}" << (p + 1 < result.passes.size() ? "," : "") << "\n";
+        }
+        out << "      }\n";
+        out << "    }" << (r + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+    return true;
+}
+
+void printSummary(const QualityResult& result) {
+    std::cout << "\n=== " << Renderer::getQualityName(result.qualityLevel) << " (quality " << result.qualityLevel << ") ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(20) << "pass" << std::setw(10) << "cpu avg" << std::setw(10) << "cpu p99"
+              << std::setw(10) << "gpu avg" << std::setw(10) << "gpu p95" << std::setw(10) << "gpu p99" << std::endl;
+    for (const auto& pass : result.passes) {
+        std::cout << std::setw(20) << pass.name
+                  << std::setw(10) << pass.cpu.avg << std::setw(10) << pass.cpu.p99
+                  << std::setw(10) << pass.gpu.avg << std::setw(10) << pass.gpu.p95 << std::setw(10) << pass.gpu.p99 << std::endl;
+    }
+    std::cout << "allocations per frame: " << result.allocationsPerFrame << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    try {
+        Window window(options.width, options.height, "Vibe-GI Benchmark", options.visible);
+        glfwSwapInterval(0); // Never let vsync cap the measurement
+        glEnable(GL_DEPTH_TEST);
+
+        CameraPath recordedPath;
+        if (!options.pathFile.empty() && !recordedPath.loadFromFile(options.pathFile)) {
+            return 1;
+        }
+
+        std::cout << "Benchmarking scene '" << options.scene << "' at " << options.width << "x" << options.height
+                  << ", " << options.warmupFrames << " warm-up + " << options.frames << " frames per quality level" << std::endl;
+
+        Renderer renderer(options.width, options.height);
+        SyncMonitor::setEnabled(options.debugSync);
+        if (options.meshBudgetMB > 0) {
+            MeshStreamer::instance().setMemoryBudget(static_cast<size_t>(options.meshBudgetMB) * 1024 * 1024);
+        }
+        std::vector<QualityResult> results;
+        for (int qualityLevel : options.qualityLevels) {
+            results.push_back(runQualityLevel(options, recordedPath, window, renderer, qualityLevel));
+            printSummary(results.back());
+        }
+
+        bool ok = true;
+        if (!options.csvFile.empty()) {
+            ok = writeCsv(options.csvFile, options, results) && ok;
+        }
+        if (!options.jsonFile.empty()) {
+            ok = writeJson(options.jsonFile, options, results) && ok;
+        }
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return -1;
+    }
+}
@@ -0,0 +1,808 @@
+/**
+ * micro_benchmark.cpp - CPU Hot Path Micro-Benchmarks (vibe-gi-microbench)
+ *
+ * Times individual CPU-side operations in isolation, the way Google Benchmark
+ * does, without the frame loop around them: a benchmark is a function that
+ * runs its operation while state.keepRunning() is true. Every benchmark is
+ * first calibrated to the iteration count that fills --min-time, then
+ * measured --repetitions times; the median time per iteration is what gets
+ * reported and compared. Work inside pauseTiming()/resumeTiming() (e.g.
+ * removing a cache entry before a cold import) is not counted. Log output
+ * of the measured code is muted while it runs.
+ *
+ * Fixtures are the bundled assets: every model in models/ and every texture
+ * in textures/ gets its own benchmarks. Benchmarks that need an OpenGL
+ * context (uploads, uniforms) only run with --gpu, which opens a hidden
+ * window; everything else runs without a window or a display.
+ *
+ * Some benchmarks also check what the timed code produced (a model has to
+ * deduplicate into far fewer vertices than its soup, GI has to go idle
+ * under a still camera). A failed check is reported as
+ * FAILED and the run exits with status 3, whatever the timings.
+ *
+ * Baselines: --save-baseline writes the results as CSV, and --baseline
+ * compares a run against such a file. A benchmark whose median is more than
+ * --tolerance (default 15%) slower than its baseline is reported as a
+ * regression and the run exits with status 2. Baselines are only comparable
+ * on the machine and build type that recorded them.
+ *
+ * Usage:
+ *   vibe-gi-microbench [--filter text] [--repetitions N] [--min-time seconds]
+ *                      [--baseline file] [--save-baseline file] [--tolerance fraction]
+ *                      [--gpu] [--list]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "../include/Window.h"
+#include "../include/Mesh.h"
+#include "../include/MeshCache.h"
+#include "../include/ObjParser.h"
+#include "../include/Entity.h"
+#include "../include/TransformComponent.h"
+#include "../include/Material.h"
+#include "../include/TextureCompressor.h"
+#include "../include/Shader.h"
+#include "../include/PerformanceProfiler.h"
+#include "../include/Renderer.h"
+#include "../include/Scene.h"
+#include "../include/TextureStreamer.h"
+#include "../include/MeshStreamer.h"
+#include "../src/stb_image.h"
+
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+
+namespace {
+
+const char* const MODELS[] = {"models/teapot.obj", "models/bunny.obj", "models/dragon.obj"};
+
+struct TextureFixture {
+    const char* path;
+    TextureEncoding encoding;   ///< What TextureStreamer encodes the file as
+};
+
+const TextureFixture TEXTURES[] = {
+    {"textures/stone_basecolor.jpg", TextureEncoding::BC1},
+    {"textures/stone_normal.jpg", TextureEncoding::BC5},
+    {"textures/stone_roughness.jpg", TextureEncoding::BC4},
+    {"textures/stone_ambientOcclusion.jpg", TextureEncoding::BC4},
+    {"textures/stone_height.png", TextureEncoding::BC4}
+};
+
+struct BenchmarkOptions {
+    std::string filter;                 ///< Only run benchmarks whose name contains this
+    int repetitions = 5;
+    double minTime = 0.1;               ///< Seconds each repetition runs at least
+    std::string baselineFile;
+    std::string saveBaselineFile;
+    double tolerance = 0.15;            ///< Allowed slowdown against the baseline (0.15 = 15%)
+    bool gpu = false;                   ///< Also run the benchmarks that need a GL context
+    bool list = false;
+};
+
+// Keeps the compiler from discarding a result that is never used
+template <typename T>
+void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * Iteration control handed to a benchmark function
+ */
+class BenchmarkState {
+public:
+    explicit BenchmarkState(size_t iterations) : iterations(iterations) {}
+
+    /**
+     * True while iterations remain; starts the clock on the first call and
+     * stops it after the last
+     */
+    bool keepRunning() {
+        if (completed == 0 && !started) {
+            started = true;
+            resumeTiming();
+            return iterations > 0;
+        }
+        if (++completed < iterations) {
+            return true;
+        }
+        pauseTiming();
+        return false;
+    }
+
+    void pauseTiming() {
+        if (running) {
+            elapsed += std::chrono::steady_clock::now() - start;
+            running = false;
+        }
+    }
+
+    void resumeTiming() {
+        if (!running) {
+            start = std::chrono::steady_clock::now();
+            running = true;
+        }
+    }
+
+    /**
+     * Items (entities, matrices, ...) handled per iteration, for the throughput column
+     */
+    void setItemsPerIteration(size_t items) { itemsPerIteration = items; }
+
+    /**
+     * Give up on the benchmark (missing fixture, failed setup)
+     */
+    void skip(const std::string& reason) { skipReason = reason; }
+
+    /**
+     * Report a wrong result; the benchmark stops like a skipped one, but fails the run
+     */
+    void fail(const std::string& reason) { failReason = reason; }
+
+    size_t getIterations() const { return iterations; }
+    double getSeconds() const { return std::chrono::duration<double>(elapsed).count(); }
+    size_t getItemsPerIteration() const { return itemsPerIteration; }
+    const std::string& getSkipReason() const { return skipReason; }
+    const std::string& getFailReason() const { return failReason; }
+
+private:
+    size_t iterations;
+    size_t completed = 0;
+    size_t itemsPerIteration = 0;
+    bool started = false;
+    bool running = false;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration elapsed{0};
+    std::string skipReason;
+    std::string failReason;
+};
+
+struct Benchmark {
+    std::string name;
+    bool gpu;                           ///< Needs a GL context
+    std::function<void(BenchmarkState&)> run;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    double medianNs = 0.0;              ///< Per iteration
+    double minNs = 0.0;
+    size_t iterations = 0;              ///< Per repetition
+    double itemsPerSecond = 0.0;        ///< 0 when the benchmark counts no items
+    double allocationsPerIteration = 0.0;
+    std::string skipReason;
+    std::string failReason;
+};
+
+// Swallows the log lines of the measured code
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+bool fileExists(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    fclose(file);
+    return true;
+}
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    size_t dot = path.find_last_of('.');
+    size_t begin = slash == std::string::npos ? 0 : slash + 1;
+    return path.substr(begin, dot == std::string::npos || dot < begin ? std::string::npos : dot - begin);
+}
+
+// Distinct component types for the lookup benchmarks
+template <int N>
+struct FillerComponent {
+    glm::vec4 value = glm::vec4(static_cast<float>(N));
+};
+
+template <int N>
+void addFillers(Registry& registry, EntityId entity, int count) {
+    if constexpr (N < 7) {
+        if (N < count) {
+            registry.add<FillerComponent<N>>(entity);
+            addFillers<N + 1>(registry, entity, count);
+        }
+    }
+}
+
+// ---- GPU-free benchmarks ----
+
+void benchObjParse(BenchmarkState& state, const std::string& path) {
+    if (!fileExists(path)) {
+        state.skip("missing " + path);
+        return;
+    }
+    std::vector<Vertex> soup;
+    while (state.keepRunning()) {
+        if (!ObjParser::parse(path, soup)) {
+            state.skip("failed to parse " + path);
+            return;
+        }
+        doNotOptimize(soup.data());
+    }
+}
+
+// Indexing the parsed soup. The teapot and dragon have no normals in the file;
+// the parser's smooth normals have to let their corners weld like the bunny's.
+void benchDeduplicate(BenchmarkState& state, const std::string& path) {
+    std::vector<Vertex> soup;
+    if (!fileExists(path) || !ObjParser::parse(path, soup)) {
+        state.skip("missing " + path);
+        return;
+    }
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    state.setItemsPerIteration(soup.size());
+    while (state.keepRunning()) {
+        Mesh::deduplicate(soup, vertices, indices);
+        doNotOptimize(vertices.data());
+    }
+    // A closed triangle mesh has about half as many vertices as triangles: 6x fewer than the soup
+    if (vertices.size() * 4 > soup.size()) {
+        state.fail(std::to_string(soup.size()) + " soup vertices -> " + std::to_string(vertices.size()) + " unique");
+    }
+}
+
+// Parse, deduplicate, optimize, simplify and write the cache entry
+void benchObjImportCold(BenchmarkState& state, const std::string& path) {
+    if (!fileExists(path)) {
+        state.skip("missing " + path);
+        return;
+    }
+    const std::string cachePath = MeshCache::getCachePath(path);
+    std::vector<MeshLodData> levels;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        std::remove(cachePath.c_str());
+        state.resumeTiming();
+        if (!Mesh::importOBJ(path, levels)) {
+            state.skip("failed to import " + path);
+            return;
+        }
+        doNotOptimize(levels.data());
+    }
+}
+
+void benchObjImportCached(BenchmarkState& state, const std::string& path) {
+    std::vector<MeshLodData> levels;
+    if (!fileExists(path) || !Mesh::importOBJ(path, levels)) {
+        state.skip("missing " + path);
+        return;
+    }
+    while (state.keepRunning()) {
+        Mesh::importOBJ(path, levels);
+        doNotOptimize(levels.data());
+    }
+}
+
+void benchGetComponent(BenchmarkState& state, int componentsPerEntity) {
+    const size_t ENTITY_COUNT = 16384;
+    Registry registry;
+    std::vector<Entity> entities;
+    for (size_t i = 0; i < ENTITY_COUNT; ++i) {
+        EntityId id = registry.createEntity();
+        registry.add<TransformComponent>(id, glm::vec3(static_cast<float>(i)));
+        addFillers<0>(registry, id, componentsPerEntity - 1);
+        entities.emplace_back(&registry, id);
+    }
+    // Scattered lookups, like systems visiting entities in another pool's order
+    std::shuffle(entities.begin(), entities.end(), std::mt19937(1));
+    state.setItemsPerIteration(ENTITY_COUNT);
+    while (state.keepRunning()) {
+        float sum = 0.0f;
+        for (const Entity& entity : entities) {
+            sum += entity.getComponent<TransformComponent>()->position.x;
+        }
+        doNotOptimize(sum);
+    }
+}
+
+void benchModelMatrix(BenchmarkState& state) {
+    const size_t TRANSFORM_COUNT = 4096;
+    std::vector<TransformComponent> transforms;
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (size_t i = 0; i < TRANSFORM_COUNT; ++i) {
+        transforms.emplace_back(glm::vec3(unit(random), unit(random), unit(random)) * 10.0f,
+                                glm::vec3(unit(random), unit(random), unit(random)) * 180.0f,
+                                glm::vec3(1.0f + 0.5f * unit(random)));
+    }
+    std::vector<glm::mat4> matrices(TRANSFORM_COUNT);
+    state.setItemsPerIteration(TRANSFORM_COUNT);
+    while (state.keepRunning()) {
+        for (size_t i = 0; i < TRANSFORM_COUNT; ++i) {
+            matrices[i] = transforms[i].getModelMatrix();
+        }
+        doNotOptimize(matrices.data());
+    }
+}
+
+// The decode Texture::loadFromFile does before its upload
+void benchTextureDecode(BenchmarkState& state, const std::string& path) {
+    if (!fileExists(path)) {
+        state.skip("missing " + path);
+        return;
+    }
+    stbi_set_flip_vertically_on_load(true);
+    while (state.keepRunning()) {
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 0);
+        if (!pixels) {
+            state.skip("failed to decode " + path);
+            return;
+        }
+        doNotOptimize(pixels);
+        stbi_image_free(pixels);
+    }
+}
+
+// Mip chain and block compression of a texture cache miss (TextureStreamer's loader threads)
+void benchTextureCompress(BenchmarkState& state, const TextureFixture& texture) {
+    stbi_set_flip_vertically_on_load(true);
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(texture.path, &width, &height, &channels, 4);
+    if (!pixels) {
+        state.skip(std::string("missing ") + texture.path);
+        return;
+    }
+    while (state.keepRunning()) {
+        TextureImage image = TextureCompressor::build(pixels, width, height, texture.encoding);
+        doNotOptimize(image.data.data());
+    }
+    stbi_image_free(pixels);
+}
+
+// Change tracking alone: a still camera with float noise in its position and
+// direction has to let GI go idle, a small real move has to wake it up
+void benchGiScheduler(BenchmarkState& state) {
+    const int FRAMES = 256;
+    GiUpdateScheduler::FrameState frame;
+    frame.cameraPosition = glm::vec3(0.0f, 1.0f, 5.0f);
+    frame.cameraForward = glm::normalize(glm::vec3(0.0f, -1.0f, -5.0f));
+    frame.activeCascades = 6;
+    frame.width = 1280;
+    frame.height = 720;
+    const GiUpdateScheduler::FrameState still = frame;
+    state.setItemsPerIteration(FRAMES + 1);
+    while (state.keepRunning()) {
+        GiUpdateScheduler scheduler;
+        int idleFrames = 0;
+        for (int i = 0; i < FRAMES; ++i) {
+            const float noise = (i % 2 ? 1.0f : -1.0f) * 1e-6f;
+            frame.cameraPosition = still.cameraPosition + noise;
+            frame.cameraForward = glm::normalize(still.cameraForward + noise);
+            idleFrames = scheduler.update(frame) == 0 ? idleFrames + 1 : 0;
+        }
+        if (idleFrames != FRAMES - GiUpdateScheduler::CONVERGE_FRAMES - 1) {
+            state.fail("still camera kept GI updating");
+            return;
+        }
+        frame.cameraPosition = still.cameraPosition + glm::vec3(1e-3f, 0.0f, 0.0f);
+        scheduler.update(frame);
+        if (!scheduler.isViewChanged()) {
+            state.fail("1 mm camera move not detected");
+            return;
+        }
+    }
+}
+
+// ---- Benchmarks that need a GL context (--gpu) ----
+
+void benchMeshLoad(BenchmarkState& state, const std::string& path) {
+    std::vector<MeshLodData> levels;
+    if (!fileExists(path) || !Mesh::importOBJ(path, levels)) {
+        state.skip("missing " + path);
+        return;
+    }
+    // Warm cache: what a scene load costs on the GL thread after the first run
+    while (state.keepRunning()) {
+        std::unique_ptr<Mesh> mesh = Mesh::loadFromOBJ(path, VertexFormat::Packed);
+        glFinish();
+        state.pauseTiming();
+        mesh.reset();
+        state.resumeTiming();
+    }
+}
+
+void benchTextureLoad(BenchmarkState& state, const std::string& path) {
+    if (!fileExists(path)) {
+        state.skip("missing " + path);
+        return;
+    }
+    while (state.keepRunning()) {
+        std::unique_ptr<Texture> texture = std::make_unique<Texture>();
+        if (!texture->loadFromFile(path)) {
+            state.skip("failed to load " + path);
+            return;
+        }
+        glFinish();
+        state.pauseTiming();
+        texture.reset();
+        state.resumeTiming();
+    }
+}
+
+void benchUniforms(BenchmarkState& state, bool byName) {
+    const int UNIFORMS_PER_ITERATION = 256;
+    Shader shader("shaders/shadow_depth.vert", "shaders/shadow_depth.frag");
+    if (!shader.isValid()) {
+        state.skip("failed to compile shaders/shadow_depth");
+        return;
+    }
+    shader.use();
+    const int location = shader.getUniformLocation("lightSpaceMatrix");
+    glm::mat4 matrix(1.0f);
+    state.setItemsPerIteration(UNIFORMS_PER_ITERATION);
+    while (state.keepRunning()) {
+        for (int i = 0; i < UNIFORMS_PER_ITERATION; ++i) {
+            matrix[3][0] = static_cast<float>(i);
+            if (byName) {
+                shader.setMat4("lightSpaceMatrix", matrix);
+            } else {
+                shader.setMat4(location, matrix);
+            }
+        }
+    }
+    glFinish();
+}
+
+// Frames of a still camera once GI has converged: the scheduler has to skip
+// the cascades, with and without TAA jittering the projection every frame
+void benchStillFrame(BenchmarkState& state, int antiAliasingMode) {
+    const int SIZE = 64;
+    Renderer renderer(SIZE, SIZE);
+    Scene scene("stone");
+    TextureStreamer::instance().finishAll();
+    MeshStreamer::instance().finishAll();
+    scene.updateWorldMatrices();
+    RenderSettings settings;
+    settings.antiAliasingMode = antiAliasingMode;
+    PerformanceProfiler profiler;
+    // No behaviours run, so only the renderer itself could see a change
+    for (int frame = 0; frame <= GiUpdateScheduler::CONVERGE_FRAMES; ++frame) {
+        renderer.render(scene, settings, SIZE, SIZE, 0.0f, profiler);
+    }
+    while (state.keepRunning()) {
+        renderer.render(scene, settings, SIZE, SIZE, 0.0f, profiler);
+        const GiUpdateScheduler& scheduler = renderer.getGiScheduler();
+        if (scheduler.getUpdateMask() != 0) {
+            state.fail(std::string("GI still updating (") + (scheduler.isViewChanged() ? "view moved" :
+                       scheduler.isSceneChanged() ? "scene changed" : "converging") + ")");
+            break;
+        }
+    }
+    glFinish();
+}
+
+std::vector<Benchmark> createBenchmarks() {
+    std::vector<Benchmark> benchmarks;
+    for (const char* model : MODELS) {
+        const std::string path = model;
+        const std::string name = baseName(path);
+        benchmarks.push_back({"obj_parse/" + name, false, [path](BenchmarkState& s) { benchObjParse(s, path); }});
+        benchmarks.push_back({"mesh_deduplicate/" + name, false, [path](BenchmarkState& s) { benchDeduplicate(s, path); }});
+        benchmarks.push_back({"obj_import_cold/" + name, false, [path](BenchmarkState& s) { benchObjImportCold(s, path); }});
+        benchmarks.push_back({"obj_import_cached/" + name, false, [path](BenchmarkState& s) { benchObjImportCached(s, path); }});
+        benchmarks.push_back({"mesh_load/" + name, true, [path](BenchmarkState& s) { benchMeshLoad(s, path); }});
+    }
+    for (int components : {1, 2, 4, 8}) {
+        benchmarks.push_back({"entity_get_component/" + std::to_string(components), false,
+                              [components](BenchmarkState& s) { benchGetComponent(s, components); }});
+    }
+    benchmarks.push_back({"transform_model_matrix", false, benchModelMatrix});
+    benchmarks.push_back({"gi_scheduler", false, benchGiScheduler});
+    for (const TextureFixture& texture : TEXTURES) {
+        const std::string path = texture.path;
+        const std::string name = baseName(path);
+        benchmarks.push_back({"texture_decode/" + name, false, [path](BenchmarkState& s) { benchTextureDecode(s, path); }});
+        benchmarks.push_back({"texture_compress/" + name, false, [texture](BenchmarkState& s) { benchTextureCompress(s, texture); }});
+        benchmarks.push_back({"texture_load/" + name, true, [path](BenchmarkState& s) { benchTextureLoad(s, path); }});
+    }
+    benchmarks.push_back({"shader_uniform/by_name", true, [](BenchmarkState& s) { benchUniforms(s, true); }});
+    benchmarks.push_back({"shader_uniform/by_location", true, [](BenchmarkState& s) { benchUniforms(s, false); }});
+    benchmarks.push_back({"still_frame/native", true, [](BenchmarkState& s) { benchStillFrame(s, 0); }});
+    benchmarks.push_back({"still_frame/taa", true, [](BenchmarkState& s) { benchStillFrame(s, 2); }});
+    return benchmarks;
+}
+
+// ---- Runner ----
+
+BenchmarkResult runBenchmark(const Benchmark& benchmark, const BenchmarkOptions& options) {
+    BenchmarkResult result;
+    result.name = benchmark.name;
+    NullBuffer nullBuffer;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&nullBuffer);
+
+    // Calibrate (and warm up): grow the iteration count until one run fills minTime
+    size_t iterations = 1;
+    for (;;) {
+        BenchmarkState state(iterations);
+        benchmark.run(state);
+        if (!state.getSkipReason().empty() || !state.getFailReason().empty()) {
+            std::cout.rdbuf(coutBuffer);
+            result.skipReason = state.getSkipReason();
+            result.failReason = state.getFailReason();
+            return result;
+        }
+        const double seconds = state.getSeconds();
+        if (seconds >= options.minTime || iterations >= 1000000000) {
+            break;
+        }
+        // Aim a little past minTime, growing at most tenfold per step
+        const double perIteration = seconds / iterations;
+        const double wanted = perIteration > 0.0 ? options.minTime * 1.2 / perIteration : iterations * 10.0;
+        iterations = static_cast<size_t>(std::min(std::max(wanted, iterations + 1.0), iterations * 10.0));
+    }
+
+    std::vector<double> samples;
+    uint64_t allocations = 0;
+    size_t itemsPerIteration = 0;
+    for (int r = 0; r < options.repetitions; ++r) {
+        BenchmarkState state(iterations);
+        const uint64_t allocationsBefore = PerformanceProfiler::getAllocationCount();
+        benchmark.run(state);
+        allocations += PerformanceProfiler::getAllocationCount() - allocationsBefore;
+        samples.push_back(state.getSeconds() * 1e9 / iterations);
+        itemsPerIteration = state.getItemsPerIteration();
+    }
+    std::cout.rdbuf(coutBuffer);
+
+    std::sort(samples.begin(), samples.end());
+    const size_t middle = samples.size() / 2;
+    result.medianNs = samples.size() % 2 ? samples[middle] : 0.5 * (samples[middle - 1] + samples[middle]);
+    result.minNs = samples.front();
+    result.iterations = iterations;
+    result.itemsPerSecond = itemsPerIteration > 0 && result.medianNs > 0.0 ? itemsPerIteration * 1e9 / result.medianNs : 0.0;
+    // Includes the setup of each repetition (fixtures), spread over its iterations
+    result.allocationsPerIteration = static_cast<double>(allocations) / (static_cast<double>(iterations) * options.repetitions);
+    return result;
+}
+
+std::string formatTime(double ns) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(ns < 10.0 ? 2 : 1);
+    if (ns >= 1e9) {
+        out << ns / 1e9 << " s";
+    } else if (ns >= 1e6) {
+        out << ns / 1e6 << " ms";
+    } else if (ns >= 1e3) {
+        out << ns / 1e3 << " us";
+    } else {
+        out << ns << " ns";
+    }
+    return out.str();
+}
+
+void printResult(const BenchmarkResult& result) {
+    std::cout << std::left << std::setw(40) << result.name << std::right;
+    if (!result.failReason.empty()) {
+        std::cout << "  FAILED (" << result.failReason << ")" << std::endl;
+        return;
+    }
+    if (!result.skipReason.empty()) {
+        std::cout << "  skipped (" << result.skipReason << ")" << std::endl;
+        return;
+    }
+    std::cout << std::setw(12) << formatTime(result.medianNs) << std::setw(12) << formatTime(result.minNs)
+              << std::setw(12) << result.iterations;
+    std::cout << std::fixed << std::setprecision(1) << std::setw(12) << result.allocationsPerIteration;
+    if (result.itemsPerSecond > 0.0) {
+        std::cout << std::setw(12) << std::setprecision(2) << result.itemsPerSecond / 1e6 << " M items/s";
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::endl;
+}
+
+bool saveBaseline(const std::string& file, const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(file);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write " << file << std::endl;
+        return false;
+    }
+    out << std::fixed << std::setprecision(1);
+    out << "benchmark,median_ns,min_ns,iterations,allocations_per_iteration\n";
+    for (const auto& result : results) {
+        if (result.skipReason.empty() && result.failReason.empty()) {
+            out << result.name << "," << result.medianNs << "," << result.minNs << "," << result.iterations << ","
+                << result.allocationsPerIteration << "\n";
+        }
+    }
+    std::cout << "Baseline written to " << file << std::endl;
+    return true;
+}
+
+bool loadBaseline(const std::string& file, std::map<std::string, double>& medians) {
+    std::ifstream in(file);
+    if (!in.is_open()) {
+        std::cerr << "Failed to read baseline " << file << std::endl;
+        return false;
+    }
+    std::string line;
+    std::getline(in, line); // Header
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name, median;
+        if (std::getline(fields, name, ',') && std::getline(fields, median, ',')) {
+            medians[name] = std::atof(median.c_str());
+        }
+    }
+    return true;
+}
+
+// Returns the number of regressions
+int compareToBaseline(const std::vector<BenchmarkResult>& results, const std::map<std::string, double>& baseline,
+                      double tolerance) {
+    int regressions = 0;
+    std::cout << "\n=== Baseline comparison (tolerance " << std::fixed << std::setprecision(0) << tolerance * 100.0
+              << "%) ===" << std::endl;
+    for (const auto& result : results) {
+        auto entry = baseline.find(result.name);
+        if (!result.skipReason.empty() || !result.failReason.empty() || entry == baseline.end() || entry->second <= 0.0) {
+            continue;
+        }
+        const double change = result.medianNs / entry->second - 1.0;
+        const bool regressed = change > tolerance;
+        std::ostream& out = regressed ? std::cerr : std::cout;
+        out << (regressed ? "REGRESSION " : "           ") << std::left << std::setw(40) << result.name << std::right
+            << std::setw(12) << formatTime(result.medianNs) << "  vs " << std::setw(12) << formatTime(entry->second)
+            << "  " << std::showpos << std::fixed << std::setprecision(1) << change * 100.0 << "%" << std::noshowpos
+            << std::endl;
+        regressions += regressed ? 1 : 0;
+    }
+    for (const auto& entry : baseline) {
+        bool found = std::any_of(results.begin(), results.end(), [&](const BenchmarkResult& r) { return r.name == entry.first; });
+        if (!found) {
+            std::cout << "           " << entry.first << " not run (in the baseline only)" << std::endl;
+        }
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    return regressions;
+}
+
+void printUsage() {
+    std::cout << "Usage: vibe-gi-microbench [options]\n"
+              << "  --filter <text>    Only run benchmarks whose name contains text\n"
+              << "  --repetitions <N>  Measured repetitions per benchmark (default: 5)\n"
+              << "  --min-time <s>     Minimum seconds per repetition (default: 0.1)\n"
+              << "  --baseline <file>  Compare against a baseline; exit with status 2 on regressions\n"
+              << "  --save-baseline <file> Write the results as a baseline\n"
+              << "  --tolerance <f>    Allowed slowdown against the baseline (default: 0.15 = 15%)\n"
+              << "  --gpu              Also run the benchmarks that need a GL context (hidden window)\n"
+              << "  --list             List the benchmarks and exit\n";
+}
+
+bool parseArguments(int argc, char** argv, BenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--filter" && hasValue) {
+                options.filter = argv[++i];
+            } else if (arg == "--repetitions" && hasValue) {
+                options.repetitions = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--min-time" && hasValue) {
+                options.minTime = std::max(0.0, std::stod(argv[++i]));
+            } else if (arg == "--baseline" && hasValue) {
+                options.baselineFile = argv[++i];
+            } else if (arg == "--save-baseline" && hasValue) {
+                options.saveBaselineFile = argv[++i];
+            } else if (arg == "--tolerance" && hasValue) {
+                options.tolerance = std::max(0.0, std::stod(argv[++i]));
+            } else if (arg == "--gpu") {
+                options.gpu = true;
+            } else if (arg == "--list") {
+                options.list = true;
+            } else if (arg == "--help" || arg == "-h") {
+                printUsage();
+                return false;
+            } else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                printUsage();
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<Benchmark> benchmarks = createBenchmarks();
+    benchmarks.erase(std::remove_if(benchmarks.begin(), benchmarks.end(), [&](const Benchmark& b) {
+        return (b.gpu && !options.gpu) || b.name.find(options.filter) == std::string::npos;
+    }), benchmarks.end());
+    if (options.list) {
+        for (const Benchmark& benchmark : benchmarks) {
+            std::cout << benchmark.name << (benchmark.gpu ? " (gpu)" : "") << std::endl;
+        }
+        return 0;
+    }
+
+    std::map<std::string, double> baseline;
+    if (!options.baselineFile.empty() && !loadBaseline(options.baselineFile, baseline)) {
+        return 1;
+    }
+
+    try {
+        // Only the GL benchmarks need a context; the rest run headless
+        std::unique_ptr<Window> window;
+        if (options.gpu) {
+            window = std::make_unique<Window>(64, 64, "Vibe-GI Micro-Benchmark", false);
+        }
+
+        std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "median"
+                  << std::setw(12) << "min" << std::setw(12) << "iterations" << std::setw(12) << "allocs/it"
+                  << std::setw(12) << "throughput" << std::endl;
+        std::vector<BenchmarkResult> results;
+        for (const Benchmark& benchmark : benchmarks) {
+            results.push_back(runBenchmark(benchmark, options));
+            printResult(results.back());
+        }
+
+        const int failures = static_cast<int>(std::count_if(results.begin(), results.end(), [](const BenchmarkResult& r) {
+            return !r.failReason.empty();
+        }));
+        bool ok = true;
+        if (!options.saveBaselineFile.empty()) {
+            ok = saveBaseline(options.saveBaselineFile, results) && ok;
+        }
+        int regressions = 0;
+        if (!baseline.empty()) {
+            regressions = compareToBaseline(results, baseline, options.tolerance);
+            if (regressions > 0) {
+                std::cerr << "\n" << regressions << " benchmark(s) regressed beyond "
+                          << options.tolerance * 100.0 << "% of " << options.baselineFile << std::endl;
+            } else {
+                std::cout << "\nNo regressions against " << options.baselineFile << std::endl;
+            }
+        }
+        // A wrong result outranks a slow one
+        if (failures > 0) {
+            std::cerr << "\n" << failures << " benchmark(s) failed their result check" << std::endl;
+            return 3;
+        }
+        if (regressions > 0) {
+            return 2;
+        }
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Micro-benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
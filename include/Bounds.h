@@ -0,0 +1,81 @@
+/**
+ * Bounds.h - Bounding Volumes and View Frustum Tests
+ *
+ * Meshes compute a local-space axis-aligned box and bounding sphere once,
+ * when they are created. Each frame they are carried to world space with
+ * the entity's model matrix (see BoundsComponent) and tested against view
+ * frusta before anything is submitted:
+ *
+ * - Sphere test first (one dot product per plane, rejects most objects)
+ * - Box test for the survivors (positive-vertex test per plane)
+ *
+ * Both tests are conservative: an object is only rejected when it lies
+ * entirely outside one plane, so nothing visible is ever culled.
+ */
+
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <glm/glm.hpp>
+
+/**
+ * Axis-aligned bounding box (empty until a point is added)
+ */
+struct BoundingBox {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    BoundingBox();
+    BoundingBox(const glm::vec3& minCorner, const glm::vec3& maxCorner) : min(minCorner), max(maxCorner) {}
+
+    bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    void expand(const glm::vec3& point);
+
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 getExtents() const { return (max - min) * 0.5f; }   ///< Half size per axis
+
+    /**
+     * Box enclosing this box after an affine transform (exact for the
+     * transformed corners, computed without transforming all eight)
+     */
+    BoundingBox transformed(const glm::mat4& matrix) const;
+};
+
+/**
+ * Bounding sphere
+ */
+struct BoundingSphere {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+
+    /**
+     * Sphere enclosing this sphere after an affine transform (radius grows by the largest axis scale)
+     */
+    BoundingSphere transformed(const glm::mat4& matrix) const;
+};
+
+/**
+ * Six clip planes of a view-projection matrix (normals point inward)
+ */
+class Frustum {
+public:
+    Frustum();
+
+    /**
+     * Extract the planes of a perspective or orthographic view-projection
+     */
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    bool intersects(const BoundingSphere& sphere) const;
+    bool intersects(const BoundingBox& box) const;
+
+    /**
+     * Plane 0-5: left, right, bottom, top, near, far
+     */
+    const glm::vec4& getPlane(int index) const { return planes[index]; }
+
+private:
+    glm::vec4 planes[6];            ///< xyz = normal, w = distance; inside when dot(n, p) + w >= 0
+};
+
+#endif // BOUNDS_H
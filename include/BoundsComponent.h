@@ -0,0 +1,22 @@
+// BoundsComponent.h
+#ifndef BOUNDSCOMPONENT_H
+#define BOUNDSCOMPONENT_H
+
+#include "../include/Bounds.h"
+
+/**
+ * World-space bounds of a mesh entity, kept next to its TransformComponent
+ * DrawBatcher adds and refreshes it every frame from the mesh's local bounds.
+ */
+class BoundsComponent {
+public:
+    BoundingBox box;                ///< World-space axis-aligned box
+    BoundingSphere sphere;          ///< World-space bounding sphere
+
+    void update(const BoundingBox& localBox, const BoundingSphere& localSphere, const glm::mat4& model) {
+        box = localBox.transformed(model);
+        sphere = localSphere.transformed(model);
+    }
+};
+
+#endif // BOUNDSCOMPONENT_H
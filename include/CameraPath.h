@@ -0,0 +1,71 @@
+/**
+ * CameraPath.h - Recorded Camera and Light Paths
+ *
+ * A camera path is a list of timed keyframes holding the camera position and
+ * orientation plus the primary light position. Paths can be recorded from an
+ * interactive session, saved as plain text and replayed deterministically by
+ * the benchmark, so every build renders exactly the same sequence of frames.
+ *
+ * File format (one keyframe per line, '#' starts a comment):
+ *     time  camX camY camZ  yaw pitch  lightX lightY lightZ
+ */
+
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Camera;
+
+struct CameraKeyframe {
+    float time = 0.0f;                     ///< Time in seconds from the start of the path
+    glm::vec3 cameraPosition{0.0f};        ///< Camera world position
+    float yaw = -90.0f;                    ///< Camera yaw in degrees
+    float pitch = 0.0f;                    ///< Camera pitch in degrees
+    glm::vec3 lightPosition{0.0f};         ///< Primary light world position
+};
+
+class CameraPath {
+public:
+    /**
+     * Append a keyframe; keyframes must be added in increasing time order
+     */
+    void addKeyframe(const CameraKeyframe& keyframe);
+
+    /**
+     * Sample the path at a given time (clamped to the path duration)
+     * Positions and angles are interpolated linearly between keyframes.
+     */
+    CameraKeyframe sample(float time) const;
+
+    /**
+     * Apply a sampled keyframe to a camera (updates its direction vectors)
+     */
+    static void applyToCamera(const CameraKeyframe& keyframe, Camera& camera);
+
+    bool loadFromFile(const std::string& path);
+    bool saveToFile(const std::string& path) const;
+
+    /**
+     * Build a slow orbit around a point, with the light swinging in a circle above it
+     *
+     * @param center         Point the camera orbits and looks at
+     * @param radius         Orbit radius
+     * @param height         Camera height above the center
+     * @param lightPosition  Light rest position (orbits around it with a small radius)
+     * @param duration       Length of one full orbit in seconds
+     */
+    static CameraPath createOrbit(const glm::vec3& center, float radius, float height,
+                                  const glm::vec3& lightPosition, float duration);
+
+    bool empty() const { return keyframes.empty(); }
+    float getDuration() const { return keyframes.empty() ? 0.0f : keyframes.back().time; }
+    const std::vector<CameraKeyframe>& getKeyframes() const { return keyframes; }
+
+private:
+    std::vector<CameraKeyframe> keyframes;
+};
+
+#endif // CAMERA_PATH_H
@@ -0,0 +1,80 @@
+/**
+ * DepthPyramid.h - Hierarchical-Z Min/Max Depth Pyramid
+ *
+ * Built once per frame right after the G-buffer. Level 0 matches the
+ * render resolution and every further level halves it (GL mip sizes), with
+ * each texel holding the NEAREST (r) and FARTHEST (g) linear depth of the
+ * texels below it:
+ *
+ * - Screen-space rays (hiz_trace.glsl: SSR and the cascade march) skip
+ *   every cell they cross entirely in front of its nearest depth or behind
+ *   its farthest, climbing to coarser levels while space stays empty and
+ *   descending only near a surface, so long rays cost a few dozen texel
+ *   fetches instead of a fixed step count that misses thin geometry.
+ * - Occlusion culling reduces its readback grid from a coarse max level
+ *   instead of from the full-resolution depth.
+ *
+ * The background (linear depth 0) is stored as NO_GEOMETRY_DEPTH so it
+ * never counts as a surface and never occludes.
+ */
+
+#ifndef DEPTHPYRAMID_H
+#define DEPTHPYRAMID_H
+
+#include <cstddef>
+
+class Shader;
+class FullscreenQuad;
+
+class DepthPyramid {
+public:
+    static const int TEXTURE_UNIT = 14;                 ///< Where bindForSampling() leaves the pyramid
+    static constexpr float NO_GEOMETRY_DEPTH = 1.0e30f; ///< Stored for background texels
+
+    DepthPyramid();
+    ~DepthPyramid();
+    DepthPyramid(const DepthPyramid&) = delete;
+    DepthPyramid& operator=(const DepthPyramid&) = delete;
+
+    /**
+     * (Re)allocate for a render resolution; no-op when the size is unchanged
+     */
+    void resize(int width, int height);
+
+    /**
+     * Rebuild every level from the G-buffer linear depth
+     * Leaves the framebuffer and viewport for the caller to restore.
+     *
+     * @param shader      Program built from hiz_build.frag
+     * @param quad        Fullscreen quad
+     * @param linearDepth G-buffer linear depth texture (resize() first)
+     */
+    void build(Shader& shader, FullscreenQuad& quad, unsigned int linearDepth);
+
+    /**
+     * Bind the pyramid at TEXTURE_UNIT and set the hiz_trace.glsl level count
+     * (shader must be in use; the depthPyramid sampler unit is the caller's)
+     */
+    void bindForSampling(Shader& shader) const;
+
+    unsigned int getTexture() const { return texture; }
+    int getLevelCount() const { return levelCount; }
+    int getLevelWidth(int level) const;
+    int getLevelHeight(int level) const;
+
+    /**
+     * Bytes of GPU texture memory (all levels)
+     */
+    size_t getMemoryUsage() const;
+
+private:
+    void cleanup();
+
+    unsigned int texture;   ///< RG32F, r = min and g = max linear depth per level
+    unsigned int fbo;
+    int width;
+    int height;
+    int levelCount;
+};
+
+#endif // DEPTHPYRAMID_H
@@ -0,0 +1,240 @@
+/**
+ * DrawBatcher.h - Sorted, Instanced Geometry Submission
+ *
+ * Collects every (Mesh, Transform[, Material]) entity once per frame, sorts
+ * the draws by mesh and then material, and turns runs of identical meshes
+ * into instanced draws. Per-instance data (model matrix, object color and
+ * material index) lives in one vertex buffer that is uploaded once per frame
+ * and read by the vertex shaders as attributes:
+ *
+ *     location 5-8: mat4 instanceModel  (one column per location)
+ *     location 9:   vec4 instanceColor  (a = MaterialTable index)
+ *
+ * Because instances are ordered by mesh first, the same buffer serves two
+ * batch lists:
+ *
+ * - Material batches: same mesh and same material textures (G-buffer pass;
+ *   the shader looks everything else up in the MaterialTable)
+ * - Mesh batches:     same mesh, any material (depth-only passes)
+ *
+ * Entities with a Behaviour attached are treated as dynamic (they may move
+ * every frame); everything else is static. Static and dynamic instances never
+ * share a batch, so the shadow cache can re-render only the moving casters.
+ *
+ * While drawing, the VAO and material textures are only changed when they
+ * actually differ from the previous batch, so the number of GL calls grows
+ * with the number of distinct meshes and texture sets rather than with the
+ * number of entities or materials.
+ *
+ * GL 3.3 has no base instance, so each batch re-points the instance
+ * attributes at its first instance before drawing.
+ *
+ * Culling: build() produces view 0, which draws everything. addView()
+ * tests every instance's world bounds (BoundsComponent) against a frustum,
+ * and optionally an OcclusionCuller, and appends the survivors to the same
+ * instance buffer as a compacted copy with its own batch lists. The buffer
+ * is uploaded once, by the first draw after the last view was added.
+ *
+ * The instances go to a RingBuffer region per frame in flight
+ * (setFrameRegion()), so the upload never waits for the previous frames'
+ * draws; the attribute pointers add the offset of this frame's data.
+ *
+ * Levels of detail: view 0 draws each mesh's finest resident level, and
+ * a CPU-culled view added with a LodSelection draws, per instance, the
+ * coarsest level whose simplification error projects to at most
+ * maxErrorPixels (see Mesh::requestLod()). Each run of one mesh is
+ * appended level by level, so the levels still batch. Entities whose mesh
+ * is still loading are skipped.
+ *
+ * GPU-driven mode (setGpuCuller()): build() hands view 0 to a GpuCuller,
+ * and added views are culled by a compute pass instead of on the CPU and
+ * drawn with multi-draw-indirect calls (see GpuCuller.h). The draw calls
+ * and shadow cache work unchanged; only the culled views' instance counts
+ * are unknown on the CPU, and every view draws view 0's levels.
+ */
+
+#ifndef DRAW_BATCHER_H
+#define DRAW_BATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Bounds.h"
+#include "MaterialTable.h"
+#include "RingBuffer.h"
+
+class Mesh;
+class Material;
+class Registry;
+class Shader;
+class OcclusionCuller;
+class GpuCuller;
+struct HiZOcclusion;
+
+/**
+ * Per-instance vertex data (80 bytes, matches locations 5-9)
+ */
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 color;                ///< rgb = object color, a = MaterialTable index
+};
+
+/**
+ * A contiguous run of instances drawn with one call
+ */
+struct DrawBatch {
+    Mesh* mesh;
+    Material* material;             ///< First material of the batch (they all share its maps); nullptr for mesh batches and unmaterialed entities
+    unsigned int firstInstance;
+    unsigned int instanceCount;
+    bool dynamic;                   ///< Instances belong to entities with a Behaviour
+    int textureSet;                 ///< MaterialTable texture set of the instances (0 for mesh batches)
+};
+
+/**
+ * How a view picks levels of detail
+ */
+struct LodSelection {
+    glm::mat4 viewProjection;
+    float viewportHeight;           ///< Pixels (or shadow map texels) covered by clip space y -1..1
+    float maxErrorPixels;           ///< Largest projected simplification error; 0 draws full detail
+};
+
+/**
+ * Which mesh batches a depth-only draw submits
+ */
+enum class BatchFilter {
+    All,
+    Static,
+    Dynamic
+};
+
+class DrawBatcher {
+public:
+    static const unsigned int INSTANCE_MODEL_LOCATION = 5;  ///< Locations 5-8
+    static const unsigned int INSTANCE_COLOR_LOCATION = 9;
+
+    DrawBatcher();
+    ~DrawBatcher();
+    DrawBatcher(const DrawBatcher&) = delete;
+    DrawBatcher& operator=(const DrawBatcher&) = delete;
+
+    /**
+     * Gather, sort and batch all drawable entities and refresh their world bounds
+     * Call once per frame after transforms are final. Resets the views to view 0.
+     *
+     * @param worldMatrices Model matrices packed like registry.pool<TransformComponent>()
+     *                      (Scene::getWorldMatrices()); if the size does not match, the
+     *                      matrices are computed here instead
+     */
+    void build(Registry& registry, const std::vector<glm::mat4>& worldMatrices);
+
+    /**
+     * Ring region the next upload writes to (FramePacer::getRegion(); set before build())
+     */
+    void setFrameRegion(int region) { frameRegion = region; }
+
+    /**
+     * Cull and draw the added views on the GPU, or on the CPU with nullptr
+     * (set before build(); the culler must outlive its use)
+     */
+    void setGpuCuller(GpuCuller* culler) { gpuCuller = culler; }
+    bool isGpuDriven() const { return gpuCuller != nullptr; }
+
+    /**
+     * Add a culled view of this frame's instances
+     *
+     * @param frustum   Instances outside it are dropped
+     * @param occlusion Optional, CPU culling only; instances it reports occluded are dropped too
+     * @param hiZ       Optional, GPU culling only; instances hidden in last frame's depth are dropped too
+     * @param lod       Optional, CPU culling only; without it the view draws view 0's levels
+     * @return View index for the draw calls
+     */
+    int addView(const Frustum& frustum, const OcclusionCuller* occlusion = nullptr,
+                const HiZOcclusion* hiZ = nullptr, const LodSelection* lod = nullptr);
+
+    /**
+     * Draw the mesh batches with a depth-only shader (no material state)
+     */
+    void drawMeshBatches(const Shader& shader, BatchFilter filter = BatchFilter::All, int view = 0);
+
+    /**
+     * Draw every material batch with the material table bound, binding the
+     * material textures only when the texture set changes (unless the table
+     * is bindless). The shader must be bound.
+     */
+    void drawMaterialBatches(const Shader& shader, int view = 0);
+
+    const std::vector<DrawBatch>& getMaterialBatches(int view = 0) const { return views[view].materialBatches; }
+    const std::vector<DrawBatch>& getMeshBatches(int view = 0) const { return views[view].meshBatches; }
+    size_t getInstanceCount(int view = 0) const { return views[view].instanceCount; }  ///< Before culling for GPU-culled views
+    bool hasDynamicInstances() const { return dynamicInstanceCount > 0; }
+    MaterialTable& getMaterialTable() { return materialTable; }
+    const MaterialTable& getMaterialTable() const { return materialTable; }
+
+    /**
+     * Hash of every static instance (mesh and model matrix) and of the mesh
+     * residency; changes whenever static geometry is added, removed or moved,
+     * or levels of detail are loaded or released
+     */
+    uint64_t getStaticHash() const { return staticHash; }
+    
+    /**
+     * Hash of every instance (mesh, material, model matrix and color); changes
+     * whenever anything drawn is added, removed, moved or given another material
+     */
+    uint64_t getSceneHash() const { return sceneHash; }
+
+    /**
+     * Point the instance attributes (locations 5-9) of the bound VAO at
+     * InstanceData in the bound GL_ARRAY_BUFFER, starting at a byte offset
+     */
+    static void setInstanceAttributes(size_t byteOffset);
+
+private:
+    struct DrawItem {
+        Mesh* mesh;                 ///< Full-detail mesh (sort key)
+        Mesh* drawMesh;             ///< Level drawn by view 0
+        Material* material;
+        unsigned int entity;        ///< Tie-breaker so the order is stable frame to frame
+        bool dynamic;
+        int textureSet;
+        InstanceData instance;
+        BoundingBox box;            ///< World space
+        BoundingSphere sphere;      ///< World space
+    };
+
+    struct View {
+        std::vector<DrawBatch> materialBatches;
+        std::vector<DrawBatch> meshBatches;
+        size_t instanceCount = 0;
+        int gpuView = -1;           ///< GpuCuller view, or -1 when culled on the CPU
+    };
+
+    RingBuffer instanceRing;
+    size_t instanceOffset;          ///< Byte offset of this frame's instances in instanceRing
+    int frameRegion;                ///< Ring region of this frame (FramePacer::getRegion())
+    MaterialTable materialTable;    ///< Rebuilt by build()
+    GpuCuller* gpuCuller;           ///< Optional (setGpuCuller())
+
+    std::vector<DrawItem> items;
+    std::vector<BoundingBox> boxes;         ///< World bounds of view 0's instances (GPU culling input)
+    std::vector<InstanceData> instances;    ///< View 0 first, then every added view's survivors
+    std::vector<const DrawItem*> survivors; ///< addView() scratch
+    std::vector<Mesh*> survivorMeshes;      ///< addView() scratch: level drawn per survivor
+    std::vector<View> views;                ///< views[0] draws everything; only the first viewCount are this frame's
+    size_t viewCount;
+    size_t uploadedCount;                   ///< Instances in instanceRing (upload() is due when it differs)
+    size_t dynamicInstanceCount;
+    uint64_t staticHash;
+    uint64_t sceneHash;
+
+    void appendInstance(View& view, const DrawItem& item, Mesh* mesh);
+    static int selectLod(const DrawItem& item, const LodSelection& lod);
+    static void clearView(View& view);
+    void upload();
+    void bindInstanceAttributes(unsigned int firstInstance) const;
+};
+
+#endif // DRAW_BATCHER_H
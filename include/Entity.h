@@ -1,33 +1,64 @@
-
 // Entity.h
 #ifndef ENTITY_H
 #define ENTITY_H
 
-#include <vector>
+#include "Registry.h"
 #include <memory>
+#include <utility>
 
-class Component;
+class Behaviour;
 
+/**
+ * Entity - Lightweight handle to an entity stored in a Registry
+ *
+ * Components live in the registry's packed pools, not in the entity, so the
+ * handle is just (registry, id) and is cheap to copy. Component pointers
+ * returned here follow the Registry lifetime rules.
+ */
 class Entity {
 public:
-    void addComponent(std::unique_ptr<Component> component);
+    Entity() = default;
+    Entity(Registry* registry, EntityId id) : registry(registry), id(id) {}
+
+    template <typename T, typename... Args>
+    T& addComponent(Args&&... args) {
+        return registry->add<T>(id, std::forward<Args>(args)...);
+    }
+
     template <typename T>
-    T* getComponent() {
-        for (auto& comp : components) {
-            if (T* c = dynamic_cast<T*>(comp.get())) {
-                return c;
-            }
-        }
-        return nullptr;
+    T* getComponent() const {
+        return registry ? registry->get<T>(id) : nullptr;
     }
 
-private:
-    std::vector<std::unique_ptr<Component>> components;
-};
+    template <typename T>
+    bool hasComponent() const {
+        return registry && registry->has<T>(id);
+    }
 
-class Component {
-public:
-    virtual ~Component() = default;
+    template <typename T>
+    void removeComponent() {
+        registry->remove<T>(id);
+    }
+
+    /**
+     * Attach a script component; behaviours are polymorphic so they are
+     * stored by pointer in the registry's Behaviour pool
+     */
+    Behaviour* addBehaviour(std::unique_ptr<Behaviour> behaviour);
+
+    /**
+     * Get the attached script component, or nullptr
+     */
+    Behaviour* getBehaviour() const;
+
+    EntityId getId() const { return id; }
+    Registry* getRegistry() const { return registry; }
+    bool isValid() const { return registry && registry->isAlive(id); }
+    explicit operator bool() const { return isValid(); }
+
+private:
+    Registry* registry = nullptr;
+    EntityId id = INVALID_ENTITY;
 };
 
-#endif // ENTITY_H 
\ No newline at end of file
+#endif // ENTITY_H
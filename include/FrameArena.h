@@ -0,0 +1,98 @@
+/**
+ * FrameArena.h - Linear Allocator for Per-Frame Scratch Memory
+ *
+ * Temporary arrays that only live for one frame (culling lists, sort
+ * scratch) are carved out of one block by bumping a pointer instead of going
+ * to the system allocator. reset() at the start of the next frame releases
+ * everything at once; nothing is freed individually and no destructors run,
+ * so only trivially destructible data belongs here.
+ *
+ * A frame that needs more than the block holds gets further blocks; the
+ * next reset() replaces them with one block of the frame's total size, so
+ * after the first few frames the arena never allocates again.
+ *
+ * Allocator<T> plugs the arena into standard containers (FrameArena::Vector);
+ * reserve() up front, since every regrowth leaves the old storage unused
+ * until the reset. Not thread-safe: one arena per thread.
+ */
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class FrameArena {
+public:
+    explicit FrameArena(size_t initialCapacity = 256 * 1024);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * Uninitialised memory valid until the next reset()
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * Release everything allocated since the last reset (once per frame)
+     */
+    void reset();
+
+    size_t getUsed() const { return used + offset; }       ///< Bytes handed out since the last reset
+    size_t getCapacity() const;
+    size_t getHighWater() const { return highWater; }      ///< Most bytes any frame used
+
+    /**
+     * Standard allocator drawing from an arena (deallocate is a no-op)
+     */
+    template <typename T>
+    class Allocator {
+    public:
+        typedef T value_type;
+
+        explicit Allocator(FrameArena& arena) : arena(&arena) {}
+        template <typename U>
+        Allocator(const Allocator<U>& other) : arena(other.arena) {}
+
+        T* allocate(size_t count) { return arena->allocateArray<T>(count); }
+        void deallocate(T*, size_t) {}
+
+        template <typename U>
+        bool operator==(const Allocator<U>& other) const { return arena == other.arena; }
+        template <typename U>
+        bool operator!=(const Allocator<U>& other) const { return arena != other.arena; }
+
+    private:
+        template <typename U>
+        friend class Allocator;
+        FrameArena* arena;
+    };
+
+    template <typename T>
+    using Vector = std::vector<T, Allocator<T>>;
+
+    /**
+     * An empty vector allocating from this arena
+     */
+    template <typename T>
+    Vector<T> makeVector() { return Vector<T>(Allocator<T>(*this)); }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;      ///< blocks.back() is the one being filled
+    size_t offset;                  ///< Next free byte in blocks.back()
+    size_t used;                    ///< Bytes handed out from the blocks before blocks.back()
+    size_t highWater;
+};
+
+#endif // FRAME_ARENA_H
@@ -0,0 +1,64 @@
+/**
+ * FrameBudgetController.h - Closed-Loop Dynamic Resolution
+ *
+ * Holds the frame time near a target (e.g. 16.7 ms for 60 Hz) by adjusting
+ * two knobs instead of the manual quality preset:
+ *
+ * 1. Internal render scale of the G-buffer, GI and composite targets
+ *    (TAA/FXAA resolve back to the output resolution)
+ * 2. Radiance cascades dropped below the quality level's count, once the
+ *    scale has reached its floor
+ *
+ * The measured time (GPU time of the renderer's work, when available) is
+ * low-pass filtered. Decisions are only taken after the effect of the last
+ * change is visible: GPU timings arrive a few frames late, and every scale
+ * change reallocates render targets, so changes are quantized to
+ * SCALE_STEP and spaced by SETTLE_FRAMES. Scaling down is proportional to
+ * the overshoot (cost ~ pixel count); scaling up is one step at a time
+ * with a wider dead band, which keeps the loop from oscillating.
+ */
+
+#ifndef FRAME_BUDGET_CONTROLLER_H
+#define FRAME_BUDGET_CONTROLLER_H
+
+class FrameBudgetController {
+public:
+    static constexpr float MIN_RENDER_SCALE = 0.5f;
+    static constexpr float SCALE_STEP = 0.05f;
+    static const int MAX_CASCADE_REDUCTION = 3;
+    static const int LATENCY_FRAMES = 5;        ///< Samples ignored after a change (GPU results lag behind)
+    static const int SETTLE_FRAMES = 20;        ///< Frames between two changes
+
+    /**
+     * Target frame time in milliseconds (1000 / refresh rate)
+     */
+    void setTargetFrameTime(float milliseconds) { targetFrameTime = milliseconds; }
+    float getTargetFrameTime() const { return targetFrameTime; }
+
+    /**
+     * Feed one frame's measured time; returns true when scale or cascade count changed
+     *
+     * @param frameTime Measured frame time in milliseconds (ignored when <= 0)
+     */
+    bool update(float frameTime);
+
+    /**
+     * Return to full resolution and all cascades
+     */
+    void reset();
+
+    float getRenderScale() const { return renderScale; }
+    int getCascadeReduction() const { return cascadeReduction; }
+    float getFilteredFrameTime() const { return filteredFrameTime; }
+
+private:
+    float targetFrameTime = 1000.0f / 60.0f;
+    float filteredFrameTime = -1.0f;            ///< Negative until the first sample after a change
+    float renderScale = 1.0f;
+    int cascadeReduction = 0;
+    int framesSinceChange = 0;
+
+    void changed();
+};
+
+#endif // FRAME_BUDGET_CONTROLLER_H
@@ -0,0 +1,63 @@
+/**
+ * FramePacer.h - Limit on Frames in Flight
+ *
+ * GL commands only queue work; the CPU can record frame N+1 while the GPU
+ * still executes frame N, as long as nothing makes it wait. The pacer lets
+ * the CPU run at most framesInFlight frames ahead: endFrame() fences each
+ * frame's commands, and beginFrame() waits for the fence of the frame that
+ * many frames back. With 1 this is the old serial loop; 2 (default) lets
+ * CPU and GPU overlap by one frame without adding more latency.
+ *
+ * The limit is also what makes the per-frame ring buffers (RingBuffer.h)
+ * safe without further fences: a region is rewritten every
+ * MAX_FRAMES_IN_FLIGHT frames, and the frame that used it last has
+ * finished by then.
+ */
+
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <cstdint>
+
+struct __GLsync;
+
+class FramePacer {
+public:
+    static const int MAX_FRAMES_IN_FLIGHT = 3;
+
+    FramePacer();
+    ~FramePacer();
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    /**
+     * Wait until fewer than framesInFlight earlier frames are unfinished
+     *
+     * @param framesInFlight Clamped to 1..MAX_FRAMES_IN_FLIGHT
+     */
+    void beginFrame(int framesInFlight);
+
+    /**
+     * Fence everything submitted for this frame
+     */
+    void endFrame();
+
+    /**
+     * Ring buffer region of the current frame (see RingBuffer.h)
+     */
+    int getRegion() const { return static_cast<int>(frameIndex % MAX_FRAMES_IN_FLIGHT); }
+
+    uint64_t getFrameIndex() const { return frameIndex; }
+
+    /**
+     * CPU time the last beginFrame() waited for the GPU (ms)
+     */
+    float getLastWaitTime() const { return lastWaitTime; }
+
+private:
+    __GLsync* fences[MAX_FRAMES_IN_FLIGHT];    ///< By frame index modulo MAX_FRAMES_IN_FLIGHT
+    uint64_t frameIndex;
+    float lastWaitTime;
+};
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,177 @@
+/**
+ * GLExtensions.h - Runtime Detection of OpenGL Features Beyond 3.3
+ *
+ * The renderer is built against the OpenGL 3.3 core headers and asks for a
+ * 3.3 core context, which is all macOS offers. Other drivers usually hand
+ * back a newer context, so newer features are detected at runtime and their
+ * entry points are loaded through GLFW; the same binary then takes the fast
+ * path where it exists and falls back to the 3.3 code elsewhere.
+ *
+ * Call initialize() once a context is current (Renderer does this). Every
+ * wrapper is a no-op when the feature is unavailable, so callers only need
+ * to check the has*() query to pick a path.
+ */
+
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <cstdint>
+
+// Tokens missing from the 3.3 core headers
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_TEXTURE_FETCH_BARRIER_BIT
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#endif
+#ifndef GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#endif
+#ifndef GL_FRAMEBUFFER_BARRIER_BIT
+#define GL_FRAMEBUFFER_BARRIER_BIT 0x00000400
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DEBUG_OUTPUT
+#define GL_DEBUG_OUTPUT 0x92E0
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_DEBUG_TYPE_PERFORMANCE
+#define GL_DEBUG_TYPE_PERFORMANCE 0x8250
+#endif
+
+class GLExtensions {
+public:
+    /**
+     * Query the context version and extensions and load the entry points
+     * Safe to call more than once; later calls do nothing.
+     */
+    static void initialize();
+
+    static int getMajorVersion() { return majorVersion; }
+    static int getMinorVersion() { return minorVersion; }
+
+    /**
+     * Whether the context advertises an extension (e.g. "GL_ARB_compute_shader")
+     */
+    static bool hasExtension(const char* name);
+
+    /**
+     * Compute shaders plus image load/store (GL 4.3 or the matching ARB extensions)
+     */
+    static bool hasComputeShaders() { return computeShaders; }
+
+    /**
+     * Compute shaders writing storage buffers that multi-draw-indirect calls
+     * consume, with base instances (GL 4.3, or compute shaders plus
+     * GL_ARB_shader_storage_buffer_object, GL_ARB_multi_draw_indirect and
+     * GL_ARB_base_instance)
+     */
+    static bool hasMultiDrawIndirect() { return multiDrawIndirect; }
+
+    /**
+     * Texture handles usable as shader samplers without binding (GL_ARB_bindless_texture)
+     */
+    static bool hasBindlessTextures() { return bindlessTextures; }
+
+    /**
+     * Linked programs can be saved and reloaded as driver binaries (GL 4.1 or
+     * GL_ARB_get_program_binary, with at least one binary format)
+     */
+    static bool hasProgramBinary() { return programBinaries; }
+
+    /**
+     * The driver compiles on its own threads and reports completion without
+     * blocking (GL_KHR/ARB_parallel_shader_compile)
+     */
+    static bool hasParallelShaderCompile() { return parallelShaderCompile; }
+
+    /**
+     * Immutable buffer storage that can stay mapped while the GPU reads it
+     * (GL 4.4 or GL_ARB_buffer_storage)
+     */
+    static bool hasBufferStorage() { return bufferStorageSupported; }
+
+    /**
+     * Driver messages through a callback (GL 4.3 or GL_KHR_debug); only some
+     * drivers report performance warnings outside a debug context
+     */
+    static bool hasDebugOutput() { return debugOutput; }
+
+    /**
+     * Receives performance messages (GL_DEBUG_TYPE_PERFORMANCE) while debug
+     * output is enabled
+     */
+    typedef void (*PerformanceMessageHandler)(const char* message);
+
+    // GL 4.2/4.3 entry points (no-ops when unsupported)
+    static void dispatchCompute(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ);
+    static void bindImageTexture(unsigned int unit, unsigned int texture, int level, bool layered,
+                                 int layer, unsigned int access, unsigned int format);
+    static void memoryBarrier(unsigned int barriers);
+
+    // GL 4.3 multi-draw-indirect entry point (no-op when unsupported); commands
+    // are read from the bound GL_DRAW_INDIRECT_BUFFER at offset
+    static void multiDrawElementsIndirect(unsigned int mode, unsigned int type, intptr_t offset,
+                                          int drawCount, int stride);
+
+    // GL_ARB_bindless_texture entry points (no-ops, handle 0, when unsupported)
+    static uint64_t getTextureHandle(unsigned int texture);
+    static void makeTextureHandleResident(uint64_t handle);
+    static void makeTextureHandleNonResident(uint64_t handle);
+
+    // GL 4.1 program binary entry points (no-ops, length 0, when unsupported)
+    static void programParameteri(unsigned int program, unsigned int name, int value);
+    static void getProgramBinary(unsigned int program, int bufferSize, int* length, unsigned int* format, void* binary);
+    static void programBinary(unsigned int program, unsigned int format, const void* binary, int length);
+
+    // GL 4.4 buffer storage entry point (no-op when unsupported)
+    static void bufferStorage(unsigned int target, intptr_t size, const void* data, unsigned int flags);
+
+    /**
+     * Route the driver's performance messages to a handler, or stop with
+     * nullptr (no-op without debug output)
+     */
+    static void setPerformanceMessageHandler(PerformanceMessageHandler handler);
+
+private:
+    static bool initialized;
+    static int majorVersion;
+    static int minorVersion;
+    static bool computeShaders;
+    static bool multiDrawIndirect;
+    static bool bindlessTextures;
+    static bool programBinaries;
+    static bool parallelShaderCompile;
+    static bool bufferStorageSupported;
+    static bool debugOutput;
+};
+
+#endif // GL_EXTENSIONS_H
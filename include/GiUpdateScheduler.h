@@ -0,0 +1,89 @@
+/**
+ * GiUpdateScheduler.h - Change Tracking and Incremental Cascade Updates
+ *
+ * Decides every frame which radiance cascades are recomputed, from what
+ * changed since the last frame:
+ *
+ * - View (camera position or forward direction, compared with a tolerance
+ *   in world units and radians so that TAA jitter and float noise do not
+ *   count as movement): every cascade is recomputed. The cascades live
+ *   in screen space, but their history is reprojected with the motion
+ *   vectors, so moving no longer throws away converged GI.
+ * - Scene (geometry, materials, transforms; DrawBatcher::getSceneHash())
+ *   or lights (primary position, color, radius; LightClusters::getLightHash()
+ *   for the local lights) with a still camera: the fine
+ *   cascades are recomputed every frame, the coarse ones (far light, slow
+ *   to change on screen) round-robin, one of every COARSE_UPDATE_INTERVAL
+ *   frames each.
+ * - Nothing: cascades keep accumulating for CONVERGE_FRAMES, then GI is
+ *   left as it is (no compute or blur) until something changes.
+ *
+ * With the probe cache as far field (FrameState::probeFarField, see
+ * ProbeCache.h) the coarse cascades no longer follow the view every frame
+ * either: the light beyond them lives in world space, so they are
+ * recomputed round-robin every MOVING_COARSE_UPDATE_INTERVAL frames while
+ * the camera moves.
+ *
+ * Resolution, cascade count, the far-field source, switching world-space
+ * rays or an explicit reset() force a full update. The scene hash covers
+ * off-screen instances too, so the BVH hits are tracked like everything else.
+ */
+
+#ifndef GI_UPDATE_SCHEDULER_H
+#define GI_UPDATE_SCHEDULER_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class GiUpdateScheduler {
+public:
+    static const int CONVERGE_FRAMES = 32;          ///< Unchanged frames accumulated before GI sleeps
+    static const int COARSE_UPDATE_INTERVAL = 4;    ///< Frames between updates of one coarse cascade
+    static const int MOVING_COARSE_UPDATE_INTERVAL = 2; ///< Same while the view moves (probe far field only)
+    static const int FIRST_COARSE_CASCADE = 2;      ///< Cascades below this always follow scene changes
+
+    /**
+     * Everything the cascades depend on, captured once per frame
+     */
+    struct FrameState {
+        glm::vec3 cameraPosition = glm::vec3(0.0f);
+        glm::vec3 cameraForward = glm::vec3(0.0f, 0.0f, -1.0f);
+        uint64_t sceneHash = 0;
+        glm::vec3 lightPosition = glm::vec3(0.0f);
+        glm::vec3 lightColor = glm::vec3(0.0f);     ///< Color * intensity (zero when the light is off)
+        float lightRadius = 0.0f;
+        uint64_t localLightHash = 0;                ///< LightClusters::getLightHash()
+        int activeCascades = 0;
+        int width = 0;                              ///< Cascade (internal render) resolution
+        int height = 0;
+        bool probeFarField = false;                 ///< Coarsest cascade merges the probe cache
+        bool worldSpaceRays = false;                ///< Screen misses continue through the scene BVH
+    };
+
+    /**
+     * Compare with the previous frame and pick the cascades to recompute
+     *
+     * @return Update mask (bit i = cascade i), 0 when GI can be reused as is
+     */
+    unsigned int update(const FrameState& state);
+
+    /**
+     * Force a full update next frame (history was cleared)
+     */
+    void reset() { hasPrevious = false; }
+
+    bool isViewChanged() const { return viewChanged; }
+    bool isSceneChanged() const { return sceneChanged; }
+    unsigned int getUpdateMask() const { return updateMask; }
+
+private:
+    FrameState previous;
+    bool hasPrevious = false;
+    bool viewChanged = false;
+    bool sceneChanged = false;
+    int unchangedFrames = 0;
+    unsigned int frame = 0;
+    unsigned int updateMask = 0;
+};
+
+#endif // GI_UPDATE_SCHEDULER_H
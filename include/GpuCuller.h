@@ -0,0 +1,183 @@
+/**
+ * GpuCuller.h - GPU Instance Culling and Multi-Draw-Indirect Submission
+ *
+ * The GPU-driven path of DrawBatcher (DrawBatcher::setGpuCuller()). The CPU
+ * still sorts and batches the instances once per frame, but no longer culls
+ * them or issues a call per batch:
+ *
+ * 1. update() turns view 0's material batches into draw commands
+ *    (DrawElementsIndirectCommand) against a MeshArena, and uploads every
+ *    instance's model matrix, color, world box and command. Both only
+ *    change with DrawBatcher::getSceneHash(), so static scenes upload
+ *    nothing per frame.
+ * 2. addView() records a frustum and, for the camera, optionally the
+ *    previous frame's depth pyramid (HiZOcclusion). The views of a frame are
+ *    culled together by the first draw of any of them: gpu_cull.comp tests
+ *    every instance and appends the survivors to their command's instance
+ *    range in that view's part of the visible-instance buffer.
+ * 3. The depth and material draws bind the arena segment and the view's
+ *    visible instances and issue one glMultiDrawElementsIndirect call per
+ *    run of commands: per vertex format for depth passes, and additionally
+ *    per static/dynamic half and material texture set for the G-buffer.
+ *
+ * Commands are ordered by vertex format, then static before dynamic, then
+ * texture set, so every run is a contiguous command range.
+ *
+ * The survivors are only known on the GPU, so a view's instance count on
+ * the CPU is its instance count before culling. The Hi-Z test reprojects
+ * into last frame's depth, so an object appearing from behind an occluder
+ * shows up one frame late.
+ *
+ * Requires GLExtensions::hasMultiDrawIndirect().
+ */
+
+#ifndef GPU_CULLER_H
+#define GPU_CULLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Bounds.h"
+#include "DrawBatcher.h"
+#include "MeshArena.h"
+
+class Shader;
+class DepthPyramid;
+class Material;
+
+/**
+ * Last frame's depth to test a view's instances against
+ */
+struct HiZOcclusion {
+    const DepthPyramid* pyramid;    ///< Built from last frame's G-buffer
+    glm::mat4 view;                 ///< Camera matrices it was rendered with
+    glm::mat4 projection;
+};
+
+class GpuCuller {
+public:
+    static const int MAX_VIEWS = 6;         ///< Per frame (camera and every shadow cascade, one spare); further views are culled on the CPU
+    static const int WORKGROUP_SIZE = 64;   ///< Must match gpu_cull.comp
+
+    /**
+     * @param cullShader Program built from gpu_cull.comp (must stay alive)
+     */
+    explicit GpuCuller(Shader& cullShader);
+    ~GpuCuller();
+    GpuCuller(const GpuCuller&) = delete;
+    GpuCuller& operator=(const GpuCuller&) = delete;
+
+    /**
+     * Take this frame's instances and drop the previous frame's views
+     *
+     * @param batches   View 0 material batches
+     * @param instances View 0 instances (indexed by the batches)
+     * @param boxes     World bounds, one per instance
+     * @param sceneHash DrawBatcher::getSceneHash(); nothing is uploaded while it is unchanged
+     */
+    void update(const std::vector<DrawBatch>& batches, const std::vector<InstanceData>& instances,
+                const std::vector<BoundingBox>& boxes, uint64_t sceneHash);
+
+    /**
+     * Add a view to cull on the next draw
+     *
+     * @param hiZ Optional; instances hidden in its depth pyramid are dropped too
+     * @return View index, or -1 when MAX_VIEWS views were added this frame
+     */
+    int addView(const Frustum& frustum, const HiZOcclusion* hiZ);
+
+    /**
+     * Draw a view's surviving instances with a depth-only shader (must be bound)
+     */
+    void drawDepth(const Shader& shader, BatchFilter filter, int view);
+
+    /**
+     * Draw a view's surviving instances with the G-buffer shader (must be
+     * bound, material table already bound), binding material textures per
+     * texture set unless the table is bindless
+     */
+    void drawMaterials(const Shader& shader, int view, bool bindTextures);
+
+    int getCommandCount() const { return static_cast<int>(commands.size()); }
+    const MeshArena& getMeshArena() const { return arena; }
+
+    /**
+     * Bytes of GPU buffer memory (instances, commands and the mesh arena)
+     */
+    size_t getMemoryUsage() const;
+
+private:
+    /**
+     * glMultiDrawElementsIndirect command layout
+     */
+    struct DrawCommand {
+        uint32_t count;
+        uint32_t instanceCount;     ///< 0 in the template, counted up by gpu_cull.comp
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t baseInstance;      ///< First instance slot of the command within a view
+    };
+
+    /**
+     * Culling input per instance (matches gpu_cull.comp)
+     */
+    struct CullInstance {
+        InstanceData instance;
+        glm::vec4 boxMin;           ///< w = command index (uint bits)
+        glm::vec4 boxMax;
+    };
+
+    /**
+     * Contiguous commands drawn by one multi-draw
+     */
+    struct Run {
+        int segment;
+        bool dynamic;
+        int textureSet;
+        Material* material;         ///< For the texture set's maps
+        uint32_t firstCommand;
+        uint32_t commandCount;
+    };
+
+    struct View {
+        glm::vec4 planes[6];
+        bool occlusion;
+        HiZOcclusion hiZ;
+    };
+
+    Shader* shader;
+    MeshArena arena;
+    unsigned int instanceBuffer;            ///< CullInstance per instance
+    unsigned int templateBuffer;            ///< DrawCommand per command, no instances
+    unsigned int commandBuffer;             ///< Template copy per view
+    unsigned int visibleBuffer;             ///< InstanceData per instance and view
+    size_t instanceCount;
+    size_t instanceBytes;                   ///< Allocated sizes
+    size_t commandBytes;
+    size_t visibleBytes;
+    uint64_t uploadedHash;
+
+    std::vector<DrawCommand> commands;
+    std::vector<Run> runs;
+    std::vector<CullInstance> cullInstances;    ///< Upload staging
+    std::vector<uint32_t> commandOrder;         ///< Batch index per command (build scratch)
+    std::vector<const Mesh*> meshes;            ///< Arena input (build scratch)
+    View views[MAX_VIEWS];
+    int viewCount;
+    int culledCount;                        ///< Views already dispatched this frame
+
+    int instanceCountLocation;
+    int commandBaseLocation;
+    int visibleBaseLocation;
+    int frustumPlanesLocation;
+    int hiZEnabledLocation;
+    int hiZViewLocation;
+    int hiZProjectionLocation;
+
+    void dispatch(unsigned int callerProgram);
+    void bindVisibleInstances(int view) const;
+    void drawCommands(int view, uint32_t firstCommand, uint32_t commandCount) const;
+};
+
+#endif // GPU_CULLER_H
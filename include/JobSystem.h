@@ -0,0 +1,137 @@
+/**
+ * JobSystem.h - Work-Stealing Thread Pool for Per-Frame CPU Work
+ *
+ * A fixed set of worker threads (hardware threads - 1, the main thread being
+ * the last one) runs small jobs. Every worker owns a deque:
+ *
+ * - Jobs submitted from a worker go to the back of its own deque and are
+ *   popped from the back again (LIFO, the data is still in cache)
+ * - An idle worker steals from the front of the other deques (FIFO, the
+ *   oldest and usually largest piece of work)
+ * - Jobs submitted from other threads are spread round-robin
+ *
+ * submit() and parallelFor() return a JobHandle that counts the unfinished
+ * jobs. wait() does not block while work is queued: the waiting thread runs
+ * jobs itself, so waiting inside a job (nested parallelFor) cannot deadlock
+ * and the main thread contributes while it waits.
+ *
+ * Jobs must not call OpenGL; the context is only current on the main thread.
+ *
+ * Submitting does not allocate in steady state: each submit()/parallelFor()
+ * shares one batch block (completion count and range function) between its
+ * chunks and its handle, drawn from a recycled pool, and the queues are
+ * rings that only grow. The caller's function is copied once per batch, so
+ * keep captures small (two pointers fit std::function's inline storage).
+ */
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Completion handle for one or more jobs (default-constructed = already done)
+ */
+class JobHandle {
+public:
+    JobHandle() = default;
+
+    bool isDone() const { return !remaining || remaining->load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::shared_ptr<std::atomic<int>> remaining;   ///< Jobs of this handle not finished yet
+};
+
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+    using RangeJob = std::function<void(size_t begin, size_t end)>;
+
+    /**
+     * Start the workers
+     *
+     * @param workerCount Threads to start (0 = hardware threads - 1; may end up 0 on one core,
+     *                    then every job runs inside wait())
+     */
+    explicit JobSystem(unsigned int workerCount = 0);
+
+    /**
+     * Finishes every queued job, then joins the workers
+     */
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * Queue a single job
+     */
+    JobHandle submit(Job job);
+
+    /**
+     * Split [0, count) into chunks of at most grainSize and queue one job per chunk
+     */
+    JobHandle parallelFor(size_t count, size_t grainSize, const RangeJob& job);
+
+    /**
+     * Run queued jobs on the calling thread until the handle's jobs are done
+     */
+    void wait(const JobHandle& handle);
+
+    unsigned int getWorkerCount() const { return static_cast<unsigned int>(workers.size()); }
+
+private:
+    /**
+     * State shared by the chunks of one submission and its handle
+     */
+    struct Batch {
+        std::atomic<int> remaining;
+        RangeJob range;             ///< parallelFor() only
+    };
+
+    struct Task {
+        Job job;                    ///< submit() only
+        size_t begin = 0;           ///< parallelFor() chunk
+        size_t end = 0;
+        std::shared_ptr<Batch> batch;
+    };
+
+    /**
+     * Ring of tasks, grown (never shrunk) when full
+     */
+    struct WorkQueue {
+        std::mutex mutex;
+        std::vector<Task> tasks;
+        size_t head = 0;
+        size_t count = 0;
+
+        void pushBack(Task task);
+        bool popBack(Task& task);
+        bool popFront(Task& task);
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;  ///< One per worker, plus one for outside threads
+    std::vector<std::thread> workers;
+    std::atomic<unsigned int> nextQueue;             ///< Round-robin target for outside submissions
+    std::atomic<int> queuedTasks;                    ///< Tasks sitting in any queue (wakes sleepers)
+    std::mutex sleepMutex;
+    std::condition_variable taskAvailable;
+    bool stopping;                                   ///< Guarded by sleepMutex
+
+    static std::shared_ptr<Batch> createBatch(int chunks);
+    static JobHandle handleOf(const std::shared_ptr<Batch>& batch);
+    void push(Task task);
+    bool runOne(int self);
+    bool popTask(int self, Task& task);
+    int currentQueue() const;
+    void workerLoop(int index);
+};
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,99 @@
+/**
+ * LightClusters.h - Clustered Culling of the Local Point Lights
+ *
+ * The primary light (Scene::getPrimaryLight) stays the one shadowed light
+ * in the FrameUniforms block. Every other LightComponent is a local light:
+ * unshadowed, and limited to its range, 3x its radius, where the soft
+ * attenuation reaches zero. Local lights are assigned on the CPU to a
+ * froxel grid (TILES_X x TILES_Y screen tiles x SLICES exponential depth
+ * slices) each frame, so a shader only loops over the lights whose range
+ * touches the cluster it is shading: cost follows the light density on
+ * screen, not the number of lights in the scene.
+ *
+ * Assignment per light: frustum test of its range sphere, screen rectangle
+ * from the projected corners of its view-space box (the whole screen when
+ * the sphere reaches the near plane), depth slices from its view depth
+ * range. Counting first and filling after a prefix sum keeps each
+ * cluster's indices contiguous.
+ *
+ * GL 3.3 has no storage buffers, so everything goes to the shaders in one
+ * R32UI texture buffer (clustered_lights.glsl), in this order:
+ * - per cluster: first index, light count
+ * - per light: world position, range, color * intensity, (pad) as float bits
+ * - the light indices of all clusters
+ */
+
+#ifndef LIGHTCLUSTERS_H
+#define LIGHTCLUSTERS_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+class Shader;
+class FrameArena;
+
+class LightClusters {
+public:
+    // Must match shaders/clustered_lights.glsl
+    static const int TILES_X = 16;
+    static const int TILES_Y = 9;
+    static const int SLICES = 24;
+    static const int CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+    static const int MAX_LIGHTS = 1024;     ///< Further lights are ignored
+    static const int TEXTURE_UNIT = 15;     ///< Where bindForSampling() leaves the buffer
+
+    /**
+     * A local light as the clusters see it
+     */
+    struct Light {
+        glm::vec3 position = glm::vec3(0.0f);   ///< World space
+        float radius = 1.0f;                    ///< LightComponent::radius (range is 3x)
+        glm::vec3 color = glm::vec3(0.0f);      ///< Color * intensity
+    };
+
+    LightClusters();
+    ~LightClusters();
+    LightClusters(const LightClusters&) = delete;
+    LightClusters& operator=(const LightClusters&) = delete;
+
+    /**
+     * Assign the lights to the clusters of this camera and upload the result
+     *
+     * @param lights     Local lights (the primary light excluded)
+     * @param view       Camera view matrix
+     * @param projection Camera projection the clusters tile
+     * @param nearPlane  Projection near plane (first slice starts here)
+     * @param farPlane   Projection far plane (last slice ends here)
+     * @param arena      Scratch for the per-light cluster ranges
+     */
+    void build(const std::vector<Light>& lights, const glm::mat4& view, const glm::mat4& projection,
+               float nearPlane, float farPlane, FrameArena& arena);
+
+    /**
+     * Bind the buffer at TEXTURE_UNIT and set the clustered_lights.glsl light count
+     * (shader must be in use; the lightClusters sampler unit is the caller's)
+     */
+    void bindForSampling(Shader& shader) const;
+
+    int getLightCount() const { return lightCount; }            ///< Lights in the buffer
+    int getVisibleLightCount() const { return visibleCount; }   ///< Lights assigned to a cluster
+    int getMaxClusterLights() const { return maxClusterLights; }
+
+    /**
+     * Changes whenever a light's position, range or color does (GI change tracking)
+     */
+    uint64_t getLightHash() const { return lightHash; }
+
+private:
+    unsigned int buffer;
+    unsigned int texture;           ///< Texture buffer view of buffer
+    std::vector<uint32_t> data;     ///< Staging copy, rebuilt every frame
+    std::vector<int> clusterCounts;
+    int lightCount;
+    int visibleCount;
+    int maxClusterLights;
+    uint64_t lightHash;
+};
+
+#endif // LIGHTCLUSTERS_H
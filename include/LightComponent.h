@@ -21,7 +21,6 @@
 #ifndef LIGHTCOMPONENT_H
 #define LIGHTCOMPONENT_H
 
-#include "Entity.h"
 #include <glm/glm.hpp>
 
 /**
@@ -31,7 +30,7 @@
  * The light has color, intensity, and radius parameters that control its
  * appearance and influence on the scene lighting.
  */
-class LightComponent : public Component {
+class LightComponent {
 public:
     // Light Properties
     glm::vec3 color;            ///< Light color (RGB values, typically 0-1 range)
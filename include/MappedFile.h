@@ -0,0 +1,51 @@
+/**
+ * MappedFile.h - Read-only Memory-Mapped Files
+ *
+ * Maps a whole file into memory so loaders can parse it in place (or hand
+ * the bytes straight to OpenGL) without copying through iostreams. On
+ * platforms without mmap the file is read into a heap buffer instead, so
+ * callers never need a fallback path of their own.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Map a file read-only (any previous mapping is released)
+     * @return False if the file could not be opened or mapped
+     */
+    bool open(const std::string& path);
+    void close();
+
+    /**
+     * Size and modification time of a file, used by the asset caches to
+     * detect that a cached entry is older than its source
+     * @return False if the file does not exist
+     */
+    static bool getFileStamp(const std::string& path, uint64_t& size, int64_t& modificationTime);
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool isOpen() const { return opened; }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+    bool mapped = false;            ///< True if bytes come from mmap rather than fallbackBuffer
+    std::vector<char> fallbackBuffer;
+};
+
+#endif // MAPPED_FILE_H
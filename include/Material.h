@@ -15,16 +15,30 @@
  * 
  * Features:
  * - Automatic PBR texture loading from standard naming conventions
+ * - Asynchronous, block-compressed texture streaming (see TextureStreamer.h)
  * - OpenGL texture management with proper binding/unbinding
- * - Shader uniform integration for rendering
+ * - Bindless texture handles where the driver supports them
+ * - Per-frame material table for the G-buffer pass (see MaterialTable.h)
  * - Memory management with proper cleanup
  */
 
 #ifndef MATERIAL_H
 #define MATERIAL_H
 
+#include <cstdint>
 #include <string>
 #include <glm/glm.hpp>
+#include "Shader.h"
+
+/**
+ * How a texture's channels are used, which decides its compressed format
+ * and the placeholder shown while it streams in
+ */
+enum class TextureUsage {
+    Color,      ///< RGB color (BC1), placeholder white
+    Normal,     ///< Tangent-space normal, XY only (BC5), placeholder flat normal
+    Grayscale   ///< Single channel in R (BC4), placeholder 1.0
+};
 
 /**
  * Texture class - OpenGL texture wrapper for image data
@@ -66,6 +80,23 @@ public:
      */
     bool loadFromFile(const std::string& path);
     
+    /**
+     * Start loading a texture in the background
+     * 
+     * The texture is usable immediately and shows a 1x1 placeholder until
+     * TextureStreamer::processUploads() uploads the full mip chain.
+     * 
+     * @param path  Path to image file
+     * @param usage Channel usage (selects the compressed format)
+     * @return false if the file does not exist
+     */
+    bool loadAsync(const std::string& path, TextureUsage usage);
+    
+    /**
+     * Whether the full image has been uploaded (false while showing the placeholder)
+     */
+    bool isResident() const { return resident; }
+    
     /**
      * Bind texture to specified texture unit for rendering
      * 
@@ -78,8 +109,20 @@ public:
      */
     void unbind() const;
     
+    /**
+     * Resident bindless handle (GL_ARB_bindless_texture), created on first use
+     * 
+     * A handle freezes the texture, so there is none (0) until the full image
+     * is resident, or when the extension is unavailable.
+     */
+    uint64_t getBindlessHandle();
+    
 private:
+    friend class TextureStreamer;
+    
     int width, height, nrChannels;  ///< Image dimensions and channel count
+    bool resident;                  ///< Full image uploaded
+    uint64_t bindlessHandle;        ///< 0 until getBindlessHandle() made one resident
 };
 
 /**
@@ -158,25 +201,24 @@ public:
     
     /**
      * Bind all available textures to appropriate texture units
-     * Sets up texture units for shader access during rendering
+     * Sets up texture units for shader access during rendering. The material's
+     * properties themselves reach the shaders through MaterialTable.
      */
     void bindTextures() const;
     
     /**
      * Unbind all textures from their texture units
-     * Cleans up texture state after rendering
+     * Cleans up texture state after rendering (units 0-6, whatever material bound them)
      */
-    void unbindTextures() const;
+    static void unbindTextures();
     
     /**
-     * Set material properties as shader uniforms
-     * 
-     * Uploads material properties and texture availability flags to shaders.
-     * Assumes standard PBR uniform names in the shader program.
+     * Assign the fixed texture units (0-6) to the material samplers of a shader
+     * Only needs to run once per program; the shader must be bound.
      * 
-     * @param shaderId OpenGL shader program ID
+     * @param shader Shader program using the standard PBR sampler names
      */
-    void setUniforms(unsigned int shaderId) const;
+    static void setSamplerUnits(const Shader& shader);
     
 private:
     /**
@@ -0,0 +1,119 @@
+/**
+ * MaterialTable.h - Per-Frame Table of Every Drawn Material
+ *
+ * DrawBatcher::build() adds the material of every instance and stores the
+ * returned index in the instance data (InstanceData::color.a), so the
+ * G-buffer shader reads the material's scalars and map flags from this
+ * table instead of from per-draw uniforms. Index 0 is "no material"
+ * (object color, default roughness).
+ *
+ * Textures are reached one of two ways:
+ * - Bindless (GL_ARB_bindless_texture, gbuffer_bindless.frag): each record
+ *   also holds the 64-bit handles of its maps, so nothing is bound per
+ *   batch. A texture gets its handle once it is resident (a handle freezes
+ *   the texture), and its map counts as absent until then, which looks
+ *   the same as the streaming placeholder.
+ * - Bound (GL 3.3): the maps of a batch's material are bound to the fixed
+ *   units of Material::setSamplerUnits() whenever the texture set changes.
+ *
+ * Materials with identical maps share a texture set (0 = no maps), and
+ * material batches only break where the texture set does, so materials
+ * that differ only in their scalars draw in one instanced call. Batches
+ * still break on texture sets in the bindless path: a sampler built from a
+ * handle must be dynamically uniform within a draw.
+ *
+ * GL 3.3 has no storage buffers, so the table is an RGBA32UI texture buffer
+ * (floats as bits), RECORD_TEXELS texels per material:
+ * - 0: base color, roughness
+ * - 1: emission, metallic
+ * - 2: tiling, height scale, ambient occlusion
+ * - 3: map flags (gbuffer_surface.glsl), unused
+ * - 4-7: 64-bit map handles in Material::setSamplerUnits() order (bindless only)
+ */
+
+#ifndef MATERIAL_TABLE_H
+#define MATERIAL_TABLE_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+class Material;
+class Texture;
+
+class MaterialTable {
+public:
+    static const int TEXTURE_UNIT = 7;      ///< Right after the material map units 0-6
+    static const int RECORD_TEXELS = 8;     ///< Must match gbuffer_surface.glsl
+    static const int MAX_MATERIALS = 8192;  ///< GL 3.3 guarantees 65536 buffer texels; further materials draw unmaterialed
+
+    MaterialTable();
+    ~MaterialTable();
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+
+    /**
+     * Put texture handles in the records instead of expecting bound maps
+     * (only when GLExtensions::hasBindlessTextures() and the bindless G-buffer
+     * shader compiled)
+     */
+    void setBindless(bool enabled) { bindless = enabled; }
+    bool isBindless() const { return bindless; }
+
+    /**
+     * Start this frame's table with only the "no material" record
+     */
+    void begin();
+
+    /**
+     * Index of a material's record, adding it on first use this frame
+     *
+     * @param material May be nullptr (returns 0)
+     */
+    int add(const Material* material);
+
+    /**
+     * Texture set of a record: equal for records with the same maps, 0 for
+     * records without maps
+     */
+    int getTextureSet(int index) const { return textureSets[index]; }
+
+    /**
+     * Upload the records if they changed since the last upload
+     */
+    void upload();
+
+    /**
+     * Bind the table at TEXTURE_UNIT (the materialTable sampler unit is the caller's)
+     */
+    void bindForSampling() const;
+
+    int getMaterialCount() const { return static_cast<int>(textureSets.size()); }   ///< Including "no material"
+    int getTextureSetCount() const { return textureSetCount + 1; }
+
+private:
+    typedef std::array<const Texture*, 7> MapSet;
+
+    /**
+     * A map value and the frame (begin() count) it was assigned in
+     */
+    struct Entry {
+        uint64_t frame = 0;
+        int index = 0;
+    };
+
+    unsigned int buffer;
+    unsigned int texture;                                   ///< Texture buffer view of buffer
+    bool bindless;
+    std::vector<uint32_t> data;                             ///< This frame's records
+    std::vector<uint32_t> uploaded;                         ///< Contents of buffer
+    std::vector<int> textureSets;                           ///< Per record
+    uint64_t frame;                                         ///< Entries from other frames are stale
+    std::unordered_map<const Material*, Entry> indices;     ///< Record of each material
+    std::map<MapSet, Entry> textureSetIds;
+    int textureSetCount;                                    ///< Texture sets assigned this frame
+};
+
+#endif // MATERIAL_TABLE_H
@@ -1,12 +1,15 @@
-
 // Mesh.h
 #ifndef MESH_H
 #define MESH_H
 
+#include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
+#include "Bounds.h"
+
+class Shader;
 
 struct Vertex {
     glm::vec3 Position;
@@ -16,21 +19,210 @@ struct Vertex {
     glm::vec3 Bitangent;
 };
 
+/**
+ * GPU vertex layout used when uploading a mesh
+ *
+ * Full:   56-byte float Vertex as above (locations 0-4)
+ * Packed: 20-byte quantized vertex
+ *         location 0: half4 position, w = bitangent sign
+ *         location 1: snorm16x2 octahedral normal
+ *         location 2: half2 texture coordinates
+ *         location 3: snorm16x2 octahedral tangent
+ *         Bitangent is rebuilt in the shader as cross(N, T) * sign.
+ */
+enum class VertexFormat {
+    Full,
+    Packed
+};
+
+/**
+ * CPU geometry of one level of detail (see MeshSimplifier.h)
+ */
+struct MeshLodData {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    float error = 0.0f;                 ///< Simplification error in model units (0 for full detail)
+};
+
+/**
+ * Levels of detail: a mesh loaded from a model file carries a chain of
+ * simplified copies (getLod(); level 0 is the mesh itself), each a Mesh with
+ * its own buffers. DrawBatcher picks a level per instance and view with
+ * requestLod(), which also tells the MeshStreamer which levels are in use.
+ *
+ * Residency: the streamer keeps the GPU buffers of a chain's levels within
+ * a memory budget, releasing levels that have not been used for a while;
+ * the coarsest level always stays resident and the CPU copies are kept, so
+ * a released level can be uploaded again. Procedural meshes have one level
+ * and are always resident.
+ */
+
 class Mesh {
 public:
-    std::vector<Vertex> vertices;
+    std::vector<Vertex> vertices;       ///< Unique vertices (after deduplication)
+    std::vector<unsigned int> indices;  ///< Triangle list indices into vertices
     unsigned int VAO;
 
-    Mesh(std::vector<Vertex> verts);
+    /**
+     * Build an indexed mesh from a triangle soup (3 vertices per triangle)
+     * Identical vertices are merged and the triangles are reordered for the
+     * post-transform cache, overdraw and vertex fetch locality.
+     */
+    Mesh(std::vector<Vertex> verts, VertexFormat format = VertexFormat::Full);
+
+    /**
+     * Build a mesh from already indexed data (uploaded as given)
+     */
+    Mesh(std::vector<Vertex> verts, std::vector<unsigned int> inds, VertexFormat format = VertexFormat::Full);
+
+    ~Mesh();
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
     static std::unique_ptr<Mesh> createSphere(float radius, int sectors = 20, int stacks = 20);
     static std::unique_ptr<Mesh> createPlane(float width, float height, int segmentsX = 1, int segmentsY = 1);
     static std::unique_ptr<Mesh> createCube();
-    static std::unique_ptr<Mesh> loadFromOBJ(const std::string& filepath);
-    void Draw(unsigned int shaderID);
+    /**
+     * Load an OBJ model, using the binary mesh cache when it is up to date
+     * (see MeshCache.h); otherwise parse it with ObjParser and refresh the cache
+     */
+    static std::unique_ptr<Mesh> loadFromOBJ(const std::string& filepath, VertexFormat format = VertexFormat::Full);
+
+    /**
+     * Create an empty mesh and load an OBJ model on the MeshStreamer's threads
+     * It has no geometry (and is not drawn) until a later
+     * MeshStreamer::processUploads(); a file that cannot be loaded becomes a cube.
+     */
+    static std::unique_ptr<Mesh> loadAsync(const std::string& filepath, VertexFormat format = VertexFormat::Full);
+
+    /**
+     * Parse, optimize and simplify an OBJ model into its level-of-detail chain
+     * through the mesh cache (no GL calls, safe on any thread)
+     *
+     * @return False if the file cannot be parsed
+     */
+    static bool importOBJ(const std::string& filepath, std::vector<MeshLodData>& levels);
+
+    /**
+     * Triangle soup of a unit cube centered on the origin
+     */
+    static std::vector<Vertex> createCubeVertices();
+    void Draw(const Shader& shader);
+
+    /**
+     * Replace the geometry with levels[0] and attach the coarser levels
+     * (GL thread; the mesh gets a new serial and its levels are handed to the MeshStreamer)
+     */
+    void setGeometry(std::vector<MeshLodData> levels);
+
+    int getLodCount() const { return 1 + static_cast<int>(lods.size()); }
+    Mesh* getLod(int level) { return level == 0 ? this : lods[level - 1].get(); }
+    const Mesh* getLod(int level) const { return level == 0 ? this : lods[level - 1].get(); }
+    float getLodError() const { return lodError; }  ///< Of this level, in model units of the full mesh
+
+    /**
+     * Mark a level as used this frame (queueing its upload if it is released)
+     * and return the level to draw instead: the finest resident level at or
+     * coarser than it, else the coarsest finer one; nullptr while nothing is loaded
+     */
+    Mesh* requestLod(int level);
+
+    /**
+     * Finest resident level, without marking anything used; nullptr while nothing is loaded
+     */
+    Mesh* getResidentLod();
+
+    bool isResident() const { return resident; }
+
+    /**
+     * Bytes of this level's vertex and index buffers (also while released)
+     */
+    size_t getGpuMemoryUsage() const;
+
+    /**
+     * Bind the VAO and tell the shader how to decode this mesh's vertex format
+     * (leaves the VAO bound, e.g. for DrawBatcher's instance attributes)
+     */
+    void bind(const Shader& shader) const;
+
+    /**
+     * Draw the bound mesh instanceCount times (requires bind() first)
+     */
+    void drawInstanced(int instanceCount) const;
+
+    /**
+     * Set the packedVertices uniform for a vertex format (for VAOs that are not
+     * a Mesh's own, e.g. MeshArena's). The location comes from the shader's own
+     * uniform table: program names are reused once a program is deleted.
+     */
+    static void setFormatUniform(const Shader& shader, VertexFormat format);
+
+    /**
+     * Point attributes 0-4 of the bound VAO at the bound GL_ARRAY_BUFFER,
+     * decoding a vertex format from offset 0
+     */
+    static void setupVertexAttributes(VertexFormat format);
+
+    /**
+     * Bytes per uploaded vertex of a format
+     */
+    static size_t getVertexStride(VertexFormat format);
+
+    VertexFormat getVertexFormat() const { return format; }
+    unsigned int getVertexBuffer() const { return VBO; }    ///< Uploaded vertices (getVertexStride() bytes each)
+    uint64_t getSerial() const { return serial; }  ///< Unique for the process (addresses and GL names are reused)
+    size_t getTriangleCount() const { return indices.size() / 3; }
+
+    /**
+     * Local-space bounds, computed from the vertices when the mesh is created
+     */
+    const BoundingBox& getBoundingBox() const { return boundingBox; }
+    const BoundingSphere& getBoundingSphere() const { return boundingSphere; }
+
+    /**
+     * Merge bit-identical vertices of a triangle soup
+     * @param soup    3 vertices per triangle
+     * @param outVertices  Unique vertices
+     * @param outIndices   One index per soup vertex
+     */
+    static void deduplicate(const std::vector<Vertex>& soup, std::vector<Vertex>& outVertices, std::vector<unsigned int>& outIndices);
+
+    /**
+     * Reorder triangles and vertices for GPU efficiency, in place:
+     * vertex cache order (Forsyth), coarse overdraw order of triangle
+     * clusters, then vertex fetch order (vertices sorted by first use)
+     */
+    static void optimize(std::vector<Vertex>& verts, std::vector<unsigned int>& inds);
+
+    /**
+     * Average cache miss ratio (transformed vertices per triangle) of an index
+     * buffer under a FIFO cache of the given size; 0.5 is ideal, 3.0 is worst
+     */
+    static float computeACMR(const std::vector<unsigned int>& inds, size_t vertexCount, int cacheSize = 16);
 
 private:
+    friend class MeshStreamer;
+
     unsigned int VBO;
+    unsigned int EBO;
+    unsigned int indexType;             ///< GL_UNSIGNED_SHORT when all indices fit, else GL_UNSIGNED_INT
+    VertexFormat format;
+    uint64_t serial;
+    BoundingBox boundingBox;
+    BoundingSphere boundingSphere;      ///< Centered on the box, radius to the furthest vertex
+    std::vector<std::unique_ptr<Mesh>> lods;    ///< Coarser levels, lods[0] = level 1
+    float lodError = 0.0f;
+    bool resident = false;              ///< GPU buffers exist
+    bool streamed = false;              ///< Known to the MeshStreamer (async load or level of a chain)
+    bool pinned = true;                 ///< Never released (coarsest level)
+    bool uploadQueued = false;          ///< Released and waiting in the streamer's upload queue
+    uint64_t lastUsedFrame = 0;         ///< MeshStreamer frame of the last requestLod()
+
+    explicit Mesh(VertexFormat format); ///< Empty, not resident (loadAsync())
+    void computeBounds();
     void setupMesh();
+    void upload();
+    void release();
 };
 
-#endif // MESH_H 
\ No newline at end of file
+#endif // MESH_H
@@ -0,0 +1,93 @@
+/**
+ * MeshArena.h - Shared Vertex and Index Buffers for Indirect Draws
+ *
+ * Every Mesh owns its VAO and buffers, which is what the per-batch draws
+ * bind. A GPU-driven draw (GpuCuller.h) submits many meshes in one
+ * glMultiDrawElementsIndirect call, so their geometry must share one vertex
+ * and one index buffer: the arena concatenates the meshes drawn this frame,
+ * and each draw command selects its mesh through firstIndex and baseVertex.
+ *
+ * A VAO can only decode one vertex layout, so there is one segment per
+ * VertexFormat, each with its own VAO; a multi-draw never spans segments.
+ * Vertices are copied on the GPU from each mesh's own vertex buffer (in its
+ * upload format, no repacking); indices are rewritten as 32-bit from the
+ * mesh's CPU copy.
+ *
+ * Meshes are keyed by Mesh::getSerial(). The arena is rebuilt from scratch
+ * whenever this frame's meshes are not all in it, which happens when scenes
+ * load rather than per frame; meshes no longer drawn are dropped then.
+ */
+
+#ifndef MESH_ARENA_H
+#define MESH_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+class Shader;
+
+class MeshArena {
+public:
+    static const int SEGMENT_COUNT = 2;     ///< One per VertexFormat (Full, Packed)
+
+    /**
+     * Where a mesh lives in the arena (the fields of its draw commands)
+     */
+    struct Range {
+        int segment;                ///< VertexFormat of the mesh
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        int32_t baseVertex;
+    };
+
+    MeshArena();
+    ~MeshArena();
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+
+    /**
+     * Make sure every mesh has a range, rebuilding the arena if any is missing
+     *
+     * @param meshes This frame's meshes (duplicates allowed)
+     * @return true when the arena was rebuilt (earlier ranges are invalid)
+     */
+    bool update(const std::vector<const Mesh*>& meshes);
+
+    /**
+     * Range of a mesh passed to the last update()
+     */
+    const Range& getRange(const Mesh* mesh) const;
+
+    /**
+     * Bind a segment's VAO and set the shader's packedVertices uniform
+     * (leaves the VAO bound for the instance attributes)
+     */
+    void bind(int segment, const Shader& shader) const;
+
+    int getMeshCount() const { return static_cast<int>(ranges.size()); }
+
+    /**
+     * Bytes of GPU buffer memory (every segment)
+     */
+    size_t getMemoryUsage() const;
+
+private:
+    struct Segment {
+        unsigned int vertexArray = 0;
+        unsigned int vertexBuffer = 0;
+        unsigned int indexBuffer = 0;
+        size_t vertexBytes = 0;
+        size_t indexBytes = 0;
+    };
+
+    Segment segments[SEGMENT_COUNT];
+    std::unordered_map<uint64_t, Range> ranges;     ///< By Mesh::getSerial()
+    std::vector<const Mesh*> uniqueMeshes;          ///< Rebuild input, kept for reuse
+
+    void rebuild();
+};
+
+#endif // MESH_ARENA_H
@@ -0,0 +1,49 @@
+/**
+ * MeshCache.h - Versioned Binary Mesh Cache
+ *
+ * After an OBJ has been parsed, deduplicated, optimized and simplified into
+ * its levels of detail, the vertex and index arrays of every level are
+ * written to cache/meshes/. Later runs map the cache file and copy the
+ * arrays out with two memcpys per level, skipping parsing, optimization and
+ * simplification entirely.
+ *
+ * File layout (little endian, native Vertex layout):
+ *     MeshCacheHeader (64 bytes)
+ *     MeshCacheLevel[levelCount] (32 bytes each, finest first)
+ *     per level: Vertex[vertexCount] at vertexOffset, uint32[indexCount] at indexOffset
+ *
+ * A cache entry is only used if its version, vertex stride and the source
+ * file's size and modification time all match, so editing an asset or
+ * changing the mesh pipeline (bump MeshCache::VERSION) rebuilds it.
+ */
+
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Mesh.h"
+
+class MeshCache {
+public:
+    static const uint32_t VERSION = 3;
+
+    /**
+     * Load the cached levels of detail for a source file
+     * @return False if there is no valid, up-to-date cache entry
+     */
+    static bool load(const std::string& sourcePath, std::vector<MeshLodData>& levels);
+
+    /**
+     * Write the cache entry for a source file (written atomically via rename)
+     */
+    static bool save(const std::string& sourcePath, const std::vector<MeshLodData>& levels);
+
+    /**
+     * Cache file used for a source file
+     */
+    static std::string getCachePath(const std::string& sourcePath);
+};
+
+#endif // MESH_CACHE_H
@@ -3,10 +3,9 @@
 #ifndef MESHCOMPONENT_H
 #define MESHCOMPONENT_H
 
-#include "Entity.h"
 #include "../include/Mesh.h"
 
-class MeshComponent : public Component {
+class MeshComponent {
 public:
     Mesh* mesh;
     glm::vec3 color;
@@ -0,0 +1,59 @@
+/**
+ * MeshSimplifier.h - Quadric Error Simplification and Level-of-Detail Chains
+ *
+ * simplify() reduces an indexed triangle mesh towards a target triangle
+ * count by collapsing edges (Garland and Heckbert quadrics): every vertex
+ * accumulates the area-weighted planes of its triangles, and collapsing
+ * vertex u onto its neighbour v costs the RMS distance of v to the planes of
+ * both. Collapses run in passes: each pass sorts the candidate edges by cost
+ * and performs the cheapest ones whose neighbourhoods were not changed yet
+ * in that pass, rejecting any that would fold a triangle over.
+ *
+ * Collapses work on positions, so vertices that only differ in their normal
+ * or UVs (seams, flat shading) move together and the surface never tears.
+ * A position moves onto an existing one, so nothing is interpolated: a
+ * moved corner takes the vertex already there on smooth surfaces and keeps
+ * its own attributes otherwise; flat-shaded triangles get their new face
+ * normal. Positions on open or non-manifold edges are locked.
+ *
+ * buildLods() turns a mesh into a chain of levels, each simplified from the
+ * previous one to half its triangles, until a level no longer shrinks by a
+ * quarter, falls below MIN_LOD_TRIANGLES or its error exceeds
+ * MAX_RELATIVE_ERROR of the mesh's size. Every level is re-optimized and
+ * keeps only the vertices it references.
+ */
+
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <cstddef>
+#include <vector>
+#include "Mesh.h"
+
+class MeshSimplifier {
+public:
+    static const int MAX_LEVELS = 5;                    ///< Including full detail
+    static const size_t MIN_LOD_TRIANGLES = 256;        ///< No level is simplified below this
+    static constexpr float MAX_RELATIVE_ERROR = 0.05f;  ///< Of the bounding sphere radius
+
+    /**
+     * Collapse edges until at most targetTriangles remain or the next
+     * collapse would exceed maxError
+     *
+     * @param mesh            Simplified in place; the vertices are rebuilt for the remaining corners
+     * @param targetTriangles Triangle count to stop at
+     * @param maxError        Largest collapse error allowed, in model units
+     * @return Largest error of the collapses performed, in model units
+     */
+    static float simplify(MeshLodData& mesh, size_t targetTriangles, float maxError);
+
+    /**
+     * Build the level-of-detail chain of a mesh
+     *
+     * @param full Level 0 (kept as is, error 0)
+     * @return full followed by every coarser level; errors are cumulative
+     */
+    static std::vector<MeshLodData> buildLods(MeshLodData full);
+};
+
+#endif // MESH_SIMPLIFIER_H
@@ -0,0 +1,148 @@
+/**
+ * MeshStreamer.h - Asynchronous Mesh Loading and Level-of-Detail Residency
+ *
+ * Two jobs, the mesh counterpart of TextureStreamer:
+ *
+ * 1. Loading: Mesh::loadAsync() creates an empty mesh and queues its file
+ *    here, so scene creation never blocks on parsing or simplification.
+ *    Loader threads run Mesh::importOBJ() (mesh cache hit, or parse,
+ *    optimize, build the LOD chain and write the cache entry), and
+ *    processUploads() hands finished chains to their meshes on the GL thread.
+ * 2. Residency: every level of a loaded chain is registered here. Levels
+ *    chosen by Mesh::requestLod() are marked used each frame; released ones
+ *    are uploaded again, and while the levels' GPU buffers exceed the memory
+ *    budget, the least recently used levels are released. Levels used within
+ *    the last EVICTION_DELAY_FRAMES frames and every chain's coarsest level
+ *    are never released, so a drawn mesh always has a level to fall back to.
+ *
+ * Both share the per-call upload budget. The budget only covers GPU
+ * buffers: CPU copies stay loaded (released levels are re-uploaded from
+ * them, and SceneBvh traces the full-detail vertices).
+ *
+ * Destroying a Mesh cancels its pending load and unregisters its levels;
+ * results for cancelled meshes are dropped instead of uploaded. Everything
+ * except the loader threads runs on the GL thread.
+ */
+
+#ifndef MESH_STREAMER_H
+#define MESH_STREAMER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Mesh.h"
+
+class MeshStreamer {
+public:
+    static const size_t DEFAULT_UPLOAD_BUDGET = 16 * 1024 * 1024;      ///< Bytes uploaded per processUploads() call
+    static const size_t DEFAULT_MEMORY_BUDGET = 512 * 1024 * 1024;     ///< Bytes of resident level buffers
+    static const uint64_t EVICTION_DELAY_FRAMES = 30;                  ///< A level unused for longer may be released
+
+    static MeshStreamer& instance();
+
+    MeshStreamer(const MeshStreamer&) = delete;
+    MeshStreamer& operator=(const MeshStreamer&) = delete;
+
+    /**
+     * Queue an OBJ file for loading into an empty mesh (Mesh::loadAsync())
+     */
+    void request(Mesh* mesh, const std::string& path);
+
+    /**
+     * Forget a mesh: cancel its pending load and unregister it (called by ~Mesh)
+     */
+    void remove(Mesh* mesh);
+
+    /**
+     * Register a level of a loaded chain (Mesh::setGeometry())
+     */
+    void add(Mesh* level);
+
+    /**
+     * Mark a level used this frame, queueing its upload if released (Mesh::requestLod())
+     */
+    void markUsed(Mesh* level);
+
+    /**
+     * Once per frame (GL thread): hand finished loads to their meshes, upload
+     * the requested levels and release unused ones down to the memory budget.
+     * At least one load or level is uploaded per call even if it is larger
+     * than the budget.
+     */
+    void processUploads(size_t budgetBytes = DEFAULT_UPLOAD_BUDGET);
+
+    /**
+     * Block until every queued load is uploaded (loading screens, benchmarks)
+     */
+    void finishAll();
+
+    /**
+     * Loads that are queued, running or waiting for upload
+     */
+    size_t getPendingCount() const;
+
+    void setMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+    size_t getMemoryBudget() const { return memoryBudget; }
+    size_t getResidentBytes() const { return residentBytes; }   ///< GPU buffers of the resident levels
+    size_t getLevelCount() const { return levels.size(); }
+    size_t getResidentLevelCount() const;
+
+    /**
+     * Changes whenever a level is loaded, uploaded or released, i.e. whenever
+     * Mesh::requestLod() may pick differently for the same request
+     */
+    uint64_t getResidencyVersion() const { return residencyVersion; }
+
+private:
+    struct Job {
+        uint64_t ticket;
+        Mesh* mesh;
+        std::string path;
+        VertexFormat format;
+    };
+
+    struct Result {
+        uint64_t ticket;
+        Mesh* mesh;
+        std::string path;
+        bool success;
+        float loadTimeMs;
+        std::vector<MeshLodData> levels;
+        size_t bytes;               ///< Approximate upload size
+    };
+
+    MeshStreamer() = default;
+    ~MeshStreamer();
+
+    void startWorkers();
+    void workerLoop();
+    bool releaseLeastRecentlyUsed();
+    void release(Mesh* level);
+
+    mutable std::mutex mutex;
+    std::condition_variable jobAvailable;       ///< Signalled when a job is queued or on shutdown
+    std::condition_variable resultAvailable;    ///< Signalled when a worker finishes a job
+    std::deque<Job> jobs;
+    std::deque<Result> results;
+    std::unordered_map<Mesh*, uint64_t> tickets; ///< Live load per mesh (absent = cancelled)
+    std::vector<std::thread> workers;
+    uint64_t nextTicket = 1;
+    size_t pending = 0;
+    bool stopping = false;
+
+    // GL thread only
+    std::vector<Mesh*> levels;                  ///< Registered levels of loaded chains
+    std::vector<Mesh*> uploadQueue;             ///< Released levels marked used since the last processUploads()
+    size_t memoryBudget = DEFAULT_MEMORY_BUDGET;
+    size_t residentBytes = 0;
+    uint64_t frame = 1;
+    uint64_t residencyVersion = 0;
+};
+
+#endif // MESH_STREAMER_H
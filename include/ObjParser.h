@@ -0,0 +1,40 @@
+/**
+ * ObjParser.h - Fast Multithreaded Wavefront OBJ Parser
+ *
+ * Memory-maps the file and parses it in place: the file is split into
+ * line-aligned chunks that are parsed concurrently, each producing its own
+ * positions, normals and face corners. Chunk results are then stitched
+ * together with prefix sums so OBJ's global (and negative, relative)
+ * indices resolve exactly as they would in a single pass.
+ *
+ * Supported: v, vn, f with v, v/vt, v//vn and v/vt/vn corners, polygons
+ * (fan triangulated) and negative indices. Texture coordinates, groups and
+ * materials are ignored, like the original loader.
+ */
+
+#ifndef OBJ_PARSER_H
+#define OBJ_PARSER_H
+
+#include <string>
+#include <vector>
+#include "Mesh.h"
+
+class ObjParser {
+public:
+    /**
+     * Parse an OBJ file into a triangle soup (3 vertices per triangle)
+     *
+     * Files without normals get smooth, area-weighted vertex normals
+     * (corners at the same position share one), so the soup deduplicates
+     * into an indexed mesh. Texture coordinates and tangents get the same
+     * defaults as the original loader.
+     *
+     * @param path         OBJ file path
+     * @param soup         Output triangle soup
+     * @param threadCount  Worker threads (0 = hardware concurrency)
+     * @return False if the file could not be read
+     */
+    static bool parse(const std::string& path, std::vector<Vertex>& soup, unsigned int threadCount = 0);
+};
+
+#endif // OBJ_PARSER_H
@@ -0,0 +1,97 @@
+/**
+ * OcclusionCuller.h - CPU Occlusion Culling from Last Frame's Depth
+ *
+ * After the G-buffer pass the depth pyramid (DepthPyramid.h) is reduced on
+ * the GPU, from its finest level no smaller than the grid, to a small
+ * GRID_WIDTH x GRID_HEIGHT grid holding the farthest depth per cell, and
+ * read back asynchronously (pixel buffer objects + fences, never waiting).
+ * A few frames later the CPU builds a max-depth mip pyramid from it. An
+ * object is occluded when the nearest point of its world box is farther
+ * than the farthest depth of every cell its screen rectangle covers, tested
+ * at the pyramid level where that rectangle spans at most 2x2 cells.
+ *
+ * The snapshot is rendered from a slightly older camera, so it is only used
+ * while the camera stays close to where it was taken; otherwise (and after
+ * invalidate()) nothing is reported as occluded. Occluders that move away
+ * can leave an object hidden for the few frames the readback lags behind.
+ */
+
+#ifndef OCCLUSIONCULLER_H
+#define OCCLUSIONCULLER_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Bounds.h"
+
+class Shader;
+class FullscreenQuad;
+class DepthPyramid;
+struct __GLsync;
+
+class OcclusionCuller {
+public:
+    static const int GRID_WIDTH = 128;
+    static const int GRID_HEIGHT = 64;
+    static const int READBACK_FRAMES = 3;   ///< Readbacks in flight before the oldest is dropped
+
+    OcclusionCuller();
+    ~OcclusionCuller();
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    /**
+     * Collect finished readbacks and decide whether the newest snapshot fits this camera
+     *
+     * @return true when isOccluded() may be used this frame
+     */
+    bool beginFrame(const glm::vec3& cameraPosition, const glm::vec3& cameraFront);
+
+    /**
+     * Reduce this frame's depth to the grid and start reading it back
+     * Changes the framebuffer and viewport.
+     *
+     * @param shader           occlusion_depth.frag program
+     * @param depthPyramid     This frame's depth pyramid (already built)
+     * @param viewProjection   Camera matrix the depth was rendered with
+     */
+    void capture(Shader& shader, FullscreenQuad& quad, const DepthPyramid& depthPyramid,
+                 const glm::mat4& viewProjection, const glm::vec3& cameraPosition, const glm::vec3& cameraFront);
+
+    /**
+     * Drop the snapshot and pending readbacks (camera cut, scene change)
+     */
+    void invalidate();
+
+    /**
+     * Whether a world-space box is certainly hidden behind the snapshot's depth
+     */
+    bool isOccluded(const BoundingBox& box) const;
+
+private:
+    struct Readback {
+        unsigned int pixelBuffer = 0;
+        __GLsync* fence = nullptr;
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+        glm::vec3 cameraPosition = glm::vec3(0.0f);
+        glm::vec3 cameraFront = glm::vec3(0.0f);
+    };
+
+    unsigned int gridFBO;
+    unsigned int gridTexture;
+    Readback readbacks[READBACK_FRAMES];
+    int nextReadback;
+
+    // Newest snapshot: max-depth pyramid, level 0 = GRID_WIDTH x GRID_HEIGHT
+    std::vector<std::vector<float>> levels;
+    glm::mat4 snapshotViewProjection;
+    glm::vec3 snapshotPosition;
+    glm::vec3 snapshotFront;
+    bool hasSnapshot;
+    bool active;
+
+    void consume(Readback& readback);
+    void buildPyramid();
+    float sampleLevel(int level, int x, int y) const;
+};
+
+#endif // OCCLUSIONCULLER_H
@@ -0,0 +1,65 @@
+/**
+ * OverdrawMonitor.h - Measured G-Buffer Overdraw and Pre-Pass Selection
+ *
+ * A depth pre-pass only pays off when many hidden fragments would otherwise
+ * run the full G-buffer shader. In a pre-pass frame two GL_SAMPLES_PASSED
+ * queries give the overdraw directly:
+ *
+ *     overdraw = fragments passing the pre-pass (depth test LESS, i.e. what
+ *                the G-buffer would shade without it)
+ *              / fragments passing the G-buffer pass (depth test EQUAL,
+ *                one per covered pixel)
+ *
+ * In automatic mode the pre-pass is switched on above ENABLE_OVERDRAW and
+ * off below DISABLE_OVERDRAW. While it is off, one pre-pass frame every
+ * PROBE_INTERVAL frames keeps the measurement current. Query results are
+ * read QUERY_FRAMES later, so the GPU is never waited on.
+ */
+
+#ifndef OVERDRAWMONITOR_H
+#define OVERDRAWMONITOR_H
+
+class OverdrawMonitor {
+public:
+    static const int QUERY_FRAMES = 4;
+    static const int PROBE_INTERVAL = 120;
+    static constexpr float ENABLE_OVERDRAW = 1.5f;
+    static constexpr float DISABLE_OVERDRAW = 1.25f;
+
+    OverdrawMonitor();
+    ~OverdrawMonitor();
+    OverdrawMonitor(const OverdrawMonitor&) = delete;
+    OverdrawMonitor& operator=(const OverdrawMonitor&) = delete;
+
+    /**
+     * Collect finished measurements and decide whether this frame uses the pre-pass
+     *
+     * @param mode 0 = never, 1 = always, 2 = automatic
+     */
+    bool beginFrame(int mode);
+
+    // Bracket the two passes of a pre-pass frame (ignored in other frames)
+    void beginDepthPass();
+    void endDepthPass();
+    void beginShadingPass();
+    void endShadingPass();
+
+    /**
+     * Latest measured overdraw (0 until the first pre-pass frame resolved)
+     */
+    float getOverdraw() const { return overdraw; }
+    bool isPrepassEnabled() const { return prepassEnabled; }
+
+private:
+    unsigned int depthQueries[QUERY_FRAMES];
+    unsigned int shadingQueries[QUERY_FRAMES];
+    bool pending[QUERY_FRAMES];     ///< Slot holds an unread pre-pass frame measurement
+    int frame;
+    bool measuring;                 ///< Current frame runs the pre-pass
+    bool prepassEnabled;            ///< Automatic mode's current decision
+    float overdraw;
+
+    int slot() const { return frame % QUERY_FRAMES; }
+};
+
+#endif // OVERDRAWMONITOR_H
@@ -0,0 +1,186 @@
+/**
+ * PerformanceProfiler.h - CPU and GPU Pass Timing
+ *
+ * Measures every named rendering scope on both sides of the driver:
+ *
+ * - CPU: std::chrono timers around the code that records GL commands
+ * - GPU: GL_TIMESTAMP query pairs around the same scope, showing how long
+ *        the GPU actually spent executing the submitted work
+ *
+ * GPU queries are kept in a ring of GPU_QUERY_FRAMES slots per scope. Results
+ * are only read back once GL_QUERY_RESULT_AVAILABLE reports them complete,
+ * several frames after submission, so timing never stalls the pipeline.
+ * Timestamps are used instead of GL_TIME_ELAPSED because elapsed-time queries
+ * cannot be nested, while our scopes are (e.g. "gi_total" contains "gi_compute").
+ *
+ * Scope names are interned once into process-wide ScopeIds (getScopeId())
+ * and the per-scope data lives in an array indexed by them. The name
+ * overloads remember the address of each string literal they were called
+ * with, so timing a scope by name costs a pointer lookup and never builds
+ * a std::string; hot callers can hold on to the ScopeId instead.
+ *
+ * The profiler also counts calls to the global operator new (all threads),
+ * so a frame's heap allocations show up next to its timings; in steady
+ * state the render loop should make none (see FrameArena.h). malloc() calls
+ * from C libraries and the driver are not included.
+ */
+
+#ifndef PERFORMANCE_PROFILER_H
+#define PERFORMANCE_PROFILER_H
+
+#include <cfloat>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class PerformanceProfiler {
+public:
+    static const int GPU_QUERY_FRAMES = 4;     ///< Frames a GPU result may stay in flight before its slot is reused
+
+    typedef int ScopeId;
+
+    /**
+     * Rolling timing statistics for a single scope (milliseconds)
+     */
+    struct TimingData {
+        float lastTime = 0.0f;
+        float minTime = FLT_MAX;
+        float maxTime = 0.0f;
+        float avgTime = 0.0f;
+        int sampleCount = 0;
+
+        void updateStats(float newTime);
+    };
+
+    PerformanceProfiler();
+    ~PerformanceProfiler();
+
+    /**
+     * Start a new frame and collect any GPU results that have become available
+     * Must be called from the thread owning the GL context.
+     */
+    void beginFrame();
+
+    /**
+     * Interned id of a scope name (the same in every profiler)
+     */
+    static ScopeId getScopeId(const char* name);
+    static const char* getScopeName(ScopeId id);
+
+    /**
+     * Begin/end a named scope on both CPU and GPU
+     * GPU timestamps are only recorded when GPU timing is enabled.
+     */
+    void beginTimer(ScopeId id);
+    void endTimer(ScopeId id);
+    void beginTimer(const char* name);
+    void endTimer(const char* name);
+
+    /**
+     * Print CPU and GPU timings for all scopes side by side, sorted by cost
+     */
+    void logDetailedStats();
+
+    float getLastTime(const char* name);    ///< Last CPU time of a scope
+    float getAverageTime(const char* name); ///< Rolling-average CPU time of a scope
+    float getGpuLastTime(const char* name); ///< Last resolved GPU time of a scope
+    float getGpuAverageTime(const char* name); ///< Rolling-average GPU time of a scope
+
+    /**
+     * Enable or disable GPU timestamp queries (enabled by default)
+     */
+    void setGpuTimingEnabled(bool enabled) { gpuTimingEnabled = enabled; }
+    bool isGpuTimingEnabled() const { return gpuTimingEnabled; }
+
+    int getFrameCount() const { return frameCounter; }
+
+    /**
+     * operator new calls since startup (all threads)
+     */
+    static uint64_t getAllocationCount();
+
+    /**
+     * operator new calls between the last two beginFrame() calls
+     */
+    uint64_t getFrameAllocations() const { return frameAllocations; }
+
+    /**
+     * Keep every raw sample (not just rolling stats) for offline analysis
+     * Used by the benchmark to compute percentiles per pass.
+     *
+     * @param expectedSamples Reserved per scope before its first recorded
+     *                        sample, so recording does not allocate per frame
+     */
+    void setHistoryRecording(bool enabled, size_t expectedSamples = 0);
+
+    /**
+     * Wait for the GPU to finish and resolve every outstanding query
+     * Stalls on purpose - only for the end of a benchmark run, never per frame.
+     */
+    void flushGpuTimers();
+
+    std::vector<std::string> getScopeNames();
+    std::vector<float> getCpuHistory(const char* name);
+    std::vector<float> getGpuHistory(const char* name);
+
+private:
+    /**
+     * Ring of timestamp query pairs for one scope
+     */
+    struct GpuTimer {
+        unsigned int beginQueries[GPU_QUERY_FRAMES] = {};
+        unsigned int endQueries[GPU_QUERY_FRAMES] = {};
+        bool pending[GPU_QUERY_FRAMES] = {};
+        TimingData stats;
+    };
+
+    struct ScopeData {
+        std::chrono::time_point<std::chrono::high_resolution_clock> start;
+        TimingData cpu;
+        GpuTimer gpu;
+        bool gpuInitialized = false;
+        bool used = false;                 ///< Timed at least once by this profiler
+        std::vector<float> cpuHistory;     ///< Raw CPU samples (only when recording history)
+        std::vector<float> gpuHistory;     ///< Raw GPU samples (only when recording history)
+    };
+
+    void resolveGpuTimer(ScopeData& scope);
+    int currentQuerySlot() const { return frameCounter % GPU_QUERY_FRAMES; }
+    void recordSample(std::vector<float>& history, float sample);
+
+    // Timer bodies (timerMutex held)
+    void beginScope(ScopeId id);
+    void endScope(ScopeId id, std::chrono::high_resolution_clock::time_point end);
+
+    /**
+     * Id of a name through the literal address cache (timerMutex held)
+     */
+    ScopeId findId(const char* name);
+
+    /**
+     * Scope data of an id, if this profiler has timed it (timerMutex held)
+     */
+    ScopeData* findScope(const char* name);
+
+    std::vector<ScopeData> scopes;                                  ///< Indexed by ScopeId
+    struct LiteralId {
+        ScopeId id;
+        const char* name;                                           ///< Interned copy, to check the address still holds it
+    };
+
+    std::unordered_map<const char*, LiteralId> literalIds;          ///< Name address -> id
+    std::vector<ScopeId> sortScratch;                               ///< logDetailedStats() order, kept between calls
+    std::mutex timerMutex;
+    int frameCounter = 0;
+    bool gpuTimingEnabled = true;
+    bool recordHistory = false;
+    size_t expectedHistorySamples = 0;
+    uint64_t frameStartAllocations = 0;
+    uint64_t frameAllocations = 0;
+    std::chrono::time_point<std::chrono::high_resolution_clock> frameStart;
+};
+
+#endif // PERFORMANCE_PROFILER_H
@@ -0,0 +1,63 @@
+/**
+ * PostChain.h - Ping-Pong Buffers for the Post-Processing Stages
+ *
+ * The composite and every post stage after it (SSR resolve, FXAA) read the
+ * previous stage's image and write a new one. Instead of one texture per
+ * stage, the chain holds just two pooled buffers and alternates between
+ * them: advance() hands the buffer two stages back to the RenderTargetPool
+ * and acquires the next output at the size that stage asks for, so:
+ *
+ * - Stages that are switched off are simply never advanced to and cost
+ *   nothing (SSR off, FXAA-vs-TAA picked by RenderSettings::antiAliasingMode).
+ * - Sizes follow the frame: the scene buffer is acquired at the internal
+ *   render resolution RadianceCascades::resize() was given, the FXAA output
+ *   at the output resolution, and a window or render-scale change needs no
+ *   reallocation step of its own (equal sizes get the same pooled texture
+ *   back every frame).
+ *
+ * TAA keeps its own history pair in RadianceCascades: it must outlive the
+ * frame, which a shared ping-pong buffer does not.
+ */
+
+#ifndef POST_CHAIN_H
+#define POST_CHAIN_H
+
+#include "RenderTargetPool.h"
+
+class PostChain {
+public:
+    explicit PostChain(RenderTargetPool& pool);
+    ~PostChain();
+    PostChain(const PostChain&) = delete;
+    PostChain& operator=(const PostChain&) = delete;
+
+    /**
+     * Start a frame with the scene buffer the composite renders into
+     */
+    const RenderTarget& begin(int width, int height);
+
+    /**
+     * Acquire the next stage's output; getInputTexture() is then the image it reads
+     */
+    const RenderTarget& advance(int width, int height);
+
+    /**
+     * Return both buffers to the pool (after the output copy)
+     */
+    void end();
+
+    const RenderTarget& getCurrent() const { return buffers[current]; }
+    unsigned int getInputTexture() const { return buffers[1 - current].texture; }
+
+    /**
+     * Storage format of every buffer in the chain (HDR, no alpha)
+     */
+    static unsigned int getFormat();
+
+private:
+    RenderTargetPool& pool;
+    RenderTarget buffers[2];
+    int current;
+};
+
+#endif // POST_CHAIN_H
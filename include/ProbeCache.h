@@ -0,0 +1,100 @@
+/**
+ * ProbeCache.h - World-Space Irradiance Probe Clipmap
+ *
+ * The radiance cascades only know what is on screen this frame. The probe
+ * cache keeps a grid of GRID_X x GRID_Y x GRID_Z irradiance probes,
+ * SPACING world units apart, centred on the camera, and it persists across
+ * frames and camera moves:
+ *
+ * - Each probe stores a mean radiance (L0) and a luminance-weighted mean
+ *   direction (L1) in two RGBA16F 3D textures, plus a valid flag and a
+ *   sample count so new rays blend in at 1/n up to a fixed history length.
+ * - Probes trace rays through the current G-buffer (probe_update.frag).
+ *   Rays leaving the screen carry no information, so light a probe saw
+ *   earlier survives while it is off screen or behind the camera.
+ * - The grid is a clipmap: cell c is stored at texel c mod grid size.
+ *   When the camera crosses a cell only the texels of cells that left the
+ *   grid are cleared and reused; everything else stays where it is.
+ * - Updates are incremental: SLICES_PER_FRAME z slices trace each frame,
+ *   round-robin, so the whole grid refreshes every GRID_Z / SLICES_PER_FRAME
+ *   frames at a fixed cost.
+ *
+ * probe_common.glsl samples the cache; the coarsest radiance cascade uses
+ * it as its merge source (the far field), and the final composite uses it
+ * where the cascades found no light.
+ */
+
+#ifndef PROBECACHE_H
+#define PROBECACHE_H
+
+#include <cstddef>
+#include <glm/glm.hpp>
+
+class Shader;
+class FullscreenQuad;
+
+class ProbeCache {
+public:
+    static const int GRID_X = 32;
+    static const int GRID_Y = 16;
+    static const int GRID_Z = 32;
+    static constexpr float SPACING = 0.5f;  ///< World units between probes
+    static const int SLICES_PER_FRAME = 4;  ///< Z slices traced per update
+    static const int TEXTURE_UNIT = 12;     ///< probeL0 is bound here, probeL1 at the next unit
+
+    /**
+     * G-buffer targets the probes trace against (RadianceCascades getters)
+     */
+    struct GBufferInputs {
+        unsigned int normal = 0;
+        unsigned int albedo = 0;
+        unsigned int linearDepth = 0;
+        unsigned int emission = 0;
+    };
+
+    ProbeCache();
+    ~ProbeCache();
+    ProbeCache(const ProbeCache&) = delete;
+    ProbeCache& operator=(const ProbeCache&) = delete;
+
+    /**
+     * Scroll the clipmap to the camera and trace the next slices
+     * Camera and light come from the FrameUniforms block. Leaves the
+     * framebuffer and viewport for the caller to restore.
+     *
+     * @param shader         Program built from probe_update.frag
+     * @param quad           Fullscreen quad
+     * @param cameraPosition World position the grid is centred on
+     * @param gBuffer        Current G-buffer
+     */
+    void update(Shader& shader, FullscreenQuad& quad, const glm::vec3& cameraPosition, const GBufferInputs& gBuffer);
+
+    /**
+     * Bind the probe textures at TEXTURE_UNIT and set the probe_common.glsl
+     * grid uniforms (shader must be in use; sampler units are the caller's)
+     */
+    void bindForSampling(Shader& shader) const;
+
+    /**
+     * Drop every probe (next update starts from an empty grid)
+     */
+    void reset() { hasOrigin = false; }
+
+    /**
+     * Bytes of GPU texture memory (both probe textures and the update target)
+     */
+    size_t getMemoryUsage() const;
+
+    glm::ivec3 getOrigin() const { return origin; }
+
+private:
+    unsigned int probeTextures[2];  ///< L0, L1 (3D)
+    unsigned int sliceTextures[2];  ///< One slice of each, rendered then copied in
+    unsigned int sliceFBO;
+    glm::ivec3 origin;              ///< World cell of the grid's first probe
+    bool hasOrigin;
+    int nextSlice;
+    unsigned int frame;
+};
+
+#endif // PROBECACHE_H
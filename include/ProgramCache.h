@@ -0,0 +1,51 @@
+/**
+ * ProgramCache.h - On-Disk Cache of Linked Shader Program Binaries
+ *
+ * Compiling and linking the renderer's programs from GLSL is the bulk of
+ * startup time. Where the driver supports program binaries
+ * (GLExtensions::hasProgramBinary()), every program linked from source is
+ * saved to cache/shaders/ and later runs hand the binary straight back to
+ * glProgramBinary instead of compiling.
+ *
+ * An entry is keyed by a hash of the program's expanded sources (includes
+ * resolved) and of the GL vendor, renderer and version strings, so editing
+ * a shader or updating the driver simply misses the cache. A driver may also
+ * reject a binary it wrote itself; Shader then compiles from source and the
+ * entry is rewritten.
+ *
+ * File layout (native endian):
+ *     uint32 magic "VGPB", uint32 VERSION, uint32 binary format, uint32 size
+ *     size bytes of glGetProgramBinary output
+ */
+
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ProgramCache {
+public:
+    static const uint32_t VERSION = 1;
+
+    /**
+     * Cache key of a program: its stage sources in link order plus the driver strings
+     */
+    static uint64_t makeKey(const std::vector<std::string>& sources);
+
+    /**
+     * Load a cached binary into a program object
+     * @return True if the program is now linked from the cache
+     */
+    static bool load(uint64_t key, unsigned int program);
+
+    /**
+     * Save a successfully linked program (written atomically via rename)
+     */
+    static bool save(uint64_t key, unsigned int program);
+
+    static std::string getCachePath(uint64_t key);
+};
+
+#endif // PROGRAM_CACHE_H
@@ -17,6 +17,17 @@
  * - Temporal Anti-Aliasing (TAA) for temporal upsampling
  * - Motion vectors for temporal effects
  * 
+ * Memory layout:
+ * - The G-buffer stores no position; it is rebuilt from 32-bit linear depth
+ * - Cascades are RGBA16F, emission is packed R11G11B10F
+ * - History is shared: each cascade's output is next frame's temporal input
+ *   (the two textures swap roles), and TAA ping-pongs the same way
+ * - Pass-local intermediates come from a RenderTargetPool and alias each other;
+ *   the images between post stages live in a PostChain built on the same pool
+ * - SSAO and SSR can trace at half resolution (optionally one checkerboard
+ *   half per frame) and are upsampled depth-aware, with a reprojected history
+ *   filling in what was not traced (see setPostResolution)
+ * 
  * References:
  * - "Radiance Cascades: A Novel Approach to Real-Time Global Illumination"
  * - Screen-space techniques in real-time rendering
@@ -25,8 +36,12 @@
 #ifndef RADIANCE_CASCADES_H
 #define RADIANCE_CASCADES_H
 
+#include <cstddef>
 #include <vector>
 #include "../include/Shader.h"
+#include "../include/FullscreenQuad.h"
+#include "../include/RenderTargetPool.h"
+#include "../include/UniformBuffer.h"
 #include <glm/glm.hpp>
 
 /**
@@ -38,6 +53,31 @@
  */
 class RadianceCascades {
 public:
+    /**
+     * Bytes of GPU render-target memory, grouped by owner
+     */
+    struct MemoryUsage {
+        size_t gBuffer = 0;
+        size_t cascades = 0;    ///< Active cascade outputs
+        size_t history = 0;     ///< Their temporal history
+        size_t post = 0;        ///< SSAO, SSR and TAA targets
+        size_t transient = 0;   ///< Pooled intermediates at peak
+        
+        size_t total() const { return gBuffer + cascades + history + post + transient; }
+    };
+    
+    static const unsigned int ALL_CASCADES = ~0u;   ///< Update mask selecting every cascade
+    static const int SSAO_KERNEL_SIZE = 32;          ///< Samples in the SSAOKernel block (ssao.frag)
+    
+    /**
+     * Execution rate of SSAO and SSR (setPostResolution)
+     */
+    enum PostResolution {
+        POST_FULL = 0,          ///< Every pixel, every frame
+        POST_HALF = 1,          ///< Half resolution, bilateral upsample + temporal reconstruction
+        POST_CHECKERBOARD = 2   ///< Half resolution, and only one checkerboard half of it per frame
+    };
+    
     /**
      * Constructor - Initialize the radiance cascades system
      * 
@@ -59,12 +99,37 @@ public:
     /**
      * Compute radiance cascades for global illumination
      * This is the main GI computation that propagates light through multiple scales
+     * Camera and light data come from the FrameUniforms block (UniformBuffer.h).
+     * 
+     * History is sampled at the position the motion vectors (gVelocity) map
+     * each texel to in the previous frame, so camera motion keeps converged GI.
+     * 
+     * @param shader         Radiance cascade compute shader
+     * @param activeCascades Number of cascades to compute (-1 for all)
+     * @param updateMask     Bit i set = recompute cascade i; the others keep last frame's
+     *                       output (and still serve as merge sources)
+     */
+    void compute(Shader& shader, int activeCascades = -1, unsigned int updateMask = ALL_CASCADES);
+    
+    /**
+     * Compute radiance cascades with a compute program (GL 4.3+, see GLExtensions.h)
+     * Same result as compute(), but each cascade is one dispatch that writes its
+     * image and temporal history directly, merging the coarser cascade from
+     * shared memory. compute() remains the fallback for 3.3 contexts.
+     * 
+     * @param computeShader  Program built from rc_cascade.comp
+     * @param activeCascades Number of cascades to compute (-1 for all)
+     * @param updateMask     Cascades to recompute, as for compute()
+     */
+    void dispatch(Shader& computeShader, int activeCascades = -1, unsigned int updateMask = ALL_CASCADES);
+    
+    /**
+     * Set the animation time passed to the cascade shader
+     * Driven by the caller so fixed-timestep playback renders identical frames.
      * 
-     * @param shader     Radiance cascade compute shader
-     * @param view       Camera view matrix
-     * @param projection Camera projection matrix
+     * @param seconds Time in seconds
      */
-    void compute(Shader& shader, const glm::mat4& view, const glm::mat4& projection, int activeCascades = -1);
+    void setTime(float seconds) { animationTime = seconds; }
     
     /**
      * Apply temporal blur to smooth GI and reduce noise
@@ -72,8 +137,10 @@ public:
      * 
      * @param blurShader  Shader for blur computation
      * @param activeCascades Number of cascades to blur (-1 for all)
+     * @param updateMask     Only cascades recomputed this frame are blurred (the others
+     *                       already hold a blurred result)
      */
-    void blur(Shader& blurShader, int activeCascades = -1);
+    void blur(Shader& blurShader, int activeCascades = -1, unsigned int updateMask = ALL_CASCADES);
     
     /**
      * Apply blur to a single cascade for selective performance optimization
@@ -88,11 +155,14 @@ public:
     /**
      * Compute Screen Space Ambient Occlusion
      * Provides contact shadows and enhanced depth perception
+     * The projection matrix comes from the FrameUniforms block.
+     * 
+     * The kernel lives in a uniform block uploaded once per allocation.
      * 
-     * @param ssaoShader SSAO computation shader
-     * @param projection Camera projection matrix for depth reconstruction
+     * @param ssaoShader        SSAO computation shader
+     * @param reconstructShader Upsampling pass (post_reconstruct.frag), used below POST_FULL
      */
-    void computeSSAO(Shader& ssaoShader, const glm::mat4& projection);
+    void computeSSAO(Shader& ssaoShader, Shader& reconstructShader);
     
     /**
      * Apply blur to SSAO to reduce noise while preserving details
@@ -106,58 +176,100 @@ public:
     /**
      * Compute Screen Space Reflections
      * Provides realistic surface reflections for shiny materials
+     * Camera matrices and position come from the FrameUniforms block.
      * 
      * @param ssrShader SSR computation shader
+     * @param reconstructShader Upsampling pass (post_reconstruct.frag), used below POST_FULL
      * @param colorTexture Current frame color texture for reflection sampling
-     * @param view Current view matrix
-     * @param projection Current projection matrix
-     * @param viewPos Camera position in world space
      */
-    void computeSSR(Shader& ssrShader, unsigned int colorTexture, const glm::mat4& view, 
-                    const glm::mat4& projection, const glm::vec3& viewPos);
+    void computeSSR(Shader& ssrShader, Shader& reconstructShader, unsigned int colorTexture);
+    
+    /**
+     * Choose how SSAO and SSR are executed (reallocates their targets on change)
+     * 
+     * Reduced modes trace into a half-resolution target. A reconstruction
+     * pass then upsamples it with weights that reject texels at a different
+     * depth, and blends in last frame's result reprojected with gVelocity
+     * and clamped to the fresh neighbourhood. In POST_CHECKERBOARD the
+     * untraced half of the trace target still holds last frame's values and
+     * only contributes with a reduced weight.
+     * 
+     * @param mode A PostResolution value
+     */
+    void setPostResolution(int mode);
+    int getPostResolution() const { return postResolution; }
     
     /**
-     * Apply SSR to final composite
-     * Blends screen space reflections with the lit scene
+     * Blend the reflections of computeSSR() over the lit scene
+     * Runs at the internal resolution.
      * 
-     * @param compositeShader Final composite shader
-     * @param ssrStrength Reflection strength multiplier
+     * @param resolveShader ssr_resolve.frag program
+     * @param colorTexture  Lit scene the reflections were traced against
+     * @param outputFBO     Target of the blended image (must not sample colorTexture)
      */
-    void applySSR(Shader& compositeShader, float ssrStrength);
+    void applySSR(Shader& resolveShader, unsigned int colorTexture, unsigned int outputFBO);
     
     // Temporal Anti-Aliasing (TAA)
     
     /**
      * Apply Temporal Anti-Aliasing to reduce aliasing artifacts
      * Uses motion vectors and history buffer for temporal upsampling
+     * Current and previous view-projection come from the FrameUniforms block.
+     * Runs at the output resolution: a frame rendered at a lower internal
+     * resolution is upscaled here, and the history keeps full detail.
+     * With the projection jitter of FrameUniforms every frame samples other
+     * sub-pixel positions, so the history converges to output-resolution
+     * detail (temporal upscaling). Linear depth rejects disoccluded history.
      * 
      * @param taaShader TAA computation shader
      * @param currentFrame Current frame texture
-     * @param currentViewProj Current view-projection matrix
-     * @param previousViewProj Previous frame's view-projection matrix
      */
-    void applyTAA(Shader& taaShader, unsigned int currentFrame, 
-                  const glm::mat4& currentViewProj, const glm::mat4& previousViewProj);
+    void applyTAA(Shader& taaShader, unsigned int currentFrame);
     
     /**
      * Apply FXAA (Fast Approximate Anti-Aliasing) as alternative to TAA
+     * Resolves to the output resolution.
      * 
      * @param fxaaShader FXAA computation shader
      * @param inputTexture Source texture to anti-alias
+     * @param outputFBO    Output-sized target of the anti-aliased image
      */
-    void applyFXAA(Shader& fxaaShader, unsigned int inputTexture);
+    void applyFXAA(Shader& fxaaShader, unsigned int inputTexture, unsigned int outputFBO);
+    
+    /**
+     * Pool for transient render targets, shared with the Renderer's own passes
+     */
+    RenderTargetPool& getTargetPool() { return targetPool; }
+    
+    /**
+     * Render-target memory used at this resolution
+     * 
+     * @param activeCascades  Cascades computed per frame
+     * @param blurredCascades Cascades blurred per frame (sizes their pooled intermediates)
+     */
+    MemoryUsage getMemoryUsage(int activeCascades, int blurredCascades) const;
     
     // System Management
     
     /**
-     * Resize all buffers when window size changes
-     * Reallocates all framebuffers and textures to new resolution
+     * Resize the internal-resolution buffers (window resize or render scale change)
+     * Reallocates every framebuffer and texture except the TAA pair (see setOutputSize)
      * 
-     * @param width  New screen width
-     * @param height New screen height
+     * @param width  New internal render width
+     * @param height New internal render height
      */
     void resize(int width, int height);
     
+    /**
+     * Set the resolution the TAA/FXAA passes resolve to
+     * Only the anti-aliasing targets are reallocated, so changing the internal
+     * resolution with resize() keeps the TAA history.
+     * 
+     * @param width  Output width
+     * @param height Output height
+     */
+    void setOutputSize(int width, int height);
+    
     /**
      * Reset temporal accumulation buffers
      * Useful when lighting changes dramatically to prevent ghosting
@@ -191,10 +303,11 @@ public:
     // G-Buffer Access Methods
     
     /**
-     * Get world-space position buffer from G-buffer
-     * Contains XYZ world positions for each pixel
+     * Get linear depth buffer from G-buffer
+     * Contains positive view-space depth; view positions are rebuilt from it
+     * (shaders/view_position.glsl)
      */
-    unsigned int getGPosition() const;
+    unsigned int getGLinearDepth() const;
     
     /**
      * Get world-space normal buffer from G-buffer  
@@ -291,31 +404,31 @@ public:
 
 private:
     // Core Properties
-    int screenWidth, screenHeight;              ///< Current screen resolution
+    int screenWidth, screenHeight;              ///< Internal render resolution (G-buffer, cascades, SSAO, SSR)
+    int outputWidth, outputHeight;              ///< Resolution of the anti-aliased output
     int numCascades;                           ///< Number of cascade levels
     
     // Cascade Resources
     std::vector<unsigned int> cascadeFBOs;     ///< Framebuffers for each cascade level
     std::vector<unsigned int> cascadeTextures; ///< Radiance textures for each cascade
-    std::vector<unsigned int> tempBlurFBOs;    ///< Temporary framebuffers for blur passes
-    std::vector<unsigned int> tempBlurTextures;///< Temporary textures for blur passes
     
     // Temporal Accumulation (for stability and convergence)
     std::vector<unsigned int> temporalFBOs;    ///< Temporal accumulation framebuffers
-    std::vector<unsigned int> temporalTextures;///< Temporal accumulation textures
+    std::vector<unsigned int> temporalTextures;///< Last frame's cascade output (swapped with cascadeTextures)
     bool useTemporalBuffer;                    ///< Flag for temporal buffer usage
     int frameCounter;                          ///< Frame counter for temporal effects
+    float animationTime = 0.0f;                ///< Time uniform for the cascade shader (see setTime)
     
     // G-Buffer Resources (Deferred Rendering)
     unsigned int gBuffer;                      ///< Main G-buffer framebuffer
-    unsigned int gPosition;                    ///< World-space position texture (RGB: xyz, A: depth)
     unsigned int gNormal;                      ///< World-space normal texture (RGB: normalized xyz)
     unsigned int gAlbedo;                      ///< Albedo/diffuse color texture (RGB: color, A: roughness)
-    unsigned int gDepth;                       ///< Depth buffer for depth testing
+    unsigned int gDepth;                       ///< Linear depth texture (R32F; positions are rebuilt from it)
     unsigned int rboDepth;                     ///< Depth renderbuffer object
     unsigned int gVelocity;                    ///< Motion vector texture for TAA (RG: screen-space velocity)
     unsigned int gEmission;                    ///< Emission texture (RGB: emissive color and intensity)
-    unsigned int historyTexture;               ///< Previous frame texture for TAA
+    unsigned int historyTexture;               ///< Previous frame texture for TAA (swapped with taaTexture)
+    unsigned int historyFBO;                   ///< Framebuffer of historyTexture
     
     // Cascade Parameters
     float probeSpacing;                        ///< Spatial spacing between radiance probes
@@ -327,16 +440,35 @@ private:
     unsigned int ssaoFBO, ssaoBlurFBO;        ///< SSAO framebuffers (raw and blurred)
     unsigned int ssaoTexture, ssaoBlurTexture;///< SSAO textures (raw and blurred)
     unsigned int noiseTexture;                ///< Random noise texture for SSAO sampling
-    std::vector<glm::vec3> ssaoKernel;        ///< Hemisphere sampling kernel for SSAO
+    std::vector<glm::vec4> ssaoKernel;        ///< Hemisphere sampling kernel for SSAO (xyz, std140 padded)
+    
+    UniformBuffer ssaoKernelBuffer;           ///< ssaoKernel as the SSAOKernel uniform block
     
     // SSR Resources
     unsigned int ssrFBO;                      ///< SSR framebuffer for reflection computation
     unsigned int ssrTexture;                  ///< SSR reflection texture (RGB: reflection, A: strength)
     
+    /**
+     * Extra targets of an effect running below POST_FULL
+     */
+    struct ReducedRateTargets {
+        unsigned int traceFBO = 0, traceTexture = 0;        ///< Half resolution, kept across frames
+        unsigned int historyFBO = 0, historyTexture = 0;    ///< Last full-resolution result (swapped with the output)
+        bool historyValid = false;                          ///< Both hold data from an earlier frame
+        unsigned int frame = 0;                             ///< Picks the checkerboard half
+    };
+    int postResolution;                       ///< PostResolution of SSAO and SSR
+    ReducedRateTargets ssaoReduced;
+    ReducedRateTargets ssrReduced;
+    
     // TAA Resources
     unsigned int taaFBO;                      ///< TAA framebuffer for temporal accumulation
     unsigned int taaTexture;                  ///< TAA output texture
     
+    // Shared resources
+    RenderTargetPool targetPool;              ///< Transient intermediates (blur, post chain)
+    FullscreenQuad quad;                      ///< Fullscreen quad shared by every pass
+    
     // Private Setup Methods
     
     /**
@@ -345,20 +477,25 @@ private:
     void setupCascades();
     
     /**
-     * Initialize blur target resources
+     * Initialize temporal accumulation buffers
      */
-    void setupBlurTargets();
+    void setupTemporalBuffers();
     
     /**
-     * Initialize temporal accumulation buffers
+     * Make last frame's output of each recomputed cascade this frame's history
      */
-    void setupTemporalBuffers();
+    void swapHistory(int activeCascades, unsigned int updateMask);
     
     /**
-     * Initialize Temporal Anti-Aliasing resources
+     * Initialize Temporal Anti-Aliasing resources (output and history, at output resolution)
      */
     void setupTAA();
     
+    /**
+     * Delete the TAA resources (kept by cleanup() across internal resizes)
+     */
+    void cleanupTAA();
+    
     /**
      * Initialize Screen Space Ambient Occlusion resources
      */
@@ -382,7 +519,26 @@ private:
     void setupSSR();
     
     /**
-     * Clean up all OpenGL resources
+     * Allocate (or, at POST_FULL, delete) the reduced-rate targets of both effects
+     */
+    void setupReducedTargets();
+    void cleanupReducedTargets();
+    
+    /**
+     * Start a reduced-rate trace: bind the half-resolution target and pick the
+     * checkerboard parity (-1 = trace every texel)
+     */
+    int beginReducedTrace(ReducedRateTargets& targets);
+    
+    /**
+     * Upsample a reduced-rate trace into outputTexture, last frame's result
+     * becoming the history first
+     */
+    void reconstruct(Shader& reconstructShader, ReducedRateTargets& targets, int checkerParity,
+                     unsigned int& outputTexture, unsigned int& outputFBO);
+    
+    /**
+     * Clean up all OpenGL resources at internal resolution
      */
     void cleanup();
 };
@@ -0,0 +1,250 @@
+/**
+ * Registry.h - Dense Component Storage for the Entity-Component-System
+ *
+ * Entities are plain integer ids. Every component type gets its own pool that
+ * stores the components contiguously (a "sparse set"):
+ *
+ *     sparse[entity] -> index into dense arrays
+ *     dense[i]       -> component value
+ *     owners[i]      -> entity that owns dense[i]
+ *
+ * Lookups are two array reads, removal is swap-and-pop and iterating a pool
+ * walks packed memory. Multi-component queries iterate the smallest pool and
+ * probe the others, so a query over (Mesh, Transform) costs one pass over the
+ * meshes instead of a dynamic_cast scan per entity.
+ *
+ * Pointers and references to components are only valid until the next
+ * add/remove on the same pool (the dense array may reallocate or move the
+ * last element into the freed slot). Do not add or remove components of a
+ * type while iterating over it.
+ */
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using EntityId = uint32_t;
+constexpr EntityId INVALID_ENTITY = 0xFFFFFFFFu;
+
+namespace ecs_detail {
+    // Atomic: the first use of two types may happen on different JobSystem workers
+    inline size_t nextComponentTypeId() {
+        static std::atomic<size_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // One small integer per component type, assigned on first use (the static's
+    // initialization is thread-safe, so each type draws exactly one id)
+    template <typename T>
+    size_t componentTypeId() {
+        static const size_t id = nextComponentTypeId();
+        return id;
+    }
+}
+
+/**
+ * Type-erased pool interface so the registry can clear/remove without knowing T
+ */
+class ComponentPoolBase {
+public:
+    virtual ~ComponentPoolBase() = default;
+    virtual bool has(EntityId entity) const = 0;
+    virtual void remove(EntityId entity) = 0;
+    virtual void clear() = 0;
+    virtual size_t size() const = 0;
+    virtual const std::vector<EntityId>& entities() const = 0;
+};
+
+/**
+ * ComponentPool - Packed storage for one component type
+ */
+template <typename T>
+class ComponentPool : public ComponentPoolBase {
+public:
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    template <typename... Args>
+    T& emplace(EntityId entity, Args&&... args) {
+        if (entity >= sparse.size()) {
+            sparse.resize(entity + 1, INVALID_INDEX);
+        }
+        uint32_t index = sparse[entity];
+        if (index != INVALID_INDEX) {
+            // Replacing an existing component keeps its slot
+            dense[index] = T(std::forward<Args>(args)...);
+            return dense[index];
+        }
+        sparse[entity] = static_cast<uint32_t>(dense.size());
+        owners.push_back(entity);
+        dense.emplace_back(std::forward<Args>(args)...);
+        return dense.back();
+    }
+
+    T* get(EntityId entity) {
+        if (entity >= sparse.size() || sparse[entity] == INVALID_INDEX) {
+            return nullptr;
+        }
+        return &dense[sparse[entity]];
+    }
+
+    const T* get(EntityId entity) const {
+        if (entity >= sparse.size() || sparse[entity] == INVALID_INDEX) {
+            return nullptr;
+        }
+        return &dense[sparse[entity]];
+    }
+
+    bool has(EntityId entity) const override {
+        return entity < sparse.size() && sparse[entity] != INVALID_INDEX;
+    }
+
+    void remove(EntityId entity) override {
+        if (!has(entity)) {
+            return;
+        }
+        // Swap-and-pop keeps the arrays packed
+        uint32_t index = sparse[entity];
+        uint32_t last = static_cast<uint32_t>(dense.size() - 1);
+        if (index != last) {
+            dense[index] = std::move(dense[last]);
+            owners[index] = owners[last];
+            sparse[owners[index]] = index;
+        }
+        dense.pop_back();
+        owners.pop_back();
+        sparse[entity] = INVALID_INDEX;
+    }
+
+    void clear() override {
+        dense.clear();
+        owners.clear();
+        sparse.clear();
+    }
+
+    size_t size() const override { return dense.size(); }
+    const std::vector<EntityId>& entities() const override { return owners; }
+
+    // Direct access to the packed arrays (same order as entities())
+    T* data() { return dense.data(); }
+    const T* data() const { return dense.data(); }
+    typename std::vector<T>::iterator begin() { return dense.begin(); }
+    typename std::vector<T>::iterator end() { return dense.end(); }
+
+private:
+    std::vector<T> dense;           ///< Packed component values
+    std::vector<EntityId> owners;   ///< Owning entity of each dense element
+    std::vector<uint32_t> sparse;   ///< Entity id -> dense index (INVALID_INDEX if absent)
+};
+
+/**
+ * Registry - Owns entity ids and one ComponentPool per component type
+ */
+class Registry {
+public:
+    Registry() = default;
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    /**
+     * Create a new entity (ids of destroyed entities are reused)
+     */
+    EntityId createEntity();
+
+    /**
+     * Destroy an entity and all of its components
+     */
+    void destroyEntity(EntityId entity);
+
+    bool isAlive(EntityId entity) const;
+    size_t getEntityCount() const { return aliveCount; }
+
+    /**
+     * Destroy every entity and component (pool allocations are kept)
+     */
+    void clear();
+
+    template <typename T, typename... Args>
+    T& add(EntityId entity, Args&&... args) {
+        return pool<T>().emplace(entity, std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    T* get(EntityId entity) {
+        ComponentPool<T>* p = findPool<T>();
+        return p ? p->get(entity) : nullptr;
+    }
+
+    template <typename T>
+    bool has(EntityId entity) const {
+        const ComponentPool<T>* p = findPool<T>();
+        return p && p->has(entity);
+    }
+
+    template <typename T>
+    void remove(EntityId entity) {
+        if (ComponentPool<T>* p = findPool<T>()) {
+            p->remove(entity);
+        }
+    }
+
+    /**
+     * Get (or create) the pool for a component type
+     */
+    template <typename T>
+    ComponentPool<T>& pool() {
+        size_t id = ecs_detail::componentTypeId<T>();
+        if (id >= pools.size()) {
+            pools.resize(id + 1);
+        }
+        if (!pools[id]) {
+            pools[id] = std::make_unique<ComponentPool<T>>();
+        }
+        return static_cast<ComponentPool<T>&>(*pools[id]);
+    }
+
+    /**
+     * Call func(EntityId, First&, Rest&...) for every entity that has all the
+     * listed components. Iteration is driven by the smallest of the pools.
+     */
+    template <typename First, typename... Rest, typename Func>
+    void each(Func&& func) {
+        ComponentPool<First>& first = pool<First>();
+        const std::vector<EntityId>* driver = &first.entities();
+        ((driver = pool<Rest>().size() < driver->size() ? &pool<Rest>().entities() : driver), ...);
+
+        for (size_t i = 0; i < driver->size(); ++i) {
+            EntityId entity = (*driver)[i];
+            First* component = first.get(entity);
+            if (!component || !(pool<Rest>().has(entity) && ...)) {
+                continue;
+            }
+            func(entity, *component, *pool<Rest>().get(entity)...);
+        }
+    }
+
+private:
+    template <typename T>
+    ComponentPool<T>* findPool() {
+        size_t id = ecs_detail::componentTypeId<T>();
+        return id < pools.size() ? static_cast<ComponentPool<T>*>(pools[id].get()) : nullptr;
+    }
+
+    template <typename T>
+    const ComponentPool<T>* findPool() const {
+        size_t id = ecs_detail::componentTypeId<T>();
+        return id < pools.size() ? static_cast<const ComponentPool<T>*>(pools[id].get()) : nullptr;
+    }
+
+    std::vector<std::unique_ptr<ComponentPoolBase>> pools;  ///< Indexed by component type id
+    std::vector<bool> alive;                                ///< Liveness per entity id
+    std::vector<EntityId> freeIds;                          ///< Destroyed ids available for reuse
+    size_t aliveCount = 0;
+};
+
+#endif // REGISTRY_H
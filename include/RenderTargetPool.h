@@ -0,0 +1,85 @@
+/**
+ * RenderTargetPool.h - Transient Render Targets with Aliasing
+ *
+ * Many passes only need a texture for part of a frame: the horizontal blur
+ * temporary of each cascade, the composite target, the FXAA output. Instead
+ * of every pass owning one such texture forever, passes acquire a target
+ * for exactly the span they use it and release it afterwards; a later pass
+ * asking for the same size and format gets the same texture back. GL has no
+ * explicit memory aliasing, so sharing happens at texture granularity: any
+ * two transients with matching descriptions and disjoint lifetimes alias.
+ *
+ * Targets that stay free for MAX_IDLE_FRAMES frames (after a quality or
+ * resolution change) are deleted in beginFrame().
+ */
+
+#ifndef RENDER_TARGET_POOL_H
+#define RENDER_TARGET_POOL_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A single-attachment color target: texture plus the framebuffer rendering into it
+ */
+struct RenderTarget {
+    unsigned int fbo = 0;
+    unsigned int texture = 0;
+    int width = 0;
+    int height = 0;
+    unsigned int internalFormat = 0;
+
+    bool isValid() const { return texture != 0; }
+};
+
+class RenderTargetPool {
+public:
+    static const int MAX_IDLE_FRAMES = 120;
+
+    RenderTargetPool() = default;
+    ~RenderTargetPool();
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    /**
+     * Get a free target of this size and format, creating one if none is free
+     * The contents are undefined; clear or fully overwrite it.
+     */
+    RenderTarget acquire(int width, int height, unsigned int internalFormat);
+
+    /**
+     * Hand a target back; it may be returned by the next matching acquire()
+     */
+    void release(const RenderTarget& target);
+
+    /**
+     * Age free targets and delete the ones idle for MAX_IDLE_FRAMES
+     */
+    void beginFrame();
+
+    /**
+     * Delete every target (outstanding ones become invalid)
+     */
+    void clear();
+
+    size_t getAllocatedBytes() const;
+    int getTargetCount() const { return static_cast<int>(entries.size()); }
+
+    /**
+     * Storage size of one texel of a sized internal format (0 if unknown)
+     */
+    static size_t getBytesPerPixel(unsigned int internalFormat);
+
+private:
+    struct Entry {
+        RenderTarget target;
+        bool inUse;
+        int idleFrames;
+    };
+    std::vector<Entry> entries;
+
+    static RenderTarget create(int width, int height, unsigned int internalFormat);
+    static void destroy(RenderTarget& target);
+};
+
+#endif // RENDER_TARGET_POOL_H
@@ -0,0 +1,309 @@
+/**
+ * Renderer.h - Frame Rendering Pipeline
+ *
+ * Owns every GPU resource needed to turn a Scene into a final image and runs
+ * the complete multi-pass pipeline for one frame:
+ *
+ * 1. Shadow Map Generation (cascaded, cached, casters culled per cascade)
+ * 2. G-Buffer Pass (geometry data, frustum and optionally occlusion culled,
+ *    behind a depth pre-pass when the measured overdraw is high), then the
+ *    min/max depth pyramid the ray marches and occlusion culling use
+ *
+ * The geometry passes (1 and 2) are culled and submitted from the CPU, or,
+ * with RenderSettings::gpuDriven where the context supports it, culled by a
+ * compute pass and drawn with multi-draw-indirect (see GpuCuller.h).
+ * 3. SSAO Computation
+ * 4. Radiance Cascades GI (optionally with a world-space probe cache as far field,
+ *    and world-space rays through a scene BVH where the screen has no answer)
+ * 5. Final Composite
+ * 6. Screen Space Reflections, blended over the composite
+ * 7. Anti-Aliasing (FXAA or TAA)
+ * 8. Output to the default framebuffer
+ *
+ * With dynamic resolution enabled, a FrameBudgetController picks the internal
+ * resolution of steps 2-5 and trims the cascade count to hold a frame-time
+ * target; anti-aliasing and the output copy always run at the window size.
+ *
+ * A FramePacer lets the CPU record up to RenderSettings::framesInFlight
+ * frames ahead of the GPU; the per-frame uniforms and instances are
+ * streamed into ring buffer regions instead of re-uploaded in place, so
+ * nothing in the frame waits for the GPU (see FramePacer.h, SyncMonitor.h).
+ *
+ * The renderer knows nothing about windows, input or UI, so the interactive
+ * application and the headless benchmark drive exactly the same code path.
+ */
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <functional>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Shader.h"
+#include "ShaderVariants.h"
+#include "Material.h"
+#include "UniformBuffer.h"
+#include "DrawBatcher.h"
+#include "ShadowMap.h"
+#include "RadianceCascades.h"
+#include "FullscreenQuad.h"
+#include "FrameBudgetController.h"
+#include "OcclusionCuller.h"
+#include "OverdrawMonitor.h"
+#include "GiUpdateScheduler.h"
+#include "ProbeCache.h"
+#include "DepthPyramid.h"
+#include "PostChain.h"
+#include "LightClusters.h"
+#include "FramePacer.h"
+#include "FrameArena.h"
+#include "SceneBvh.h"
+#include "GpuCuller.h"
+
+class Scene;
+class PerformanceProfiler;
+class JobSystem;
+
+/**
+ * User-facing rendering toggles and quality selection
+ */
+struct RenderSettings {
+    bool ambientEnabled = false;    ///< Ambient lighting (default off)
+    bool giEnabled = true;          ///< Global illumination (default on)
+    bool ssaoEnabled = false;       ///< Screen space ambient occlusion (default off)
+    bool ssrEnabled = false;        ///< Screen space reflections (default off)
+    bool lightEnabled = true;       ///< Scene lights: the shadowed primary and the clustered local lights (default on)
+    int antiAliasingMode = 2;       ///< AA mode: 0=none, 1=FXAA, 2=TAA (default TAA)
+    int qualityLevel = 2;           ///< Quality level: 0=super low, 1=performance, 2=balanced, 3=high, 4=ultra
+    bool computeGI = true;          ///< Use the compute GI path where the context supports it
+    bool dynamicResolution = false; ///< Scale internal resolution and cascades to hold targetFrameTimeMs
+    float targetFrameTimeMs = 1000.0f / 60.0f; ///< Frame-time budget for dynamic resolution
+    bool occlusionCulling = false;  ///< Also cull G-buffer draws hidden in last frames' depth (frustum culling is always on)
+    int depthPrepassMode = 2;       ///< Depth pre-pass: 0=off, 1=always, 2=automatic from measured overdraw (default)
+    bool probeCache = false;        ///< World-space irradiance probes as the GI far field (see ProbeCache.h)
+    int postResolution = 1;         ///< SSAO/SSR rate: 0=full, 1=half resolution (default), 2=half resolution checkerboard
+    bool hierarchicalTracing = true; ///< SSR and GI rays march the min/max depth pyramid instead of fixed steps (see DepthPyramid.h)
+    bool worldSpaceRays = false;    ///< GI rays the screen misses continue through the scene BVH (see SceneBvh.h)
+    int upscaleMode = 0;            ///< Temporal upscaling, TAA only: 0=native, 1=quality, 2=balanced, 3=performance, 4=ultra performance (see getUpscaleRatio)
+    int framesInFlight = 2;         ///< Frames the CPU may record ahead of the GPU, 1-3 (1 = serial CPU and GPU)
+    bool gpuDriven = false;         ///< Cull on the GPU and draw with multi-draw-indirect where supported (see GpuCuller.h); occlusion culling then uses last frame's depth pyramid
+    float lodErrorPixels = 1.0f;    ///< Largest on-screen simplification error of a level of detail, in pixels; 0 = full detail (shadow casters allow twice as much, see DrawBatcher.h)
+};
+
+class Renderer {
+public:
+    static const int QUALITY_LEVELS = 5;
+    static const int UPSCALE_MODES = 5;
+
+    /**
+     * Load all pipeline shaders and allocate render targets
+     * Requires a current OpenGL context.
+     *
+     * @param width  Initial framebuffer width
+     * @param height Initial framebuffer height
+     */
+    Renderer(int width, int height);
+
+    /**
+     * Render one frame of the scene into the default framebuffer
+     *
+     * @param scene    Scene to render (camera, lights and geometry)
+     * @param settings Feature toggles and quality level for this frame
+     * @param width    Current framebuffer width (resources are resized on change)
+     * @param height   Current framebuffer height
+     * @param time     Animation time in seconds passed to time-dependent shaders
+     * @param profiler Profiler receiving CPU/GPU timings for every pass
+     * @param sceneReleased Optional; called as soon as the scene's lights, camera and
+     *                 instances (world matrices from Scene::updateWorldMatrices()) are
+     *                 copied out, before the passes are submitted. The scene may be
+     *                 modified from then on, e.g. by the next frame's simulation jobs.
+     */
+    void render(Scene& scene, const RenderSettings& settings, int width, int height,
+                float time, PerformanceProfiler& profiler, const std::function<void()>& sceneReleased = {});
+
+    /**
+     * Worker pool for CPU-side preparation (scene BVH builds); nullptr, the
+     * default, does everything on the render thread
+     */
+    void setJobSystem(JobSystem* jobSystem) { jobs = jobSystem; }
+
+    /**
+     * Discard accumulated GI history (e.g. after a discontinuous camera cut)
+     */
+    void resetTemporalAccumulation();
+
+    /**
+     * Number of radiance cascades evaluated at a given quality level
+     */
+    static int getCascadeCountForQuality(int qualityLevel);
+
+    /**
+     * Number of cascades the GI blur pass smooths at a given quality level
+     */
+    static int getBlurredCascadeCountForQuality(int qualityLevel);
+
+    /**
+     * Render-target memory a quality level uses at the current resolution
+     */
+    RadianceCascades::MemoryUsage getMemoryUsageForQuality(int qualityLevel) const;
+
+    /**
+     * Print the memory use of every quality level (done on each resize)
+     */
+    void logMemoryUsage() const;
+
+    /**
+     * Composite GI strength for a quality level (more cascades capture more light)
+     */
+    static float getGiStrengthForQuality(int qualityLevel);
+
+    static const char* getQualityName(int qualityLevel);
+
+    /**
+     * Internal resolution per output axis of a temporal upscaling mode
+     * (1, 0.77, 0.67, 0.58, 0.5); the budget controller's scale applies on top
+     */
+    static float getUpscaleRatio(int upscaleMode);
+
+    static const char* getUpscaleModeName(int upscaleMode);
+
+    /**
+     * Upscaling mode of a command line name (native, quality, balanced,
+     * performance, ultra-performance), -1 if there is none
+     */
+    static int parseUpscaleMode(const std::string& name);
+
+    RadianceCascades& getRadianceCascades() { return rc; }
+    
+    /**
+     * Dynamic resolution state (render scale, cascade reduction, filtered frame time)
+     */
+    const FrameBudgetController& getBudgetController() const { return budgetController; }
+    int getRenderWidth() const { return renderWidth; }
+    int getRenderHeight() const { return renderHeight; }
+    
+    /**
+     * Instances drawn into the G-buffer last frame after culling, and before
+     */
+    size_t getVisibleInstanceCount() const { return batcher.getInstanceCount(cameraView); }
+    size_t getTotalInstanceCount() const { return batcher.getInstanceCount(); }
+
+    /**
+     * Whether the context can take the GPU-driven path, and whether last frame did
+     * (visible counts are then the counts before culling)
+     */
+    bool isGpuDrivenSupported() const { return gpuCuller != nullptr; }
+    bool isGpuDriven() const { return batcher.isGpuDriven(); }
+    
+    /**
+     * Pre-pass state (latest measured G-buffer overdraw and the automatic decision)
+     */
+    const OverdrawMonitor& getOverdrawMonitor() const { return overdrawMonitor; }
+    
+    /**
+     * GI change tracking (what changed last frame and which cascades were recomputed)
+     */
+    const GiUpdateScheduler& getGiScheduler() const { return giScheduler; }
+    
+    /**
+     * World-space probe clipmap (only updated while RenderSettings::probeCache is on)
+     */
+    const ProbeCache& getProbeCache() const { return probeCache; }
+
+    /**
+     * Scene BVH of the world-space GI rays (only updated while RenderSettings::worldSpaceRays is on)
+     */
+    const SceneBvh& getSceneBvh() const { return sceneBvh; }
+
+    /**
+     * Local lights and their cluster assignment for the last frame
+     */
+    const LightClusters& getLightClusters() const { return lightClusters; }
+
+    /**
+     * Frames-in-flight limit (time the last frame waited for the GPU)
+     */
+    const FramePacer& getFramePacer() const { return framePacer; }
+
+    /**
+     * Per-frame scratch memory (reset at the start of every render())
+     */
+    const FrameArena& getFrameArena() const { return frameArena; }
+
+private:
+    // Pipeline shaders
+    Shader shadowShader;            ///< Shadow map generation
+    Shader gBufferShader;           ///< Deferred geometry pass
+    std::unique_ptr<Shader> gBufferBindlessShader; ///< Bindless-material variant of gBufferShader (null without GL_ARB_bindless_texture)
+    ShaderVariants rcVariants;      ///< Radiance cascades computation, per cascade count and tracing features
+    std::unique_ptr<ShaderVariants> rcComputeVariants; ///< Compute path of rcVariants (null without GL 4.3)
+    std::unique_ptr<Shader> gpuCullShader; ///< Instance culling of the GPU-driven path (null without multi-draw-indirect)
+    Shader blurShader;              ///< GI temporal blur
+    ShaderVariants compositeVariants; ///< Final lighting composite, per cascade count and features
+    Shader copyShader;              ///< Direct copy (no AA)
+    Shader ssaoShader;              ///< Screen-space ambient occlusion
+    Shader ssaoBlurShader;          ///< SSAO blur for noise reduction
+    Shader ssrShader;               ///< Screen-space reflections
+    Shader reconstructShader;       ///< Upsampling of half-rate SSAO/SSR
+    Shader ssrResolveShader;        ///< Reflections blended over the lit scene
+    Shader taaShader;               ///< Temporal anti-aliasing
+    Shader fxaaShader;              ///< Fast approximate anti-aliasing
+    Shader occlusionShader;         ///< Depth reduction for occlusion culling
+    Shader prepassShader;           ///< Depth-only pre-pass (shadow vertex shader, empty fragment shader)
+    Shader probeUpdateShader;       ///< Probe cache slice update
+    Shader depthPyramidShader;      ///< Min/max depth pyramid reduction
+
+    // Core rendering systems
+    ShadowMap shadowMap;            ///< Cascaded, cached light shadow mapping
+    RadianceCascades rc;            ///< 6-cascade radiance cascade GI system
+    PostChain postChain;            ///< Ping-pong images from the composite to the anti-aliasing pass
+    FullscreenQuad quad;            ///< Fullscreen quad for post-processing
+    DrawBatcher batcher;            ///< Sorted, instanced submission for geometry passes
+    std::unique_ptr<GpuCuller> gpuCuller;   ///< GPU culling and indirect draws for batcher (null without gpuCullShader)
+    FrameBudgetController budgetController; ///< Dynamic resolution feedback loop
+    OcclusionCuller occlusionCuller;        ///< Occlusion test against a recent depth snapshot
+    OverdrawMonitor overdrawMonitor;        ///< Decides when the depth pre-pass pays off
+    GiUpdateScheduler giScheduler;          ///< Change tracking: which cascades to recompute
+    ProbeCache probeCache;                  ///< World-space far-field irradiance
+    DepthPyramid depthPyramid;              ///< Hierarchical-Z for ray marching and occlusion culling
+    LightClusters lightClusters;            ///< Froxel assignment of the local lights
+    SceneBvh sceneBvh;                      ///< Triangles for world-space GI rays
+    JobSystem* jobs;                        ///< Optional worker pool (setJobSystem())
+    FramePacer framePacer;                  ///< Frames-in-flight limit and ring buffer region
+    FrameArena frameArena;                  ///< This frame's scratch allocations
+    std::vector<LightClusters::Light> localLights; ///< Every light but the primary, gathered per frame
+
+    // Per-frame shared uniforms (camera, light, screen), streamed once per frame
+    UniformBuffer frameUniformBuffer;
+    FrameUniforms frameUniforms;
+
+    // Uniform handles for per-draw and per-element updates, resolved once (resolveShaders())
+    int shadowLightSpaceLocation;
+    int prepassViewProjLocation;
+
+    // Frame-to-frame state
+    int cameraView;                 ///< DrawBatcher view culled for the camera
+    bool depthPyramidValid;         ///< depthPyramid still holds last frame's depth (GPU occlusion culling input)
+    int lastWidth;                  ///< Output resolution
+    int lastHeight;
+    int renderWidth;                ///< Internal resolution (output scaled by the budget controller)
+    int renderHeight;
+    bool firstFrame;
+    glm::mat4 previousView;
+    glm::mat4 previousProjection;
+    glm::mat4 previousViewProj;
+    glm::vec2 previousJitter;       ///< Last frame's projection jitter (NDC)
+    unsigned int jitterIndex;       ///< Position in the Halton sequence
+
+    /**
+     * Check the optional programs, fetch uniform handles and assign sampler units.
+     * Runs once every program is submitted: each check waits for its link, and the
+     * driver meanwhile compiles the rest in parallel.
+     */
+    void resolveShaders();
+};
+
+#endif // RENDERER_H
@@ -0,0 +1,68 @@
+/**
+ * RingBuffer.h - Per-Frame Regions of One Streaming Buffer
+ *
+ * Data the CPU rewrites every frame (frame uniforms, instance transforms)
+ * used to be uploaded by orphaning: glBufferData(nullptr) and a fresh copy.
+ * That makes the driver find new storage every frame, and some drivers
+ * stall doing it. A ring buffer instead keeps MAX_FRAMES_IN_FLIGHT regions
+ * in one buffer and writes each frame into its own region (FramePacer::
+ * getRegion()); the frames-in-flight limit guarantees the GPU is done with
+ * a region before it comes around again, so writes never wait.
+ *
+ * With GLExtensions::hasBufferStorage() the buffer is mapped once,
+ * persistently and coherently, and a write is a memcpy. On GL 3.3 each
+ * write maps its range unsynchronized, which the frame limit makes safe.
+ *
+ * Several writes per frame are placed one after another in the region. A
+ * write that does not fit replaces the buffer with one twice the size;
+ * commands already recorded keep the old buffer alive until they finish.
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <cstddef>
+
+class RingBuffer {
+public:
+    /**
+     * @param target     GL binding target used for mapping (e.g. GL_ARRAY_BUFFER)
+     * @param regionSize Initial bytes per frame region
+     * @param alignment  Offset alignment of every write (e.g. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT)
+     */
+    RingBuffer(unsigned int target, size_t regionSize, size_t alignment = 16);
+    ~RingBuffer();
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    /**
+     * Copy data into a frame region
+     *
+     * The first write with a new region starts at the region's beginning;
+     * further writes with the same region follow the previous ones.
+     *
+     * @return Byte offset of the data in getBuffer()
+     */
+    size_t write(int region, const void* data, size_t size);
+
+    /**
+     * Current buffer object (changes when a write grows the buffer)
+     */
+    unsigned int getBuffer() const { return buffer; }
+
+    bool isPersistent() const { return mapped != nullptr; }
+    size_t getRegionSize() const { return regionSize; }
+
+private:
+    void allocate(size_t newRegionSize);
+
+    unsigned int target;
+    unsigned int buffer;
+    size_t regionSize;
+    size_t alignment;
+    int currentRegion;          ///< Region of the last write
+    size_t cursor;              ///< Next free byte in currentRegion
+    void* mapped;               ///< Persistent mapping of the whole buffer, or nullptr
+};
+
+#endif // RING_BUFFER_H
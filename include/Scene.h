@@ -19,10 +19,12 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 #include "Entity.h"
 #include "Camera.h"
 #include "Mesh.h"
+#include "JobSystem.h"
 
 /**
  * Scene class - Central manager for all world entities and rendering data
@@ -34,7 +36,7 @@
 class Scene {
 public:
     // ECS Management
-    std::vector<std::unique_ptr<Entity>> entities;  ///< All entities in the scene (ECS pattern)
+    Registry registry;                               ///< Entity ids and packed component pools
     
     // Camera System
     Camera camera;                                   ///< Main scene camera for rendering
@@ -45,12 +47,89 @@ public:
     std::unique_ptr<Mesh> bunnyMesh;                ///< Shared bunny model geometry
     std::unique_ptr<Mesh> dragonMesh;               ///< Shared dragon model geometry
     std::unique_ptr<Mesh> floorMesh;                ///< Shared floor plane geometry
+    std::unique_ptr<Mesh> lightMesh;                ///< Shared light marker sphere geometry
 
     /**
      * Constructor - Initializes scene and loads default content
      */
     Scene();
     
+    /**
+     * Constructor - Initializes scene with a named demo scenario
+     * Falls back to the teapot lightbox if the name is unknown.
+     * 
+     * @param sceneName Scene name as accepted by loadByName()
+     */
+    explicit Scene(const std::string& sceneName);
+    
+    /**
+     * Load a demo scenario by name
+     * Accepts the loader name ("loadTeapotLightbox") or its short form ("teapot").
+     * 
+     * @param sceneName Scene to load
+     * @return True if the name matched a scene
+     */
+    bool loadByName(const std::string& sceneName);
+    
+    /**
+     * Short names of all scenes accepted by loadByName()
+     */
+    static std::vector<std::string> getSceneNames();
+    
+    /**
+     * Check whether loadByName() would accept a scene name
+     */
+    static bool isSceneName(const std::string& sceneName);
+    
+    /**
+     * Create an empty entity in this scene's registry
+     */
+    Entity createEntity() { return Entity(&registry, registry.createEntity()); }
+    
+    /**
+     * Number of live entities in the scene
+     */
+    size_t getEntityCount() const { return registry.getEntityCount(); }
+    
+    /**
+     * Find the primary light (first entity with both a LightComponent and a
+     * TransformComponent). Returns an invalid handle if the scene has no light.
+     */
+    Entity getPrimaryLight();
+    
+    /**
+     * Start (on first call) and update every enabled script component
+     * 
+     * @param deltaTime Time elapsed since last update in seconds
+     * @param jobs      Optional; Update() then runs in parallel (see updateBehavioursAsync)
+     */
+    void updateBehaviours(float deltaTime, JobSystem* jobs = nullptr);
+    
+    /**
+     * Start new behaviours on this thread, then queue every Update() on the job system
+     * 
+     * Update() calls run concurrently: a behaviour may only modify its own
+     * entity's existing components and must not add or remove components or
+     * entities (do that in Start()). The registry must not be touched by the
+     * caller until the handle is done.
+     */
+    JobHandle updateBehavioursAsync(JobSystem& jobs, float deltaTime);
+    
+    /**
+     * Compute every TransformComponent's model matrix once for this frame
+     * Call after the last transform change of the frame (behaviours, input).
+     * 
+     * @param jobs Optional; the matrices are then computed in parallel
+     */
+    void updateWorldMatrices(JobSystem* jobs = nullptr);
+    
+    /**
+     * Model matrices from the last updateWorldMatrices(), packed in the same
+     * order as registry.pool<TransformComponent>() (stale after transforms
+     * are added or removed until the next update)
+     */
+    const std::vector<glm::mat4>& getWorldMatrices() const { return worldMatrices; }
+    
     /**
      * Scene Loading Functions
      * These methods set up different demo scenarios with appropriate
@@ -80,6 +159,20 @@ public:
      * Demonstrates PBR material system with detailed textures
      */
     void loadStoneFloorScene();
+    
+    /**
+     * Load the shadow test geometry lit by a dimmed primary light and a
+     * grid of small colored local lights (exercises LightClusters)
+     */
+    void loadManyLightsScene();
+
+private:
+    static const size_t BEHAVIOUR_GRAIN = 64;       ///< Behaviours per job
+    static const size_t TRANSFORM_GRAIN = 256;      ///< Model matrices per job
+
+    std::vector<glm::mat4> worldMatrices;           ///< See getWorldMatrices()
+
+    void startBehaviours();
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,172 @@
+/**
+ * SceneBvh.h - Two-Level Bounding Volume Hierarchy for World-Space GI Rays
+ *
+ * The radiance cascades march rays through the G-buffer, so anything off
+ * screen or hidden behind the visible surface casts no light. The scene BVH
+ * lets those rays continue in world space against the actual triangles
+ * (bvh_trace.glsl, enabled per variant with WORLD_SPACE_RAYS):
+ *
+ * - Bottom level: one tree per Mesh over its object-space triangles, built
+ *   once with a binned surface area heuristic (SAH) the first time the mesh
+ *   is drawn. Large subtrees build in parallel on the JobSystem, and the
+ *   trees of several new meshes build at the same time. Trees are keyed by
+ *   Mesh::getSerial(); those of meshes no longer drawn are dropped the next
+ *   time the geometry buffer is uploaded.
+ * - Top level: one tree over the world boxes of the mesh instances
+ *   (BoundsComponent), each leaf pointing at its mesh's tree through the
+ *   instance's world-to-object matrix. When only transforms changed it is
+ *   refit (bounds recomputed bottom-up, topology kept); when instances were
+ *   added or removed, or refitting has made it REBUILD_COST_RATIO times
+ *   more expensive than it was when built, it is rebuilt with SAH.
+ *
+ * Hits are shaded with the instance's flat albedo and emission (material
+ * base color and emission, or the object color); textures are not sampled.
+ *
+ * GL 3.3 has no storage buffers, so the data lives in two RGBA32F texture
+ * buffers (integers stored as float bits):
+ * - Geometry (GEOMETRY_TEXTURE_UNIT, uploaded when a mesh is added):
+ *   bottom-level nodes, then triangles from getTriangleBase()
+ * - Instances (INSTANCE_TEXTURE_UNIT, uploaded when anything moved):
+ *   top-level nodes, then instance records from getInstanceBase()
+ *
+ * Node (2 texels):     min.xyz, first | max.xyz, count
+ *                      count > 0: leaf of count primitives from first;
+ *                      count = 0: children are nodes first and first + 1
+ * Triangle (3 texels): v0, v1 - v0, v2 - v0 (object space)
+ * Instance (5 texels): rows 0-2 of the world-to-object matrix |
+ *                      albedo.rgb, bottom-level root | emission.rgb, unused
+ */
+
+#ifndef SCENE_BVH_H
+#define SCENE_BVH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Bounds.h"
+
+class Mesh;
+class Registry;
+class Shader;
+class JobSystem;
+
+class SceneBvh {
+public:
+    static const int GEOMETRY_TEXTURE_UNIT = 8;     ///< Unused by the GI programs' G-buffer inputs (1-7)
+    static const int INSTANCE_TEXTURE_UNIT = 9;
+    static const int MAX_DEPTH = 32;                ///< Must match the traversal stack in bvh_trace.glsl
+    static constexpr float REBUILD_COST_RATIO = 1.5f;
+    static const int MAX_LEAF_TRIANGLES = 4;
+    static const uint32_t PARALLEL_PRIMITIVES = 4096;  ///< Smaller subtrees build on the thread that split them
+
+    /**
+     * Tree node, laid out as its two buffer texels
+     */
+    struct Node {
+        glm::vec3 min;
+        uint32_t first;             ///< First primitive (leaf) or left child (inner)
+        glm::vec3 max;
+        uint32_t count;             ///< Primitives in the leaf, 0 for inner nodes
+    };
+
+    SceneBvh();
+    ~SceneBvh();
+    SceneBvh(const SceneBvh&) = delete;
+    SceneBvh& operator=(const SceneBvh&) = delete;
+
+    /**
+     * Bring the hierarchy up to date with this frame's instances and upload
+     * what changed. Call after DrawBatcher::build(), which refreshes the
+     * world bounds (BoundsComponent) the top level is built from.
+     *
+     * @param worldMatrices As for DrawBatcher::build()
+     * @param jobs          Optional; bottom-level builds then run on the workers
+     */
+    void update(Registry& registry, const std::vector<glm::mat4>& worldMatrices, JobSystem* jobs);
+
+    /**
+     * Bind both buffers at their units and set the bvh_trace.glsl uniforms
+     * (shader must be in use; the sampler units are set by the caller)
+     */
+    void bindForSampling(Shader& shader) const;
+
+    int getInstanceCount() const { return static_cast<int>(instances.size()); }
+    size_t getTriangleCount() const { return triangleCount; }
+    bool wasRebuilt() const { return rebuilt; }     ///< Last update() rebuilt the top level (else refit or unchanged)
+    int getTriangleBase() const { return static_cast<int>(geometryNodes.size()) * 2; }  ///< First triangle texel
+    int getInstanceBase() const { return static_cast<int>(topNodes.size()) * 2; }       ///< First instance texel
+
+    /**
+     * Bytes of GPU buffer memory (both buffers)
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * Binned SAH build over primitive bounds; reorders order[] so every leaf
+     * covers a contiguous range of it
+     *
+     * @param boxes    Primitive bounds
+     * @param order    Out: primitive indices in leaf order
+     * @param maxLeaf  Largest leaf the heuristic may keep
+     * @param jobs     Optional; subtrees of more than PARALLEL_PRIMITIVES build in parallel
+     * @return Nodes, root first
+     */
+    static std::vector<Node> build(const std::vector<BoundingBox>& boxes, std::vector<uint32_t>& order,
+                                   int maxLeaf, JobSystem* jobs);
+
+    /**
+     * SAH cost of a tree relative to its root's surface area
+     */
+    static float computeCost(const std::vector<Node>& nodes);
+
+private:
+    /**
+     * Bottom-level tree of one mesh, offsets into the geometry buffer
+     */
+    struct MeshTree {
+        uint32_t root;              ///< Node index of the root
+    };
+
+    /**
+     * Top-level primitive of this frame
+     */
+    struct Instance {
+        const Mesh* mesh;
+        BoundingBox box;            ///< World space
+        glm::mat4 model;
+        glm::vec3 albedo;
+        glm::vec3 emission;
+    };
+
+    unsigned int buffers[2];                ///< Geometry, instances
+    unsigned int textures[2];               ///< Texture buffer views of buffers
+    std::unordered_map<uint64_t, MeshTree> meshTrees;      ///< By Mesh::getSerial()
+    std::unordered_set<uint64_t> rejectedMeshes;           ///< Serials that did not fit the geometry buffer (retried after clearGeometry())
+    std::vector<Node> geometryNodes;        ///< Every mesh's tree, concatenated
+    std::vector<glm::vec4> triangles;       ///< 3 texels per triangle, in leaf order
+    size_t triangleCount;
+    size_t geometryBytes;                   ///< Uploaded size of buffers[0]
+    size_t instanceBytes;
+    int maxTexels;                          ///< GL_MAX_TEXTURE_BUFFER_SIZE; meshes beyond it are not traced
+
+    std::vector<Instance> instances;
+    std::vector<const Mesh*> frameMeshes;   ///< Distinct meshes of this frame's instances
+    std::vector<BoundingBox> instanceBoxes; ///< Build input, kept for reuse
+    std::vector<uint32_t> instanceOrder;    ///< Top-level leaf order
+    std::vector<Node> topNodes;
+    std::vector<glm::vec4> instanceData;    ///< Upload staging for buffers[1]
+    float builtCost;                        ///< computeCost() right after the last top-level build
+    uint64_t instanceHash;                  ///< Meshes of the instances in order (topology)
+    uint64_t contentHash;                   ///< Everything uploaded to buffers[1]
+    bool rebuilt;
+
+    void addMeshes(const std::vector<const Mesh*>& meshes, JobSystem* jobs);
+    void clearGeometry();
+    void refit();
+    void uploadInstances();
+};
+
+#endif // SCENE_BVH_H
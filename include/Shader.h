@@ -7,15 +7,29 @@
  * 
  * Features:
  * - Automatic vertex and fragment shader compilation
+ * - Compute programs where the context supports them (see GLExtensions.h)
  * - Shader program linking with error checking
  * - Type-safe uniform setting methods
- * - Convenient uniform access by name
+ * - Convenient uniform access by name, or by precomputed location handle
+ * - Uniform locations reflected once at link time (no per-call driver lookups;
+ *   names are looked up as string views, so literals never allocate)
+ * - Automatic binding of shared uniform blocks (see UniformBuffer.h)
+ * - #include "file" support in shader sources (paths relative to the shader)
+ * - Linked program binaries cached on disk (see ProgramCache.h)
+ * - Compile-time permutations: #defines injected after the #version line
+ *   (ShaderDefines; see ShaderVariants.h for a cache of variants)
+ * - Deferred link checks: constructors only submit the compile and link,
+ *   and errors and uniforms are resolved on first use, so the driver can
+ *   compile every program of the renderer at once on its own threads
+ *   (GL_KHR_parallel_shader_compile where available)
  * - Proper error handling and reporting
  * 
  * Usage:
  * - Create shader with vertex and fragment shader files
  * - Use shader.use() to bind for rendering
  * - Set uniforms with type-specific methods
+ * - In per-draw loops, fetch a handle once with getUniformLocation() and
+ *   pass it to the setters instead of the name
  * - Shader automatically manages OpenGL state
  * 
  * Supported uniform types:
@@ -27,9 +41,54 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <cstdint>
+#include <map>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <glm/glm.hpp>
 
+/**
+ * Preprocessor switches for one permutation of a shader
+ * 
+ * Feature toggles that are constant for a frame (cascade count, optional
+ * passes) belong here rather than in uniforms: the compiler then removes
+ * the disabled paths and the samplers they read.
+ */
+class ShaderDefines {
+public:
+    static const int MAX_DEFINES = 8;
+
+    /**
+     * Add or change a define
+     *
+     * @param name Not copied: must outlive the defines (a string literal)
+     */
+    ShaderDefines& set(const char* name, int value);
+
+    /**
+     * One "#define NAME value" line per define, ordered by name, so equal
+     * sets give equal sources (and hit the same ProgramCache entry)
+     */
+    std::string getSource() const;
+
+    bool empty() const { return count == 0; }
+
+    /**
+     * Order of equal-or-not sets (ShaderVariants key); compares without allocating
+     */
+    bool operator<(const ShaderDefines& other) const;
+
+private:
+    struct Define {
+        const char* name;
+        int value;
+    };
+
+    Define values[MAX_DEFINES];     ///< Sorted by name
+    int count = 0;
+};
+
 /**
  * Shader class - OpenGL shader program wrapper
  * 
@@ -50,8 +109,39 @@ public:
      * 
      * @param vertexPath   Path to vertex shader source file (.vert)
      * @param fragmentPath Path to fragment shader source file (.frag)
+     * @param defines      Injected into both stages
      */
-    Shader(const char* vertexPath, const char* fragmentPath);
+    Shader(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines = ShaderDefines());
+
+    /**
+     * Constructor - Compile and link a compute program from a source file
+     * 
+     * Only call this when GLExtensions::hasComputeShaders() is true, and
+     * check isValid() before dispatching.
+     * 
+     * @param computePath Path to compute shader source file (.comp)
+     * @param defines     Injected into the source
+     */
+    explicit Shader(const char* computePath, const ShaderDefines& defines = ShaderDefines());
+
+    /**
+     * Whether every stage compiled and the program linked
+     * (waits for the driver if the program is still compiling)
+     */
+    bool isValid() const;
+    
+    /**
+     * Whether the program finished compiling and linking, without waiting
+     * 
+     * Only drivers with parallel compile can answer that; elsewhere this is
+     * always true and the first use waits instead.
+     */
+    bool isReady() const;
+    
+    /**
+     * Whether the program was loaded from the binary cache instead of compiled
+     */
+    bool isFromCache() const { return fromCache; }
 
     /**
      * Activate this shader program for rendering
@@ -59,9 +149,19 @@ public:
      */
     void use();
     
+    /**
+     * Location of an active uniform, from the table built at link time
+     * 
+     * Array elements can be looked up as "name[i]". Returns -1 for names the
+     * linker removed or never saw; setting location -1 is a silent no-op.
+     * 
+     * @param name Uniform variable name in shader
+     */
+    int getUniformLocation(std::string_view name) const;
+    
     // Uniform Setting Methods
-    // These methods provide type-safe uniform setting with automatic
-    // uniform location lookup by name
+    // These methods provide type-safe uniform setting with uniform location
+    // lookup by name (cached) or by a handle from getUniformLocation()
     
     /**
      * Set boolean uniform variable
@@ -69,7 +169,7 @@ public:
      * @param name  Uniform variable name in shader
      * @param value Boolean value to set
      */
-    void setBool(const std::string &name, bool value) const;
+    void setBool(std::string_view name, bool value) const;
     
     /**
      * Set integer uniform variable
@@ -77,7 +177,7 @@ public:
      * @param name  Uniform variable name in shader
      * @param value Integer value to set
      */
-    void setInt(const std::string &name, int value) const;
+    void setInt(std::string_view name, int value) const;
     
     /**
      * Set float uniform variable
@@ -85,7 +185,7 @@ public:
      * @param name  Uniform variable name in shader
      * @param value Float value to set
      */
-    void setFloat(const std::string &name, float value) const;
+    void setFloat(std::string_view name, float value) const;
     
     /**
      * Set 2D vector uniform variable
@@ -93,7 +193,7 @@ public:
      * @param name  Uniform variable name in shader
      * @param value 2D vector value (vec2 in GLSL)
      */
-    void setVec2(const std::string &name, const glm::vec2 &value) const;
+    void setVec2(std::string_view name, const glm::vec2 &value) const;
     
     /**
      * Set 3D vector uniform variable
@@ -101,7 +201,7 @@ public:
      * @param name  Uniform variable name in shader
      * @param value 3D vector value (vec3 in GLSL)
      */
-    void setVec3(const std::string &name, const glm::vec3 &value) const;
+    void setVec3(std::string_view name, const glm::vec3 &value) const;
     
     /**
      * Set 4x4 matrix uniform variable
@@ -109,9 +209,84 @@ public:
      * @param name Uniform variable name in shader
      * @param mat  4x4 matrix value (mat4 in GLSL)
      */
-    void setMat4(const std::string &name, const glm::mat4 &mat) const;
+    void setMat4(std::string_view name, const glm::mat4 &mat) const;
+    
+    // Handle-based overloads for hot paths (no string construction or hashing)
+    void setBool(int location, bool value) const;
+    void setInt(int location, int value) const;
+    void setFloat(int location, float value) const;
+    void setVec2(int location, const glm::vec2 &value) const;
+    void setVec3(int location, const glm::vec3 &value) const;
+    void setMat4(int location, const glm::mat4 &mat) const;
+    
+    /**
+     * Set a whole vec3 array uniform in one call
+     * 
+     * @param location Location of element 0 (getUniformLocation("name"))
+     * @param values   First element
+     * @param count    Number of elements
+     */
+    void setVec3Array(int location, const glm::vec3* values, int count) const;
+
+    /**
+     * Set a whole vec4 array uniform in one call (as setVec3Array)
+     */
+    void setVec4Array(int location, const glm::vec4* values, int count) const;
 
 private:
+    struct PendingStage {
+        unsigned int shader;
+        const char* type;       ///< "VERTEX", "FRAGMENT" or "COMPUTE" for error messages
+    };
+    
+    // Filled in by resolve() on first use, hence mutable
+    mutable std::map<std::string, int, std::less<>> uniformLocations;  ///< Active uniform name -> location (transparent lookup)
+    mutable bool valid = true;                              ///< Cleared by any compile or link error
+    mutable bool pending = false;                           ///< Submitted, not yet checked and reflected
+    mutable std::vector<PendingStage> pendingStages;        ///< Compiled from source, deleted by resolve()
+    bool fromCache = false;
+    uint64_t cacheKey = 0;
+    
+    /**
+     * Create the program from the binary cache, or compile and link the
+     * stages without waiting for the result
+     * 
+     * @param types   GL shader stage per source
+     * @param names   Stage name per source, for error messages
+     * @param sources Expanded stage sources
+     */
+    void submit(const std::vector<unsigned int>& types, const std::vector<const char*>& names,
+                const std::vector<std::string>& sources);
+    
+    /**
+     * Finish a submitted program: check errors, save the binary, reflect uniforms
+     */
+    void resolve() const;
+
+    /**
+     * Read a shader source file and expand its #include directives
+     * 
+     * @param path  Shader source path
+     * @param depth Current include depth (guards against include cycles)
+     */
+    static std::string loadSource(const std::string& path, int depth = 0);
+    
+    /**
+     * Insert defines after the #version and #extension lines of a stage
+     * source (those must come first), renumbering the lines that follow
+     */
+    static void injectDefines(std::string& source, const ShaderDefines& defines);
+    
+    /**
+     * Build the uniform location table of the linked program
+     */
+    void reflectUniforms() const;
+    
+    /**
+     * Attach every uniform block with a known binding point (see UniformBuffer.h)
+     */
+    void bindUniformBlocks() const;
+
     /**
      * Check shader compilation and program linking errors
      * 
@@ -119,9 +294,9 @@ private:
      * error information to help debug shader issues.
      * 
      * @param shader Shader object ID to check
-     * @param type   Type of check ("PROGRAM", "VERTEX", "FRAGMENT")
+     * @param type   Type of check ("PROGRAM", "VERTEX", "FRAGMENT", "COMPUTE")
      */
-    void checkCompileErrors(unsigned int shader, std::string type);
+    void checkCompileErrors(unsigned int shader, std::string type) const;
 };
 
 #endif // SHADER_H 
\ No newline at end of file
@@ -0,0 +1,61 @@
+/**
+ * ShaderVariants.h - Lazily Compiled Permutations of One Shader
+ *
+ * Some shaders have switches that stay fixed for many frames (the cascade
+ * count of the quality level, the probe far field, hierarchical tracing).
+ * Compiling each combination as its own program with the switches as
+ * #defines (ShaderDefines) lets the compiler drop the disabled paths, the
+ * loops over inactive cascades and the samplers nothing reads any more,
+ * instead of branching on uniforms in every pixel.
+ *
+ * A variant is compiled the first time get() asks for it and then kept, so
+ * switching quality back and forth costs nothing after the first time (and
+ * the first time is usually a ProgramCache hit). Sampler units and other
+ * constant uniforms are assigned by the setup callback, which runs once per
+ * variant with the new program in use.
+ */
+
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include "Shader.h"
+#include <functional>
+#include <map>
+#include <memory>
+
+class ShaderVariants {
+public:
+    typedef std::function<void(Shader&)> Setup;
+
+    /**
+     * Variants of a vertex + fragment program
+     */
+    ShaderVariants(const char* vertexPath, const char* fragmentPath, Setup setup = Setup());
+
+    /**
+     * Variants of a compute program (only where GLExtensions::hasComputeShaders())
+     */
+    explicit ShaderVariants(const char* computePath, Setup setup = Setup());
+
+    ~ShaderVariants();
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    /**
+     * The variant compiled with these defines, created on first use
+     *
+     * Creating a variant runs the setup callback, which leaves that variant
+     * in use; call use() on the result before setting uniforms either way.
+     */
+    Shader& get(const ShaderDefines& defines);
+
+    int getVariantCount() const { return static_cast<int>(variants.size()); }
+
+private:
+    const char* vertexPath;     ///< Null for compute variants
+    const char* fragmentPath;   ///< Or the compute path
+    Setup setup;
+    std::map<ShaderDefines, std::unique_ptr<Shader>> variants;     ///< Looked up every frame, so keyed without building strings
+};
+
+#endif // SHADER_VARIANTS_H
@@ -1,26 +1,116 @@
-// ShadowMap.h
+/**
+ * ShadowMap.h - Cascaded, Cached Shadow Maps
+ *
+ * The camera frustum (up to MAX_SHADOW_DISTANCE) is split into cascades with
+ * the practical split scheme (a blend of logarithmic and uniform splits).
+ * Each cascade gets its own orthographic light frustum, fitted to a bounding
+ * sphere of its slice and snapped to whole shadow texels, and is rendered
+ * into one layer of a depth texture array. Resolution and cascade count
+ * follow the quality level instead of one fixed giant texture.
+ *
+ * Caching: a cascade is only re-rendered when its matrix changed (camera or
+ * light moved) or static geometry changed (see DrawBatcher::getStaticHash).
+ * When dynamic casters exist, static casters are cached in a second array
+ * and copied into the sampled array before the dynamic casters are drawn on
+ * top, so static geometry is never re-rendered just because something moved.
+ * Casters are culled against each rendered cascade's light frustum.
+ */
+
 #ifndef SHADOWMAP_H
 #define SHADOWMAP_H
 
+#include <cstdint>
 #include <glm/glm.hpp>
 
+class DrawBatcher;
+class Shader;
+
 class ShadowMap {
 public:
-    static const unsigned int SHADOW_WIDTH = 16384;  // Ultra-high quality shadows
-    static const unsigned int SHADOW_HEIGHT = 16384; // Ultra-high quality shadows
-    
-    unsigned int depthMapFBO;
-    unsigned int depthMap;
-    
+    static const int MAX_CASCADES = 4;                  ///< Must match the FrameUniforms block
+    static constexpr float MAX_SHADOW_DISTANCE = 50.0f; ///< View distance covered by the cascades
+
+    unsigned int depthMapFBO;       ///< Framebuffer used to render one cascade layer
+    unsigned int depthMap;          ///< Depth texture array (one layer per cascade), sampled by the composite
+
     ShadowMap();
     ~ShadowMap();
-    
-    void bindForWriting();
+    ShadowMap(const ShadowMap&) = delete;
+    ShadowMap& operator=(const ShadowMap&) = delete;
+
+    /**
+     * Shadow map size and cascade count for a quality level
+     */
+    static unsigned int getResolutionForQuality(int qualityLevel);
+    static int getCascadeCountForQuality(int qualityLevel);
+
+    /**
+     * Set resolution and cascade count; reallocates (and drops the cache) only on change
+     */
+    void configure(unsigned int resolution, int cascadeCount);
+
+    /**
+     * Fit the cascade frusta to the camera for this frame
+     *
+     * @param lightPos    Light position (the light looks at the scene center)
+     * @param cameraView  Camera view matrix
+     * @param fovY        Camera vertical field of view in radians
+     * @param aspect      Camera aspect ratio
+     * @param nearPlane   Camera near plane
+     * @param farPlane    Camera far plane (clamped to MAX_SHADOW_DISTANCE)
+     */
+    void updateCascades(const glm::vec3& lightPos, const glm::mat4& cameraView,
+                        float fovY, float aspect, float nearPlane, float farPlane);
+
+    /**
+     * Render the cascades that are out of date
+     *
+     * @param batcher            Batched scene geometry for this frame
+     * @param depthShader        Depth-only shader (must be bound)
+     * @param lightSpaceLocation Location of its lightSpaceMatrix uniform
+     * @param lodErrorTexels     Largest simplification error of a caster, in shadow map texels (0 = full detail)
+     */
+    void render(DrawBatcher& batcher, const Shader& depthShader, int lightSpaceLocation, float lodErrorTexels = 0.0f);
+
+    /**
+     * Force every cascade to be re-rendered next frame
+     */
+    void invalidate();
+
     void bindForReading(unsigned int textureUnit);
+
+    /**
+     * Light matrix covering the whole scene; the cascades share its light view and depth range
+     */
     glm::mat4 getLightSpaceMatrix(const glm::vec3& lightPos, float lightRadius = 2.0f);
-    
+
+    const glm::mat4& getCascadeMatrix(int cascade) const { return cascadeMatrices[cascade]; }
+    float getCascadeSplit(int cascade) const { return cascadeSplits[cascade]; }   ///< Far view distance of a cascade
+    int getCascadeCount() const { return cascadeCount; }
+    unsigned int getResolution() const { return resolution; }
+    int getCascadesRendered() const { return cascadesRendered; }                   ///< Re-rendered last frame
+
 private:
+    unsigned int resolution;
+    int cascadeCount;
+
+    unsigned int staticDepthMap;    ///< Static casters only (allocated once dynamic casters appear)
+    unsigned int staticFBO;
+
+    glm::mat4 cascadeMatrices[MAX_CASCADES];
+    float cascadeSplits[MAX_CASCADES];
+
+    // Cache state
+    glm::mat4 cachedMatrices[MAX_CASCADES];
+    bool cacheValid[MAX_CASCADES];
+    bool cacheHasDynamic;           ///< Cache lives in staticDepthMap (true) or depthMap (false)
+    uint64_t cachedStaticHash;
+    int cascadesRendered;
+
     void setupShadowMap();
+    void releaseTextures();
+    unsigned int createDepthArray() const;
+    void attachLayer(unsigned int target, unsigned int fbo, unsigned int texture, int layer) const;
 };
 
-#endif // SHADOWMAP_H 
\ No newline at end of file
+#endif // SHADOWMAP_H
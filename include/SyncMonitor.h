@@ -0,0 +1,87 @@
+/**
+ * SyncMonitor.h - Debug Detection of Implicit CPU-GPU Synchronisation
+ *
+ * Some GL calls quietly wait for the GPU: reading a query result that is not
+ * ready, mapping or respecifying a buffer the GPU still reads, reading back
+ * pixels. Each one serialises the CPU and GPU, and none of them shows up as
+ * an error. With the monitor enabled (--debug-sync), such calls are timed
+ * with a Scope and any that blocks longer than STALL_THRESHOLD_MS is
+ * reported on stderr with its name. Where the driver offers debug output
+ * (GLExtensions::hasDebugOutput()), its performance warnings, e.g. about a
+ * buffer upload that had to wait, are reported the same way.
+ *
+ * Waiting for the frames-in-flight limit (FramePacer) is pacing rather
+ * than a stall and is counted separately.
+ *
+ * Disabled, a Scope costs one branch. All calls come from the GL thread.
+ */
+
+#ifndef SYNC_MONITOR_H
+#define SYNC_MONITOR_H
+
+#include <chrono>
+#include <string>
+
+class SyncMonitor {
+public:
+    static constexpr float STALL_THRESHOLD_MS = 0.5f;
+
+    /**
+     * Times one potentially blocking GL call (or a few) while the monitor is enabled
+     */
+    class Scope {
+    public:
+        explicit Scope(const char* name);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        bool timing;
+        std::chrono::high_resolution_clock::time_point start;
+    };
+
+    /**
+     * Start or stop reporting (also routes the driver's performance messages
+     * where debug output exists; needs a current context)
+     */
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return enabled; }
+
+    /**
+     * Report a stall measured elsewhere
+     */
+    static void reportStall(const char* name, float milliseconds);
+
+    /**
+     * Time the CPU spent waiting on the frames-in-flight limit
+     */
+    static void reportPacingWait(float milliseconds);
+
+    /**
+     * Close the frame's counters (Renderer calls this once per frame)
+     */
+    static void endFrame();
+
+    // Last finished frame
+    static int getStallCount() { return lastStallCount; }
+    static float getStallTime() { return lastStallTime; }
+    static float getPacingWaitTime() { return lastPacingWait; }
+    static int getDriverWarningCount() { return driverWarnings; }     ///< Since enabled
+
+private:
+    static void driverMessage(const char* message);
+
+    static bool enabled;
+    static int stallCount;
+    static float stallTime;
+    static float pacingWait;
+    static int lastStallCount;
+    static float lastStallTime;
+    static float lastPacingWait;
+    static int driverWarnings;
+    static long long frame;
+};
+
+#endif // SYNC_MONITOR_H
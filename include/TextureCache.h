@@ -0,0 +1,48 @@
+/**
+ * TextureCache.h - Compressed, Pre-Mipped Texture Cache (KTX 1.1)
+ *
+ * The first time a texture is streamed, its decoded pixels are turned into a
+ * complete block-compressed mip chain (see TextureCompressor.h) and written
+ * to cache/textures/ as a standard KTX 1.1 file. Later runs map the KTX file
+ * and hand the levels straight to glCompressedTexImage2D: no JPEG/PNG decode,
+ * no CPU or GPU mip generation.
+ *
+ * File layout (little endian, see the Khronos KTX 1.1 specification):
+ *     identifier «KTX 11» + 13 uint32 header fields (64 bytes)
+ *     key/value data: "KTXorientation" = "S=r,T=u" (rows bottom to top)
+ *                     "vibegi.source"  = "<source size> <source mtime> <VERSION>"
+ *     per mip level: uint32 imageSize, imageSize bytes, padding to 4
+ *
+ * The files open in regular KTX viewers. An entry is only used if the
+ * vibegi.source stamp matches the current source file and cache VERSION.
+ */
+
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include "TextureCompressor.h"
+
+class TextureCache {
+public:
+    static const uint32_t VERSION = 1;
+
+    /**
+     * Load the cached mip chain of a source image in the requested encoding
+     * @return False if there is no valid, up-to-date cache entry
+     */
+    static bool load(const std::string& sourcePath, TextureEncoding encoding, TextureImage& image);
+
+    /**
+     * Write the cache entry for a source image (written atomically via rename)
+     */
+    static bool save(const std::string& sourcePath, const TextureImage& image);
+
+    /**
+     * Cache file used for a source image and encoding
+     */
+    static std::string getCachePath(const std::string& sourcePath, TextureEncoding encoding);
+};
+
+#endif // TEXTURE_CACHE_H
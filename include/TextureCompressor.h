@@ -0,0 +1,75 @@
+/**
+ * TextureCompressor.h - CPU Mip Generation and Block Compression
+ *
+ * Produces complete, GPU-ready mip chains offline (or on first run) so the
+ * renderer never calls glGenerateMipmap or uploads uncompressed textures:
+ *
+ * - BC1 (DXT1, via EXT_texture_compression_s3tc): RGB color, 4 bpp
+ * - BC4 (RGTC1, core GL 3.0): single channel (roughness, AO, height), 4 bpp
+ * - BC5 (RGTC2, core GL 3.0): two channels (tangent-space normal XY), 8 bpp
+ * - RGBA8: uncompressed fallback when S3TC is unavailable
+ *
+ * The encoders are simple bounding-box/range fits per 4x4 block (in the
+ * spirit of van Waveren's real-time DXT encoder): fast enough to run on the
+ * loader threads, with quality close to offline tools for PBR maps.
+ */
+
+#ifndef TEXTURE_COMPRESSOR_H
+#define TEXTURE_COMPRESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class TextureEncoding {
+    RGBA8,
+    BC1,
+    BC4,
+    BC5
+};
+
+struct TextureMipLevel {
+    int width;
+    int height;
+    size_t offset;      ///< Byte offset into TextureImage::data
+    size_t size;        ///< Byte size of the level
+};
+
+/**
+ * CPU-side texture with a full mip chain, ready for glCompressedTexImage2D
+ * (or glTexImage2D for RGBA8)
+ */
+struct TextureImage {
+    TextureEncoding encoding = TextureEncoding::RGBA8;
+    int width = 0;
+    int height = 0;
+    std::vector<TextureMipLevel> levels;
+    std::vector<unsigned char> data;
+};
+
+class TextureCompressor {
+public:
+    /**
+     * Build a mip chain from RGBA8 pixels and encode every level
+     *
+     * @param rgba      Top level pixels, 4 bytes per pixel, rows bottom to top
+     * @param width     Top level width
+     * @param height    Top level height
+     * @param encoding  Output encoding (BC4 uses R, BC5 uses RG)
+     */
+    static TextureImage build(const unsigned char* rgba, int width, int height, TextureEncoding encoding);
+
+    /**
+     * OpenGL internal format enum for an encoding
+     */
+    static unsigned int getInternalFormat(TextureEncoding encoding);
+
+    /**
+     * Byte size of one mip level in the given encoding
+     */
+    static size_t getLevelSize(TextureEncoding encoding, int width, int height);
+
+    static bool isCompressed(TextureEncoding encoding) { return encoding != TextureEncoding::RGBA8; }
+};
+
+#endif // TEXTURE_COMPRESSOR_H
@@ -0,0 +1,115 @@
+/**
+ * TextureStreamer.h - Asynchronous Texture Loading and Upload
+ *
+ * Texture::loadAsync() creates the GL texture with a 1x1 placeholder and
+ * queues the file here, so scene creation never blocks on image decoding:
+ *
+ * 1. Loader threads read the compressed KTX cache entry (TextureCache.h) or,
+ *    on a cache miss, decode the source with stb_image, build and encode the
+ *    mip chain (TextureCompressor.h) and write the cache entry.
+ * 2. processUploads() runs on the GL thread once per frame and uploads a
+ *    bounded number of bytes per call through two alternating pixel unpack
+ *    buffers (PBOs), so the driver can copy one while the next is filled.
+ *
+ * Destroying a Texture cancels its pending request; results for cancelled
+ * textures are dropped instead of uploaded.
+ */
+
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "TextureCompressor.h"
+
+class Texture;
+enum class TextureUsage;
+
+class TextureStreamer {
+public:
+    static const size_t DEFAULT_UPLOAD_BUDGET = 16 * 1024 * 1024;  ///< Bytes uploaded per processUploads() call
+
+    static TextureStreamer& instance();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    /**
+     * Queue a texture for loading (GL thread). The texture must already own a
+     * GL texture name; it is filled in by a later processUploads() call.
+     */
+    void request(Texture* texture, const std::string& path, TextureUsage usage);
+
+    /**
+     * Forget any pending request for a texture (called by ~Texture)
+     */
+    void cancel(Texture* texture);
+
+    /**
+     * Upload finished textures (GL thread). At least one texture is uploaded
+     * per call even if it is larger than the budget.
+     */
+    void processUploads(size_t budgetBytes = DEFAULT_UPLOAD_BUDGET);
+
+    /**
+     * Block until every queued texture is uploaded (loading screens, benchmarks)
+     */
+    void finishAll();
+
+    /**
+     * Requests that are queued, loading or waiting for upload
+     */
+    size_t getPendingCount() const;
+
+private:
+    struct Job {
+        uint64_t ticket;
+        Texture* texture;
+        std::string path;
+        TextureEncoding encoding;
+    };
+
+    struct Result {
+        uint64_t ticket;
+        Texture* texture;
+        std::string path;
+        bool success;
+        bool fromCache;
+        float loadTimeMs;
+        TextureImage image;
+    };
+
+    TextureStreamer() = default;
+    ~TextureStreamer();
+
+    void startWorkers();
+    void workerLoop();
+    void loadImage(const Job& job, Result& result);
+    bool upload(Texture* texture, const TextureImage& image);
+    TextureEncoding chooseEncoding(TextureUsage usage);
+
+    mutable std::mutex mutex;
+    std::condition_variable jobAvailable;       ///< Signalled when a job is queued or on shutdown
+    std::condition_variable resultAvailable;    ///< Signalled when a worker finishes a job
+    std::deque<Job> jobs;
+    std::deque<Result> results;
+    std::unordered_map<Texture*, uint64_t> tickets; ///< Live request per texture (absent = cancelled)
+    std::vector<std::thread> workers;
+    uint64_t nextTicket = 1;
+    size_t pending = 0;
+    bool stopping = false;
+
+    // GL thread only
+    unsigned int uploadBuffers[2] = {0, 0};     ///< Alternating pixel unpack buffers
+    int nextUploadBuffer = 0;
+    int s3tcSupported = -1;                     ///< -1 until queried
+};
+
+#endif // TEXTURE_STREAMER_H
@@ -21,7 +21,6 @@
 #ifndef TRANSFORMCOMPONENT_H
 #define TRANSFORMCOMPONENT_H
 
-#include "Entity.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -32,7 +31,7 @@
  * Provides automatic model matrix generation for rendering and physics.
  * Essential component for any entity that needs spatial representation.
  */
-class TransformComponent : public Component {
+class TransformComponent {
 public:
     // Spatial Properties
     glm::vec3 position;         ///< World position (x, y, z) in world units
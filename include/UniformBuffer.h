@@ -0,0 +1,108 @@
+/**
+ * UniformBuffer.h - Uniform Buffer Objects (UBOs) for Shared Shader Data
+ *
+ * Data that is identical for every pass of a frame (camera matrices, light
+ * parameters, screen size) lives in one std140 uniform block instead of being
+ * re-sent to each program with glUniform* calls. The block is declared once in
+ * shaders/frame_uniforms.glsl (pulled in with #include, see Shader.h) and
+ * uploaded once per frame; every program that declares it reads the same
+ * buffer through a fixed binding point.
+ *
+ * GLSL 3.30 cannot set a block's binding in the shader, so Shader binds every
+ * block it recognises (see getBlockBinding) right after linking.
+ *
+ * Blocks rewritten every frame use stream() instead of update(): each frame
+ * writes its own region of a RingBuffer and binds that range, so the upload
+ * neither orphans storage nor waits for frames still in flight.
+ */
+
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include "RingBuffer.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <glm/glm.hpp>
+
+/**
+ * Binding points of the known uniform blocks
+ */
+enum UniformBlockBinding : unsigned int {
+    FRAME_UNIFORMS_BINDING = 0,
+    SSAO_KERNEL_BINDING = 1         ///< SSAOKernel block (ssao.frag), owned by RadianceCascades
+};
+
+/**
+ * CPU mirror of the FrameUniforms block in shaders/frame_uniforms.glsl
+ * Member order and types follow std140 rules (vec3 + float share 16 bytes).
+ */
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 invView;
+    glm::mat4 invProjection;
+    glm::mat4 previousView;
+    glm::mat4 previousProjection;
+    glm::mat4 currentViewProj;
+    glm::mat4 previousViewProj;
+    glm::mat4 cascadeMatrices[4];   ///< Light space matrix per shadow cascade (ShadowMap::MAX_CASCADES)
+    glm::vec3 viewPos;
+    float nearPlane;
+    glm::vec3 lightPos;
+    float lightRadius;
+    glm::vec3 lightColor;
+    float farPlane;
+    glm::vec4 screenSize;           ///< width, height, 1/width, 1/height
+    glm::vec4 cascadeSplits;        ///< Far view distance of each shadow cascade
+    glm::vec4 shadowParams;         ///< x = cascade count, y = shadow distance
+    glm::vec4 jitter;               ///< Projection offset in NDC: xy = this frame, zw = last frame
+};
+static_assert(sizeof(FrameUniforms) == 12 * 64 + 7 * 16, "FrameUniforms must match the std140 block layout");
+
+class UniformBuffer {
+public:
+    /**
+     * Allocate a buffer of the given size and attach it to a binding point
+     */
+    UniformBuffer(size_t size, unsigned int binding);
+    ~UniformBuffer();
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    /**
+     * Replace the buffer contents (the previous storage is orphaned so the
+     * upload never waits for draws still reading last frame's data)
+     */
+    void update(const void* data, size_t size);
+
+    /**
+     * Write this frame's contents into its ring region and bind that range
+     * (the ring is created on first use; see RingBuffer.h)
+     *
+     * @param region FramePacer::getRegion() of the current frame
+     */
+    void stream(const void* data, size_t size, int region);
+
+    /**
+     * Re-attach the buffer (or the last streamed range) to its binding point
+     */
+    void bind() const;
+
+    unsigned int getID() const { return ubo; }
+
+    /**
+     * Binding point for a uniform block name, or -1 if the block is unknown
+     */
+    static int getBlockBinding(const std::string& blockName);
+
+private:
+    unsigned int ubo;
+    unsigned int bindingPoint;
+    size_t capacity;
+    std::unique_ptr<RingBuffer> ring;   ///< stream() storage
+    size_t streamedOffset;              ///< Range of the last stream() in ring
+    size_t streamedSize;
+};
+
+#endif // UNIFORM_BUFFER_H
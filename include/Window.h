@@ -7,7 +7,8 @@
 
 class Window {
 public:
-    Window(int width, int height, const char* title);
+    // visible=false creates a hidden window (offscreen rendering, benchmarks)
+    Window(int width, int height, const char* title, bool visible = true);
     ~Window();
 
     bool shouldClose();
@@ -6,12 +6,9 @@
 #include "../include/TransformComponent.h"
 
 Behaviour::Behaviour() 
-    : parentEntity(nullptr), started(false), enabled(true) {
+    : started(false), enabled(true) {
 }
 
 TransformComponent* Behaviour::getTransform() const {
-    if (parentEntity) {
-        return parentEntity->getComponent<TransformComponent>();
-    }
-    return nullptr;
+    return parentEntity.getComponent<TransformComponent>();
 } 
\ No newline at end of file
@@ -13,7 +13,6 @@
 
 // Forward declarations
 class TransformComponent;
-class Entity;
 
 /**
  * Behaviour - Base class for all script components
@@ -22,7 +21,7 @@ class Entity;
  * and common functionality. All custom script components should inherit
  * from this class to get standardized behavior management.
  */
-class Behaviour : public Component {
+class Behaviour {
 public:
     /**
      * Constructor
@@ -41,7 +40,9 @@ public:
     virtual void Start() {}
 
     /**
-     * Called every frame
+     * Called every frame, possibly on a job system worker in parallel with
+     * other behaviours: only modify this entity's existing components, never
+     * add/remove components or call OpenGL (see Scene::updateBehavioursAsync)
      * @param deltaTime Time elapsed since last frame in seconds
      */
     virtual void Update(float deltaTime) {}
@@ -60,9 +61,9 @@ public:
 
     /**
      * Get the entity this behaviour is attached to
-     * @return Pointer to the parent entity
+     * @return Handle to the parent entity (invalid if not attached)
      */
-    Entity* getEntity() const { return parentEntity; }
+    Entity getEntity() const { return parentEntity; }
 
     /**
      * Get a component from the parent entity
@@ -70,10 +71,7 @@ public:
      */
     template<typename T>
     T* getComponent() const {
-        if (parentEntity) {
-            return parentEntity->getComponent<T>();
-        }
-        return nullptr;
+        return parentEntity.getComponent<T>();
     }
 
     /**
@@ -86,7 +84,7 @@ public:
      * Set the parent entity (called by the entity system)
      * @param entity The entity this behaviour belongs to
      */
-    void setEntity(Entity* entity) { parentEntity = entity; }
+    void setEntity(const Entity& entity) { parentEntity = entity; }
 
     /**
      * Check if this behaviour has been started
@@ -112,7 +110,7 @@ public:
     bool isEnabled() const { return enabled; }
 
 protected:
-    Entity* parentEntity = nullptr;     ///< The entity this behaviour is attached to
+    Entity parentEntity;                ///< The entity this behaviour is attached to
     bool started = false;               ///< Whether Start() has been called
     bool enabled = true;                ///< Whether this behaviour is active
 
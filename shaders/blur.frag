@@ -3,13 +3,14 @@ out vec4 FragColor;
 in vec2 TexCoords;
 
 uniform sampler2D inputTexture;
-uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform int blurDirection; // 0 = horizontal, 1 = vertical
+#include "frame_uniforms.glsl"
+#include "view_position.glsl"
 
 void main() {
     vec4 centerSample = texture(inputTexture, TexCoords);
-    vec3 centerPos = texture(gPosition, TexCoords).xyz;
+    vec3 centerPos = reconstructViewPosition(TexCoords);
     // Reconstruct center normal from RG16F format
     vec2 centerNormalXY = texture(gNormal, TexCoords).rg;
     float centerNormalZ = sqrt(max(0.0, 1.0 - dot(centerNormalXY, centerNormalXY)));
@@ -73,7 +74,7 @@ void main() {
             sampleCoord.y < 0.0 || sampleCoord.y > 1.0) continue;
         
         vec4 sampleData = texture(inputTexture, sampleCoord);
-        vec3 samplePos = texture(gPosition, sampleCoord).xyz;
+        vec3 samplePos = reconstructViewPosition(sampleCoord);
                     // Reconstruct sample normal from RG16F format
             vec2 sampleNormalXY = texture(gNormal, sampleCoord).rg;
             float sampleNormalZ = sqrt(max(0.0, 1.0 - dot(sampleNormalXY, sampleNormalXY)));
@@ -0,0 +1,144 @@
+// bvh_trace.glsl - World-space rays against the two-level scene BVH (SceneBvh.h)
+// Everything is RGBA32F texels, integers as float bits:
+//   bvhGeometry:  bottom-level nodes (2 texels), triangles from bvhTriangleBase (3 texels)
+//   bvhInstances: top-level nodes (2 texels), instance records from bvhInstanceBase (5 texels)
+// Node: min.xyz, first | max.xyz, count (count 0: children are first and first + 1)
+uniform samplerBuffer bvhGeometry;
+uniform samplerBuffer bvhInstances;
+uniform int bvhTriangleBase;
+uniform int bvhInstanceBase;
+uniform int bvhInstanceCount;   // 0: nothing to trace
+const int BVH_STACK_SIZE = 32;  // SceneBvh::MAX_DEPTH
+const int BVH_MAX_VISITS = 384; // Node visits per ray over both levels; the ray gives up (misses) beyond
+
+struct BvhHit {
+    float t;
+    vec3 normal;                // World space, facing the ray origin
+    vec3 albedo;
+    vec3 emission;
+};
+
+// Entry distance of the ray into a box, or a negative value when it misses within [tMin, tMax]
+float bvhIntersectBox(vec4 boxMin, vec4 boxMax, vec3 origin, vec3 invDir, float tMin, float tMax) {
+    vec3 t0 = (boxMin.xyz - origin) * invDir;
+    vec3 t1 = (boxMax.xyz - origin) * invDir;
+    vec3 tNear = min(t0, t1);
+    vec3 tFar = max(t0, t1);
+    float enter = max(max(tNear.x, tNear.y), max(tNear.z, tMin));
+    float exit = min(min(tFar.x, tFar.y), min(tFar.z, tMax));
+    return enter <= exit ? enter : -1.0;
+}
+
+vec3 bvhInverse(vec3 dir) {
+    // Avoid infinities for axis-aligned rays (0 * inf would poison the slabs)
+    vec3 safe = mix(dir, vec3(1e-8), lessThan(abs(dir), vec3(1e-8)));
+    return 1.0 / safe;
+}
+
+// Closest hit along origin + t * dir, tMin < t < tMax (dir need not be normalized)
+bool traceSceneBvh(vec3 origin, vec3 dir, float tMin, float tMax, out BvhHit hit) {
+    hit.t = tMax;
+    hit.normal = vec3(0.0);
+    hit.albedo = vec3(0.0);
+    hit.emission = vec3(0.0);
+    if (bvhInstanceCount == 0) {
+        return false;
+    }
+
+    bool found = false;
+    int visits = 0;
+    vec3 invDir = bvhInverse(dir);
+    int stack[BVH_STACK_SIZE];
+    int stackSize = 1;
+    stack[0] = 0;
+    while (stackSize > 0 && visits < BVH_MAX_VISITS) {
+        int node = stack[--stackSize];
+        ++visits;
+        vec4 a = texelFetch(bvhInstances, node * 2);
+        vec4 b = texelFetch(bvhInstances, node * 2 + 1);
+        if (bvhIntersectBox(a, b, origin, invDir, tMin, hit.t) < 0.0) {
+            continue;
+        }
+        int first = floatBitsToInt(a.w);
+        int count = floatBitsToInt(b.w);
+        if (count == 0) {
+            if (stackSize + 2 <= BVH_STACK_SIZE) {
+                stack[stackSize++] = first + 1;
+                stack[stackSize++] = first;
+            }
+            continue;
+        }
+
+        for (int i = first; i < first + count; ++i) {
+            // Into object space: t is unchanged by the affine transform
+            int record = bvhInstanceBase + i * 5;
+            vec4 row0 = texelFetch(bvhInstances, record);
+            vec4 row1 = texelFetch(bvhInstances, record + 1);
+            vec4 row2 = texelFetch(bvhInstances, record + 2);
+            vec4 material = texelFetch(bvhInstances, record + 3);
+            vec3 localOrigin = vec3(dot(row0, vec4(origin, 1.0)), dot(row1, vec4(origin, 1.0)), dot(row2, vec4(origin, 1.0)));
+            vec3 localDir = vec3(dot(row0.xyz, dir), dot(row1.xyz, dir), dot(row2.xyz, dir));
+            vec3 localInvDir = bvhInverse(localDir);
+
+            int localStack[BVH_STACK_SIZE];
+            int localSize = 1;
+            localStack[0] = floatBitsToInt(material.w);
+            while (localSize > 0 && visits < BVH_MAX_VISITS) {
+                int localNode = localStack[--localSize];
+                ++visits;
+                vec4 la = texelFetch(bvhGeometry, localNode * 2);
+                vec4 lb = texelFetch(bvhGeometry, localNode * 2 + 1);
+                if (bvhIntersectBox(la, lb, localOrigin, localInvDir, tMin, hit.t) < 0.0) {
+                    continue;
+                }
+                int localFirst = floatBitsToInt(la.w);
+                int localCount = floatBitsToInt(lb.w);
+                if (localCount == 0) {
+                    if (localSize + 2 <= BVH_STACK_SIZE) {
+                        localStack[localSize++] = localFirst + 1;
+                        localStack[localSize++] = localFirst;
+                    }
+                    continue;
+                }
+                for (int t = localFirst; t < localFirst + localCount; ++t) {
+                    // Moller-Trumbore, both faces
+                    int texel = bvhTriangleBase + t * 3;
+                    vec3 v0 = texelFetch(bvhGeometry, texel).xyz;
+                    vec3 e1 = texelFetch(bvhGeometry, texel + 1).xyz;
+                    vec3 e2 = texelFetch(bvhGeometry, texel + 2).xyz;
+                    vec3 p = cross(localDir, e2);
+                    float det = dot(e1, p);
+                    if (abs(det) < 1e-10) {
+                        continue;
+                    }
+                    float invDet = 1.0 / det;
+                    vec3 s = localOrigin - v0;
+                    float u = dot(s, p) * invDet;
+                    if (u < 0.0 || u > 1.0) {
+                        continue;
+                    }
+                    vec3 q = cross(s, e1);
+                    float v = dot(localDir, q) * invDet;
+                    if (v < 0.0 || u + v > 1.0) {
+                        continue;
+                    }
+                    float hitT = dot(e2, q) * invDet;
+                    if (hitT > tMin && hitT < hit.t) {
+                        // Normals go to world space with the transpose of the world-to-object matrix
+                        vec3 localNormal = cross(e1, e2);
+                        hit.normal = localNormal.x * row0.xyz + localNormal.y * row1.xyz + localNormal.z * row2.xyz;
+                        hit.t = hitT;
+                        hit.albedo = material.rgb;
+                        hit.emission = texelFetch(bvhInstances, record + 4).rgb;
+                        found = true;
+                    }
+                }
+            }
+        }
+    }
+    if (found) {
+        hit.normal = normalize(hit.normal);
+        hit.normal = dot(hit.normal, dir) > 0.0 ? -hit.normal : hit.normal;
+    }
+    return found;
+}
@@ -0,0 +1,9 @@
+// Interleaved execution of reduced-rate passes (RadianceCascades::POST_CHECKERBOARD):
+// each frame only one checkerboard half of the target is traced, the other half
+// keeps what an earlier frame wrote there.
+uniform int checkerParity; // Texels with (x + y) & 1 == parity are traced; -1 = all
+
+bool skipCheckerPixel() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    return checkerParity >= 0 && ((pixel.x + pixel.y) & 1) != checkerParity;
+}
@@ -0,0 +1,53 @@
+// clustered_lights.glsl - Local point lights culled into a froxel grid (LightClusters.h)
+// Include after frame_uniforms.glsl. One R32UI texture buffer holds, in order:
+//   per cluster: first index, light count
+//   per light:   position.xyz, radius, color.rgb, pad (float bits)
+//   the light indices of every cluster
+uniform usamplerBuffer lightClusters;
+uniform int localLightCount;    // Lights assigned to any cluster (0: skip the lookup)
+
+// Must match LightClusters.h
+const int LIGHT_TILES_X = 16;
+const int LIGHT_TILES_Y = 9;
+const int LIGHT_SLICES = 24;
+const int LIGHT_CLUSTER_COUNT = LIGHT_TILES_X * LIGHT_TILES_Y * LIGHT_SLICES;
+
+// Same soft falloff as the primary light, zero beyond 3x the radius (the culling range)
+float localLightAttenuation(float distance, float radius) {
+    float normalizedDist = distance / radius;
+    float falloff = 1.0 / (1.0 + normalizedDist * normalizedDist * 0.25);
+    float maxRange = radius * 3.0;
+    return falloff * (1.0 - smoothstep(maxRange * 0.7, maxRange, distance));
+}
+
+// Diffuse light (before albedo) the local lights of this pixel's cluster cast on a surface
+//   uv:        screen position (picks the tile)
+//   viewDepth: positive linear depth (picks the slice)
+vec3 sampleLocalLights(vec2 uv, float viewDepth, vec3 worldPos, vec3 worldNormal) {
+    if (localLightCount == 0) {
+        return vec3(0.0);
+    }
+    ivec2 tile = clamp(ivec2(uv * vec2(LIGHT_TILES_X, LIGHT_TILES_Y)), ivec2(0), ivec2(LIGHT_TILES_X - 1, LIGHT_TILES_Y - 1));
+    float sliceScale = float(LIGHT_SLICES) / log(farPlane / nearPlane);
+    int slice = clamp(int(log(max(viewDepth, nearPlane) / nearPlane) * sliceScale), 0, LIGHT_SLICES - 1);
+    int cluster = (slice * LIGHT_TILES_Y + tile.y) * LIGHT_TILES_X + tile.x;
+    int first = int(texelFetch(lightClusters, cluster * 2).r);
+    int count = int(texelFetch(lightClusters, cluster * 2 + 1).r);
+
+    vec3 light = vec3(0.0);
+    for (int i = 0; i < count; ++i) {
+        int record = LIGHT_CLUSTER_COUNT * 2 + int(texelFetch(lightClusters, first + i).r) * 8;
+        vec4 positionRadius = uintBitsToFloat(uvec4(texelFetch(lightClusters, record).r,
+                                                    texelFetch(lightClusters, record + 1).r,
+                                                    texelFetch(lightClusters, record + 2).r,
+                                                    texelFetch(lightClusters, record + 3).r));
+        vec3 color = uintBitsToFloat(uvec3(texelFetch(lightClusters, record + 4).r,
+                                           texelFetch(lightClusters, record + 5).r,
+                                           texelFetch(lightClusters, record + 6).r));
+        vec3 toLight = positionRadius.xyz - worldPos;
+        float distance = length(toLight);
+        float nDotL = max(dot(worldNormal, toLight / max(distance, 1e-4)), 0.0);
+        light += color * nDotL * localLightAttenuation(distance, positionRadius.w);
+    }
+    return light;
+}
@@ -6,5 +6,5 @@ in vec2 TexCoords;
 uniform sampler2D inputTexture;
 
 void main() {
-    FragColor = texture(inputTexture, TexCoords);
+    FragColor = vec4(texture(inputTexture, TexCoords).rgb, 1.0); // TAA keeps depth in alpha
 } 
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 330 core
+// Depth pre-pass: no outputs and no gl_FragDepth write, so early-Z stays on
+
+void main()
+{
+}
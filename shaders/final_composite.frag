@@ -3,35 +3,61 @@ out vec4 FragColor;
 
 in vec2 TexCoords;
 
-uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedo;
 uniform sampler2D gEmission; // New: emission texture for emissive materials
-uniform sampler2D shadowMap;
-uniform sampler2D rcTexture[6]; // Support up to 6 cascades
+uniform sampler2DArray shadowMap; // One layer per cascade
 uniform sampler2D ssaoTexture; // New: SSAO texture
-uniform int activeCascades; // Number of active cascades for current quality level
 
-// Lighting uniforms
-uniform vec3 lightPos;
-uniform vec3 lightColor;
-uniform vec3 viewPos;
-uniform mat4 lightSpaceMatrix;
-uniform mat4 view;
-uniform float lightRadius; // New: light size parameter
+// Permutation switches, injected by the Renderer (ShaderDefines)
+#ifndef CASCADE_COUNT
+#define CASCADE_COUNT 6 // Active cascades of the quality level (0 = GI off)
+#endif
+#ifndef USE_SSAO
+#define USE_SSAO 1
+#endif
+#ifndef PROBE_FAR_FIELD
+#define PROBE_FAR_FIELD 0 // World-space probe cache fills in where the cascades found no light
+#endif
+
+#if CASCADE_COUNT > 0
+uniform sampler2D rcTexture[CASCADE_COUNT];
+#endif
+
+// Lighting uniforms (camera, light and shadow matrix)
+#include "frame_uniforms.glsl"
+#include "view_position.glsl"
+#include "probe_common.glsl"
+#include "clustered_lights.glsl"
 
 // SSGI parameters
 uniform float ssgiStrength;
 uniform float ambientStrength;
 uniform float ssaoStrength; // New: SSAO strength
 
+// Cascade covering a view-space position (cascadeCount when beyond the shadow distance)
+int selectCascade(float viewDepth)
+{
+    int cascadeCount = int(shadowParams.x);
+    for (int i = 0; i < cascadeCount; ++i) {
+        if (viewDepth < cascadeSplits[i])
+            return i;
+    }
+    return cascadeCount;
+}
+
 // Enhanced shadow calculation with distance-based softness and Poisson disk sampling
-float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir, float lightDistance)
+float ShadowCalculation(vec3 viewPosition, vec3 normal, vec3 lightDir, float lightDistance)
 {
+    float viewDepth = -viewPosition.z;
+    int cascade = selectCascade(viewDepth);
+    if (cascade >= int(shadowParams.x))
+        return 0.0;
+
+    vec4 fragPosLightSpace = cascadeMatrices[cascade] * invView * vec4(viewPosition, 1.0);
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     projCoords = projCoords * 0.5 + 0.5;
     
-    float closestDepth = texture(shadowMap, projCoords.xy).r; 
     float currentDepth = projCoords.z;
     
     // Improved bias calculation - more stable across different angles
@@ -61,14 +87,14 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir, floa
     );
     
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
     
     // Use more samples for higher quality
     int numSamples = 32;
     for(int i = 0; i < numSamples; ++i)
     {
         vec2 sampleCoord = projCoords.xy + poissonDisk[i] * texelSize * shadowSoftness;
-        float pcfDepth = texture(shadowMap, sampleCoord).r;
+        float pcfDepth = texture(shadowMap, vec3(sampleCoord, float(cascade))).r;
         shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
     }
     shadow /= float(numSamples);
@@ -77,9 +103,10 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir, floa
     if(projCoords.z > 1.0)
         shadow = 0.0;
     
-    // Smooth transition at shadow map edges
+    // Smooth transition at shadow map edges and towards the end of the shadow distance
     vec2 fadeDistance = smoothstep(0.0, 0.05, projCoords.xy) * (1.0 - smoothstep(0.95, 1.0, projCoords.xy));
     shadow *= fadeDistance.x * fadeDistance.y;
+    shadow *= 1.0 - smoothstep(shadowParams.y * 0.9, shadowParams.y, viewDepth);
         
     return shadow;
 }
@@ -101,7 +128,7 @@ float calculateSoftAttenuation(float distance, float radius) {
 
 void main()
 {
-    vec3 position = texture(gPosition, TexCoords).xyz;
+    vec3 position = reconstructViewPosition(TexCoords);
     // Reconstruct normal from RG16F format
     vec2 normalXY = texture(gNormal, TexCoords).rg;
     float normalZ = sqrt(max(0.0, 1.0 - dot(normalXY, normalXY)));
@@ -117,9 +144,6 @@ void main()
     vec3 fragPos = position; // Already in view space
     vec3 worldNormal = normalize(normal); // Already in view space
     
-    // Transform to world space for shadow calculation
-    vec4 fragPosLightSpace = lightSpaceMatrix * inverse(view) * vec4(fragPos, 1.0);
-    
     // Light direction in view space
     vec3 lightDir = normalize((view * vec4(lightPos, 1.0)).xyz - fragPos);
     float lightDistance = length((view * vec4(lightPos, 1.0)).xyz - fragPos);
@@ -127,7 +151,7 @@ void main()
     // Use new soft attenuation based on light radius
     float attenuation = calculateSoftAttenuation(lightDistance, lightRadius);
     
-    float shadow = ShadowCalculation(fragPosLightSpace, worldNormal, lightDir, lightDistance);
+    float shadow = ShadowCalculation(fragPos, worldNormal, lightDir, lightDistance);
     
     // Calculate raw lighting components (WITHOUT albedo yet)
     float nDotL = max(dot(worldNormal, lightDir), 0.0);
@@ -136,6 +160,10 @@ void main()
     // Direct diffuse lighting (will be modulated by albedo)
     vec3 directDiffuse = nDotL * lightRadiance * (1.0 - shadow);
     
+    // Unshadowed local lights, only those whose range reaches this pixel's cluster
+    vec3 surfaceWorldPos = (invView * vec4(fragPos, 1.0)).xyz;
+    directDiffuse += sampleLocalLights(TexCoords, -fragPos.z, surfaceWorldPos, mat3(invView) * worldNormal);
+    
     // Specular lighting (NOT modulated by albedo - it's a surface reflection)
     vec3 viewDir = normalize(-fragPos);
     vec3 reflectDir = reflect(-lightDir, worldNormal);
@@ -146,17 +174,18 @@ void main()
     vec3 indirectDiffuse = vec3(0.0);
     float totalWeight = 0.0;
     
+#if CASCADE_COUNT > 0
     // First, collect all cascade contributions with quality-aware smooth sampling
     vec3 cascadeContributions[6];
     float cascadeWeights[6];
     
-    for (int i = 0; i < activeCascades; ++i) {
+    for (int i = 0; i < CASCADE_COUNT; ++i) {
         // Quality-aware sampling with better upsampling for Ultra mode
         vec3 smoothGi = vec3(0.0);
         float smoothBeta = 0.0;
         
         // Enhanced sampling with less aggressive smoothing for better detail preservation
-        if (activeCascades >= 6 && i >= 2) { // Only apply to cascade 2+ to preserve detail
+        if (CASCADE_COUNT >= 6 && i >= 2) { // Only apply to cascade 2+ to preserve detail
             vec2 texelSize = 1.0 / textureSize(rcTexture[i], 0);
             
             // 3x3 detail-preserving upsampling kernel 
@@ -208,13 +237,13 @@ void main()
     }
     
     // Now blend cascades smoothly with quality-aware weighting
-    for (int i = 0; i < activeCascades; ++i) {
+    for (int i = 0; i < CASCADE_COUNT; ++i) {
         vec3 cascadeGi = cascadeContributions[i];
         float cascadeBeta = cascadeWeights[i];
         
         // Quality-aware cascade weighting
         float spatialWeight;
-        if (activeCascades >= 6) {
+        if (CASCADE_COUNT >= 6) {
             // Ultra mode: More sophisticated cascade weighting
             spatialWeight = pow(0.75, float(i)); // Gentler falloff for more cascades
         } else {
@@ -225,7 +254,7 @@ void main()
         float betaWeight = cascadeBeta;
         
         // Minimal inter-cascade blending to preserve detail
-        if (activeCascades >= 6 && i > 2 && i < (activeCascades - 1)) {
+        if (CASCADE_COUNT >= 6 && i > 2 && i < (CASCADE_COUNT - 1)) {
             // Ultra mode: only blend higher cascades to preserve fine detail
             vec3 prevCascade = cascadeContributions[i-1];
             vec3 nextCascade = cascadeContributions[i+1];
@@ -234,7 +263,7 @@ void main()
             cascadeGi = mix(cascadeGi, (prevCascade + nextCascade) * 0.5, blendFactor);
         }
         // Standard mode: only blend highest cascades to preserve detail
-        else if (i > 3 && i < (activeCascades - 1)) {
+        else if (i > 3 && i < (CASCADE_COUNT - 1)) {
             vec3 prevCascade = cascadeContributions[i-1];
             vec3 nextCascade = cascadeContributions[i+1];
             
@@ -251,6 +280,19 @@ void main()
         indirectDiffuse /= totalWeight;
     }
     
+#endif
+    
+    // The coarsest cascade already merges the probes; taking the larger of the two
+    // (instead of adding) only lifts pixels whose rays all left the screen
+#if PROBE_FAR_FIELD
+    {
+        vec3 worldPos = (invView * vec4(fragPos, 1.0)).xyz;
+        vec3 probeIrradiance = sampleProbeIrradiance(worldPos, mat3(invView) * worldNormal);
+        indirectDiffuse = max(indirectDiffuse, probeIrradiance * 0.5); // Cosine-weighted like a cascade ray
+    }
+#endif
+    
+#if CASCADE_COUNT > 0
     // Universal spatial interpolation to "join up" sparse GI hits for smooth lighting
     vec3 originalGI = indirectDiffuse;
     
@@ -262,8 +304,8 @@ void main()
         vec3 interpolatedGI = vec3(0.0);
         float interpolationWeight = 0.0;
         
-        vec2 texelSize = 1.0 / textureSize(gPosition, 0);
-        vec3 centerPosition = texture(gPosition, TexCoords).xyz;
+        vec2 texelSize = 1.0 / textureSize(gLinearDepth, 0);
+        vec3 centerPosition = reconstructViewPosition(TexCoords);
         vec2 centerNormalXY = texture(gNormal, TexCoords).rg;
         float centerNormalZ = sqrt(max(0.0, 1.0 - dot(centerNormalXY, centerNormalXY)));
         vec3 centerNormal = normalize(vec3(centerNormalXY, centerNormalZ));
@@ -282,7 +324,7 @@ void main()
             if (sampleCoord.x >= 0.0 && sampleCoord.x <= 1.0 && sampleCoord.y >= 0.0 && sampleCoord.y <= 1.0) {
                 // Sample neighbor GI from cascade 0 (highest quality)
                 vec3 neighborGI = texture(rcTexture[0], sampleCoord).rgb;
-                vec3 neighborPosition = texture(gPosition, sampleCoord).xyz;
+                vec3 neighborPosition = reconstructViewPosition(sampleCoord);
                 vec2 neighborNormalXY = texture(gNormal, sampleCoord).rg;
                 float neighborNormalZ = sqrt(max(0.0, 1.0 - dot(neighborNormalXY, neighborNormalXY)));
                 vec3 neighborNormal = normalize(vec3(neighborNormalXY, neighborNormalZ));
@@ -315,16 +357,22 @@ void main()
         }
     }
     
+#endif
+    
     // Quality-aware indirect lighting scaling
     float qualityMultiplier = 0.4; // Base multiplier
-    if (activeCascades >= 6) {
+    if (CASCADE_COUNT >= 6) {
         // Ultra mode: Moderate reduction now that ambient/exposure are fixed
         qualityMultiplier = 0.22; // Moderate reduction for Ultra mode
     }
     indirectDiffuse *= ssgiStrength * qualityMultiplier;
     
     // Sample SSAO
+#if USE_SSAO
     float ambientOcclusion = texture(ssaoTexture, TexCoords).r;
+#else
+    float ambientOcclusion = 1.0;
+#endif
     
     // Energy conservation: direct + indirect should not exceed incoming light
     vec3 totalDiffuse = directDiffuse + indirectDiffuse;
@@ -0,0 +1,23 @@
+// Per-frame data shared by every pass, uploaded once per frame by the Renderer.
+// Must match struct FrameUniforms in include/UniformBuffer.h (std140).
+layout (std140) uniform FrameUniforms {
+    mat4 view;
+    mat4 projection;
+    mat4 invView;
+    mat4 invProjection;
+    mat4 previousView;
+    mat4 previousProjection;
+    mat4 currentViewProj;
+    mat4 previousViewProj;
+    mat4 cascadeMatrices[4];   // Light space matrix per shadow cascade
+    vec3 viewPos;       // Camera position (world space)
+    float nearPlane;
+    vec3 lightPos;      // Primary light position (world space)
+    float lightRadius;
+    vec3 lightColor;    // Color * intensity, zero when the light is disabled
+    float farPlane;
+    vec4 screenSize;    // width, height, 1/width, 1/height
+    vec4 cascadeSplits; // Far view distance of each shadow cascade
+    vec4 shadowParams;  // x = cascade count, y = shadow distance
+    vec4 jitter;        // Projection offset in NDC: xy = this frame, zw = last frame
+};
@@ -1,9 +1,14 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
+// Full format: float attributes as listed (aPos.w defaults to 1)
+// Packed format: aPos.w = bitangent sign, aNormal.xy/aTangent.xy octahedral, no aBitangent
+layout (location = 0) in vec4 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 layout (location = 3) in vec3 aTangent;
 layout (location = 4) in vec3 aBitangent;
+// Per-instance data from DrawBatcher
+layout (location = 5) in mat4 instanceModel; // Locations 5-8
+layout (location = 9) in vec4 instanceColor; // a = MaterialTable index
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -12,39 +17,66 @@ out vec3 ViewNormal;
 out vec2 TexCoords;
 out vec3 ViewTangent;
 out vec3 ViewBitangent;
-out vec2 Velocity; // Motion vector (simplified, no jittering)
+out vec2 Velocity; // Screen-space motion since last frame, projection jitter removed
+flat out vec3 ObjectColor;
+flat out int MaterialIndex;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat4 previousView;
-uniform mat4 previousProjection;
+uniform bool packedVertices; // Set by Mesh::Draw
+#include "frame_uniforms.glsl"
+
+// The depth pre-pass (shadow_depth.vert with currentViewProj) must produce the
+// exact same depth for GL_EQUAL, so both use the same invariant expression
+invariant gl_Position;
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    vec3 normal = aNormal;
+    vec3 tangent = aTangent;
+    vec3 bitangent = aBitangent;
+    if (packedVertices) {
+        normal = octDecode(aNormal.xy);
+        tangent = octDecode(aTangent.xy);
+        bitangent = cross(normal, tangent) * aPos.w;
+    }
+
+    mat4 model = instanceModel;
+    ObjectColor = instanceColor.rgb;
+    MaterialIndex = int(instanceColor.a);
+
+    vec4 worldPos = model * vec4(aPos.xyz, 1.0);
+    FragPos = vec3(worldPos);
+    Normal = mat3(transpose(inverse(model))) * normal;
     
     // Compute view-space positions
     vec4 viewPos = view * vec4(FragPos, 1.0);
     ViewPos = viewPos.xyz;
-    ViewNormal = mat3(transpose(inverse(view * model))) * aNormal;
+    ViewNormal = mat3(transpose(inverse(view * model))) * normal;
     
     // Pass texture coordinates and compute view-space tangent vectors
     TexCoords = aTexCoords;
-    ViewTangent = mat3(transpose(inverse(view * model))) * aTangent;
-    ViewBitangent = mat3(transpose(inverse(view * model))) * aBitangent;
+    ViewTangent = mat3(transpose(inverse(view * model))) * tangent;
+    ViewBitangent = mat3(transpose(inverse(view * model))) * bitangent;
     
     // Simplified motion vectors for effects that might still need them
     vec4 currentClip = projection * viewPos;
     vec4 previousViewPos = previousView * vec4(FragPos, 1.0);
     vec4 previousClip = previousProjection * previousViewPos;
     
-    vec2 currentScreen = (currentClip.xy / currentClip.w) * 0.5 + 0.5;
-    vec2 previousScreen = (previousClip.xy / previousClip.w) * 0.5 + 0.5;
+    // Both frames' projections carry their own TAA jitter; motion must not
+    vec2 currentScreen = (currentClip.xy / currentClip.w - jitter.xy) * 0.5 + 0.5;
+    vec2 previousScreen = (previousClip.xy / previousClip.w - jitter.zw) * 0.5 + 0.5;
     
     // Simple, clean motion vector
     Velocity = currentScreen - previousScreen;
     
-    gl_Position = currentClip;
+    gl_Position = currentViewProj * worldPos;
 } 
\ No newline at end of file
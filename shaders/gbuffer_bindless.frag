@@ -0,0 +1,5 @@
+#version 400 core
+#extension GL_ARB_bindless_texture : require
+// Material maps reached through the handles in the MaterialTable records
+#define BINDLESS_MATERIALS
+#include "gbuffer_surface.glsl"
@@ -0,0 +1,219 @@
+// gbuffer_surface.glsl - G-buffer surface evaluation shared by gbuffer.frag and gbuffer_bindless.frag
+// The including stage declares #version, and BINDLESS_MATERIALS when the maps come from handles.
+// Location 0 is unused: view positions are rebuilt from gLinearDepth
+layout (location = 1) out vec2 gNormal;
+layout (location = 2) out vec4 gAlbedo;
+layout (location = 3) out float gLinearDepth;
+layout (location = 4) out vec2 gVelocity; // New: motion vector output
+layout (location = 5) out vec3 gEmission; // New: emission output
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec3 ViewPos;
+in vec3 ViewNormal;
+in vec2 TexCoords;
+in vec3 ViewTangent;
+in vec3 ViewBitangent;
+in vec2 Velocity; // From vertex shader
+flat in vec3 ObjectColor; // Per-instance base color
+flat in int MaterialIndex; // Per-instance MaterialTable record
+
+// Material records, see MaterialTable.h (floats stored as bits)
+uniform usamplerBuffer materialTable;
+const int MATERIAL_RECORD_TEXELS = 8;
+
+// Map slots, in Material::setSamplerUnits() order; slot i has flag bit i + 1
+const int MAP_ALBEDO = 0;
+const int MAP_NORMAL = 1;
+const int MAP_ROUGHNESS = 2;
+const int MAP_METALLIC = 3;
+const int MAP_AO = 4;
+const int MAP_HEIGHT = 5;
+const int MAP_EMISSION = 6;
+const uint HAS_MATERIAL = 1u;
+
+struct MaterialRecord {
+    vec3 baseColor;
+    float roughness;
+    vec3 emission;
+    float metallic;
+    vec2 tiling;
+    float heightScale;
+    float ambientOcclusion;
+    uint flags;
+#ifdef BINDLESS_MATERIALS
+    uvec2 handles[7];
+#endif
+};
+
+MaterialRecord material;
+
+MaterialRecord fetchMaterial(int index) {
+    int base = index * MATERIAL_RECORD_TEXELS;
+    uvec4 t0 = texelFetch(materialTable, base);
+    uvec4 t1 = texelFetch(materialTable, base + 1);
+    uvec4 t2 = texelFetch(materialTable, base + 2);
+    MaterialRecord record;
+    record.baseColor = uintBitsToFloat(t0.xyz);
+    record.roughness = uintBitsToFloat(t0.w);
+    record.emission = uintBitsToFloat(t1.xyz);
+    record.metallic = uintBitsToFloat(t1.w);
+    record.tiling = uintBitsToFloat(t2.xy);
+    record.heightScale = uintBitsToFloat(t2.z);
+    record.ambientOcclusion = uintBitsToFloat(t2.w);
+    record.flags = texelFetch(materialTable, base + 3).x;
+#ifdef BINDLESS_MATERIALS
+    // Two handles per texel, seven in total
+    for (int i = 0; i < 7; ++i) {
+        uvec4 handlePair = texelFetch(materialTable, base + 4 + i / 2);
+        record.handles[i] = (i % 2 == 0) ? handlePair.xy : handlePair.zw;
+    }
+#endif
+    return record;
+}
+
+bool hasMaterial() {
+    return (material.flags & HAS_MATERIAL) != 0u;
+}
+
+bool hasMap(int slot) {
+    return (material.flags & (2u << uint(slot))) != 0u;
+}
+
+// Material batches never mix texture sets, so a handle is uniform within a draw
+#ifdef BINDLESS_MATERIALS
+#define MATERIAL_MAP(slot, boundSampler) sampler2D(material.handles[slot])
+#else
+uniform sampler2D albedoMap;
+uniform sampler2D normalMap;
+uniform sampler2D roughnessMap;
+uniform sampler2D metallicMap;
+uniform sampler2D aoMap;
+uniform sampler2D heightMap;
+uniform sampler2D emissionMap;
+#define MATERIAL_MAP(slot, boundSampler) boundSampler
+#endif
+
+vec3 getNormalFromMap(vec2 texCoords) {
+    // Normal maps are stored as two-channel BC5, z is reconstructed from xy
+    vec2 tangentXY = texture(MATERIAL_MAP(MAP_NORMAL, normalMap), texCoords).xy * 2.0 - 1.0;
+    vec3 tangentNormal = vec3(tangentXY, sqrt(max(0.0, 1.0 - dot(tangentXY, tangentXY))));
+    
+    vec3 N = normalize(ViewNormal);
+    vec3 T = normalize(ViewTangent);
+    vec3 B = normalize(ViewBitangent);
+    mat3 TBN = mat3(T, B, N);
+    
+    return normalize(TBN * tangentNormal);
+}
+
+vec2 parallaxOcclusionMapping(vec2 texCoords, vec3 viewDir) {
+    if (!hasMap(MAP_HEIGHT)) {
+        return texCoords; // No height map, return original coordinates
+    }
+    
+    // Number of layers for parallax occlusion mapping
+    const float minLayers = 8.0;
+    const float maxLayers = 32.0;
+    float numLayers = mix(maxLayers, minLayers, abs(dot(vec3(0.0, 0.0, 1.0), viewDir)));
+    
+    // Calculate the size of each layer
+    float layerDepth = 1.0 / numLayers;
+    float currentLayerDepth = 0.0;
+    
+    // The amount to shift the texture coordinates per layer (from vector P)
+    vec2 P = viewDir.xy / viewDir.z * material.heightScale;
+    vec2 deltaTexCoords = P / numLayers;
+    
+    // Get initial values
+    vec2 currentTexCoords = texCoords;
+    float currentDepthMapValue = texture(MATERIAL_MAP(MAP_HEIGHT, heightMap), currentTexCoords).r;
+    
+    while(currentLayerDepth < currentDepthMapValue) {
+        // Shift texture coordinates along direction of P
+        currentTexCoords -= deltaTexCoords;
+        // Get depthmap value at current texture coordinates
+        currentDepthMapValue = texture(MATERIAL_MAP(MAP_HEIGHT, heightMap), currentTexCoords).r;
+        // Get depth of next layer
+        currentLayerDepth += layerDepth;
+    }
+    
+    // Get texture coordinates before collision (reverse operations)
+    vec2 prevTexCoords = currentTexCoords + deltaTexCoords;
+    
+    // Get depth after and before collision for linear interpolation
+    float afterDepth = currentDepthMapValue - currentLayerDepth;
+    float beforeDepth = texture(MATERIAL_MAP(MAP_HEIGHT, heightMap), prevTexCoords).r - currentLayerDepth + layerDepth;
+    
+    // Interpolation of texture coordinates
+    float weight = afterDepth / (afterDepth - beforeDepth);
+    vec2 finalTexCoords = prevTexCoords * weight + currentTexCoords * (1.0 - weight);
+    
+    return finalTexCoords;
+}
+
+void main()
+{    
+    material = fetchMaterial(MaterialIndex);
+    
+    // Apply texture coordinate tiling (MaterialTable leaves index 0 zeroed)
+    vec2 tiledTexCoords = TexCoords * (hasMaterial() ? material.tiling : vec2(1.0));
+    
+    // Calculate view direction for parallax mapping
+    vec3 viewDir = vec3(0.0, 0.0, 1.0); // Default tangent space view direction
+    if (hasMaterial() && hasMap(MAP_HEIGHT)) {
+        // Convert view direction to tangent space for parallax mapping
+        vec3 viewDirWorld = normalize(-ViewPos); // View direction in view space
+        vec3 N = normalize(ViewNormal);
+        vec3 T = normalize(ViewTangent);
+        vec3 B = normalize(ViewBitangent);
+        mat3 TBN = mat3(T, B, N);
+        viewDir = normalize(transpose(TBN) * viewDirWorld);
+    }
+    
+    // Apply parallax occlusion mapping
+    vec2 finalTexCoords = parallaxOcclusionMapping(tiledTexCoords, viewDir);
+    
+    // Calculate normal (either from normal map or vertex normal)
+    vec3 normal;
+    if (hasMaterial() && hasMap(MAP_NORMAL)) {
+        normal = getNormalFromMap(finalTexCoords);
+    } else {
+        normal = normalize(ViewNormal);
+    }
+    gNormal = normal.xy; // Store only X,Y - Z can be reconstructed
+    
+    // Calculate albedo (either from texture or material/object color)
+    vec3 albedo;
+    if (hasMaterial() && hasMap(MAP_ALBEDO)) {
+        albedo = texture(MATERIAL_MAP(MAP_ALBEDO, albedoMap), finalTexCoords).rgb * material.baseColor;
+    } else if (hasMaterial()) {
+        albedo = material.baseColor;
+    } else {
+        albedo = ObjectColor;
+    }
+    gAlbedo.rgb = albedo;
+    
+    // Store material properties in alpha channel (we'll need to expand this later)
+    // For now, we'll use a simple encoding: roughness in alpha
+    float roughness = hasMaterial() ? material.roughness : 0.5;
+    if (hasMaterial() && hasMap(MAP_ROUGHNESS)) {
+        roughness *= texture(MATERIAL_MAP(MAP_ROUGHNESS, roughnessMap), finalTexCoords).r;
+    }
+    gAlbedo.a = roughness;
+    
+    gLinearDepth = -ViewPos.z;
+    
+    // Store velocity for TAA
+    gVelocity = Velocity;
+    
+    // Calculate emission (either from texture or material emission)
+    vec3 emission = vec3(0.0);
+    if (hasMaterial()) {
+        emission = material.emission;
+        if (hasMap(MAP_EMISSION)) {
+            emission *= texture(MATERIAL_MAP(MAP_EMISSION, emissionMap), finalTexCoords).rgb;
+        }
+    }
+    gEmission = emission;
+} 
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 330 core
+// Builds one level of the min/max depth pyramid (DepthPyramid.h): r = nearest
+// and g = farthest linear depth. Level 0 converts the G-buffer depth; every
+// further level reduces the previous one, whose level is the only one visible.
+out vec2 FragColor;
+
+uniform sampler2D sourceDepth;
+uniform bool fromLinearDepth;
+
+const float NO_GEOMETRY_DEPTH = 1.0e30; // Background (cleared to 0) is never a surface
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    if (fromLinearDepth) {
+        float depth = texelFetch(sourceDepth, pixel, 0).r;
+        FragColor = vec2(depth > 0.0 ? depth : NO_GEOMETRY_DEPTH);
+        return;
+    }
+
+    // Mip sizes round down, so on an odd source axis the last texel also covers a third row/column
+    ivec2 sourceSize = textureSize(sourceDepth, 0);
+    ivec2 first = pixel * 2;
+    ivec2 last = min(first + 1 + ivec2(equal(first + 3, sourceSize)), sourceSize - 1);
+
+    vec2 range = vec2(NO_GEOMETRY_DEPTH, 0.0);
+    for (int y = first.y; y <= last.y; ++y) {
+        for (int x = first.x; x <= last.x; ++x) {
+            vec2 texel = texelFetch(sourceDepth, ivec2(x, y), 0).rg;
+            range = vec2(min(range.x, texel.x), max(range.y, texel.y));
+        }
+    }
+    FragColor = range;
+}
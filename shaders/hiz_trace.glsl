@@ -0,0 +1,75 @@
+// hiz_trace.glsl - Hierarchical ray marching through the min/max depth pyramid (DepthPyramid.h)
+// Include after frame_uniforms.glsl. r = nearest and g = farthest linear depth per texel.
+uniform sampler2D depthPyramid;
+uniform int depthPyramidLevels;
+
+vec2 projectToUV(vec3 viewPos) {
+    vec4 clip = projection * vec4(viewPos, 1.0);
+    return clip.xy / clip.w * 0.5 + 0.5;
+}
+
+// Marches the view-space segment start -> end across the screen. A cell whose depth
+// range the segment passes entirely in front of, or behind by more than the relative
+// thickness, is skipped whole and the march climbs a level; near a surface it descends
+// again, and reaching one at level 0 is a hit. Returns false when the segment leaves
+// the screen, runs out of iterations or ends without touching anything.
+bool traceDepthPyramid(vec3 start, vec3 end, float thickness, int maxIterations, out vec2 hitUV) {
+    hitUV = vec2(0.0);
+    float nearZ = -nearPlane;
+    if (start.z > nearZ) {
+        return false;
+    }
+    if (end.z > nearZ) {
+        end = mix(start, end, (start.z - nearZ) / (start.z - end.z));
+    }
+
+    // Screen position is linear in t, depth is not: 1/depth is
+    vec2 uvStart = projectToUV(start);
+    vec2 uvDelta = projectToUV(end) - uvStart;
+    float invDepthStart = 1.0 / -start.z;
+    float invDepthEnd = 1.0 / -end.z;
+
+    vec2 fullSize = vec2(textureSize(depthPyramid, 0));
+    float texels = max(abs(uvDelta.x * fullSize.x), abs(uvDelta.y * fullSize.y));
+    if (texels < 1.0) {
+        return false;
+    }
+    float t = 1.0 / texels; // Leave the starting pixel
+    int level = 0;
+
+    for (int i = 0; i < maxIterations && t < 1.0; ++i) {
+        vec2 uv = uvStart + uvDelta * t;
+        if (any(lessThan(uv, vec2(0.0))) || any(greaterThanEqual(uv, vec2(1.0)))) {
+            return false;
+        }
+        vec2 levelSize = vec2(textureSize(depthPyramid, level));
+        vec2 position = uv * levelSize;
+        vec2 cell = floor(position);
+        vec2 delta = uvDelta * levelSize;
+
+        // Where the segment leaves this cell
+        vec2 boundary = cell + step(vec2(0.0), delta);
+        vec2 exitT = vec2(1.0e9);
+        if (delta.x != 0.0) exitT.x = (boundary.x - position.x) / delta.x;
+        if (delta.y != 0.0) exitT.y = (boundary.y - position.y) / delta.y;
+        float tExit = min(t + min(exitT.x, exitT.y), 1.0);
+
+        float depthIn = 1.0 / mix(invDepthStart, invDepthEnd, t);
+        float depthOut = 1.0 / mix(invDepthStart, invDepthEnd, tExit);
+        float rayNear = min(depthIn, depthOut);
+        float rayFar = max(depthIn, depthOut);
+        vec2 range = texelFetch(depthPyramid, ivec2(cell), level).rg;
+
+        if (rayFar < range.x || rayNear > range.y * (1.0 + thickness)) {
+            // Empty for this whole span: step just past the cell, try a coarser one next
+            t = tExit + 0.01 / max(abs(delta.x), abs(delta.y));
+            level = min(level + 1, depthPyramidLevels - 1);
+        } else if (level == 0) {
+            hitUV = (cell + 0.5) / levelSize;
+            return true;
+        } else {
+            level--;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,26 @@
+#version 330 core
+// Reduces the depth pyramid (DepthPyramid.h) to the small occlusion grid: each
+// output texel stores the FARTHEST depth of the texels it covers, so an object
+// is only considered hidden if it is behind everything in its footprint.
+// Background is already stored as a huge depth, so it never occludes.
+out float FragColor;
+
+uniform sampler2D depthPyramid; // g = farthest linear depth
+uniform int sourceLevel;        // Coarsest level at least as large as the grid
+uniform vec2 gridSize;
+
+void main() {
+    ivec2 sourceSize = textureSize(depthPyramid, sourceLevel);
+    vec2 texelsPerCell = vec2(sourceSize) / gridSize;
+    ivec2 cell = ivec2(gl_FragCoord.xy);
+    ivec2 first = ivec2(floor(vec2(cell) * texelsPerCell));
+    ivec2 last = min(ivec2(ceil(vec2(cell + 1) * texelsPerCell)), sourceSize) - 1;
+
+    float farthest = 0.0;
+    for (int y = first.y; y <= last.y; ++y) {
+        for (int x = first.x; x <= last.x; ++x) {
+            farthest = max(farthest, texelFetch(depthPyramid, ivec2(x, y), sourceLevel).g);
+        }
+    }
+    FragColor = farthest;
+}
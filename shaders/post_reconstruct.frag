@@ -0,0 +1,64 @@
+#version 330 core
+// Upsamples a half-resolution SSAO or SSR trace to the full internal resolution.
+// The four nearest trace texels are weighted bilinearly and by how close their
+// depth is to this pixel's, so occlusion and reflections do not bleed across
+// silhouettes. Last frame's result, reprojected with the motion vectors and
+// clamped to the range of the freshly traced texels, is blended in.
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D traceTexture;     // Half resolution
+uniform sampler2D historyTexture;   // Last frame's output
+uniform sampler2D gVelocity;        // Current - previous uv
+uniform int checkerParity;          // Traced checkerboard half this frame, -1 = all
+uniform bool useHistory;
+#include "frame_uniforms.glsl"
+#include "view_position.glsl"
+
+const float DEPTH_SIGMA = 0.05;     // Relative depth difference that costs ~63% weight
+const float STALE_WEIGHT = 0.25;    // Weight of texels left from the previous frame (checkerboard)
+const float HISTORY_WEIGHT = 0.5;   // Share of the reprojected history in the result
+
+void main() {
+    float depth = sampleLinearDepth(TexCoords);
+    ivec2 traceSize = textureSize(traceTexture, 0);
+    vec2 coord = TexCoords * vec2(traceSize) - 0.5;
+    ivec2 base = ivec2(floor(coord));
+    vec2 f = fract(coord);
+
+    vec4 sum = vec4(0.0);
+    float weightSum = 0.0;
+    vec4 freshMin = vec4(1e9);
+    vec4 freshMax = vec4(-1e9);
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 2; ++x) {
+            ivec2 texel = clamp(base + ivec2(x, y), ivec2(0), traceSize - 1);
+            vec4 value = texelFetch(traceTexture, texel, 0);
+            float texelDepth = sampleLinearDepth((vec2(texel) + 0.5) / vec2(traceSize));
+            float weight = (x == 0 ? 1.0 - f.x : f.x) * (y == 0 ? 1.0 - f.y : f.y);
+            weight *= exp(-abs(texelDepth - depth) / (DEPTH_SIGMA * depth + 1e-4));
+            bool fresh = checkerParity < 0 || ((texel.x + texel.y) & 1) == checkerParity;
+            if (fresh) {
+                freshMin = min(freshMin, value);
+                freshMax = max(freshMax, value);
+            } else {
+                weight *= STALE_WEIGHT;
+            }
+            sum += value * weight;
+            weightSum += weight;
+        }
+    }
+    // Every neighbour on another surface: take the nearest texel rather than nothing
+    vec4 current = weightSum > 1e-5 ? sum / weightSum
+                                    : texelFetch(traceTexture, clamp(ivec2(TexCoords * vec2(traceSize)), ivec2(0), traceSize - 1), 0);
+
+    vec2 historyUV = TexCoords - texture(gVelocity, TexCoords).rg;
+    bool historyOnScreen = all(greaterThanEqual(historyUV, vec2(0.0))) && all(lessThanEqual(historyUV, vec2(1.0)));
+    // A 2x2 of a checkerboard always holds two fresh texels, so the clamp range exists
+    if (useHistory && historyOnScreen && freshMin.x <= freshMax.x) {
+        vec4 history = clamp(texture(historyTexture, historyUV), freshMin, freshMax);
+        current = mix(current, history, HISTORY_WEIGHT);
+    }
+    FragColor = current;
+}
@@ -0,0 +1,35 @@
+// probe_common.glsl - Sampling the world-space irradiance probe clipmap (ProbeCache.h)
+// Probe cell c sits at c * probeSpacing and is stored at texel c mod probeGridSize
+// (toroidal), so with GL_REPEAT the world position maps straight to uvw.
+//   probeL0: rgb = mean radiance * valid, a = valid
+//   probeL1: rgb = luminance-weighted mean direction (L1) * valid, a = sample count
+uniform sampler3D probeL0;
+uniform sampler3D probeL1;
+uniform vec3 probeGridOrigin;   // First cell of the clipmap (cell units)
+uniform vec3 probeGridSize;     // Probes per axis
+uniform float probeSpacing;     // World units between probes
+
+// Cosine-weighted irradiance (same scale as the cascades' mean radiance) arriving
+// at a surface; zero outside the clipmap or where no probe has been traced yet
+vec3 sampleProbeIrradiance(vec3 worldPos, vec3 worldNormal) {
+    vec3 cell = worldPos / probeSpacing;
+    vec3 local = cell - probeGridOrigin;
+    vec3 border = min(local, probeGridSize - 1.0 - local);
+    float fade = clamp(min(border.x, min(border.y, border.z)), 0.0, 1.0);
+    if (fade <= 0.0) {
+        return vec3(0.0);
+    }
+
+    vec3 uvw = (cell + 0.5) / probeGridSize;
+    vec4 l0 = texture(probeL0, uvw);
+    if (l0.a < 0.01) {
+        return vec3(0.0);
+    }
+    vec3 radiance = l0.rgb / l0.a;
+    vec3 direction = texture(probeL1, uvw).rgb / l0.a;
+
+    // L(w) ~ L0 + 3 (L1 . w); its cosine-weighted hemisphere mean around n is L0 + 2 (L1 . n)
+    float luminance = max(dot(radiance, vec3(0.299, 0.587, 0.114)), 1e-4);
+    float directional = clamp(1.0 + 2.0 * dot(direction, worldNormal) / luminance, 0.0, 2.0);
+    return radiance * directional * fade;
+}
@@ -0,0 +1,140 @@
+#version 330 core
+// Updates one z slice of the probe clipmap (ProbeCache.h). Every probe traces
+// rays through the current G-buffer; rays that leave the screen are unknown
+// and neither add light nor darken the probe, so light seen earlier persists
+// while it is off screen. Texels recycled by a clipmap scroll start empty.
+layout (location = 0) out vec4 outL0;
+layout (location = 1) out vec4 outL1;
+
+uniform sampler3D probeL0;          // History (read at this texel only)
+uniform sampler3D probeL1;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedo;
+uniform sampler2D gEmission;
+uniform ivec3 gridOrigin;           // First cell of the clipmap this frame
+uniform ivec3 previousOrigin;       // ... and when the texel was last written
+uniform ivec3 gridSize;
+uniform float spacing;
+uniform int slice;                  // Texel z of this pass
+uniform bool traceRays;             // false: only drop recycled texels
+uniform int frameIndex;             // Rotates the ray set between updates
+#include "frame_uniforms.glsl"
+#include "view_position.glsl"
+
+const int RAY_COUNT = 24;
+const int STEP_COUNT = 16;
+const float MAX_RAY_DISTANCE = 6.0;
+const float THICKNESS = 0.06;       // Relative depth tolerance, as in the cascades
+const float MAX_SAMPLES = 16.0;     // History length in updates (1/16 = slowest blend)
+
+int wrap(int value, int size) {
+    return value - size * int(floor(float(value) / float(size)));
+}
+
+// World cell stored at a texel for a given clipmap origin
+ivec3 cellAt(ivec3 texel, ivec3 origin) {
+    return origin + ivec3(wrap(texel.x - origin.x, gridSize.x),
+                          wrap(texel.y - origin.y, gridSize.y),
+                          wrap(texel.z - origin.z, gridSize.z));
+}
+
+// Spherical Fibonacci point i of n, rotated about y
+vec3 rayDirection(int i, float rotation) {
+    float z = 1.0 - (2.0 * float(i) + 1.0) / float(RAY_COUNT);
+    float r = sqrt(max(0.0, 1.0 - z * z));
+    float phi = float(i) * 2.399963 + rotation;
+    return vec3(r * cos(phi), z, r * sin(phi));
+}
+
+vec3 shadeHit(vec2 uv, vec3 worldHit) {
+    vec3 albedo = texture(gAlbedo, uv).rgb;
+    vec2 normalXY = texture(gNormal, uv).rg;
+    vec3 viewNormal = normalize(vec3(normalXY, sqrt(max(0.0, 1.0 - dot(normalXY, normalXY)))));
+    vec3 normal = mat3(invView) * viewNormal;
+    vec3 toLight = lightPos - worldHit;
+    float distanceToLight = length(toLight);
+    float diffuse = max(dot(normal, toLight / distanceToLight), 0.0);
+    float normalized = distanceToLight / lightRadius;
+    float attenuation = 1.0 / (1.0 + normalized * normalized * 0.25);
+    attenuation *= 1.0 - smoothstep(lightRadius * 2.1, lightRadius * 3.0, distanceToLight);
+    return albedo * lightColor * diffuse * attenuation + texture(gEmission, uv).rgb * 10.0;
+}
+
+void main() {
+    ivec3 texel = ivec3(ivec2(gl_FragCoord.xy), slice);
+    vec4 historyL0 = texelFetch(probeL0, texel, 0);
+    vec4 historyL1 = texelFetch(probeL1, texel, 0);
+    ivec3 cell = cellAt(texel, gridOrigin);
+    if (cell != cellAt(texel, previousOrigin)) {
+        historyL0 = vec4(0.0);
+        historyL1 = vec4(0.0);
+    }
+    outL0 = historyL0;
+    outL1 = historyL1;
+    if (!traceRays) {
+        return;
+    }
+
+    vec3 probePos = vec3(cell) * spacing;
+    // A probe buried behind the visible surface would only see the inside of the geometry
+    vec4 probeClip = currentViewProj * vec4(probePos, 1.0);
+    if (probeClip.w > 0.0) {
+        vec2 probeUV = probeClip.xy / probeClip.w * 0.5 + 0.5;
+        if (all(greaterThanEqual(probeUV, vec2(0.0))) && all(lessThanEqual(probeUV, vec2(1.0)))) {
+            float surfaceDepth = sampleLinearDepth(probeUV);
+            if (surfaceDepth > 0.0 && probeClip.w > surfaceDepth + spacing) {
+                return;
+            }
+        }
+    }
+
+    vec3 radianceSum = vec3(0.0);
+    vec3 directionSum = vec3(0.0);
+    int known = 0;
+    float rotation = float(frameIndex) * 0.618034 * 6.283185;
+    float stepSize = MAX_RAY_DISTANCE / float(STEP_COUNT);
+    for (int i = 0; i < RAY_COUNT; ++i) {
+        vec3 direction = rayDirection(i, rotation);
+        bool onScreen = true;
+        bool hit = false;
+        for (int s = 1; s <= STEP_COUNT; ++s) {
+            vec3 worldSample = probePos + direction * (float(s) * stepSize);
+            vec4 viewSample = view * vec4(worldSample, 1.0);
+            vec4 clip = projection * viewSample;
+            if (clip.w <= 0.0) {
+                onScreen = false;
+                break;
+            }
+            vec2 uv = clip.xy / clip.w * 0.5 + 0.5;
+            if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0)))) {
+                onScreen = false;
+                break;
+            }
+            float sampledDepth = sampleLinearDepth(uv);
+            float rayDepth = -viewSample.z;
+            if (sampledDepth > 0.0 && abs(rayDepth - sampledDepth) < THICKNESS * rayDepth) {
+                vec3 radiance = shadeHit(uv, worldSample);
+                radianceSum += radiance;
+                directionSum += direction * dot(radiance, vec3(0.299, 0.587, 0.114));
+                hit = true;
+                break;
+            }
+        }
+        // A ray that stayed on screen without a hit really saw nothing; one that left is unknown
+        if (hit || onScreen) {
+            known++;
+        }
+    }
+    if (known == 0) {
+        return;
+    }
+
+    vec3 radiance = radianceSum / float(known);
+    vec3 l1 = directionSum / float(known);
+    float samples = min(historyL1.a + 1.0, MAX_SAMPLES);
+    float blend = 1.0 / samples;
+    vec3 previousRadiance = historyL0.a > 0.0 ? historyL0.rgb / historyL0.a : radiance;
+    vec3 previousL1 = historyL0.a > 0.0 ? historyL1.rgb / historyL0.a : l1;
+    outL0 = vec4(mix(previousRadiance, radiance, blend), 1.0);
+    outL1 = vec4(mix(previousL1, l1, blend), samples);
+}
@@ -1,10 +1,12 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 5) in mat4 instanceModel; // Per instance (DrawBatcher), locations 5-8
 
-uniform mat4 lightSpaceMatrix;
-uniform mat4 model;
+uniform mat4 lightSpaceMatrix; // Light cascade, or the camera's view-projection for the depth pre-pass
+
+invariant gl_Position; // Matches gbuffer.vert bit for bit (pre-pass + GL_EQUAL)
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+    gl_Position = lightSpaceMatrix * (instanceModel * vec4(aPos, 1.0));
 } 
\ No newline at end of file
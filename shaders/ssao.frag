@@ -3,12 +3,16 @@ out float FragColor;
 
 in vec2 TexCoords;
 
-uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform sampler2D texNoise;
 
-uniform vec3 samples[32];
-uniform mat4 projection;
+// Hemisphere kernel, uploaded once (RadianceCascades::generateSSAOKernel)
+layout (std140) uniform SSAOKernel {
+    vec4 samples[32]; // xyz = tangent-space offset
+};
+#include "frame_uniforms.glsl"
+#include "view_position.glsl"
+#include "checkerboard.glsl"
 
 // SSAO parameters
 const int kernelSize = 32;
@@ -17,13 +21,18 @@ const float bias = 0.025;
 
 void main()
 {
+    if (skipCheckerPixel()) {
+        discard;
+    }
+    
     // Get input for SSAO algorithm
-    vec3 fragPos = texture(gPosition, TexCoords).xyz;
+    vec3 fragPos = reconstructViewPosition(TexCoords);
     // Reconstruct normal from RG16F format
     vec2 normalXY = texture(gNormal, TexCoords).rg;
     float normalZ = sqrt(max(0.0, 1.0 - dot(normalXY, normalXY)));
     vec3 normal = normalize(vec3(normalXY, normalZ));
-    vec3 randomVec = normalize(texture(texNoise, TexCoords * vec2(textureSize(gPosition, 0)) / 4.0).xyz);
+    // Noise tiles over the pixels of the target written (half resolution in reduced modes)
+    vec3 randomVec = normalize(texture(texNoise, gl_FragCoord.xy / 4.0).xyz);
     
     // Create TBN matrix to transform samples to view space
     vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
@@ -35,7 +44,7 @@ void main()
     for(int i = 0; i < kernelSize; ++i)
     {
         // Get sample position
-        vec3 samplePos = TBN * samples[i]; // From tangent to view-space
+        vec3 samplePos = TBN * samples[i].xyz; // From tangent to view-space
         samplePos = fragPos + samplePos * radius; 
         
         // Project sample position to get screen-space position
@@ -45,7 +54,7 @@ void main()
         offset.xyz = offset.xyz * 0.5 + 0.5; // Transform to range 0.0 - 1.0
         
         // Get sample depth
-        float sampleDepth = texture(gPosition, offset.xy).z; // Get depth value of kernel sample
+        float sampleDepth = -sampleLinearDepth(offset.xy); // Get depth value of kernel sample
         
         // Range check & accumulate
         float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPos.z - sampleDepth));
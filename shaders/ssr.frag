@@ -3,13 +3,14 @@ out vec4 FragColor;
 
 in vec2 TexCoords;
 
-uniform sampler2D gPosition;
 uniform sampler2D gNormal;  
 uniform sampler2D gAlbedo;
 uniform sampler2D colorTexture; // Current frame color for reflection sampling
-uniform mat4 view;
-uniform mat4 projection;
-uniform vec3 viewPos;
+uniform bool useDepthPyramid;   // Trace the min/max depth pyramid (DepthPyramid.h) instead of fixed steps
+#include "frame_uniforms.glsl"
+#include "view_position.glsl"
+#include "checkerboard.glsl"
+#include "hiz_trace.glsl"
 
 // SSR Parameters
 const int MAX_STEPS = 64;
@@ -18,6 +19,8 @@ const float RAY_STEP = 0.04;
 const float MIN_RAY_STEP = 0.01;
 const float MAX_DISTANCE = 50.0;
 const float THICKNESS = 0.1;
+const int HIZ_MAX_ITERATIONS = 64;
+const float HIZ_THICKNESS = 0.05; // Relative to the ray depth
 
 vec3 SSRTrace(vec3 rayOrigin, vec3 rayDirection, out bool hitFound) {
     hitFound = false;
@@ -53,7 +56,7 @@ vec3 SSRTrace(vec3 rayOrigin, vec3 rayDirection, out bool hitFound) {
         }
         
         // Sample depth at current position
-        float sceneDepth = texture(gPosition, currentPos.xy).z;
+        float sceneDepth = -sampleLinearDepth(currentPos.xy);
         float rayDepth = currentPos.z;
         
         // Check for intersection
@@ -63,7 +66,7 @@ vec3 SSRTrace(vec3 rayOrigin, vec3 rayDirection, out bool hitFound) {
             vec3 searchStep = rayDelta * stepSize * 0.5;
             
             for (int j = 0; j < BINARY_SEARCH_STEPS; ++j) {
-                float refineDepth = texture(gPosition, refinedPos.xy).z;
+                float refineDepth = -sampleLinearDepth(refinedPos.xy);
                 if (refinedPos.z > refineDepth) {
                     refinedPos -= searchStep;
                 } else {
@@ -84,8 +87,12 @@ vec3 SSRTrace(vec3 rayOrigin, vec3 rayDirection, out bool hitFound) {
 }
 
 void main() {
+    if (skipCheckerPixel()) {
+        discard;
+    }
+    
     // Sample G-buffer data
-    vec3 viewPos = texture(gPosition, TexCoords).xyz;
+    vec3 viewPos = reconstructViewPosition(TexCoords);
     vec2 normalXY = texture(gNormal, TexCoords).rg;
     float normalZ = sqrt(max(0.0, 1.0 - dot(normalXY, normalXY)));
     vec3 normal = normalize(vec3(normalXY, normalZ));
@@ -104,7 +111,19 @@ void main() {
     
     // Perform SSR trace
     bool hitFound;
-    vec3 reflectionColor = SSRTrace(viewPos, reflectDir, hitFound);
+    vec3 reflectionColor = vec3(0.0);
+    if (useDepthPyramid) {
+        // Lift the origin off its own surface, which is within thickness of the first cells
+        vec3 rayOrigin = viewPos + normal * (HIZ_THICKNESS * -viewPos.z);
+        vec2 hitUV;
+        hitFound = traceDepthPyramid(rayOrigin, rayOrigin + reflectDir * MAX_DISTANCE, HIZ_THICKNESS,
+                                     HIZ_MAX_ITERATIONS, hitUV);
+        if (hitFound) {
+            reflectionColor = texture(colorTexture, hitUV).rgb;
+        }
+    } else {
+        reflectionColor = SSRTrace(viewPos, reflectDir, hitFound);
+    }
     
     if (hitFound) {
         // Calculate reflection strength based on surface properties
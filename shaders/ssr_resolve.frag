@@ -0,0 +1,15 @@
+#version 330 core
+// Blends the screen-space reflections over the lit scene. The SSR target holds
+// the reflection already weighted by its strength (rgb) and the strength (a).
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D colorTexture;
+uniform sampler2D ssrTexture;
+
+void main() {
+    vec3 color = texture(colorTexture, TexCoords).rgb;
+    vec4 reflection = texture(ssrTexture, TexCoords);
+    FragColor = vec4(color * (1.0 - reflection.a) + reflection.rgb, 1.0);
+}
@@ -3,19 +3,23 @@ out vec4 FragColor;
 
 in vec2 TexCoords;
 
+// Temporal anti-aliasing and upscaling: the current frame (render resolution,
+// rendered with the sub-pixel projection jitter in FrameUniforms) is resolved
+// into the history at output resolution. The history keeps the linear depth
+// of each output pixel in alpha for the disocclusion test.
 uniform sampler2D currentFrame;
 uniform sampler2D historyFrame;
 uniform sampler2D gVelocity;
-uniform sampler2D gPosition;
-uniform mat4 currentViewProj;
-uniform mat4 previousViewProj;
+uniform sampler2D gLinearDepth;
 uniform float frameCounter;
+#include "frame_uniforms.glsl"
 
 // TAA Parameters - Much more aggressive to eliminate ghosting
 const float VELOCITY_WEIGHT = 0.02;
 const float MIN_BLEND_FACTOR = 0.15;  // Much more responsive to changes
 const float MAX_BLEND_FACTOR = 0.50;  // Allow much more current frame contribution
 const float LUMA_WEIGHT = 0.15;
+const float DISOCCLUSION_DEPTH = 0.05; // Relative depth change that rejects the history
 
 vec3 RGB2YCoCg(vec3 RGB) {
     float Y  = dot(RGB, vec3( 0.25, 0.5,  0.25));
@@ -65,14 +69,53 @@ vec3 sampleCatmullRom(sampler2D tex, vec2 uv, vec2 texSize) {
     return max(result, vec3(0.0));
 }
 
+// Weight of a sample at this distance (in input pixels), a Gaussian fit of Blackman-Harris
+float reconstructionWeight(vec2 delta) {
+    return exp(-2.29 * dot(delta, delta));
+}
+
 void main() {
-    vec2 texelSize = 1.0 / textureSize(currentFrame, 0);
-    
-    // Sample current frame
-    vec3 currentColor = texture(currentFrame, TexCoords).rgb;
+    ivec2 inputSize = textureSize(currentFrame, 0);
+    
+    // Where this output pixel falls in the jittered input grid: the jitter moved
+    // the scene by jitter.xy (NDC), so the nearest input sample is offset the same way
+    vec2 inputPos = (TexCoords + jitter.xy * 0.5) * vec2(inputSize);
+    ivec2 center = clamp(ivec2(floor(inputPos)), ivec2(0), inputSize - 1);
+    vec2 sampleOffset = inputPos - (vec2(center) + 0.5);
+    
+    // 3x3 input neighbourhood: the filtered current color, moments for the
+    // history clamp, and the closest depth whose velocity follows thin edges
+    vec3 currentSum = vec3(0.0);
+    float currentWeight = 0.0;
+    vec3 neighborSum = vec3(0.0);
+    vec3 neighborSqSum = vec3(0.0);
+    float closestDepth = 1e30;
+    ivec2 closest = center;
+    for (int x = -1; x <= 1; ++x) {
+        for (int y = -1; y <= 1; ++y) {
+            ivec2 coord = clamp(center + ivec2(x, y), ivec2(0), inputSize - 1);
+            vec3 neighbor = RGB2YCoCg(texelFetch(currentFrame, coord, 0).rgb);
+            neighborSum += neighbor;
+            neighborSqSum += neighbor * neighbor;
+            
+            float weight = reconstructionWeight(vec2(x, y) - sampleOffset);
+            currentSum += neighbor * weight;
+            currentWeight += weight;
+            
+            float depth = texelFetch(gLinearDepth, coord, 0).r;
+            depth = depth > 0.0 ? depth : 1e29; // Background is 0
+            if (depth < closestDepth) {
+                closestDepth = depth;
+                closest = coord;
+            }
+        }
+    }
+    vec3 currentYCoCg = currentSum / currentWeight;
+    vec3 currentColor = YCoCg2RGB(currentYCoCg);
+    float currentDepth = texelFetch(gLinearDepth, center, 0).r;
     
-    // Get motion vector from G-buffer
-    vec2 velocity = texture(gVelocity, TexCoords).xy;
+    // Motion vector of the closest surface (jitter already removed by the G-buffer)
+    vec2 velocity = texelFetch(gVelocity, closest, 0).xy;
     
     // Calculate previous frame UV coordinates
     vec2 prevUV = TexCoords - velocity;
@@ -80,33 +123,35 @@ void main() {
     // Check if previous UV is within bounds
     if (prevUV.x < 0.0 || prevUV.x > 1.0 || prevUV.y < 0.0 || prevUV.y > 1.0) {
         // Out of bounds - use current frame only
-        FragColor = vec4(currentColor, 1.0);
+        FragColor = vec4(currentColor, currentDepth);
         return;
     }
     
     // Sample history frame with high-quality filtering
-    vec3 historyColor = sampleCatmullRom(historyFrame, prevUV, textureSize(historyFrame, 0));
+    vec2 historySize = vec2(textureSize(historyFrame, 0));
+    vec3 historyColor = sampleCatmullRom(historyFrame, prevUV, historySize);
+    
+    // Disocclusion: the surface's depth as last frame's camera saw it must match the
+    // depth the history stored there, otherwise the history shows something else
+    bool disoccluded = false;
+    if (currentDepth > 0.0) {
+        vec2 ndc = (vec2(center) + 0.5) / vec2(inputSize) * 2.0 - 1.0;
+        vec4 rayPoint = invProjection * vec4(ndc, 1.0, 1.0);
+        vec3 viewPosition = rayPoint.xyz * (currentDepth / -rayPoint.z);
+        vec3 worldPosition = (invView * vec4(viewPosition, 1.0)).xyz;
+        float expectedDepth = -(previousView * vec4(worldPosition, 1.0)).z;
+        float historyDepth = texelFetch(historyFrame, ivec2(prevUV * historySize), 0).a;
+        disoccluded = abs(historyDepth - expectedDepth) > DISOCCLUSION_DEPTH * expectedDepth;
+    }
+    if (disoccluded) {
+        FragColor = vec4(currentColor, currentDepth);
+        return;
+    }
     
     // Convert to YCoCg for better temporal stability
-    vec3 currentYCoCg = RGB2YCoCg(currentColor);
     vec3 historyYCoCg = RGB2YCoCg(historyColor);
     
-    // Neighborhood sampling for variance estimation
-    vec3 neighborSum = vec3(0.0);
-    vec3 neighborSqSum = vec3(0.0);
-    float sampleCount = 0.0;
-    
-    // 3x3 neighborhood sampling
-    for (int x = -1; x <= 1; ++x) {
-        for (int y = -1; y <= 1; ++y) {
-            vec2 offset = vec2(float(x), float(y)) * texelSize;
-            vec3 neighbor = RGB2YCoCg(texture(currentFrame, TexCoords + offset).rgb);
-            neighborSum += neighbor;
-            neighborSqSum += neighbor * neighbor;
-            sampleCount += 1.0;
-        }
-    }
-    
+    float sampleCount = 9.0;
     vec3 neighborMean = neighborSum / sampleCount;
     vec3 neighborVariance = (neighborSqSum / sampleCount) - (neighborMean * neighborMean);
     vec3 neighborStdDev = sqrt(max(neighborVariance, vec3(0.0)));
@@ -132,6 +177,10 @@ void main() {
     float blendFactor = max(max(velocityFactor, lumaFactor), clampFactor);
     blendFactor = mix(MIN_BLEND_FACTOR, MAX_BLEND_FACTOR, blendFactor);
     
+    // An input sample far from this output pixel says less about it: the jitter
+    // sequence lands a close one every few frames, and the history fills in between
+    blendFactor *= reconstructionWeight(sampleOffset);
+    
     // For the first few frames, use higher blend factor to establish history
     if (frameCounter < 15.0) {
         float warmupFactor = frameCounter / 15.0;
@@ -144,5 +193,5 @@ void main() {
     // Convert back to RGB
     vec3 finalColor = YCoCg2RGB(finalYCoCg);
     
-    FragColor = vec4(finalColor, 1.0);
-} 
\ No newline at end of file
+    FragColor = vec4(finalColor, currentDepth);
+}
@@ -0,0 +1,15 @@
+// View-space positions rebuilt from the G-buffer's linear depth (there is no
+// position target). Include after frame_uniforms.glsl, which provides invProjection.
+uniform sampler2D gLinearDepth;
+
+// Positive view-space distance along -Z (0 where nothing was drawn)
+float sampleLinearDepth(vec2 uv) {
+    return texture(gLinearDepth, uv).r;
+}
+
+vec3 reconstructViewPosition(vec2 uv) {
+    float linearDepth = texture(gLinearDepth, uv).r;
+    // Any point on the pixel's view ray, scaled so that z = -linearDepth
+    vec4 rayPoint = invProjection * vec4(uv * 2.0 - 1.0, 1.0, 1.0);
+    return rayPoint.xyz * (linearDepth / -rayPoint.z);
+}
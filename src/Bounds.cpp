@@ -0,0 +1,88 @@
+// Bounds.cpp
+#include "../include/Bounds.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+BoundingBox::BoundingBox() : min(FLT_MAX), max(-FLT_MAX) {}
+
+void BoundingBox::expand(const glm::vec3& point) {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+BoundingBox BoundingBox::transformed(const glm::mat4& matrix) const {
+    if (!isValid()) {
+        return BoundingBox();
+    }
+    // Arvo: each output axis picks, per input axis, whichever box corner extends it most
+    glm::vec3 translation(matrix[3]);
+    BoundingBox result(translation, translation);
+    for (int column = 0; column < 3; ++column) {
+        glm::vec3 axis(matrix[column]);
+        glm::vec3 a = axis * min[column];
+        glm::vec3 b = axis * max[column];
+        result.min += glm::min(a, b);
+        result.max += glm::max(a, b);
+    }
+    return result;
+}
+
+BoundingSphere BoundingSphere::transformed(const glm::mat4& matrix) const {
+    float scale = std::max({glm::length(glm::vec3(matrix[0])),
+                            glm::length(glm::vec3(matrix[1])),
+                            glm::length(glm::vec3(matrix[2]))});
+    BoundingSphere result;
+    result.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+    result.radius = radius * scale;
+    return result;
+}
+
+Frustum::Frustum() {
+    // Everything passes until real planes are set
+    for (glm::vec4& plane : planes) {
+        plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+    // Gribb/Hartmann: clip-space planes are sums/differences of the matrix rows
+    glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+    glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+    glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+    glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+    planes[0] = row3 + row0;    // Left
+    planes[1] = row3 - row0;    // Right
+    planes[2] = row3 + row1;    // Bottom
+    planes[3] = row3 - row1;    // Top
+    planes[4] = row3 + row2;    // Near
+    planes[5] = row3 - row2;    // Far
+    for (glm::vec4& plane : planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) {
+            plane /= length;
+        }
+    }
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const {
+    for (const glm::vec4& plane : planes) {
+        if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersects(const BoundingBox& box) const {
+    for (const glm::vec4& plane : planes) {
+        // Corner furthest along the plane normal; if even it is outside, the whole box is
+        glm::vec3 positive(plane.x >= 0.0f ? box.max.x : box.min.x,
+                           plane.y >= 0.0f ? box.max.y : box.min.y,
+                           plane.z >= 0.0f ? box.max.z : box.min.z);
+        if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
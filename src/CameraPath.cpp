@@ -0,0 +1,137 @@
+// CameraPath.cpp
+#include "../include/CameraPath.h"
+#include "../include/Camera.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+void CameraPath::addKeyframe(const CameraKeyframe& keyframe) {
+    keyframes.push_back(keyframe);
+}
+
+CameraKeyframe CameraPath::sample(float time) const {
+    if (keyframes.empty()) {
+        return CameraKeyframe();
+    }
+    if (time <= keyframes.front().time) {
+        return keyframes.front();
+    }
+    if (time >= keyframes.back().time) {
+        return keyframes.back();
+    }
+
+    // First keyframe strictly after the requested time
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+        [](float t, const CameraKeyframe& k) { return t < k.time; });
+    const CameraKeyframe& b = *next;
+    const CameraKeyframe& a = *(next - 1);
+
+    float span = b.time - a.time;
+    float t = span > 0.0f ? (time - a.time) / span : 0.0f;
+
+    CameraKeyframe result;
+    result.time = time;
+    result.cameraPosition = glm::mix(a.cameraPosition, b.cameraPosition, t);
+    result.yaw = glm::mix(a.yaw, b.yaw, t);
+    result.pitch = glm::mix(a.pitch, b.pitch, t);
+    result.lightPosition = glm::mix(a.lightPosition, b.lightPosition, t);
+    return result;
+}
+
+void CameraPath::applyToCamera(const CameraKeyframe& keyframe, Camera& camera) {
+    camera.position = keyframe.cameraPosition;
+    camera.yaw = keyframe.yaw;
+    camera.pitch = keyframe.pitch;
+    camera.updateCameraVectors();
+}
+
+bool CameraPath::loadFromFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open camera path: " << path << std::endl;
+        return false;
+    }
+
+    keyframes.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream iss(line);
+        CameraKeyframe k;
+        if (!(iss >> k.time)) continue; // Blank or comment line
+        if (!(iss >> k.cameraPosition.x >> k.cameraPosition.y >> k.cameraPosition.z
+                  >> k.yaw >> k.pitch
+                  >> k.lightPosition.x >> k.lightPosition.y >> k.lightPosition.z)) {
+            std::cerr << "Malformed camera path keyframe at " << path << ":" << lineNumber << std::endl;
+            keyframes.clear();
+            return false;
+        }
+        if (!keyframes.empty() && k.time < keyframes.back().time) {
+            std::cerr << "Camera path keyframes out of order at " << path << ":" << lineNumber << std::endl;
+            keyframes.clear();
+            return false;
+        }
+        keyframes.push_back(k);
+    }
+
+    std::cout << "Loaded camera path " << path << " (" << keyframes.size() << " keyframes, "
+              << getDuration() << "s)" << std::endl;
+    return !keyframes.empty();
+}
+
+bool CameraPath::saveToFile(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to write camera path: " << path << std::endl;
+        return false;
+    }
+
+    file << "# time camX camY camZ yaw pitch lightX lightY lightZ\n";
+    file << std::fixed << std::setprecision(4);
+    for (const auto& k : keyframes) {
+        file << k.time << " "
+             << k.cameraPosition.x << " " << k.cameraPosition.y << " " << k.cameraPosition.z << " "
+             << k.yaw << " " << k.pitch << " "
+             << k.lightPosition.x << " " << k.lightPosition.y << " " << k.lightPosition.z << "\n";
+    }
+    return true;
+}
+
+CameraPath CameraPath::createOrbit(const glm::vec3& center, float radius, float height,
+                                   const glm::vec3& lightPosition, float duration) {
+    CameraPath path;
+    const int steps = 64;
+    for (int i = 0; i <= steps; ++i) {
+        float t = float(i) / float(steps);
+        float angle = t * 2.0f * 3.14159265f;
+
+        CameraKeyframe k;
+        k.time = t * duration;
+        // Start on +Z looking towards the center, like the default scene cameras
+        k.cameraPosition = center + glm::vec3(std::sin(angle) * radius, height, std::cos(angle) * radius);
+
+        glm::vec3 dir = glm::normalize(center - k.cameraPosition);
+        k.yaw = glm::degrees(std::atan2(dir.z, dir.x));
+        k.pitch = glm::degrees(std::asin(dir.y));
+
+        // Small light circle so shadows and GI actually change during playback
+        k.lightPosition = lightPosition + glm::vec3(std::cos(angle * 2.0f), 0.0f, std::sin(angle * 2.0f)) * 1.5f;
+        path.keyframes.push_back(k);
+    }
+
+    // Keep yaw continuous so interpolation never spins the long way round
+    for (size_t i = 1; i < path.keyframes.size(); ++i) {
+        float& yaw = path.keyframes[i].yaw;
+        float prev = path.keyframes[i - 1].yaw;
+        while (yaw - prev > 180.0f) yaw -= 360.0f;
+        while (yaw - prev < -180.0f) yaw += 360.0f;
+    }
+    return path;
+}
@@ -0,0 +1,129 @@
+// DepthPyramid.cpp
+#include "../include/DepthPyramid.h"
+#include "../include/Shader.h"
+#include "../include/FullscreenQuad.h"
+#include "../include/RenderTargetPool.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+const GLenum PYRAMID_FORMAT = GL_RG32F;
+
+// Scratch unit for the build passes (the pyramid's own unit stays bound for sampling)
+const int SOURCE_UNIT = 0;
+
+} // namespace
+
+DepthPyramid::DepthPyramid() : texture(0), fbo(0), width(0), height(0), levelCount(0) {
+}
+
+DepthPyramid::~DepthPyramid() {
+    cleanup();
+}
+
+void DepthPyramid::cleanup() {
+    if (fbo) {
+        glDeleteFramebuffers(1, &fbo);
+        fbo = 0;
+    }
+    if (texture) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+    width = height = levelCount = 0;
+}
+
+void DepthPyramid::resize(int newWidth, int newHeight) {
+    if (texture && newWidth == width && newHeight == height) {
+        return;
+    }
+    cleanup();
+    width = newWidth;
+    height = newHeight;
+    levelCount = 1;
+    while ((width >> levelCount) > 0 || (height >> levelCount) > 0) {
+        ++levelCount;
+    }
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    for (int level = 0; level < levelCount; ++level) {
+        glTexImage2D(GL_TEXTURE_2D, level, PYRAMID_FORMAT, getLevelWidth(level), getLevelHeight(level),
+                     0, GL_RG, GL_FLOAT, NULL);
+    }
+    // Only ever read with texelFetch; min/max must not be filtered
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Depth pyramid framebuffer incomplete!" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void DepthPyramid::build(Shader& shader, FullscreenQuad& quad, unsigned int linearDepth) {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glDisable(GL_DEPTH_TEST);
+    shader.use();
+    shader.setInt("sourceDepth", SOURCE_UNIT);
+    const int fromLinearDepthLocation = shader.getUniformLocation("fromLinearDepth");
+    glActiveTexture(GL_TEXTURE0 + SOURCE_UNIT);
+
+    // Level 0: copy the G-buffer depth with the background pushed to infinity
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glViewport(0, 0, width, height);
+    glBindTexture(GL_TEXTURE_2D, linearDepth);
+    shader.setBool(fromLinearDepthLocation, true);
+    quad.render();
+
+    // Every further level reduces the one above it. Restricting the sampled range to
+    // that level keeps the level being rendered out of the texture's readable range.
+    glBindTexture(GL_TEXTURE_2D, texture);
+    shader.setBool(fromLinearDepthLocation, false);
+    for (int level = 1; level < levelCount; ++level) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, level);
+        glViewport(0, 0, getLevelWidth(level), getLevelHeight(level));
+        quad.render();
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void DepthPyramid::bindForSampling(Shader& shader) const {
+    shader.setInt("depthPyramidLevels", levelCount);
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+int DepthPyramid::getLevelWidth(int level) const {
+    return std::max(1, width >> level);
+}
+
+int DepthPyramid::getLevelHeight(int level) const {
+    return std::max(1, height >> level);
+}
+
+size_t DepthPyramid::getMemoryUsage() const {
+    const size_t texel = RenderTargetPool::getBytesPerPixel(PYRAMID_FORMAT);
+    size_t total = 0;
+    for (int level = 0; level < levelCount; ++level) {
+        total += texel * static_cast<size_t>(getLevelWidth(level)) * getLevelHeight(level);
+    }
+    return total;
+}
@@ -0,0 +1,328 @@
+// DrawBatcher.cpp
+#include "../include/DrawBatcher.h"
+#include "../include/Registry.h"
+#include "../include/Mesh.h"
+#include "../include/MeshStreamer.h"
+#include "../include/MeshComponent.h"
+#include "../include/Material.h"
+#include "../include/MaterialComponent.h"
+#include "../include/TransformComponent.h"
+#include "../include/BoundsComponent.h"
+#include "../include/OcclusionCuller.h"
+#include "../include/GpuCuller.h"
+#include "../include/Shader.h"
+#include "../scripts/Behaviour.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+namespace {
+
+// FNV-1a over raw bytes
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Room for 4096 instances per frame before the ring first grows
+const size_t INITIAL_INSTANCE_BYTES = 4096 * sizeof(InstanceData);
+
+} // namespace
+
+DrawBatcher::DrawBatcher()
+    : instanceRing(GL_ARRAY_BUFFER, INITIAL_INSTANCE_BYTES, sizeof(glm::vec4)), instanceOffset(0), frameRegion(0),
+      gpuCuller(nullptr), views(1), viewCount(1), uploadedCount(0), dynamicInstanceCount(0), staticHash(0), sceneHash(0) {
+}
+
+DrawBatcher::~DrawBatcher() {
+}
+
+void DrawBatcher::build(Registry& registry, const std::vector<glm::mat4>& worldMatrices) {
+    items.clear();
+    materialTable.begin();
+    ComponentPool<MaterialComponent>& materials = registry.pool<MaterialComponent>();
+    ComponentPool<BoundsComponent>& bounds = registry.pool<BoundsComponent>();
+    ComponentPool<TransformComponent>& transforms = registry.pool<TransformComponent>();
+    const bool matricesValid = worldMatrices.size() == transforms.size();
+    registry.each<MeshComponent, TransformComponent>(
+        [&](EntityId entity, MeshComponent& meshComp, TransformComponent& transform) {
+            if (!meshComp.mesh) {
+                return;
+            }
+            // GPU-culled views draw view 0's levels, which are then the ones to keep resident
+            Mesh* drawMesh = gpuCuller ? meshComp.mesh->requestLod(0) : meshComp.mesh->getResidentLod();
+            if (!drawMesh) {
+                return; // Still loading
+            }
+            MaterialComponent* materialComp = materials.get(entity);
+            DrawItem item;
+            item.mesh = meshComp.mesh;
+            item.drawMesh = drawMesh;
+            item.material = materialComp ? materialComp->material.get() : nullptr;
+            item.entity = entity;
+            item.dynamic = registry.has<std::unique_ptr<Behaviour>>(entity);
+            const int materialIndex = materialTable.add(item.material);
+            item.textureSet = materialTable.getTextureSet(materialIndex);
+            item.instance.model = matricesValid ? worldMatrices[&transform - transforms.data()] : transform.getModelMatrix();
+            item.instance.color = glm::vec4(meshComp.color, static_cast<float>(materialIndex));
+
+            BoundsComponent* worldBounds = bounds.get(entity);
+            if (!worldBounds) {
+                worldBounds = &bounds.emplace(entity);
+            }
+            worldBounds->update(meshComp.mesh->getBoundingBox(), meshComp.mesh->getBoundingSphere(), item.instance.model);
+            item.box = worldBounds->box;
+            item.sphere = worldBounds->sphere;
+            items.push_back(item);
+        });
+    materialTable.upload();
+
+    // Mesh first (VAO switches and instancing), then static/dynamic, then texture set
+    // (texture switches), then material so each material's instances stay together
+    std::sort(items.begin(), items.end(), [](const DrawItem& a, const DrawItem& b) {
+        if (a.mesh != b.mesh) return std::less<Mesh*>()(a.mesh, b.mesh);
+        if (a.dynamic != b.dynamic) return b.dynamic;
+        if (a.textureSet != b.textureSet) return a.textureSet < b.textureSet;
+        if (a.material != b.material) return std::less<Material*>()(a.material, b.material);
+        return a.entity < b.entity;
+    });
+
+    instances.clear();
+    viewCount = 1;
+    clearView(views[0]);
+    uploadedCount = 0;
+    dynamicInstanceCount = 0;
+    staticHash = 14695981039346656037ull;
+    sceneHash = staticHash;
+    for (const DrawItem& item : items) {
+        sceneHash = hashBytes(sceneHash, &item.drawMesh, sizeof(item.drawMesh));
+        sceneHash = hashBytes(sceneHash, &item.material, sizeof(item.material));
+        sceneHash = hashBytes(sceneHash, &item.instance, sizeof(item.instance));
+        if (item.dynamic) {
+            dynamicInstanceCount++;
+        } else {
+            staticHash = hashBytes(staticHash, &item.drawMesh, sizeof(item.drawMesh));
+            staticHash = hashBytes(staticHash, &item.instance.model, sizeof(item.instance.model));
+        }
+        appendInstance(views[0], item, item.drawMesh);
+    }
+    // Cached shadow views pick their levels from what is resident
+    const uint64_t residency = MeshStreamer::instance().getResidencyVersion();
+    staticHash = hashBytes(staticHash, &residency, sizeof(residency));
+
+    if (gpuCuller) {
+        boxes.clear();
+        for (const DrawItem& item : items) {
+            boxes.push_back(item.box);
+        }
+        gpuCuller->update(views[0].materialBatches, instances, boxes, sceneHash);
+    }
+}
+
+int DrawBatcher::addView(const Frustum& frustum, const OcclusionCuller* occlusion, const HiZOcclusion* hiZ,
+                         const LodSelection* lod) {
+    // Views of earlier frames are reused, keeping their batch lists' storage
+    if (viewCount == views.size()) {
+        views.emplace_back();
+    }
+    View& view = views[viewCount++];
+    clearView(view);
+    if (gpuCuller) {
+        view.gpuView = gpuCuller->addView(frustum, hiZ);
+        if (view.gpuView >= 0) {
+            view.instanceCount = items.size();
+            return static_cast<int>(viewCount) - 1;
+        }
+    }
+    survivors.clear();
+    survivorMeshes.clear();
+    for (const DrawItem& item : items) {
+        if (!frustum.intersects(item.sphere) || !frustum.intersects(item.box)) {
+            continue;
+        }
+        if (occlusion && occlusion->isOccluded(item.box)) {
+            continue;
+        }
+        Mesh* mesh = item.drawMesh;
+        if (lod) {
+            mesh = item.mesh->requestLod(selectLod(item, *lod));
+        }
+        survivors.push_back(&item);
+        survivorMeshes.push_back(mesh);
+    }
+
+    // Append each mesh's run one level at a time, so every level is one contiguous batch
+    for (size_t begin = 0; begin < survivors.size();) {
+        size_t end = begin + 1;
+        while (end < survivors.size() && survivors[end]->mesh == survivors[begin]->mesh) {
+            end++;
+        }
+        for (size_t i = begin; i < end; ++i) {
+            Mesh* level = survivorMeshes[i];
+            if (!level) {
+                continue; // Appended with an earlier level
+            }
+            for (size_t j = i; j < end; ++j) {
+                if (survivorMeshes[j] == level) {
+                    appendInstance(view, *survivors[j], level);
+                    survivorMeshes[j] = nullptr;
+                }
+            }
+        }
+        begin = end;
+    }
+    return static_cast<int>(viewCount) - 1;
+}
+
+int DrawBatcher::selectLod(const DrawItem& item, const LodSelection& lod) {
+    const int count = item.mesh->getLodCount();
+    if (count == 1 || lod.maxErrorPixels <= 0.0f) {
+        return 0;
+    }
+    // Clip w of the sphere's nearest point; glm matrices are column-major (m[column][row])
+    const glm::mat4& m = lod.viewProjection;
+    const glm::vec3 rowW(m[0][3], m[1][3], m[2][3]);
+    const glm::vec3 rowY(m[0][1], m[1][1], m[2][1]);
+    const float w = glm::dot(rowW, item.sphere.center) + m[3][3] - item.sphere.radius * glm::length(rowW);
+    if (w <= 1e-4f) {
+        return 0; // Camera inside or at the sphere
+    }
+    const float pixelsPerUnit = glm::length(rowY) * lod.viewportHeight * 0.5f / w;
+
+    // Errors are in model units: scale by the largest axis of the model matrix
+    const glm::mat4& model = item.instance.model;
+    const float scale = std::max(glm::length(glm::vec3(model[0])),
+                                 std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    int level = 0;
+    for (int i = 1; i < count; ++i) {
+        if (item.mesh->getLod(i)->getLodError() * scale * pixelsPerUnit > lod.maxErrorPixels) {
+            break;
+        }
+        level = i;
+    }
+    return level;
+}
+
+void DrawBatcher::clearView(View& view) {
+    view.materialBatches.clear();
+    view.meshBatches.clear();
+    view.instanceCount = 0;
+    view.gpuView = -1;
+}
+
+void DrawBatcher::appendInstance(View& view, const DrawItem& item, Mesh* mesh) {
+    // Items arrive in sorted order, so culled runs still batch like the full list
+    unsigned int index = static_cast<unsigned int>(instances.size());
+    instances.push_back(item.instance);
+    view.instanceCount++;
+
+    if (view.meshBatches.empty() || view.meshBatches.back().mesh != mesh ||
+        view.meshBatches.back().dynamic != item.dynamic) {
+        view.meshBatches.push_back({mesh, nullptr, index, 0, item.dynamic, 0});
+    }
+    view.meshBatches.back().instanceCount++;
+
+    // Materials only differing in their table record share a batch
+    if (view.materialBatches.empty() || view.materialBatches.back().mesh != mesh ||
+        view.materialBatches.back().dynamic != item.dynamic ||
+        view.materialBatches.back().textureSet != item.textureSet) {
+        view.materialBatches.push_back({mesh, item.material, index, 0, item.dynamic, item.textureSet});
+    }
+    view.materialBatches.back().instanceCount++;
+}
+
+void DrawBatcher::upload() {
+    size_t size = instances.size() * sizeof(InstanceData);
+    if (size == 0) {
+        return;
+    }
+    // This frame's region of the ring is no longer read by the GPU, so the copy never waits
+    instanceOffset = instanceRing.write(frameRegion, instances.data(), size);
+    uploadedCount = instances.size();
+}
+
+void DrawBatcher::bindInstanceAttributes(unsigned int firstInstance) const {
+    // Attribute pointers are VAO state, so this must follow Mesh::bind()
+    setInstanceAttributes(instanceOffset + static_cast<size_t>(firstInstance) * sizeof(InstanceData));
+}
+
+void DrawBatcher::setInstanceAttributes(size_t byteOffset) {
+    uintptr_t base = byteOffset;
+    for (unsigned int column = 0; column < 4; ++column) {
+        unsigned int location = INSTANCE_MODEL_LOCATION + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(base + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+    }
+    glEnableVertexAttribArray(INSTANCE_COLOR_LOCATION);
+    glVertexAttribPointer(INSTANCE_COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                          (void*)(base + offsetof(InstanceData, color)));
+    glVertexAttribDivisor(INSTANCE_COLOR_LOCATION, 1);
+}
+
+void DrawBatcher::drawMeshBatches(const Shader& shader, BatchFilter filter, int view) {
+    if (views[view].gpuView >= 0) {
+        gpuCuller->drawDepth(shader, filter, views[view].gpuView);
+        return;
+    }
+    if (uploadedCount != instances.size()) {
+        upload();
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, instanceRing.getBuffer());
+    for (const DrawBatch& batch : views[view].meshBatches) {
+        if ((filter == BatchFilter::Static && batch.dynamic) ||
+            (filter == BatchFilter::Dynamic && !batch.dynamic)) {
+            continue;
+        }
+        batch.mesh->bind(shader);
+        bindInstanceAttributes(batch.firstInstance);
+        batch.mesh->drawInstanced(static_cast<int>(batch.instanceCount));
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void DrawBatcher::drawMaterialBatches(const Shader& shader, int view) {
+    const bool bindTextures = !materialTable.isBindless();
+    materialTable.bindForSampling();
+    if (views[view].gpuView >= 0) {
+        gpuCuller->drawMaterials(shader, views[view].gpuView, bindTextures);
+        return;
+    }
+    if (uploadedCount != instances.size()) {
+        upload();
+    }
+    const std::vector<DrawBatch>& materialBatches = views[view].materialBatches;
+    glBindBuffer(GL_ARRAY_BUFFER, instanceRing.getBuffer());
+    const Mesh* currentMesh = nullptr;
+    int currentTextureSet = 0;
+    bool texturesBound = false;
+    for (const DrawBatch& batch : materialBatches) {
+        // Batches without maps ignore whatever is bound, so only real set changes rebind
+        if (bindTextures && batch.textureSet != 0 && batch.textureSet != currentTextureSet) {
+            batch.material->bindTextures();
+            currentTextureSet = batch.textureSet;
+            texturesBound = true;
+        }
+        if (batch.mesh != currentMesh) {
+            batch.mesh->bind(shader);
+            currentMesh = batch.mesh;
+        }
+        bindInstanceAttributes(batch.firstInstance);
+        batch.mesh->drawInstanced(static_cast<int>(batch.instanceCount));
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Clean up texture bindings once for the whole pass
+    if (texturesBound) {
+        Material::unbindTextures();
+    }
+}
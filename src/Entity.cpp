@@ -1,12 +1,14 @@
-
 // Entity.cpp
 #include "../include/Entity.h"
 #include "../scripts/Behaviour.h"
 
-void Entity::addComponent(std::unique_ptr<Component> component) {
-    // If it's a Behaviour, set the parent entity
-    if (auto behaviour = dynamic_cast<Behaviour*>(component.get())) {
-        behaviour->setEntity(this);
-    }
-    components.push_back(std::move(component));
-} 
\ No newline at end of file
+Behaviour* Entity::addBehaviour(std::unique_ptr<Behaviour> behaviour) {
+    // Let the behaviour find its sibling components
+    behaviour->setEntity(*this);
+    return registry->add<std::unique_ptr<Behaviour>>(id, std::move(behaviour)).get();
+}
+
+Behaviour* Entity::getBehaviour() const {
+    std::unique_ptr<Behaviour>* behaviour = getComponent<std::unique_ptr<Behaviour>>();
+    return behaviour ? behaviour->get() : nullptr;
+}
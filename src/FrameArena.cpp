@@ -0,0 +1,44 @@
+// FrameArena.cpp
+#include "../include/FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t initialCapacity) : offset(0), used(0), highWater(0) {
+    blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[initialCapacity]), initialCapacity});
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    Block* block = &blocks.back();
+    uintptr_t base = reinterpret_cast<uintptr_t>(block->memory.get());
+    size_t start = ((base + offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1)) - base;
+    if (start + size > block->size) {
+        // Overflow block, merged into one at the next reset(); new[] is aligned for any scalar type
+        used += offset;
+        const size_t blockSize = std::max(size + alignment, block->size * 2);
+        blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize});
+        block = &blocks.back();
+        base = reinterpret_cast<uintptr_t>(block->memory.get());
+        start = ((base + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1)) - base;
+    }
+    offset = start + size;
+    return block->memory.get() + start;
+}
+
+void FrameArena::reset() {
+    highWater = std::max(highWater, getUsed());
+    if (blocks.size() > 1) {
+        const size_t merged = getCapacity();
+        blocks.clear();
+        blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[merged]), merged});
+    }
+    offset = 0;
+    used = 0;
+}
+
+size_t FrameArena::getCapacity() const {
+    size_t capacity = 0;
+    for (const Block& block : blocks) {
+        capacity += block.size;
+    }
+    return capacity;
+}
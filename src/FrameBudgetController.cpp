@@ -0,0 +1,74 @@
+// FrameBudgetController.cpp
+#include "../include/FrameBudgetController.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float FILTER_WEIGHT = 0.15f;   // Weight of the newest sample in the moving average
+const float OVER_BUDGET = 1.05f;     // Scale down above 105% of the target
+const float UNDER_BUDGET = 0.80f;    // Scale up below 80% (room for one more step)
+const float AIM = 0.90f;             // When scaling down, aim at 90% of the target
+
+float quantizeDown(float scale) {
+    return std::floor(scale / FrameBudgetController::SCALE_STEP + 1e-3f) * FrameBudgetController::SCALE_STEP;
+}
+
+} // namespace
+
+bool FrameBudgetController::update(float frameTime) {
+    if (frameTime <= 0.0f) {
+        return false;
+    }
+    ++framesSinceChange;
+    if (framesSinceChange <= LATENCY_FRAMES) {
+        return false; // Still measuring frames rendered before the last change
+    }
+    filteredFrameTime = filteredFrameTime < 0.0f
+        ? frameTime
+        : filteredFrameTime + (frameTime - filteredFrameTime) * FILTER_WEIGHT;
+    if (framesSinceChange < SETTLE_FRAMES) {
+        return false;
+    }
+
+    float load = filteredFrameTime / targetFrameTime;
+    if (load > OVER_BUDGET) {
+        if (renderScale > MIN_RENDER_SCALE) {
+            // Frame cost follows the pixel count, i.e. the square of the scale
+            float desired = renderScale * std::sqrt(AIM / load);
+            float next = std::min(quantizeDown(desired), renderScale - SCALE_STEP);
+            renderScale = std::max(MIN_RENDER_SCALE, next);
+            changed();
+            return true;
+        }
+        if (cascadeReduction < MAX_CASCADE_REDUCTION) {
+            ++cascadeReduction;
+            changed();
+            return true;
+        }
+    } else if (load < UNDER_BUDGET) {
+        // Restore in reverse order: cascades first, then resolution
+        if (cascadeReduction > 0) {
+            --cascadeReduction;
+            changed();
+            return true;
+        }
+        if (renderScale < 1.0f) {
+            renderScale = std::min(1.0f, renderScale + SCALE_STEP);
+            changed();
+            return true;
+        }
+    }
+    return false;
+}
+
+void FrameBudgetController::reset() {
+    renderScale = 1.0f;
+    cascadeReduction = 0;
+    changed();
+}
+
+void FrameBudgetController::changed() {
+    framesSinceChange = 0;
+    filteredFrameTime = -1.0f;
+}
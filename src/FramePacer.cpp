@@ -0,0 +1,58 @@
+// FramePacer.cpp
+#include "../include/FramePacer.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <chrono>
+
+FramePacer::FramePacer() : frameIndex(0), lastWaitTime(0.0f) {
+    std::fill(fences, fences + MAX_FRAMES_IN_FLIGHT, nullptr);
+}
+
+FramePacer::~FramePacer() {
+    for (__GLsync* fence : fences) {
+        if (fence) {
+            glDeleteSync(fence);
+        }
+    }
+}
+
+void FramePacer::beginFrame(int framesInFlight) {
+    framesInFlight = std::max(1, std::min(framesInFlight, MAX_FRAMES_IN_FLIGHT));
+    lastWaitTime = 0.0f;
+
+    // Every frame older than this one must be done; fences signal in order, so
+    // waiting for the youngest of them covers the rest
+    if (frameIndex < static_cast<uint64_t>(framesInFlight)) {
+        return;
+    }
+    __GLsync*& fence = fences[(frameIndex - framesInFlight) % MAX_FRAMES_IN_FLIGHT];
+    if (!fence) {
+        return;
+    }
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        auto start = std::chrono::high_resolution_clock::now();
+        // Flush so the fence can signal at all, then wait in 1 ms steps
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(fence, 0, 1000000);
+        }
+        lastWaitTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        SyncMonitor::reportPacingWait(lastWaitTime);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void FramePacer::endFrame() {
+    __GLsync*& fence = fences[frameIndex % MAX_FRAMES_IN_FLIGHT];
+    if (fence) {
+        // Never waited on (the limit was raised in between); the next frame's
+        // fences cover its commands anyway
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++frameIndex;
+}
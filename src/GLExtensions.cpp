@@ -0,0 +1,228 @@
+// GLExtensions.cpp
+#include "../include/GLExtensions.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+typedef void (*DispatchComputeProc)(GLuint, GLuint, GLuint);
+typedef void (*BindImageTextureProc)(GLuint, GLuint, GLint, GLboolean, GLint, GLenum, GLenum);
+typedef void (*MemoryBarrierProc)(GLbitfield);
+typedef void (*MultiDrawElementsIndirectProc)(GLenum, GLenum, const void*, GLsizei, GLsizei);
+typedef GLuint64 (*GetTextureHandleProc)(GLuint);
+typedef void (*TextureHandleResidencyProc)(GLuint64);
+typedef void (*ProgramParameteriProc)(GLuint, GLenum, GLint);
+typedef void (*GetProgramBinaryProc)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+typedef void (*ProgramBinaryProc)(GLuint, GLenum, const void*, GLsizei);
+typedef void (*MaxShaderCompilerThreadsProc)(GLuint);
+typedef void (*BufferStorageProc)(GLenum, GLsizeiptr, const void*, GLbitfield);
+typedef void (*DebugMessageProc)(GLenum, GLenum, GLuint, GLenum, GLsizei, const GLchar*, const void*);
+typedef void (*DebugMessageCallbackProc)(DebugMessageProc, const void*);
+
+DispatchComputeProc glDispatchComputePtr = nullptr;
+BindImageTextureProc glBindImageTexturePtr = nullptr;
+MemoryBarrierProc glMemoryBarrierPtr = nullptr;
+MultiDrawElementsIndirectProc glMultiDrawElementsIndirectPtr = nullptr;
+GetTextureHandleProc glGetTextureHandlePtr = nullptr;
+TextureHandleResidencyProc glMakeTextureHandleResidentPtr = nullptr;
+TextureHandleResidencyProc glMakeTextureHandleNonResidentPtr = nullptr;
+ProgramParameteriProc glProgramParameteriPtr = nullptr;
+GetProgramBinaryProc glGetProgramBinaryPtr = nullptr;
+ProgramBinaryProc glProgramBinaryPtr = nullptr;
+BufferStorageProc glBufferStoragePtr = nullptr;
+DebugMessageCallbackProc glDebugMessageCallbackPtr = nullptr;
+GLExtensions::PerformanceMessageHandler performanceHandler = nullptr;
+
+bool isAtLeast(int major, int minor, int requiredMajor, int requiredMinor) {
+    return major > requiredMajor || (major == requiredMajor && minor >= requiredMinor);
+}
+
+void debugMessage(GLenum, GLenum type, GLuint, GLenum, GLsizei, const GLchar* message, const void*) {
+    if (type == GL_DEBUG_TYPE_PERFORMANCE && performanceHandler) {
+        performanceHandler(message);
+    }
+}
+
+} // namespace
+
+bool GLExtensions::initialized = false;
+int GLExtensions::majorVersion = 3;
+int GLExtensions::minorVersion = 3;
+bool GLExtensions::computeShaders = false;
+bool GLExtensions::multiDrawIndirect = false;
+bool GLExtensions::bindlessTextures = false;
+bool GLExtensions::programBinaries = false;
+bool GLExtensions::parallelShaderCompile = false;
+bool GLExtensions::bufferStorageSupported = false;
+bool GLExtensions::debugOutput = false;
+
+void GLExtensions::initialize() {
+    if (initialized) {
+        return;
+    }
+    initialized = true;
+
+    glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+    glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+    bool computeCore = isAtLeast(majorVersion, minorVersion, 4, 3);
+    bool computeExtensions = hasExtension("GL_ARB_compute_shader") && hasExtension("GL_ARB_shader_image_load_store");
+    if (computeCore || computeExtensions) {
+        glDispatchComputePtr = reinterpret_cast<DispatchComputeProc>(glfwGetProcAddress("glDispatchCompute"));
+        glBindImageTexturePtr = reinterpret_cast<BindImageTextureProc>(glfwGetProcAddress("glBindImageTexture"));
+        glMemoryBarrierPtr = reinterpret_cast<MemoryBarrierProc>(glfwGetProcAddress("glMemoryBarrier"));
+        computeShaders = glDispatchComputePtr && glBindImageTexturePtr && glMemoryBarrierPtr;
+    }
+
+    // GPU-driven submission: storage buffers written by compute, drawn with base instances
+    bool indirectExtensions = hasExtension("GL_ARB_shader_storage_buffer_object") &&
+                              hasExtension("GL_ARB_multi_draw_indirect") && hasExtension("GL_ARB_base_instance");
+    if (computeShaders && (computeCore || indirectExtensions)) {
+        glMultiDrawElementsIndirectPtr = reinterpret_cast<MultiDrawElementsIndirectProc>(glfwGetProcAddress("glMultiDrawElementsIndirect"));
+        multiDrawIndirect = glMultiDrawElementsIndirectPtr != nullptr;
+    }
+
+    // Bindless samplers need GLSL 4.00, so the extension alone is not enough
+    if (isAtLeast(majorVersion, minorVersion, 4, 0) && hasExtension("GL_ARB_bindless_texture")) {
+        glGetTextureHandlePtr = reinterpret_cast<GetTextureHandleProc>(glfwGetProcAddress("glGetTextureHandleARB"));
+        glMakeTextureHandleResidentPtr = reinterpret_cast<TextureHandleResidencyProc>(glfwGetProcAddress("glMakeTextureHandleResidentARB"));
+        glMakeTextureHandleNonResidentPtr = reinterpret_cast<TextureHandleResidencyProc>(glfwGetProcAddress("glMakeTextureHandleNonResidentARB"));
+        bindlessTextures = glGetTextureHandlePtr && glMakeTextureHandleResidentPtr && glMakeTextureHandleNonResidentPtr;
+    }
+
+    if (isAtLeast(majorVersion, minorVersion, 4, 1) || hasExtension("GL_ARB_get_program_binary")) {
+        glProgramParameteriPtr = reinterpret_cast<ProgramParameteriProc>(glfwGetProcAddress("glProgramParameteri"));
+        glGetProgramBinaryPtr = reinterpret_cast<GetProgramBinaryProc>(glfwGetProcAddress("glGetProgramBinary"));
+        glProgramBinaryPtr = reinterpret_cast<ProgramBinaryProc>(glfwGetProcAddress("glProgramBinary"));
+        // Some drivers expose the entry points but no format to save in
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        programBinaries = glProgramParameteriPtr && glGetProgramBinaryPtr && glProgramBinaryPtr && formats > 0;
+    }
+
+    // Let the driver use as many compiler threads as it likes
+    MaxShaderCompilerThreadsProc maxShaderCompilerThreads = nullptr;
+    if (hasExtension("GL_KHR_parallel_shader_compile")) {
+        maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    } else if (hasExtension("GL_ARB_parallel_shader_compile")) {
+        maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+    }
+    if (maxShaderCompilerThreads) {
+        maxShaderCompilerThreads(0xFFFFFFFFu);
+        parallelShaderCompile = true;
+    }
+
+    if (isAtLeast(majorVersion, minorVersion, 4, 4) || hasExtension("GL_ARB_buffer_storage")) {
+        glBufferStoragePtr = reinterpret_cast<BufferStorageProc>(glfwGetProcAddress("glBufferStorage"));
+        bufferStorageSupported = glBufferStoragePtr != nullptr;
+    }
+
+    if (isAtLeast(majorVersion, minorVersion, 4, 3) || hasExtension("GL_KHR_debug")) {
+        glDebugMessageCallbackPtr = reinterpret_cast<DebugMessageCallbackProc>(glfwGetProcAddress("glDebugMessageCallback"));
+        debugOutput = glDebugMessageCallbackPtr != nullptr;
+    }
+
+    std::cout << "OpenGL " << majorVersion << "." << minorVersion
+              << ", compute shaders: " << (computeShaders ? "available" : "unavailable")
+              << ", multi-draw-indirect: " << (multiDrawIndirect ? "available" : "unavailable")
+              << ", bindless textures: " << (bindlessTextures ? "available" : "unavailable")
+              << ", program binaries: " << (programBinaries ? "available" : "unavailable")
+              << ", parallel compile: " << (parallelShaderCompile ? "available" : "unavailable")
+              << ", buffer storage: " << (bufferStorageSupported ? "available" : "unavailable") << std::endl;
+}
+
+bool GLExtensions::hasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension && std::strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GLExtensions::dispatchCompute(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) {
+    if (glDispatchComputePtr) {
+        glDispatchComputePtr(groupsX, groupsY, groupsZ);
+    }
+}
+
+void GLExtensions::bindImageTexture(unsigned int unit, unsigned int texture, int level, bool layered,
+                                    int layer, unsigned int access, unsigned int format) {
+    if (glBindImageTexturePtr) {
+        glBindImageTexturePtr(unit, texture, level, layered ? GL_TRUE : GL_FALSE, layer, access, format);
+    }
+}
+
+void GLExtensions::memoryBarrier(unsigned int barriers) {
+    if (glMemoryBarrierPtr) {
+        glMemoryBarrierPtr(barriers);
+    }
+}
+
+void GLExtensions::multiDrawElementsIndirect(unsigned int mode, unsigned int type, intptr_t offset,
+                                             int drawCount, int stride) {
+    if (glMultiDrawElementsIndirectPtr) {
+        glMultiDrawElementsIndirectPtr(mode, type, reinterpret_cast<const void*>(offset), drawCount, stride);
+    }
+}
+
+uint64_t GLExtensions::getTextureHandle(unsigned int texture) {
+    return glGetTextureHandlePtr ? glGetTextureHandlePtr(texture) : 0;
+}
+
+void GLExtensions::makeTextureHandleResident(uint64_t handle) {
+    if (glMakeTextureHandleResidentPtr) {
+        glMakeTextureHandleResidentPtr(handle);
+    }
+}
+
+void GLExtensions::makeTextureHandleNonResident(uint64_t handle) {
+    if (glMakeTextureHandleNonResidentPtr) {
+        glMakeTextureHandleNonResidentPtr(handle);
+    }
+}
+
+void GLExtensions::programParameteri(unsigned int program, unsigned int name, int value) {
+    if (glProgramParameteriPtr) {
+        glProgramParameteriPtr(program, name, value);
+    }
+}
+
+void GLExtensions::getProgramBinary(unsigned int program, int bufferSize, int* length, unsigned int* format, void* binary) {
+    if (glGetProgramBinaryPtr) {
+        glGetProgramBinaryPtr(program, bufferSize, length, format, binary);
+    } else if (length) {
+        *length = 0;
+    }
+}
+
+void GLExtensions::programBinary(unsigned int program, unsigned int format, const void* binary, int length) {
+    if (glProgramBinaryPtr) {
+        glProgramBinaryPtr(program, format, binary, length);
+    }
+}
+
+void GLExtensions::bufferStorage(unsigned int target, intptr_t size, const void* data, unsigned int flags) {
+    if (glBufferStoragePtr) {
+        glBufferStoragePtr(target, static_cast<GLsizeiptr>(size), data, flags);
+    }
+}
+
+void GLExtensions::setPerformanceMessageHandler(PerformanceMessageHandler handler) {
+    if (!glDebugMessageCallbackPtr) {
+        return;
+    }
+    performanceHandler = handler;
+    if (handler) {
+        glDebugMessageCallbackPtr(debugMessage, nullptr);
+        glEnable(GL_DEBUG_OUTPUT);
+    } else {
+        glDisable(GL_DEBUG_OUTPUT);
+        glDebugMessageCallbackPtr(nullptr, nullptr);
+    }
+}
@@ -0,0 +1,71 @@
+// GiUpdateScheduler.cpp
+#include "../include/GiUpdateScheduler.h"
+#include <cmath>
+
+namespace {
+
+// Camera moves below these count as unchanged (world units, radians)
+const float POSITION_EPSILON = 1e-4f;
+const float ANGLE_EPSILON = 1e-4f;
+
+bool cameraMoved(const GiUpdateScheduler::FrameState& a, const GiUpdateScheduler::FrameState& b) {
+    if (glm::length(a.cameraPosition - b.cameraPosition) > POSITION_EPSILON) {
+        return true;
+    }
+    // atan2 of sine and cosine stays accurate for tiny angles, unlike acos(dot)
+    const glm::vec3 forwardA = glm::normalize(a.cameraForward);
+    const glm::vec3 forwardB = glm::normalize(b.cameraForward);
+    const float angle = std::atan2(glm::length(glm::cross(forwardA, forwardB)), glm::dot(forwardA, forwardB));
+    return angle > ANGLE_EPSILON;
+}
+
+// Fine cascades every frame, coarse ones staggered so a frame updates at most one of each phase
+unsigned int staggeredMask(int activeCascades, unsigned int frame, int interval) {
+    unsigned int mask = 0;
+    for (int i = 0; i < activeCascades; ++i) {
+        if (i < GiUpdateScheduler::FIRST_COARSE_CASCADE || (frame + i) % interval == 0) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+} // namespace
+
+unsigned int GiUpdateScheduler::update(const FrameState& state) {
+    ++frame;
+    const unsigned int allCascades = state.activeCascades >= 32 ? ~0u : (1u << state.activeCascades) - 1u;
+
+    if (!hasPrevious || state.activeCascades != previous.activeCascades ||
+        state.width != previous.width || state.height != previous.height ||
+        state.probeFarField != previous.probeFarField || state.worldSpaceRays != previous.worldSpaceRays) {
+        viewChanged = true;
+        sceneChanged = true;
+    } else {
+        viewChanged = cameraMoved(state, previous);
+        sceneChanged = state.sceneHash != previous.sceneHash ||
+                       state.lightPosition != previous.lightPosition ||
+                       state.lightColor != previous.lightColor ||
+                       state.lightRadius != previous.lightRadius ||
+                       state.localLightHash != previous.localLightHash;
+    }
+    previous = state;
+    hasPrevious = true;
+
+    if (viewChanged) {
+        unchangedFrames = 0;
+        // A full update (first frame, resize) is flagged as a scene change too and is never staggered
+        updateMask = state.probeFarField && !sceneChanged
+                         ? staggeredMask(state.activeCascades, frame, MOVING_COARSE_UPDATE_INTERVAL)
+                         : allCascades;
+    } else if (sceneChanged) {
+        unchangedFrames = 0;
+        updateMask = staggeredMask(state.activeCascades, frame, COARSE_UPDATE_INTERVAL);
+    } else if (unchangedFrames < CONVERGE_FRAMES) {
+        ++unchangedFrames;
+        updateMask = allCascades;
+    } else {
+        updateMask = 0;
+    }
+    return updateMask;
+}
@@ -0,0 +1,269 @@
+// GpuCuller.cpp
+#include "../include/GpuCuller.h"
+#include "../include/DepthPyramid.h"
+#include "../include/GLExtensions.h"
+#include "../include/Material.h"
+#include "../include/Mesh.h"
+#include "../include/Shader.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+float uintAsFloat(uint32_t value) {
+    float bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// (Re)allocate a buffer when it is too small; the contents are rewritten by the caller
+void reserveBuffer(unsigned int buffer, size_t& allocated, size_t size) {
+    if (size <= allocated) {
+        return;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    allocated = size;
+}
+
+} // namespace
+
+GpuCuller::GpuCuller(Shader& cullShader)
+    : shader(&cullShader), instanceBuffer(0), templateBuffer(0), commandBuffer(0), visibleBuffer(0),
+      instanceCount(0), instanceBytes(0), commandBytes(0), visibleBytes(0), uploadedHash(0),
+      views(), viewCount(0), culledCount(0),
+      instanceCountLocation(cullShader.getUniformLocation("instanceCount")),
+      commandBaseLocation(cullShader.getUniformLocation("commandBase")),
+      visibleBaseLocation(cullShader.getUniformLocation("visibleBase")),
+      frustumPlanesLocation(cullShader.getUniformLocation("frustumPlanes")),
+      hiZEnabledLocation(cullShader.getUniformLocation("hiZEnabled")),
+      hiZViewLocation(cullShader.getUniformLocation("hiZView")),
+      hiZProjectionLocation(cullShader.getUniformLocation("hiZProjection")) {
+    glGenBuffers(1, &instanceBuffer);
+    glGenBuffers(1, &templateBuffer);
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &visibleBuffer);
+    cullShader.use();
+    cullShader.setInt("depthPyramid", DepthPyramid::TEXTURE_UNIT);
+    glUseProgram(0);
+}
+
+GpuCuller::~GpuCuller() {
+    glDeleteBuffers(1, &instanceBuffer);
+    glDeleteBuffers(1, &templateBuffer);
+    glDeleteBuffers(1, &commandBuffer);
+    glDeleteBuffers(1, &visibleBuffer);
+}
+
+void GpuCuller::update(const std::vector<DrawBatch>& batches, const std::vector<InstanceData>& instances,
+                       const std::vector<BoundingBox>& boxes, uint64_t sceneHash) {
+    viewCount = 0;
+    culledCount = 0;
+
+    meshes.clear();
+    for (const DrawBatch& batch : batches) {
+        meshes.push_back(batch.mesh);
+    }
+    const bool arenaRebuilt = arena.update(meshes);
+    if (!arenaRebuilt && sceneHash == uploadedHash) {
+        return;
+    }
+    uploadedHash = sceneHash;
+    instanceCount = instances.size();
+
+    // Vertex format, then static before dynamic, then texture set: every multi-draw is one range
+    commandOrder.resize(batches.size());
+    std::iota(commandOrder.begin(), commandOrder.end(), 0u);
+    std::stable_sort(commandOrder.begin(), commandOrder.end(), [&](uint32_t a, uint32_t b) {
+        const DrawBatch& first = batches[a];
+        const DrawBatch& second = batches[b];
+        const int firstSegment = static_cast<int>(first.mesh->getVertexFormat());
+        const int secondSegment = static_cast<int>(second.mesh->getVertexFormat());
+        if (firstSegment != secondSegment) return firstSegment < secondSegment;
+        if (first.dynamic != second.dynamic) return second.dynamic;
+        return first.textureSet < second.textureSet;
+    });
+
+    commands.clear();
+    runs.clear();
+    cullInstances.resize(instanceCount);
+    for (uint32_t command = 0; command < commandOrder.size(); ++command) {
+        const DrawBatch& batch = batches[commandOrder[command]];
+        const MeshArena::Range& range = arena.getRange(batch.mesh);
+        commands.push_back({range.indexCount, 0, range.firstIndex, range.baseVertex, batch.firstInstance});
+
+        if (runs.empty() || runs.back().segment != range.segment || runs.back().dynamic != batch.dynamic ||
+            runs.back().textureSet != batch.textureSet) {
+            runs.push_back({range.segment, batch.dynamic, batch.textureSet, batch.material, command, 0});
+        }
+        runs.back().commandCount++;
+
+        for (unsigned int i = batch.firstInstance; i < batch.firstInstance + batch.instanceCount; ++i) {
+            CullInstance& cull = cullInstances[i];
+            cull.instance = instances[i];
+            cull.boxMin = glm::vec4(boxes[i].min, uintAsFloat(command));
+            cull.boxMax = glm::vec4(boxes[i].max, 0.0f);
+        }
+    }
+
+    SyncMonitor::Scope sync("GPU culling upload");
+    const size_t viewCommandBytes = commands.size() * sizeof(DrawCommand);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, instanceBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(cullInstances.size() * sizeof(CullInstance)),
+                 cullInstances.empty() ? nullptr : cullInstances.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, templateBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(viewCommandBytes),
+                 commands.empty() ? nullptr : commands.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    instanceBytes = cullInstances.size() * sizeof(CullInstance);
+    reserveBuffer(commandBuffer, commandBytes, viewCommandBytes * MAX_VIEWS);
+    reserveBuffer(visibleBuffer, visibleBytes, instanceCount * sizeof(InstanceData) * MAX_VIEWS);
+}
+
+int GpuCuller::addView(const Frustum& frustum, const HiZOcclusion* hiZ) {
+    if (viewCount == MAX_VIEWS) {
+        return -1;
+    }
+    View& view = views[viewCount];
+    for (int i = 0; i < 6; ++i) {
+        view.planes[i] = frustum.getPlane(i);
+    }
+    view.occlusion = hiZ != nullptr;
+    if (hiZ) {
+        view.hiZ = *hiZ;
+    }
+    return viewCount++;
+}
+
+void GpuCuller::dispatch(unsigned int callerProgram) {
+    if (culledCount == viewCount) {
+        return;
+    }
+    if (instanceCount == 0 || commands.empty()) {
+        culledCount = viewCount;
+        return;
+    }
+
+    // Each view starts from the template's empty instance counts
+    const size_t viewCommandBytes = commands.size() * sizeof(DrawCommand);
+    glBindBuffer(GL_COPY_READ_BUFFER, templateBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, commandBuffer);
+    for (int view = culledCount; view < viewCount; ++view) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                            static_cast<GLintptr>(view * viewCommandBytes), static_cast<GLsizeiptr>(viewCommandBytes));
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    shader->use();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, visibleBuffer);
+    shader->setInt(instanceCountLocation, static_cast<int>(instanceCount));
+    const unsigned int groups = static_cast<unsigned int>((instanceCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE);
+    for (int view = culledCount; view < viewCount; ++view) {
+        const View& record = views[view];
+        shader->setInt(commandBaseLocation, view * static_cast<int>(commands.size()));
+        shader->setInt(visibleBaseLocation, view * static_cast<int>(instanceCount));
+        shader->setVec4Array(frustumPlanesLocation, record.planes, 6);
+        shader->setBool(hiZEnabledLocation, record.occlusion);
+        if (record.occlusion) {
+            shader->setMat4(hiZViewLocation, record.hiZ.view);
+            shader->setMat4(hiZProjectionLocation, record.hiZ.projection);
+            record.hiZ.pyramid->bindForSampling(*shader);
+        }
+        GLExtensions::dispatchCompute(groups, 1, 1);
+    }
+    // The draws read the commands and the visible instances as vertex attributes
+    GLExtensions::memoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    glUseProgram(callerProgram);
+    culledCount = viewCount;
+}
+
+void GpuCuller::bindVisibleInstances(int view) const {
+    glBindBuffer(GL_ARRAY_BUFFER, visibleBuffer);
+    DrawBatcher::setInstanceAttributes(static_cast<size_t>(view) * instanceCount * sizeof(InstanceData));
+}
+
+void GpuCuller::drawCommands(int view, uint32_t firstCommand, uint32_t commandCount) const {
+    const size_t command = static_cast<size_t>(view) * commands.size() + firstCommand;
+    GLExtensions::multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                            static_cast<intptr_t>(command * sizeof(DrawCommand)),
+                                            static_cast<int>(commandCount), 0);
+}
+
+void GpuCuller::drawDepth(const Shader& shader, BatchFilter filter, int view) {
+    dispatch(shader.ID);
+    if (commands.empty()) {
+        return;
+    }
+    auto included = [filter](const Run& run) {
+        return !((filter == BatchFilter::Static && run.dynamic) || (filter == BatchFilter::Dynamic && !run.dynamic));
+    };
+
+    // Depth passes ignore texture sets, so runs merge up to the vertex format (and filter) boundaries
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    size_t i = 0;
+    while (i < runs.size()) {
+        const Run& run = runs[i];
+        if (!included(run)) {
+            ++i;
+            continue;
+        }
+        uint32_t commandCount = run.commandCount;
+        size_t next = i + 1;
+        while (next < runs.size() && runs[next].segment == run.segment && included(runs[next])) {
+            commandCount += runs[next].commandCount;
+            ++next;
+        }
+        arena.bind(run.segment, shader);
+        bindVisibleInstances(view);
+        drawCommands(view, run.firstCommand, commandCount);
+        i = next;
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GpuCuller::drawMaterials(const Shader& shader, int view, bool bindTextures) {
+    dispatch(shader.ID);
+    if (commands.empty()) {
+        return;
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    int currentSegment = -1;
+    int currentTextureSet = 0;
+    bool texturesBound = false;
+    for (const Run& run : runs) {
+        // Runs without maps ignore whatever is bound, so only real set changes rebind
+        if (bindTextures && run.textureSet != 0 && run.textureSet != currentTextureSet) {
+            run.material->bindTextures();
+            currentTextureSet = run.textureSet;
+            texturesBound = true;
+        }
+        if (run.segment != currentSegment) {
+            arena.bind(run.segment, shader);
+            bindVisibleInstances(view);
+            currentSegment = run.segment;
+        }
+        drawCommands(view, run.firstCommand, run.commandCount);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    if (texturesBound) {
+        Material::unbindTextures();
+    }
+}
+
+size_t GpuCuller::getMemoryUsage() const {
+    return instanceBytes + commands.size() * sizeof(DrawCommand) + commandBytes + visibleBytes +
+           arena.getMemoryUsage();
+}
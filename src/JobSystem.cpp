@@ -0,0 +1,257 @@
+// JobSystem.cpp
+#include "../include/JobSystem.h"
+#include <algorithm>
+
+namespace {
+
+// Which system and queue the current thread works for (-1 = not a worker)
+thread_local const JobSystem* currentSystem = nullptr;
+thread_local int currentWorker = -1;
+
+/**
+ * Free list of the blocks batches are allocated from; the last reference to
+ * a batch may be dropped on any thread, hence the lock
+ */
+class BlockPool {
+public:
+    static const size_t BLOCK_SIZE = 128;
+
+    void* allocate(size_t size) {
+        if (size > BLOCK_SIZE) {
+            return ::operator new(size);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeList) {
+            return ::operator new(BLOCK_SIZE);
+        }
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        return block;
+    }
+
+    void deallocate(void* memory, size_t size) {
+        if (size > BLOCK_SIZE) {
+            ::operator delete(memory);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        FreeBlock* block = static_cast<FreeBlock*>(memory);
+        block->next = freeList;
+        freeList = block;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    std::mutex mutex;
+    FreeBlock* freeList = nullptr;
+};
+
+BlockPool& batchPool() {
+    static BlockPool* pool = new BlockPool(); // Never destroyed: handles may outlive every JobSystem
+    return *pool;
+}
+
+template <typename T>
+struct BatchAllocator {
+    typedef T value_type;
+
+    BatchAllocator() = default;
+    template <typename U>
+    BatchAllocator(const BatchAllocator<U>&) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(batchPool().allocate(sizeof(T) * count)); }
+    void deallocate(T* memory, size_t count) { batchPool().deallocate(memory, sizeof(T) * count); }
+
+    template <typename U>
+    bool operator==(const BatchAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const BatchAllocator<U>&) const { return false; }
+};
+
+} // namespace
+
+JobSystem::JobSystem(unsigned int workerCount) : nextQueue(0), queuedTasks(0), stopping(false) {
+    if (workerCount == 0) {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+    for (unsigned int i = 0; i <= workerCount; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, static_cast<int>(i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    // Jobs queued by the last running jobs after the workers saw an empty queue
+    while (runOne(currentQueue())) {
+    }
+}
+
+std::shared_ptr<JobSystem::Batch> JobSystem::createBatch(int chunks) {
+    std::shared_ptr<Batch> batch = std::allocate_shared<Batch>(BatchAllocator<Batch>());
+    batch->remaining.store(chunks, std::memory_order_relaxed);
+    return batch;
+}
+
+JobHandle JobSystem::handleOf(const std::shared_ptr<Batch>& batch) {
+    JobHandle handle;
+    handle.remaining = std::shared_ptr<std::atomic<int>>(batch, &batch->remaining);
+    return handle;
+}
+
+JobHandle JobSystem::submit(Job job) {
+    std::shared_ptr<Batch> batch = createBatch(1);
+    Task task;
+    task.job = std::move(job);
+    task.batch = batch;
+    push(std::move(task));
+    return handleOf(batch);
+}
+
+JobHandle JobSystem::parallelFor(size_t count, size_t grainSize, const RangeJob& job) {
+    if (count == 0) {
+        return JobHandle();
+    }
+    grainSize = std::max<size_t>(1, grainSize);
+    size_t chunks = (count + grainSize - 1) / grainSize;
+    std::shared_ptr<Batch> batch = createBatch(static_cast<int>(chunks));
+    batch->range = job;
+    for (size_t begin = 0; begin < count; begin += grainSize) {
+        Task task;
+        task.begin = begin;
+        task.end = std::min(count, begin + grainSize);
+        task.batch = batch;
+        push(std::move(task));
+    }
+    return handleOf(batch);
+}
+
+void JobSystem::wait(const JobHandle& handle) {
+    int self = currentQueue();
+    while (!handle.isDone()) {
+        if (!runOne(self)) {
+            // The remaining jobs are running on other threads
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::push(Task task) {
+    int target = currentQueue();
+    if (target == static_cast<int>(queues.size()) - 1) {
+        // Outside thread: spread the work so every worker finds some in its own queue
+        target = static_cast<int>(nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size());
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->pushBack(std::move(task));
+    }
+    queuedTasks.fetch_add(1, std::memory_order_release);
+    {
+        // Taking the lock orders the increment against a worker that is about to sleep
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    taskAvailable.notify_one();
+}
+
+bool JobSystem::runOne(int self) {
+    Task task;
+    if (!popTask(self, task)) {
+        return false;
+    }
+    if (task.job) {
+        task.job();
+    } else {
+        task.batch->range(task.begin, task.end);
+    }
+    task.batch->remaining.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+bool JobSystem::popTask(int self, Task& task) {
+    // Own queue from the back (newest first)
+    {
+        WorkQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.popBack(task)) {
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    // Steal from the front of the others (oldest first)
+    int queueCount = static_cast<int>(queues.size());
+    for (int i = 1; i < queueCount; ++i) {
+        WorkQueue& victim = *queues[(self + i) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.popFront(task)) {
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::WorkQueue::pushBack(Task task) {
+    if (count == tasks.size()) {
+        std::vector<Task> grown(std::max<size_t>(16, tasks.size() * 2));
+        for (size_t i = 0; i < count; ++i) {
+            grown[i] = std::move(tasks[(head + i) % tasks.size()]);
+        }
+        tasks.swap(grown);
+        head = 0;
+    }
+    tasks[(head + count) % tasks.size()] = std::move(task);
+    ++count;
+}
+
+bool JobSystem::WorkQueue::popBack(Task& task) {
+    if (count == 0) {
+        return false;
+    }
+    --count;
+    task = std::move(tasks[(head + count) % tasks.size()]);
+    return true;
+}
+
+bool JobSystem::WorkQueue::popFront(Task& task) {
+    if (count == 0) {
+        return false;
+    }
+    task = std::move(tasks[head]);
+    head = (head + 1) % tasks.size();
+    --count;
+    return true;
+}
+
+int JobSystem::currentQueue() const {
+    // Outside threads share the last queue
+    return currentSystem == this && currentWorker >= 0 ? currentWorker : static_cast<int>(queues.size()) - 1;
+}
+
+void JobSystem::workerLoop(int index) {
+    currentSystem = this;
+    currentWorker = index;
+    while (true) {
+        if (runOne(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        taskAvailable.wait(lock, [this]() { return stopping || queuedTasks.load(std::memory_order_acquire) > 0; });
+        if (stopping && queuedTasks.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,190 @@
+// LightClusters.cpp
+#include "../include/LightClusters.h"
+#include "../include/Shader.h"
+#include "../include/Bounds.h"
+#include "../include/FrameArena.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// The soft attenuation is exactly zero beyond this multiple of the radius
+const float RANGE_SCALE = 3.0f;
+
+// Buffer words per light record: position, range, color, pad
+const int LIGHT_WORDS = 8;
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// FNV-1a, as for DrawBatcher's scene hash
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+int tileOf(float ndc, int tiles) {
+    return std::max(0, std::min(static_cast<int>((ndc * 0.5f + 0.5f) * tiles), tiles - 1));
+}
+
+/**
+ * Cluster range one light touches (inclusive)
+ */
+struct ClusterBounds {
+    int x0, x1, y0, y1, z0, z1;
+};
+
+} // namespace
+
+LightClusters::LightClusters()
+    : buffer(0), texture(0), clusterCounts(CLUSTER_COUNT, 0), lightCount(0), visibleCount(0),
+      maxClusterLights(0), lightHash(0) {
+    glGenBuffers(1, &buffer);
+    glGenTextures(1, &texture);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(uint32_t) * CLUSTER_COUNT * 2, nullptr, GL_STREAM_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+LightClusters::~LightClusters() {
+    glDeleteTextures(1, &texture);
+    glDeleteBuffers(1, &buffer);
+}
+
+void LightClusters::build(const std::vector<Light>& lights, const glm::mat4& view, const glm::mat4& projection,
+                          float nearPlane, float farPlane, FrameArena& arena) {
+    lightCount = std::min(static_cast<int>(lights.size()), MAX_LIGHTS);
+    lightHash = 14695981039346656037ull;
+    for (int i = 0; i < lightCount; ++i) {
+        lightHash = hashBytes(lightHash, &lights[i], sizeof(Light));
+    }
+
+    // Pass 1: the cluster range of every light that reaches the view
+    const Frustum frustum(projection * view);
+    const float sliceScale = SLICES / std::log(farPlane / nearPlane);
+    auto sliceOf = [&](float depth) {
+        int slice = static_cast<int>(std::log(std::max(depth, nearPlane) / nearPlane) * sliceScale);
+        return std::max(0, std::min(slice, SLICES - 1));
+    };
+    FrameArena::Vector<std::pair<int, ClusterBounds>> visible = arena.makeVector<std::pair<int, ClusterBounds>>();
+    visible.reserve(lightCount);
+    std::fill(clusterCounts.begin(), clusterCounts.end(), 0);
+    for (int i = 0; i < lightCount; ++i) {
+        const Light& light = lights[i];
+        const float range = light.radius * RANGE_SCALE;
+        if (range <= 0.0f || light.color == glm::vec3(0.0f)) {
+            continue;
+        }
+        BoundingSphere sphere;
+        sphere.center = light.position;
+        sphere.radius = range;
+        if (!frustum.intersects(sphere)) {
+            continue;
+        }
+
+        const glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        const float depth = -center.z;
+        ClusterBounds bounds;
+        bounds.z0 = sliceOf(depth - range);
+        bounds.z1 = sliceOf(std::min(depth + range, farPlane));
+        if (depth - range <= nearPlane) {
+            // The projection of a sphere reaching the near plane is unbounded
+            bounds.x0 = 0;
+            bounds.x1 = TILES_X - 1;
+            bounds.y0 = 0;
+            bounds.y1 = TILES_Y - 1;
+        } else {
+            // Every corner of the view-space box is in front of the camera, so their
+            // projections bound the sphere's
+            glm::vec2 ndcMin(1.0f), ndcMax(-1.0f);
+            for (int corner = 0; corner < 8; ++corner) {
+                glm::vec3 offset((corner & 1) ? range : -range, (corner & 2) ? range : -range,
+                                 (corner & 4) ? range : -range);
+                glm::vec4 clip = projection * glm::vec4(center + offset, 1.0f);
+                glm::vec2 ndc = glm::vec2(clip) / clip.w;
+                ndcMin = glm::min(ndcMin, ndc);
+                ndcMax = glm::max(ndcMax, ndc);
+            }
+            bounds.x0 = tileOf(ndcMin.x, TILES_X);
+            bounds.x1 = tileOf(ndcMax.x, TILES_X);
+            bounds.y0 = tileOf(ndcMin.y, TILES_Y);
+            bounds.y1 = tileOf(ndcMax.y, TILES_Y);
+        }
+
+        for (int z = bounds.z0; z <= bounds.z1; ++z) {
+            for (int y = bounds.y0; y <= bounds.y1; ++y) {
+                for (int x = bounds.x0; x <= bounds.x1; ++x) {
+                    ++clusterCounts[(z * TILES_Y + y) * TILES_X + x];
+                }
+            }
+        }
+        visible.emplace_back(i, bounds);
+    }
+    visibleCount = static_cast<int>(visible.size());
+
+    // Pass 2: header (first index, count) per cluster, then the light records
+    const size_t lightBase = static_cast<size_t>(CLUSTER_COUNT) * 2;
+    const size_t indexBase = lightBase + static_cast<size_t>(lightCount) * LIGHT_WORDS;
+    size_t indexCount = 0;
+    for (int count : clusterCounts) {
+        indexCount += count;
+    }
+    data.assign(indexBase + indexCount, 0);
+
+    maxClusterLights = 0;
+    uint32_t next = static_cast<uint32_t>(indexBase);
+    for (int cluster = 0; cluster < CLUSTER_COUNT; ++cluster) {
+        data[cluster * 2] = next;
+        next += clusterCounts[cluster];
+        maxClusterLights = std::max(maxClusterLights, clusterCounts[cluster]);
+    }
+    for (int i = 0; i < lightCount; ++i) {
+        uint32_t* record = &data[lightBase + static_cast<size_t>(i) * LIGHT_WORDS];
+        record[0] = floatBits(lights[i].position.x);
+        record[1] = floatBits(lights[i].position.y);
+        record[2] = floatBits(lights[i].position.z);
+        record[3] = floatBits(lights[i].radius);
+        record[4] = floatBits(lights[i].color.r);
+        record[5] = floatBits(lights[i].color.g);
+        record[6] = floatBits(lights[i].color.b);
+    }
+
+    // Pass 3: fill the index lists, counting each cluster up again from zero
+    for (const auto& entry : visible) {
+        const ClusterBounds& bounds = entry.second;
+        for (int z = bounds.z0; z <= bounds.z1; ++z) {
+            for (int y = bounds.y0; y <= bounds.y1; ++y) {
+                for (int x = bounds.x0; x <= bounds.x1; ++x) {
+                    const int cluster = (z * TILES_Y + y) * TILES_X + x;
+                    data[data[cluster * 2] + data[cluster * 2 + 1]++] = static_cast<uint32_t>(entry.first);
+                }
+            }
+        }
+    }
+
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    SyncMonitor::Scope sync("light cluster upload");
+    glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(data.size() * sizeof(uint32_t)), data.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void LightClusters::bindForSampling(Shader& shader) const {
+    shader.setInt("localLightCount", visibleCount);
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glActiveTexture(GL_TEXTURE0);
+}
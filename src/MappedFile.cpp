@@ -0,0 +1,88 @@
+// MappedFile.cpp
+#include "../include/MappedFile.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            std::cerr << "Failed to mmap " << path << std::endl;
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        // Loaders read front to back
+        madvise(address, length, MADV_SEQUENTIAL);
+        bytes = static_cast<const char*>(address);
+        mapped = true;
+    }
+    ::close(fd); // The mapping keeps the file alive
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    length = static_cast<size_t>(file.tellg());
+    fallbackBuffer.resize(length);
+    file.seekg(0);
+    if (length > 0 && !file.read(fallbackBuffer.data(), static_cast<std::streamsize>(length))) {
+        fallbackBuffer.clear();
+        length = 0;
+        return false;
+    }
+    bytes = length > 0 ? fallbackBuffer.data() : nullptr;
+#endif
+
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (mapped && bytes) {
+        munmap(const_cast<char*>(bytes), length);
+    }
+#endif
+    bytes = nullptr;
+    length = 0;
+    opened = false;
+    mapped = false;
+    fallbackBuffer.clear();
+}
+
+bool MappedFile::getFileStamp(const std::string& path, uint64_t& size, int64_t& modificationTime) {
+    std::error_code error;
+    auto fileSize = std::filesystem::file_size(path, error);
+    if (error) return false;
+    auto writeTime = std::filesystem::last_write_time(path, error);
+    if (error) return false;
+    size = static_cast<uint64_t>(fileSize);
+    modificationTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    return true;
+}
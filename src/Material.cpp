@@ -1,4 +1,7 @@
 #include "../include/Material.h"
+#include "../include/TextureStreamer.h"
+#include "../include/GLExtensions.h"
+#include <cstdio>
 #include <iostream>
 #include <OpenGL/gl3.h>
 
@@ -7,14 +10,18 @@
 #include "stb_image.h"
 
 // Texture implementation
-Texture::Texture() : id(0), width(0), height(0), nrChannels(0) {}
+Texture::Texture() : id(0), width(0), height(0), nrChannels(0), resident(false), bindlessHandle(0) {}
 
 Texture::Texture(const std::string& path, const std::string& type) 
-    : type(type), path(path), width(0), height(0), nrChannels(0) {
+    : id(0), type(type), path(path), width(0), height(0), nrChannels(0), resident(false), bindlessHandle(0) {
     loadFromFile(path);
 }
 
 Texture::~Texture() {
+    TextureStreamer::instance().cancel(this);
+    if (bindlessHandle != 0) {
+        GLExtensions::makeTextureHandleNonResident(bindlessHandle);
+    }
     if (id != 0) {
         glDeleteTextures(1, &id);
     }
@@ -50,6 +57,7 @@ bool Texture::loadFromFile(const std::string& path) {
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
         
+        resident = true;
         std::cout << "Loaded texture: " << path << " (" << width << "x" << height << ", " << nrChannels << " channels)" << std::endl;
     } else {
         std::cerr << "Failed to load texture: " << path << std::endl;
@@ -62,6 +70,41 @@ bool Texture::loadFromFile(const std::string& path) {
     return true;
 }
 
+bool Texture::loadAsync(const std::string& path, TextureUsage usage) {
+    this->path = path;
+    
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    fclose(file);
+    
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    
+    // Neutral 1x1 placeholder so the material renders sensibly until the real image arrives
+    unsigned char placeholder[4] = {255, 255, 255, 255};
+    if (usage == TextureUsage::Normal) {
+        placeholder[0] = 128;
+        placeholder[1] = 128;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    width = 1;
+    height = 1;
+    nrChannels = 4;
+    resident = false;
+    TextureStreamer::instance().request(this, path, usage);
+    return true;
+}
+
 void Texture::bind(unsigned int unit) const {
     glActiveTexture(GL_TEXTURE0 + unit);
     glBindTexture(GL_TEXTURE_2D, id);
@@ -71,6 +114,16 @@ void Texture::unbind() const {
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+uint64_t Texture::getBindlessHandle() {
+    if (bindlessHandle == 0 && resident && id != 0 && GLExtensions::hasBindlessTextures()) {
+        bindlessHandle = GLExtensions::getTextureHandle(id);
+        if (bindlessHandle != 0) {
+            GLExtensions::makeTextureHandleResident(bindlessHandle);
+        }
+    }
+    return bindlessHandle;
+}
+
 // Material implementation
 Material::Material() {
     initializeDefaults();
@@ -120,52 +173,47 @@ void Material::initializeDefaults() {
 bool Material::loadPBRMaterial(const std::string& baseName) {
     bool success = true;
     
+    // Textures stream in asynchronously; only a missing file is reported here
+    auto requestTexture = [](const std::string& path, TextureUsage usage) -> Texture* {
+        Texture* texture = new Texture();
+        if (!texture->loadAsync(path, usage)) {
+            delete texture;
+            return nullptr;
+        }
+        return texture;
+    };
+    
     // Try to load albedo/base color
-    std::string albedoPath = "textures/" + baseName + "_basecolor.jpg";
-    albedoMap = new Texture();
-    if (!albedoMap->loadFromFile(albedoPath)) {
+    albedoMap = requestTexture("textures/" + baseName + "_basecolor.jpg", TextureUsage::Color);
+    if (!albedoMap) {
         // Try alternative naming
-        albedoPath = "textures/" + baseName + "_albedo.jpg";
-        if (!albedoMap->loadFromFile(albedoPath)) {
-            delete albedoMap;
-            albedoMap = nullptr;
+        albedoMap = requestTexture("textures/" + baseName + "_albedo.jpg", TextureUsage::Color);
+        if (!albedoMap) {
             std::cout << "Warning: Could not load albedo map for " << baseName << std::endl;
         }
     }
     
     // Try to load normal map
-    std::string normalPath = "textures/" + baseName + "_normal.jpg";
-    normalMap = new Texture();
-    if (!normalMap->loadFromFile(normalPath)) {
-        delete normalMap;
-        normalMap = nullptr;
+    normalMap = requestTexture("textures/" + baseName + "_normal.jpg", TextureUsage::Normal);
+    if (!normalMap) {
         std::cout << "Warning: Could not load normal map for " << baseName << std::endl;
     }
     
     // Try to load roughness map
-    std::string roughnessPath = "textures/" + baseName + "_roughness.jpg";
-    roughnessMap = new Texture();
-    if (!roughnessMap->loadFromFile(roughnessPath)) {
-        delete roughnessMap;
-        roughnessMap = nullptr;
+    roughnessMap = requestTexture("textures/" + baseName + "_roughness.jpg", TextureUsage::Grayscale);
+    if (!roughnessMap) {
         std::cout << "Warning: Could not load roughness map for " << baseName << std::endl;
     }
     
     // Try to load ambient occlusion map
-    std::string aoPath = "textures/" + baseName + "_ambientOcclusion.jpg";
-    aoMap = new Texture();
-    if (!aoMap->loadFromFile(aoPath)) {
-        delete aoMap;
-        aoMap = nullptr;
+    aoMap = requestTexture("textures/" + baseName + "_ambientOcclusion.jpg", TextureUsage::Grayscale);
+    if (!aoMap) {
         std::cout << "Warning: Could not load AO map for " << baseName << std::endl;
     }
     
     // Try to load height map
-    std::string heightPath = "textures/" + baseName + "_height.png";
-    heightMap = new Texture();
-    if (!heightMap->loadFromFile(heightPath)) {
-        delete heightMap;
-        heightMap = nullptr;
+    heightMap = requestTexture("textures/" + baseName + "_height.png", TextureUsage::Grayscale);
+    if (!heightMap) {
         std::cout << "Warning: Could not load height map for " << baseName << std::endl;
     }
     
@@ -199,66 +247,20 @@ void Material::bindTextures() const {
     }
 }
 
-void Material::unbindTextures() const {
+void Material::unbindTextures() {
     for (int i = 0; i < 7; ++i) { // Updated to include emissionMap
         glActiveTexture(GL_TEXTURE0 + i);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
 }
 
-void Material::setUniforms(unsigned int shaderId) const {
-    // Use OpenGL uniform functions directly instead of creating a Shader object
-    
-    // Set material properties
-    glUniform1i(glGetUniformLocation(shaderId, "hasMaterial"), true);
-    glUniform3fv(glGetUniformLocation(shaderId, "materialBaseColor"), 1, &baseColor[0]);
-    glUniform1f(glGetUniformLocation(shaderId, "materialRoughness"), roughness);
-    glUniform1f(glGetUniformLocation(shaderId, "materialMetallic"), metallic);
-    glUniform1f(glGetUniformLocation(shaderId, "materialAO"), ambientOcclusion);
-    glUniform3fv(glGetUniformLocation(shaderId, "materialEmission"), 1, &emission[0]);
-    
-    // Set texture flags and bind textures
-    glUniform1i(glGetUniformLocation(shaderId, "hasAlbedoMap"), albedoMap != nullptr);
-    glUniform1i(glGetUniformLocation(shaderId, "hasNormalMap"), normalMap != nullptr);
-    glUniform1i(glGetUniformLocation(shaderId, "hasRoughnessMap"), roughnessMap != nullptr);
-    glUniform1i(glGetUniformLocation(shaderId, "hasMetallicMap"), metallicMap != nullptr);
-    glUniform1i(glGetUniformLocation(shaderId, "hasAOMap"), aoMap != nullptr);
-    glUniform1i(glGetUniformLocation(shaderId, "hasHeightMap"), heightMap != nullptr);
-    glUniform1i(glGetUniformLocation(shaderId, "hasEmissionMap"), emissionMap != nullptr);
-    
-    // Set texture coordinate scaling for tiling
-    glUniform2fv(glGetUniformLocation(shaderId, "materialTiling"), 1, &tiling[0]);
-    
-    // Set parallax mapping parameters
-    glUniform1f(glGetUniformLocation(shaderId, "heightScale"), heightScale);
-    
-    // Bind textures and set samplers
-    if (albedoMap) {
-        glUniform1i(glGetUniformLocation(shaderId, "albedoMap"), 0);
-        albedoMap->bind(0);
-    }
-    if (normalMap) {
-        glUniform1i(glGetUniformLocation(shaderId, "normalMap"), 1);
-        normalMap->bind(1);
-    }
-    if (roughnessMap) {
-        glUniform1i(glGetUniformLocation(shaderId, "roughnessMap"), 2);
-        roughnessMap->bind(2);
-    }
-    if (metallicMap) {
-        glUniform1i(glGetUniformLocation(shaderId, "metallicMap"), 3);
-        metallicMap->bind(3);
-    }
-    if (aoMap) {
-        glUniform1i(glGetUniformLocation(shaderId, "aoMap"), 4);
-        aoMap->bind(4);
-    }
-    if (heightMap) {
-        glUniform1i(glGetUniformLocation(shaderId, "heightMap"), 5);
-        heightMap->bind(5);
-    }
-    if (emissionMap) {
-        glUniform1i(glGetUniformLocation(shaderId, "emissionMap"), 6);
-        emissionMap->bind(6);
-    }
-} 
\ No newline at end of file
+void Material::setSamplerUnits(const Shader& shader) {
+    // Same units as bindTextures()
+    shader.setInt("albedoMap", 0);
+    shader.setInt("normalMap", 1);
+    shader.setInt("roughnessMap", 2);
+    shader.setInt("metallicMap", 3);
+    shader.setInt("aoMap", 4);
+    shader.setInt("heightMap", 5);
+    shader.setInt("emissionMap", 6);
+}
@@ -0,0 +1,133 @@
+// MaterialTable.cpp
+#include "../include/MaterialTable.h"
+#include "../include/Material.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <cstring>
+
+namespace {
+
+const int WORDS_PER_RECORD = MaterialTable::RECORD_TEXELS * 4;
+
+// Map flags, must match gbuffer_surface.glsl (map i is bit i + 1)
+const uint32_t HAS_MATERIAL = 1u;
+
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+} // namespace
+
+MaterialTable::MaterialTable() : buffer(0), texture(0), bindless(false), frame(0), textureSetCount(0) {
+    glGenBuffers(1, &buffer);
+    glGenTextures(1, &texture);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(uint32_t) * WORDS_PER_RECORD, nullptr, GL_DYNAMIC_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32UI, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    begin();
+}
+
+MaterialTable::~MaterialTable() {
+    glDeleteTextures(1, &texture);
+    glDeleteBuffers(1, &buffer);
+}
+
+void MaterialTable::begin() {
+    data.assign(WORDS_PER_RECORD, 0);
+    textureSets.assign(1, 0);
+    // Entries of earlier frames stay in the maps and count as absent, so a steady
+    // scene finds every node already there instead of reallocating it each frame
+    ++frame;
+    textureSetCount = 0;
+}
+
+int MaterialTable::add(const Material* material) {
+    if (!material) {
+        return 0;
+    }
+    Entry& entry = indices[material];
+    if (entry.frame == frame) {
+        return entry.index;
+    }
+    if (getMaterialCount() >= MAX_MATERIALS) {
+        return 0;
+    }
+
+    const int index = getMaterialCount();
+    entry = {frame, index};
+    data.resize(data.size() + WORDS_PER_RECORD, 0);
+    uint32_t* record = &data[static_cast<size_t>(index) * WORDS_PER_RECORD];
+    record[0] = floatBits(material->baseColor.r);
+    record[1] = floatBits(material->baseColor.g);
+    record[2] = floatBits(material->baseColor.b);
+    record[3] = floatBits(material->roughness);
+    record[4] = floatBits(material->emission.r);
+    record[5] = floatBits(material->emission.g);
+    record[6] = floatBits(material->emission.b);
+    record[7] = floatBits(material->metallic);
+    record[8] = floatBits(material->tiling.x);
+    record[9] = floatBits(material->tiling.y);
+    record[10] = floatBits(material->heightScale);
+    record[11] = floatBits(material->ambientOcclusion);
+
+    // Same order as Material::setSamplerUnits()
+    Texture* const maps[7] = {material->albedoMap, material->normalMap, material->roughnessMap,
+                              material->metallicMap, material->aoMap, material->heightMap,
+                              material->emissionMap};
+    uint32_t flags = HAS_MATERIAL;
+    MapSet mapSet;
+    bool hasMaps = false;
+    for (int slot = 0; slot < 7; ++slot) {
+        mapSet[slot] = nullptr;
+        if (!maps[slot]) {
+            continue;
+        }
+        if (bindless) {
+            // Streaming textures have no handle yet; their map stays off until one exists
+            const uint64_t handle = maps[slot]->getBindlessHandle();
+            if (!handle) {
+                continue;
+            }
+            record[16 + slot * 2] = static_cast<uint32_t>(handle);
+            record[16 + slot * 2 + 1] = static_cast<uint32_t>(handle >> 32);
+        }
+        flags |= 2u << slot;
+        mapSet[slot] = maps[slot];
+        hasMaps = true;
+    }
+    record[12] = flags;
+
+    int textureSet = 0;
+    if (hasMaps) {
+        Entry& set = textureSetIds[mapSet];
+        if (set.frame != frame) {
+            set = {frame, ++textureSetCount};
+        }
+        textureSet = set.index;
+    }
+    textureSets.push_back(textureSet);
+    return index;
+}
+
+void MaterialTable::upload() {
+    if (data == uploaded) {
+        return;
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+    SyncMonitor::Scope sync("material table upload");
+    glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(data.size() * sizeof(uint32_t)), data.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    uploaded = data;
+}
+
+void MaterialTable::bindForSampling() const {
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glActiveTexture(GL_TEXTURE0);
+}
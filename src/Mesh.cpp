@@ -1,52 +1,577 @@
-
 // Mesh.cpp
 #include "../include/Mesh.h"
+#include "../include/MeshCache.h"
+#include "../include/MeshSimplifier.h"
+#include "../include/MeshStreamer.h"
+#include "../include/ObjParser.h"
+#include "../include/Shader.h"
 #include <GLFW/glfw3.h> // For OpenGL
 #include <OpenGL/gl3.h>
 #include <vector>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <fstream>
-#include <sstream>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <unordered_map>
+
+namespace {
+
+// Next Mesh::getSerial()
+uint64_t nextSerial = 1;
+
+// Quantized GPU vertex for VertexFormat::Packed (see Mesh.h)
+struct PackedVertex {
+    uint16_t position[4];   // half xyz, w = bitangent sign
+    int16_t normal[2];      // octahedral, snorm16
+    uint16_t texCoords[2];  // half
+    int16_t tangent[2];     // octahedral, snorm16
+};
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex must stay tightly packed");
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if (((bits >> 23) & 0xFFu) == 0xFFu) {
+        return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u)); // Inf / NaN
+    }
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00u); // Overflow to infinity
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign); // Too small, flush to zero
+        }
+        // Subnormal half
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1u) half++; // Round to nearest
+        return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000u) half++; // Round to nearest (may carry into the exponent, which is correct)
+    return static_cast<uint16_t>(half);
+}
+
+int16_t toSnorm16(float value) {
+    float clamped = std::max(-1.0f, std::min(1.0f, value));
+    return static_cast<int16_t>(std::lround(clamped * 32767.0f));
+}
+
+// Octahedral encoding of a unit vector into [-1, 1]^2
+glm::vec2 octEncode(glm::vec3 n) {
+    float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (sum <= 0.0f) {
+        return glm::vec2(0.0f, 0.0f); // Degenerate vector, decodes to +Z
+    }
+    n /= sum;
+    glm::vec2 p(n.x, n.y);
+    if (n.z < 0.0f) {
+        glm::vec2 signs(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+        p = (glm::vec2(1.0f) - glm::vec2(std::abs(p.y), std::abs(p.x))) * signs;
+    }
+    return p;
+}
+
+PackedVertex packVertex(const Vertex& v) {
+    PackedVertex packed;
+    // Bitangent is not stored, only which side of cross(N, T) it lies on
+    float handedness = glm::dot(glm::cross(v.Normal, v.Tangent), v.Bitangent) < 0.0f ? -1.0f : 1.0f;
+    packed.position[0] = floatToHalf(v.Position.x);
+    packed.position[1] = floatToHalf(v.Position.y);
+    packed.position[2] = floatToHalf(v.Position.z);
+    packed.position[3] = floatToHalf(handedness);
+
+    glm::vec2 n = octEncode(v.Normal);
+    packed.normal[0] = toSnorm16(n.x);
+    packed.normal[1] = toSnorm16(n.y);
+
+    packed.texCoords[0] = floatToHalf(v.TexCoords.x);
+    packed.texCoords[1] = floatToHalf(v.TexCoords.y);
+
+    glm::vec2 t = octEncode(v.Tangent);
+    packed.tangent[0] = toSnorm16(t.x);
+    packed.tangent[1] = toSnorm16(t.y);
+    return packed;
+}
+
+// Hash/compare vertices bitwise; Vertex is 14 tightly packed floats
+struct VertexBitsHash {
+    size_t operator()(const Vertex& v) const {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+        uint64_t hash = 1469598103934665603ull; // FNV-1a
+        for (size_t i = 0; i < sizeof(Vertex); ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+struct VertexBitsEqual {
+    bool operator()(const Vertex& a, const Vertex& b) const {
+        return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+};
+
+// Forsyth, "Linear-Speed Vertex Cache Optimisation" scoring
+const int FORSYTH_CACHE_SIZE = 32;
+
+float forsythVertexScore(int cachePosition, unsigned int remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // The last triangle's vertices get a fixed score so it isn't simply repeated
+            score = 0.75f;
+        } else {
+            float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scale, 1.5f);
+        }
+    }
+    // Favour vertices with few triangles left so they leave the working set early
+    score += 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+    return score;
+}
+
+std::vector<unsigned int> optimizeVertexCache(const std::vector<unsigned int>& inds, size_t vertexCount) {
+    const size_t triangleCount = inds.size() / 3;
+
+    // Vertex -> triangle adjacency in CSR form
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index : inds) {
+        remaining[index]++;
+    }
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<unsigned int> adjacency(inds.size());
+    std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            adjacency[cursor[inds[t * 3 + k]]++] = static_cast<unsigned int>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        vertexScore[v] = forsythVertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    int bestTriangle = -1;
+    float bestScore = -1.0f;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScore[t] = vertexScore[inds[t * 3]] + vertexScore[inds[t * 3 + 1]] + vertexScore[inds[t * 3 + 2]];
+        if (triangleScore[t] > bestScore) {
+            bestScore = triangleScore[t];
+            bestTriangle = static_cast<int>(t);
+        }
+    }
+
+    std::vector<unsigned int> output;
+    output.reserve(inds.size());
+    std::vector<unsigned int> cache, newCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+    size_t scanCursor = 0;
+
+    while (output.size() < inds.size()) {
+        if (bestTriangle < 0) {
+            // Nothing adjacent to the cache is left; continue with the next unemitted triangle
+            while (emitted[scanCursor]) scanCursor++;
+            bestTriangle = static_cast<int>(scanCursor);
+        }
 
-Mesh::Mesh(std::vector<Vertex> verts) : vertices(verts) {
+        const unsigned int* tri = &inds[static_cast<size_t>(bestTriangle) * 3];
+        emitted[bestTriangle] = true;
+        newCache.clear();
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = tri[k];
+            output.push_back(v);
+            if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) {
+                newCache.push_back(v); // Degenerate triangles repeat a vertex
+            }
+
+            // Drop the triangle from the vertex's remaining list
+            unsigned int begin = offsets[v];
+            unsigned int end = begin + remaining[v];
+            for (unsigned int a = begin; a < end; ++a) {
+                if (adjacency[a] == static_cast<unsigned int>(bestTriangle)) {
+                    std::swap(adjacency[a], adjacency[end - 1]);
+                    break;
+                }
+            }
+            remaining[v]--;
+        }
+        for (unsigned int v : cache) {
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                newCache.push_back(v);
+            }
+        }
+        for (size_t i = FORSYTH_CACHE_SIZE; i < newCache.size(); ++i) {
+            cachePosition[newCache[i]] = -1; // Evicted
+            vertexScore[newCache[i]] = forsythVertexScore(-1, remaining[newCache[i]]);
+        }
+        if (newCache.size() > static_cast<size_t>(FORSYTH_CACHE_SIZE)) {
+            newCache.resize(FORSYTH_CACHE_SIZE);
+        }
+        std::swap(cache, newCache);
+
+        for (size_t i = 0; i < cache.size(); ++i) {
+            cachePosition[cache[i]] = static_cast<int>(i);
+            vertexScore[cache[i]] = forsythVertexScore(static_cast<int>(i), remaining[cache[i]]);
+        }
+
+        // Only triangles touching the cache can have changed score
+        bestTriangle = -1;
+        bestScore = -1.0f;
+        for (unsigned int v : cache) {
+            for (unsigned int a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+                unsigned int t = adjacency[a];
+                float score = vertexScore[inds[t * 3]] + vertexScore[inds[t * 3 + 1]] + vertexScore[inds[t * 3 + 2]];
+                triangleScore[t] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestTriangle = static_cast<int>(t);
+                }
+            }
+        }
+    }
+    return output;
+}
+
+// Reorder clusters of cache-ordered triangles so outward-facing parts are
+// drawn first and occlude the rest (camera independent approximation)
+void optimizeOverdraw(const std::vector<Vertex>& verts, std::vector<unsigned int>& inds) {
+    const size_t CLUSTER_TRIANGLES = 64;
+    const size_t triangleCount = inds.size() / 3;
+    if (triangleCount <= CLUSTER_TRIANGLES) {
+        return;
+    }
+
+    glm::vec3 meshCenter(0.0f);
+    for (const Vertex& v : verts) {
+        meshCenter += v.Position;
+    }
+    meshCenter /= static_cast<float>(verts.size());
+
+    struct Cluster {
+        size_t firstTriangle;
+        size_t triangleCount;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+    for (size_t first = 0; first < triangleCount; first += CLUSTER_TRIANGLES) {
+        Cluster cluster{first, std::min(CLUSTER_TRIANGLES, triangleCount - first), 0.0f};
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        for (size_t t = first; t < first + cluster.triangleCount; ++t) {
+            const glm::vec3& p0 = verts[inds[t * 3]].Position;
+            const glm::vec3& p1 = verts[inds[t * 3 + 1]].Position;
+            const glm::vec3& p2 = verts[inds[t * 3 + 2]].Position;
+            centroid += (p0 + p1 + p2) / 3.0f;
+            normal += glm::cross(p1 - p0, p2 - p0); // Area weighted
+        }
+        centroid /= static_cast<float>(cluster.triangleCount);
+        float normalLength = glm::length(normal);
+        if (normalLength > 0.0f) {
+            cluster.sortKey = glm::dot(centroid - meshCenter, normal / normalLength);
+        }
+        clusters.push_back(cluster);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(),
+        [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> reordered;
+    reordered.reserve(inds.size());
+    for (const Cluster& cluster : clusters) {
+        auto begin = inds.begin() + cluster.firstTriangle * 3;
+        reordered.insert(reordered.end(), begin, begin + cluster.triangleCount * 3);
+    }
+    inds.swap(reordered);
+}
+
+// Renumber vertices in order of first use so vertex fetches stream linearly
+void optimizeVertexFetch(std::vector<Vertex>& verts, std::vector<unsigned int>& inds) {
+    const unsigned int UNUSED = 0xFFFFFFFFu;
+    std::vector<unsigned int> remap(verts.size(), UNUSED);
+    std::vector<Vertex> reordered;
+    reordered.reserve(verts.size());
+    for (unsigned int& index : inds) {
+        if (remap[index] == UNUSED) {
+            remap[index] = static_cast<unsigned int>(reordered.size());
+            reordered.push_back(verts[index]);
+        }
+        index = remap[index];
+    }
+    verts.swap(reordered); // Unreferenced vertices are dropped
+}
+
+} // namespace
+
+Mesh::Mesh(std::vector<Vertex> verts, VertexFormat format) : format(format), serial(nextSerial++) {
+    deduplicate(verts, vertices, indices);
+    optimize(vertices, indices);
+    setupMesh();
+}
+
+Mesh::Mesh(std::vector<Vertex> verts, std::vector<unsigned int> inds, VertexFormat format)
+    : vertices(std::move(verts)), indices(std::move(inds)), format(format), serial(nextSerial++) {
     setupMesh();
 }
 
+Mesh::Mesh(VertexFormat format)
+    : VAO(0), VBO(0), EBO(0), indexType(GL_UNSIGNED_SHORT), format(format), serial(nextSerial++) {
+    computeBounds();
+}
+
+Mesh::~Mesh() {
+    if (streamed) {
+        MeshStreamer::instance().remove(this);
+    }
+    release();
+}
+
+void Mesh::deduplicate(const std::vector<Vertex>& soup, std::vector<Vertex>& outVertices, std::vector<unsigned int>& outIndices) {
+    std::unordered_map<Vertex, unsigned int, VertexBitsHash, VertexBitsEqual> unique;
+    unique.reserve(soup.size());
+    outVertices.clear();
+    outIndices.clear();
+    outIndices.reserve(soup.size());
+    for (const Vertex& v : soup) {
+        auto result = unique.emplace(v, static_cast<unsigned int>(outVertices.size()));
+        if (result.second) {
+            outVertices.push_back(v);
+        }
+        outIndices.push_back(result.first->second);
+    }
+}
+
+void Mesh::optimize(std::vector<Vertex>& verts, std::vector<unsigned int>& inds) {
+    if (inds.size() < 3 || verts.empty()) {
+        return;
+    }
+    inds = optimizeVertexCache(inds, verts.size());
+    optimizeOverdraw(verts, inds);
+    optimizeVertexFetch(verts, inds);
+}
+
+float Mesh::computeACMR(const std::vector<unsigned int>& inds, size_t vertexCount, int cacheSize) {
+    if (inds.size() < 3) {
+        return 0.0f;
+    }
+    // FIFO cache simulation; a vertex is in the cache if it was loaded within the last cacheSize misses
+    std::vector<size_t> loadedAt(vertexCount, 0);
+    size_t misses = 0;
+    for (unsigned int index : inds) {
+        if (loadedAt[index] == 0 || misses - loadedAt[index] + 1 > static_cast<size_t>(cacheSize)) {
+            misses++;
+            loadedAt[index] = misses;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(inds.size() / 3);
+}
+
+void Mesh::computeBounds() {
+    boundingBox = BoundingBox();
+    for (const Vertex& v : vertices) {
+        boundingBox.expand(v.Position);
+    }
+    // Box center plus furthest vertex is tighter than the box's half diagonal for round models
+    boundingSphere.center = boundingBox.isValid() ? boundingBox.getCenter() : glm::vec3(0.0f);
+    float radiusSquared = 0.0f;
+    for (const Vertex& v : vertices) {
+        glm::vec3 offset = v.Position - boundingSphere.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+    boundingSphere.radius = std::sqrt(radiusSquared);
+}
+
 void Mesh::setupMesh() {
+    computeBounds();
+    upload();
+}
+
+void Mesh::upload() {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-
-    // position attribute
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    // normal attribute
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    // texture coordinate attribute
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-    // tangent attribute
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
-    // bitangent attribute
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+    if (format == VertexFormat::Packed) {
+        std::vector<PackedVertex> packed;
+        packed.reserve(vertices.size());
+        for (const Vertex& v : vertices) {
+            packed.push_back(packVertex(v));
+        }
+        glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+    }
+    setupVertexAttributes(format);
+
+    // Index buffer (bound into the VAO); 16-bit indices whenever they fit
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    if (vertices.size() <= 0xFFFF) {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+        indexType = GL_UNSIGNED_SHORT;
+    } else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        indexType = GL_UNSIGNED_INT;
+    }
 
     glBindVertexArray(0);
+    resident = true;
 }
 
-void Mesh::Draw(unsigned int shaderID) {
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, static_cast<unsigned int>(vertices.size()));
+void Mesh::release() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    VAO = 0;
+    VBO = 0;
+    EBO = 0;
+    resident = false;
+}
+
+size_t Mesh::getGpuMemoryUsage() const {
+    const size_t indexSize = vertices.size() <= 0xFFFF ? sizeof(uint16_t) : sizeof(unsigned int);
+    return vertices.size() * getVertexStride(format) + indices.size() * indexSize;
+}
+
+void Mesh::setGeometry(std::vector<MeshLodData> levels) {
+    MeshStreamer& streamer = MeshStreamer::instance();
+    if (streamed) {
+        streamer.remove(this);
+    }
+    release();
+    lods.clear();
+
+    vertices = std::move(levels[0].vertices);
+    indices = std::move(levels[0].indices);
+    lodError = levels[0].error;
+    serial = nextSerial++; // Everything keyed by the old serial is rebuilt
+    setupMesh();
+    for (size_t i = 1; i < levels.size(); ++i) {
+        lods.push_back(std::make_unique<Mesh>(std::move(levels[i].vertices), std::move(levels[i].indices), format));
+        lods.back()->lodError = levels[i].error;
+    }
+
+    const int count = getLodCount();
+    for (int level = 0; level < count; ++level) {
+        Mesh* mesh = getLod(level);
+        mesh->pinned = level == count - 1;
+        streamer.add(mesh);
+    }
+}
+
+Mesh* Mesh::requestLod(int level) {
+    const int count = getLodCount();
+    level = std::max(0, std::min(level, count - 1));
+    Mesh* wanted = getLod(level);
+    if (wanted->streamed) {
+        MeshStreamer::instance().markUsed(wanted);
+    }
+    // Coarser first: it is ready now, and the wanted level follows once uploaded
+    for (int i = level; i < count; ++i) {
+        if (getLod(i)->resident) {
+            return getLod(i);
+        }
+    }
+    for (int i = level - 1; i >= 0; --i) {
+        if (getLod(i)->resident) {
+            return getLod(i);
+        }
+    }
+    return nullptr;
+}
+
+Mesh* Mesh::getResidentLod() {
+    for (int i = 0; i < getLodCount(); ++i) {
+        if (getLod(i)->resident) {
+            return getLod(i);
+        }
+    }
+    return nullptr;
+}
+
+void Mesh::setupVertexAttributes(VertexFormat format) {
+    if (format == VertexFormat::Packed) {
+        // position (xyz) + bitangent sign (w)
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+        // octahedral normal
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+        // texture coordinate attribute
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texCoords));
+        // octahedral tangent
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, tangent));
+        // bitangent is reconstructed in the shader
+        glDisableVertexAttribArray(4);
+    } else {
+        // position attribute
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        // normal attribute
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+        // texture coordinate attribute
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+        // tangent attribute
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
+        // bitangent attribute
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+    }
+}
+
+size_t Mesh::getVertexStride(VertexFormat format) {
+    return format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+void Mesh::Draw(const Shader& shader) {
+    bind(shader);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), indexType, 0);
     glBindVertexArray(0);
 }
 
+void Mesh::bind(const Shader& shader) const {
+    setFormatUniform(shader, format);
+    glBindVertexArray(VAO);
+}
+
+void Mesh::setFormatUniform(const Shader& shader, VertexFormat format) {
+    // Tell the vertex shader how to decode attributes (ignored by shaders without the uniform)
+    const int location = shader.getUniformLocation("packedVertices");
+    if (location >= 0) {
+        glUniform1i(location, format == VertexFormat::Packed ? 1 : 0);
+    }
+}
+
+void Mesh::drawInstanced(int instanceCount) const {
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), indexType, 0, instanceCount);
+}
+
 std::unique_ptr<Mesh> Mesh::createSphere(float radius, int sectors, int stacks) {
     std::vector<Vertex> vertices;
     for (int y = 0; y < stacks; ++y) {
@@ -147,7 +672,11 @@ std::unique_ptr<Mesh> Mesh::createPlane(float width, float height, int segmentsX
 }
 
 std::unique_ptr<Mesh> Mesh::createCube() {
-    std::vector<Vertex> vertices = {
+    return std::make_unique<Mesh>(createCubeVertices());
+}
+
+std::vector<Vertex> Mesh::createCubeVertices() {
+    return {
         // Front face
         {{-0.5f, -0.5f,  0.5f}, {0.0f,  0.0f,  1.0f}, {0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}},
         {{ 0.5f, -0.5f,  0.5f}, {0.0f,  0.0f,  1.0f}, {1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}},
@@ -196,112 +725,52 @@ std::unique_ptr<Mesh> Mesh::createCube() {
         {{ 0.5f,  0.5f, -0.5f}, {0.0f,  1.0f,  0.0f}, {1.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}},
         {{-0.5f,  0.5f, -0.5f}, {0.0f,  1.0f,  0.0f}, {0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}}
     };
-    
-    return std::make_unique<Mesh>(vertices);
 }
 
-std::unique_ptr<Mesh> Mesh::loadFromOBJ(const std::string& filepath) {
-    std::vector<glm::vec3> temp_vertices;
-    std::vector<glm::vec3> temp_normals;
-    std::vector<Vertex> final_vertices;
-    
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open OBJ file: " << filepath << std::endl;
+std::unique_ptr<Mesh> Mesh::loadFromOBJ(const std::string& filepath, VertexFormat format) {
+    std::vector<MeshLodData> levels;
+    if (!importOBJ(filepath, levels)) {
         return nullptr;
     }
-    
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string prefix;
-        iss >> prefix;
-        
-        if (prefix == "v") {
-            // Vertex position
-            glm::vec3 vertex;
-            iss >> vertex.x >> vertex.y >> vertex.z;
-            temp_vertices.push_back(vertex);
-        }
-        else if (prefix == "vn") {
-            // Vertex normal
-            glm::vec3 normal;
-            iss >> normal.x >> normal.y >> normal.z;
-            temp_normals.push_back(normal);
-        }
-        else if (prefix == "f") {
-            // Face (assuming triangulated faces)
-            std::string vertex1, vertex2, vertex3;
-            iss >> vertex1 >> vertex2 >> vertex3;
-            
-            // Parse each vertex (format: v/vt/vn or v//vn or just v)
-            for (const std::string& vertexStr : {vertex1, vertex2, vertex3}) {
-                int vertexIndex = -1;
-                int normalIndex = -1;
-                
-                // Check if the vertex string contains slashes (v/vt/vn format)
-                if (vertexStr.find('/') != std::string::npos) {
-                    std::istringstream vertexStream(vertexStr);
-                    std::string component;
-                    
-                    // Get vertex index
-                    std::getline(vertexStream, component, '/');
-                    vertexIndex = std::stoi(component) - 1; // OBJ is 1-indexed
-                    
-                    // Skip texture coordinate
-                    std::getline(vertexStream, component, '/');
-                    
-                    // Get normal index
-                    if (std::getline(vertexStream, component, '/') && !component.empty()) {
-                        normalIndex = std::stoi(component) - 1; // OBJ is 1-indexed
-                    }
-                } else {
-                    // Simple format: just vertex index
-                    vertexIndex = std::stoi(vertexStr) - 1; // OBJ is 1-indexed
-                }
-                
-                Vertex vertex;
-                if (vertexIndex >= 0 && vertexIndex < temp_vertices.size()) {
-                    vertex.Position = temp_vertices[vertexIndex];
-                } else {
-                    std::cerr << "Invalid vertex index: " << vertexIndex << std::endl;
-                    continue;
-                }
-                
-                if (normalIndex >= 0 && normalIndex < temp_normals.size()) {
-                    vertex.Normal = temp_normals[normalIndex];
-                } else {
-                    // Calculate normal if not provided (will be calculated later)
-                    vertex.Normal = glm::vec3(0.0f, 1.0f, 0.0f);
-                }
-                
-                // Set default texture coordinates and tangents (could be improved)
-                vertex.TexCoords = glm::vec2(0.0f);
-                vertex.Tangent = glm::vec3(1.0f, 0.0f, 0.0f);
-                vertex.Bitangent = glm::vec3(0.0f, 0.0f, 1.0f);
-                
-                final_vertices.push_back(vertex);
-            }
-        }
+    std::unique_ptr<Mesh> mesh(new Mesh(format));
+    mesh->setGeometry(std::move(levels));
+    return mesh;
+}
+
+std::unique_ptr<Mesh> Mesh::loadAsync(const std::string& filepath, VertexFormat format) {
+    std::unique_ptr<Mesh> mesh(new Mesh(format));
+    mesh->streamed = true;
+    MeshStreamer::instance().request(mesh.get(), filepath);
+    return mesh;
+}
+
+bool Mesh::importOBJ(const std::string& filepath, std::vector<MeshLodData>& levels) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // Fast path: already parsed, optimized and simplified on a previous run
+    if (MeshCache::load(filepath, levels)) {
+        float elapsed = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        std::cout << "Loaded OBJ file: " << filepath << " from mesh cache (" << levels[0].vertices.size() << " vertices, "
+                  << levels[0].indices.size() / 3 << " triangles, " << levels.size() << " levels of detail) in "
+                  << elapsed << "ms" << std::endl;
+        return true;
     }
-    
-    file.close();
-    
-    // If no normals were provided, calculate them
-    if (temp_normals.empty() && final_vertices.size() >= 3) {
-        for (size_t i = 0; i < final_vertices.size(); i += 3) {
-            if (i + 2 < final_vertices.size()) {
-                glm::vec3 v1 = final_vertices[i + 1].Position - final_vertices[i].Position;
-                glm::vec3 v2 = final_vertices[i + 2].Position - final_vertices[i].Position;
-                glm::vec3 normal = glm::normalize(glm::cross(v1, v2));
-                
-                final_vertices[i].Normal = normal;
-                final_vertices[i + 1].Normal = normal;
-                final_vertices[i + 2].Normal = normal;
-            }
-        }
+
+    std::vector<Vertex> final_vertices;
+    if (!ObjParser::parse(filepath, final_vertices)) {
+        return false;
     }
-    
-    std::cout << "Loaded OBJ file: " << filepath << " with " << final_vertices.size() << " vertices" << std::endl;
-    return std::make_unique<Mesh>(final_vertices);
-} 
\ No newline at end of file
+    MeshLodData full;
+    deduplicate(final_vertices, full.vertices, full.indices);
+    optimize(full.vertices, full.indices);
+    const float acmr = computeACMR(full.indices, full.vertices.size());
+    levels = MeshSimplifier::buildLods(std::move(full));
+    float elapsed = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    std::cout << "Loaded OBJ file: " << filepath << " with " << final_vertices.size() << " face vertices -> "
+              << levels[0].vertices.size() << " unique, " << levels[0].indices.size() / 3 << " triangles (ACMR "
+              << acmr << "), " << levels.size() << " levels of detail down to " << levels.back().indices.size() / 3
+              << " triangles (error " << levels.back().error << ") in " << elapsed << "ms" << std::endl;
+
+    MeshCache::save(filepath, levels);
+    return true;
+}
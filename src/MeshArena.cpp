@@ -0,0 +1,126 @@
+// MeshArena.cpp
+#include "../include/MeshArena.h"
+#include "../include/Mesh.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+
+MeshArena::MeshArena() {
+    for (Segment& segment : segments) {
+        glGenVertexArrays(1, &segment.vertexArray);
+    }
+}
+
+MeshArena::~MeshArena() {
+    for (Segment& segment : segments) {
+        glDeleteVertexArrays(1, &segment.vertexArray);
+        glDeleteBuffers(1, &segment.vertexBuffer);
+        glDeleteBuffers(1, &segment.indexBuffer);
+    }
+}
+
+bool MeshArena::update(const std::vector<const Mesh*>& meshes) {
+    bool complete = true;
+    for (const Mesh* mesh : meshes) {
+        if (ranges.find(mesh->getSerial()) == ranges.end()) {
+            complete = false;
+            break;
+        }
+    }
+    if (complete) {
+        return false;
+    }
+
+    uniqueMeshes.assign(meshes.begin(), meshes.end());
+    std::sort(uniqueMeshes.begin(), uniqueMeshes.end());
+    uniqueMeshes.erase(std::unique(uniqueMeshes.begin(), uniqueMeshes.end()), uniqueMeshes.end());
+    rebuild();
+    return true;
+}
+
+const MeshArena::Range& MeshArena::getRange(const Mesh* mesh) const {
+    return ranges.find(mesh->getSerial())->second;
+}
+
+void MeshArena::rebuild() {
+    ranges.clear();
+    size_t vertexBytes[SEGMENT_COUNT] = {};
+    uint32_t vertexCounts[SEGMENT_COUNT] = {};
+    uint32_t indexCounts[SEGMENT_COUNT] = {};
+    for (const Mesh* mesh : uniqueMeshes) {
+        const int segment = static_cast<int>(mesh->getVertexFormat());
+        Range range;
+        range.segment = segment;
+        range.firstIndex = indexCounts[segment];
+        range.indexCount = static_cast<uint32_t>(mesh->indices.size());
+        range.baseVertex = static_cast<int32_t>(vertexCounts[segment]);
+        ranges[mesh->getSerial()] = range;
+        vertexBytes[segment] += mesh->vertices.size() * Mesh::getVertexStride(mesh->getVertexFormat());
+        vertexCounts[segment] += static_cast<uint32_t>(mesh->vertices.size());
+        indexCounts[segment] += range.indexCount;
+    }
+
+    SyncMonitor::Scope sync("mesh arena upload");
+    std::vector<uint32_t> indices;
+    for (int s = 0; s < SEGMENT_COUNT; ++s) {
+        Segment& segment = segments[s];
+        // Old buffers stay alive until the draws still reading them have finished
+        glDeleteBuffers(1, &segment.vertexBuffer);
+        glDeleteBuffers(1, &segment.indexBuffer);
+        segment.vertexBuffer = 0;
+        segment.indexBuffer = 0;
+        segment.vertexBytes = vertexBytes[s];
+        segment.indexBytes = static_cast<size_t>(indexCounts[s]) * sizeof(uint32_t);
+        if (vertexCounts[s] == 0) {
+            continue;
+        }
+
+        glGenBuffers(1, &segment.vertexBuffer);
+        glGenBuffers(1, &segment.indexBuffer);
+        glBindVertexArray(segment.vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, segment.vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(segment.vertexBytes), nullptr, GL_STATIC_DRAW);
+        Mesh::setupVertexAttributes(static_cast<VertexFormat>(s));
+
+        // Vertices are already on the GPU in their upload format; copy them there
+        indices.clear();
+        indices.reserve(indexCounts[s]);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, segment.vertexBuffer);
+        size_t offset = 0;
+        for (const Mesh* mesh : uniqueMeshes) {
+            if (static_cast<int>(mesh->getVertexFormat()) != s) {
+                continue;
+            }
+            const size_t bytes = mesh->vertices.size() * Mesh::getVertexStride(mesh->getVertexFormat());
+            if (bytes > 0) {
+                glBindBuffer(GL_COPY_READ_BUFFER, mesh->getVertexBuffer());
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                                    static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes));
+            }
+            offset += bytes;
+            indices.insert(indices.end(), mesh->indices.begin(), mesh->indices.end());
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, segment.indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(segment.indexBytes),
+                     indices.empty() ? nullptr : indices.data(), GL_STATIC_DRAW);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void MeshArena::bind(int segment, const Shader& shader) const {
+    Mesh::setFormatUniform(shader, static_cast<VertexFormat>(segment));
+    glBindVertexArray(segments[segment].vertexArray);
+}
+
+size_t MeshArena::getMemoryUsage() const {
+    size_t bytes = 0;
+    for (const Segment& segment : segments) {
+        bytes += segment.vertexBytes + segment.indexBytes;
+    }
+    return bytes;
+}
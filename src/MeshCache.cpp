@@ -0,0 +1,159 @@
+// MeshCache.cpp
+#include "../include/MeshCache.h"
+#include "../include/MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char MESH_CACHE_MAGIC[8] = {'V', 'G', 'I', 'M', 'E', 'S', 'H', '\0'};
+const char* MESH_CACHE_DIRECTORY = "cache/meshes";
+
+struct MeshCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t vertexStride;      // sizeof(Vertex) of the writer
+    uint32_t levelCount;
+    uint32_t reserved0;
+    uint64_t sourceSize;        // Source file size in bytes
+    int64_t sourceTime;         // Source file modification time (filesystem clock ticks)
+    uint8_t reserved[24];
+};
+static_assert(sizeof(MeshCacheHeader) == 64, "MeshCacheHeader must stay 64 bytes");
+
+struct MeshCacheLevel {
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    float error;                // MeshLodData::error
+    uint32_t reserved;
+};
+static_assert(sizeof(MeshCacheLevel) == 32, "MeshCacheLevel must stay 32 bytes");
+
+} // namespace
+
+std::string MeshCache::getCachePath(const std::string& sourcePath) {
+    // Flatten the source path into a single file name
+    std::string name = sourcePath;
+    for (char& c : name) {
+        if (c == '/' || c == '\\' || c == ':') c = '_';
+    }
+    return std::string(MESH_CACHE_DIRECTORY) + "/" + name + ".vgmesh";
+}
+
+bool MeshCache::load(const std::string& sourcePath, std::vector<MeshLodData>& levels) {
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!MappedFile::getFileStamp(sourcePath, sourceSize, sourceTime)) {
+        return false;
+    }
+
+    MappedFile file;
+    if (!file.open(getCachePath(sourcePath)) || file.size() < sizeof(MeshCacheHeader)) {
+        return false;
+    }
+
+    MeshCacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0 ||
+        header.version != VERSION || header.vertexStride != sizeof(Vertex) ||
+        header.sourceSize != sourceSize || header.sourceTime != sourceTime) {
+        return false; // Stale or foreign cache, rebuild
+    }
+    if (header.levelCount == 0 ||
+        sizeof(MeshCacheHeader) + static_cast<uint64_t>(header.levelCount) * sizeof(MeshCacheLevel) > file.size()) {
+        std::cerr << "Truncated mesh cache: " << getCachePath(sourcePath) << std::endl;
+        return false;
+    }
+
+    levels.clear();
+    levels.resize(header.levelCount);
+    for (uint32_t l = 0; l < header.levelCount; ++l) {
+        MeshCacheLevel level;
+        std::memcpy(&level, file.data() + sizeof(MeshCacheHeader) + l * sizeof(MeshCacheLevel), sizeof(level));
+        uint64_t vertexBytes = static_cast<uint64_t>(level.vertexCount) * sizeof(Vertex);
+        uint64_t indexBytes = static_cast<uint64_t>(level.indexCount) * sizeof(unsigned int);
+        if (level.vertexOffset + vertexBytes > file.size() || level.indexOffset + indexBytes > file.size()) {
+            std::cerr << "Truncated mesh cache: " << getCachePath(sourcePath) << std::endl;
+            return false;
+        }
+
+        const Vertex* vertexData = reinterpret_cast<const Vertex*>(file.data() + level.vertexOffset);
+        const unsigned int* indexData = reinterpret_cast<const unsigned int*>(file.data() + level.indexOffset);
+        for (uint32_t i = 0; i < level.indexCount; ++i) {
+            if (indexData[i] >= level.vertexCount) {
+                std::cerr << "Corrupt mesh cache: " << getCachePath(sourcePath) << std::endl;
+                return false;
+            }
+        }
+
+        levels[l].vertices.assign(vertexData, vertexData + level.vertexCount);
+        levels[l].indices.assign(indexData, indexData + level.indexCount);
+        levels[l].error = level.error;
+    }
+    return true;
+}
+
+bool MeshCache::save(const std::string& sourcePath, const std::vector<MeshLodData>& levels) {
+    MeshCacheHeader header = {};
+    if (!MappedFile::getFileStamp(sourcePath, header.sourceSize, header.sourceTime)) {
+        return false;
+    }
+    std::memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+    header.version = VERSION;
+    header.vertexStride = sizeof(Vertex);
+    header.levelCount = static_cast<uint32_t>(levels.size());
+
+    std::vector<MeshCacheLevel> table(levels.size());
+    uint64_t offset = sizeof(MeshCacheHeader) + levels.size() * sizeof(MeshCacheLevel);
+    for (size_t l = 0; l < levels.size(); ++l) {
+        table[l] = {};
+        table[l].vertexCount = static_cast<uint32_t>(levels[l].vertices.size());
+        table[l].indexCount = static_cast<uint32_t>(levels[l].indices.size());
+        table[l].error = levels[l].error;
+        table[l].vertexOffset = offset;
+        offset += levels[l].vertices.size() * sizeof(Vertex);
+        table[l].indexOffset = offset;
+        offset += levels[l].indices.size() * sizeof(unsigned int);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(MESH_CACHE_DIRECTORY, error);
+    if (error) {
+        std::cerr << "Failed to create mesh cache directory: " << error.message() << std::endl;
+        return false;
+    }
+
+    // Write to a temporary file first so a crash never leaves a half-written cache behind
+    std::string cachePath = getCachePath(sourcePath);
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to write mesh cache: " << tempPath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(MeshCacheLevel)));
+        for (const MeshLodData& level : levels) {
+            file.write(reinterpret_cast<const char*>(level.vertices.data()), static_cast<std::streamsize>(level.vertices.size() * sizeof(Vertex)));
+            file.write(reinterpret_cast<const char*>(level.indices.data()), static_cast<std::streamsize>(level.indices.size() * sizeof(unsigned int)));
+        }
+        if (!file) {
+            std::cerr << "Failed to write mesh cache: " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error) {
+        std::cerr << "Failed to finalize mesh cache " << cachePath << ": " << error.message() << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
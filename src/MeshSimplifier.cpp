@@ -0,0 +1,345 @@
+// MeshSimplifier.cpp
+#include "../include/MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+// Area-weighted sum of squared plane distances: p^T A p + 2 b.p + c, over weight w
+struct Quadric {
+    double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+    double c = 0.0;
+    double w = 0.0;
+
+    void addPlane(const glm::dvec3& n, double d, double weight) {
+        a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+        a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a22 += weight * n.z * n.z;
+        b0 += weight * n.x * d; b1 += weight * n.y * d; b2 += weight * n.z * d;
+        c += weight * d * d;
+        w += weight;
+    }
+
+    void add(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2;
+        c += q.c;
+        w += q.w;
+    }
+
+    double evaluate(const glm::vec3& p) const {
+        const double x = p.x, y = p.y, z = p.z;
+        return a00 * x * x + a11 * y * y + a22 * z * z
+             + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+             + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+    }
+};
+
+struct Collapse {
+    unsigned int from;
+    unsigned int to;
+    float error;
+};
+
+// RMS distance of a position to the planes of two quadrics
+float collapseError(const Quadric& a, const Quadric& b, const glm::vec3& position) {
+    Quadric sum = a;
+    sum.add(b);
+    if (sum.w <= 0.0) {
+        return 0.0f; // Only degenerate triangles around both: flat by definition
+    }
+    return static_cast<float>(std::sqrt(std::max(0.0, sum.evaluate(position) / sum.w)));
+}
+
+uint64_t edgeKey(unsigned int a, unsigned int b) {
+    return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+}
+
+// Locks the vertices of every edge not shared by exactly two triangles
+std::vector<bool> findLockedVertices(const std::vector<unsigned int>& indices, size_t vertexCount) {
+    std::unordered_map<uint64_t, int> edgeUses;
+    edgeUses.reserve(indices.size());
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        for (int e = 0; e < 3; ++e) {
+            edgeUses[edgeKey(indices[t + e], indices[t + (e + 1) % 3])]++;
+        }
+    }
+    std::vector<bool> locked(vertexCount, false);
+    for (const auto& edge : edgeUses) {
+        if (edge.second != 2) {
+            locked[static_cast<unsigned int>(edge.first >> 32)] = true;
+            locked[static_cast<unsigned int>(edge.first & 0xFFFFFFFFu)] = true;
+        }
+    }
+    return locked;
+}
+
+// Moving position `from` onto `to` keeps every triangle of `from` (not shared with `to`) facing the same way
+bool keepsOrientation(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices,
+                      const unsigned int* triangles, unsigned int triangleCount, unsigned int from, unsigned int to) {
+    for (unsigned int i = 0; i < triangleCount; ++i) {
+        const unsigned int* corners = &indices[triangles[i] * 3];
+        if (corners[0] == to || corners[1] == to || corners[2] == to) {
+            continue; // Degenerates and is removed
+        }
+        glm::vec3 before[3];
+        glm::vec3 after[3];
+        for (int k = 0; k < 3; ++k) {
+            before[k] = positions[corners[k]];
+            after[k] = corners[k] == from ? positions[to] : before[k];
+        }
+        const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+        const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+        // Also rejects collapses that leave a zero-area sliver
+        if (glm::dot(normalBefore, normalAfter) <= 0.25f * glm::length(normalBefore) * glm::length(normalAfter)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct PositionBitsHash {
+    size_t operator()(const glm::vec3& p) const {
+        uint32_t bits[3];
+        std::memcpy(bits, &p.x, sizeof(bits));
+        return static_cast<size_t>((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u));
+    }
+};
+
+struct PositionBitsEqual {
+    bool operator()(const glm::vec3& a, const glm::vec3& b) const {
+        return std::memcmp(&a, &b, sizeof(glm::vec3)) == 0;
+    }
+};
+
+} // namespace
+
+float MeshSimplifier::simplify(MeshLodData& mesh, size_t targetTriangles, float maxError) {
+    // Collapse on positions: vertices that only differ in attributes (seams, flat
+    // shading) must move together, or the surface tears along them
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> positionOf(mesh.vertices.size());
+    std::vector<unsigned int> firstVertex;          // A vertex at each position
+    std::vector<unsigned int> vertexCount;          // Vertices sharing each position
+    {
+        std::unordered_map<glm::vec3, unsigned int, PositionBitsHash, PositionBitsEqual> unique;
+        unique.reserve(mesh.vertices.size());
+        for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+            auto result = unique.emplace(mesh.vertices[v].Position, static_cast<unsigned int>(positions.size()));
+            if (result.second) {
+                positions.push_back(mesh.vertices[v].Position);
+                firstVertex.push_back(static_cast<unsigned int>(v));
+                vertexCount.push_back(0);
+            }
+            positionOf[v] = result.first->second;
+            vertexCount[result.first->second]++;
+        }
+    }
+    const size_t positionCount = positions.size();
+
+    // Working triangles in position indices, each remembering its source triangle
+    std::vector<unsigned int> indices;
+    std::vector<unsigned int> origins;
+    indices.reserve(mesh.indices.size());
+    for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3) {
+        const unsigned int a = positionOf[mesh.indices[t]];
+        const unsigned int b = positionOf[mesh.indices[t + 1]];
+        const unsigned int c = positionOf[mesh.indices[t + 2]];
+        if (a != b && b != c && a != c) {
+            indices.push_back(a);
+            indices.push_back(b);
+            indices.push_back(c);
+            origins.push_back(static_cast<unsigned int>(t / 3));
+        }
+    }
+
+    std::vector<Quadric> quadrics(positionCount);
+    for (size_t t = 0; t < indices.size(); t += 3) {
+        const glm::dvec3 p0(positions[indices[t]]);
+        const glm::dvec3 p1(positions[indices[t + 1]]);
+        const glm::dvec3 p2(positions[indices[t + 2]]);
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const double length = glm::length(normal);
+        if (length <= 0.0) {
+            continue;
+        }
+        normal /= length;
+        const double d = -glm::dot(normal, p0);
+        for (int k = 0; k < 3; ++k) {
+            quadrics[indices[t + k]].addPlane(normal, d, length * 0.5);
+        }
+    }
+    const std::vector<bool> locked = findLockedVertices(indices, positionCount);
+
+    float resultError = 0.0f;
+    std::vector<unsigned int> triangleOffsets;
+    std::vector<unsigned int> vertexTriangles;
+    std::vector<Collapse> collapses;
+    std::vector<unsigned int> remap(positionCount);
+    std::vector<bool> changed(positionCount);
+    while (indices.size() / 3 > targetTriangles) {
+        const unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+
+        // Triangles around every position (counting sort into one array)
+        triangleOffsets.assign(positionCount + 1, 0);
+        for (unsigned int index : indices) {
+            triangleOffsets[index + 1]++;
+        }
+        for (size_t v = 0; v < positionCount; ++v) {
+            triangleOffsets[v + 1] += triangleOffsets[v];
+        }
+        vertexTriangles.resize(indices.size());
+        std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+        for (unsigned int t = 0; t < triangleCount; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                vertexTriangles[fill[indices[t * 3 + k]]++] = t;
+            }
+        }
+
+        // Every interior edge appears once as a < b (the neighbouring triangle stores it as b, a);
+        // collapse it in the cheaper direction that moves an unlocked position
+        collapses.clear();
+        for (unsigned int t = 0; t < triangleCount; ++t) {
+            for (int e = 0; e < 3; ++e) {
+                const unsigned int a = indices[t * 3 + e];
+                const unsigned int b = indices[t * 3 + (e + 1) % 3];
+                if (a >= b || (locked[a] && locked[b])) {
+                    continue;
+                }
+                const float errorAB = locked[a] ? INFINITY : collapseError(quadrics[a], quadrics[b], positions[b]);
+                const float errorBA = locked[b] ? INFINITY : collapseError(quadrics[a], quadrics[b], positions[a]);
+                Collapse collapse = errorAB <= errorBA ? Collapse{a, b, errorAB} : Collapse{b, a, errorBA};
+                if (collapse.error <= maxError) {
+                    collapses.push_back(collapse);
+                }
+            }
+        }
+        if (collapses.empty()) {
+            break;
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            return x.error < y.error;
+        });
+
+        // A collapse removes about two triangles; stop the pass near the target
+        const size_t collapseLimit = (triangleCount - targetTriangles) / 2 + 1;
+        size_t performed = 0;
+        for (size_t v = 0; v < positionCount; ++v) {
+            remap[v] = static_cast<unsigned int>(v);
+        }
+        std::fill(changed.begin(), changed.end(), false);
+        for (const Collapse& collapse : collapses) {
+            if (performed >= collapseLimit) {
+                break;
+            }
+            if (changed[collapse.from] || changed[collapse.to]) {
+                continue;
+            }
+            const unsigned int* triangles = &vertexTriangles[triangleOffsets[collapse.from]];
+            const unsigned int count = triangleOffsets[collapse.from + 1] - triangleOffsets[collapse.from];
+            if (!keepsOrientation(positions, indices, triangles, count, collapse.from, collapse.to)) {
+                continue;
+            }
+            // Freeze the whole neighbourhood, so no triangle changes twice in one pass
+            for (unsigned int i = 0; i < count; ++i) {
+                for (int k = 0; k < 3; ++k) {
+                    changed[indices[triangles[i] * 3 + k]] = true;
+                }
+            }
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            resultError = std::max(resultError, collapse.error);
+            performed++;
+        }
+        if (performed == 0) {
+            break;
+        }
+
+        // Apply the pass and drop the triangles that collapsed
+        size_t write = 0;
+        for (size_t t = 0; t < indices.size(); t += 3) {
+            const unsigned int a = remap[indices[t]];
+            const unsigned int b = remap[indices[t + 1]];
+            const unsigned int c = remap[indices[t + 2]];
+            if (a == b || b == c || a == c) {
+                continue;
+            }
+            origins[write / 3] = origins[t / 3];
+            indices[write++] = a;
+            indices[write++] = b;
+            indices[write++] = c;
+        }
+        indices.resize(write);
+        origins.resize(write / 3);
+    }
+
+    // Back to vertices: a corner keeps its own vertex where it did not move, takes the
+    // vertex at its new position where that is unique (smooth surface), and otherwise
+    // keeps its attributes at the new position. Flat-shaded triangles get their new face normal.
+    std::vector<Vertex> soup;
+    soup.reserve(indices.size());
+    for (size_t t = 0; t < indices.size(); t += 3) {
+        const unsigned int* source = &mesh.indices[origins[t / 3] * 3];
+        const bool flat = std::memcmp(&mesh.vertices[source[0]].Normal, &mesh.vertices[source[1]].Normal, sizeof(glm::vec3)) == 0 &&
+                          std::memcmp(&mesh.vertices[source[0]].Normal, &mesh.vertices[source[2]].Normal, sizeof(glm::vec3)) == 0;
+        for (int k = 0; k < 3; ++k) {
+            const unsigned int position = indices[t + k];
+            if (positionOf[source[k]] == position) {
+                soup.push_back(mesh.vertices[source[k]]);
+            } else if (vertexCount[position] == 1 && !flat) {
+                soup.push_back(mesh.vertices[firstVertex[position]]);
+            } else {
+                soup.push_back(mesh.vertices[source[k]]);
+                soup.back().Position = positions[position];
+            }
+        }
+        if (flat) {
+            Vertex* corners = &soup[t];
+            const glm::vec3 normal = glm::cross(corners[1].Position - corners[0].Position, corners[2].Position - corners[0].Position);
+            const float length = glm::length(normal);
+            if (length > 0.0f) {
+                corners[0].Normal = corners[1].Normal = corners[2].Normal = normal / length;
+            }
+        }
+    }
+    Mesh::deduplicate(soup, mesh.vertices, mesh.indices);
+    return resultError;
+}
+
+std::vector<MeshLodData> MeshSimplifier::buildLods(MeshLodData full) {
+    std::vector<MeshLodData> levels;
+    full.error = 0.0f;
+    levels.push_back(std::move(full));
+    if (levels[0].indices.size() / 3 < MIN_LOD_TRIANGLES * 2) {
+        return levels;
+    }
+
+    BoundingBox box;
+    for (const Vertex& v : levels[0].vertices) {
+        box.expand(v.Position);
+    }
+    const float maxError = MAX_RELATIVE_ERROR * glm::length(box.getExtents());
+
+    while (static_cast<int>(levels.size()) < MAX_LEVELS) {
+        const MeshLodData& previous = levels.back();
+        const size_t previousTriangles = previous.indices.size() / 3;
+        const size_t target = std::max(previousTriangles / 2, MIN_LOD_TRIANGLES);
+        if (target * 4 > previousTriangles * 3) {
+            break;
+        }
+
+        MeshLodData level = previous;
+        // Errors add up, since every level starts from the previous one's surface
+        const float error = simplify(level, target, maxError - previous.error);
+        if (level.indices.size() / 3 * 4 > previousTriangles * 3) {
+            break; // Locked borders or the error limit stopped it early
+        }
+        level.error = previous.error + error;
+        Mesh::optimize(level.vertices, level.indices);
+        levels.push_back(std::move(level));
+    }
+    return levels;
+}
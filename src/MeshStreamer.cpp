@@ -0,0 +1,249 @@
+// MeshStreamer.cpp
+#include "../include/MeshStreamer.h"
+#include "../include/SyncMonitor.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+MeshStreamer& MeshStreamer::instance() {
+    static MeshStreamer streamer;
+    return streamer;
+}
+
+MeshStreamer::~MeshStreamer() {
+    // No GL calls here: the context is usually gone by static destruction time
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void MeshStreamer::startWorkers() {
+    // Simplifying a large model takes a few hundred MB of scratch, so keep this small
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    unsigned int count = std::min(2u, hardwareThreads > 1 ? hardwareThreads - 1 : 1u);
+    for (unsigned int i = 0; i < count; ++i) {
+        workers.emplace_back(&MeshStreamer::workerLoop, this);
+    }
+}
+
+void MeshStreamer::request(Mesh* mesh, const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (workers.empty()) {
+            startWorkers();
+        }
+        uint64_t ticket = nextTicket++;
+        if (tickets.find(mesh) == tickets.end()) {
+            pending++;
+        }
+        tickets[mesh] = ticket; // A newer request replaces an older one
+        jobs.push_back({ticket, mesh, path, mesh->getVertexFormat()});
+    }
+    jobAvailable.notify_one();
+}
+
+void MeshStreamer::remove(Mesh* mesh) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tickets.erase(mesh) > 0) {
+            pending--;
+        }
+    }
+    auto it = std::find(levels.begin(), levels.end(), mesh);
+    if (it != levels.end()) {
+        if (mesh->resident) {
+            residentBytes -= mesh->getGpuMemoryUsage();
+        }
+        levels.erase(it);
+        residencyVersion++;
+    }
+    if (mesh->uploadQueued) {
+        uploadQueue.erase(std::remove(uploadQueue.begin(), uploadQueue.end(), mesh), uploadQueue.end());
+        mesh->uploadQueued = false;
+    }
+    mesh->streamed = false;
+}
+
+void MeshStreamer::add(Mesh* level) {
+    level->streamed = true;
+    level->lastUsedFrame = frame; // Gets the eviction delay to be drawn first
+    levels.push_back(level);
+    if (level->resident) {
+        residentBytes += level->getGpuMemoryUsage();
+    }
+    residencyVersion++;
+}
+
+void MeshStreamer::markUsed(Mesh* level) {
+    level->lastUsedFrame = frame;
+    // Meshes still loading have nothing to upload yet
+    if (!level->resident && !level->uploadQueued && !level->indices.empty()) {
+        level->uploadQueued = true;
+        uploadQueue.push_back(level);
+    }
+}
+
+size_t MeshStreamer::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
+
+size_t MeshStreamer::getResidentLevelCount() const {
+    return static_cast<size_t>(std::count_if(levels.begin(), levels.end(), [](const Mesh* level) {
+        return level->resident;
+    }));
+}
+
+void MeshStreamer::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+
+            auto it = tickets.find(job.mesh);
+            if (it == tickets.end() || it->second != job.ticket) {
+                continue; // Cancelled or superseded before we got to it
+            }
+        }
+
+        Result result;
+        result.ticket = job.ticket;
+        result.mesh = job.mesh;
+        result.path = job.path;
+        auto start = std::chrono::high_resolution_clock::now();
+        result.success = Mesh::importOBJ(job.path, result.levels);
+        if (!result.success) {
+            result.levels.assign(1, MeshLodData());
+            Mesh::deduplicate(Mesh::createCubeVertices(), result.levels[0].vertices, result.levels[0].indices);
+        }
+        result.loadTimeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        result.bytes = 0;
+        for (const MeshLodData& level : result.levels) {
+            result.bytes += level.vertices.size() * Mesh::getVertexStride(job.format) + level.indices.size() * sizeof(unsigned int);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(std::move(result));
+        }
+        resultAvailable.notify_all();
+    }
+}
+
+void MeshStreamer::release(Mesh* level) {
+    residentBytes -= level->getGpuMemoryUsage();
+    level->release();
+    residencyVersion++;
+}
+
+bool MeshStreamer::releaseLeastRecentlyUsed() {
+    Mesh* oldest = nullptr;
+    for (Mesh* level : levels) {
+        if (!level->resident || level->pinned || frame - level->lastUsedFrame <= EVICTION_DELAY_FRAMES) {
+            continue;
+        }
+        if (!oldest || level->lastUsedFrame < oldest->lastUsedFrame) {
+            oldest = level;
+        }
+    }
+    if (!oldest) {
+        return false;
+    }
+    release(oldest);
+    return true;
+}
+
+void MeshStreamer::processUploads(size_t budgetBytes) {
+    frame++;
+    size_t uploadedBytes = 0;
+    bool first = true;
+
+    // Finished loads
+    while (first || uploadedBytes < budgetBytes) {
+        Result result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (results.empty()) {
+                break;
+            }
+            if (!first && results.front().bytes > budgetBytes - uploadedBytes) {
+                break; // Leave it for the next frame
+            }
+            result = std::move(results.front());
+            results.pop_front();
+
+            // Drop results for meshes that were destroyed or re-requested meanwhile
+            auto it = tickets.find(result.mesh);
+            if (it == tickets.end() || it->second != result.ticket) {
+                continue;
+            }
+            tickets.erase(it);
+            pending--;
+        }
+        first = false;
+
+        // The mesh outlives this call: ~Mesh cancels on the GL thread, which is us
+        if (!result.success) {
+            std::cerr << "Failed to load mesh: " << result.path << ", falling back to a cube" << std::endl;
+        }
+        const size_t levelCount = result.levels.size();
+        {
+            SyncMonitor::Scope sync("mesh upload");
+            result.mesh->setGeometry(std::move(result.levels));
+        }
+        uploadedBytes += result.bytes;
+        if (result.success) {
+            std::cout << "Streamed mesh: " << result.path << " (" << result.mesh->getTriangleCount() << " triangles, "
+                      << levelCount << " levels of detail, loaded in " << result.loadTimeMs << " ms)" << std::endl;
+        }
+    }
+
+    // Released levels drawn last frame, making room from the least recently used ones
+    for (Mesh* level : uploadQueue) {
+        level->uploadQueued = false;
+        if (level->resident || (!first && uploadedBytes >= budgetBytes)) {
+            continue; // Requested again next frame if still wanted
+        }
+        const size_t bytes = level->getGpuMemoryUsage();
+        while (residentBytes + bytes > memoryBudget && releaseLeastRecentlyUsed()) {
+        }
+        if (residentBytes + bytes > memoryBudget) {
+            continue; // Everything resident is in use: keep drawing the coarser level
+        }
+        {
+            SyncMonitor::Scope sync("mesh level upload");
+            level->upload();
+        }
+        residentBytes += bytes;
+        residencyVersion++;
+        uploadedBytes += bytes;
+        first = false;
+    }
+    uploadQueue.clear();
+
+    // Loads (or a lowered budget) may have pushed the total over
+    while (residentBytes > memoryBudget && releaseLeastRecentlyUsed()) {
+    }
+}
+
+void MeshStreamer::finishAll() {
+    while (getPendingCount() > 0) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            resultAvailable.wait(lock, [this]() { return !results.empty() || pending == 0; });
+        }
+        processUploads(SIZE_MAX);
+    }
+}
@@ -0,0 +1,394 @@
+// ObjParser.cpp
+#include "../include/ObjParser.h"
+#include "../include/MappedFile.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+const int32_t NO_INDEX = INT32_MIN;
+
+// One triangle corner as written in the file. Relative (negative) OBJ
+// indices are stored chunk-local and fixed up once chunk offsets are known.
+struct Corner {
+    int32_t position;
+    int32_t normal;
+    bool positionRelative;
+    bool normalRelative;
+};
+
+struct ChunkResult {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<Corner> corners;    // 3 per triangle
+};
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline void skipBlanks(const char*& p, const char* end) {
+    while (p < end && isBlank(*p)) ++p;
+}
+
+inline void skipLine(const char*& p, const char* end) {
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    p = newline ? newline + 1 : end;
+}
+
+const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+double powerOfTen(int exponent) {
+    if (exponent >= 0 && exponent <= 22) return POWERS_OF_TEN[exponent];
+    if (exponent < 0 && exponent >= -22) return 1.0 / POWERS_OF_TEN[-exponent];
+    double result = 1.0;
+    double base = exponent < 0 ? 0.1 : 10.0;
+    for (int i = 0; i < std::abs(exponent); ++i) result *= base;
+    return result;
+}
+
+// Decimal float parser for OBJ numbers (no locale, no allocation)
+float parseFloat(const char*& p, const char* end) {
+    skipBlanks(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    double value = 0.0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10.0 + (*p - '0');
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        double scale = 0.1;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value += (*p - '0') * scale;
+            scale *= 0.1;
+            ++p;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+        int exponent = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            exponent = exponent * 10 + (*p - '0');
+            ++p;
+        }
+        value *= powerOfTen(negativeExponent ? -exponent : exponent);
+    }
+    return static_cast<float>(negative ? -value : value);
+}
+
+// Returns false if there is no integer at p
+bool parseInt(const char*& p, const char* end, int32_t& out) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+        return false;
+    }
+    int64_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        ++p;
+    }
+    out = static_cast<int32_t>(negative ? -value : value);
+    return true;
+}
+
+// OBJ index (1-based or negative) -> chunk-local/absolute 0-based index
+inline void resolveIndex(int32_t objIndex, size_t localCount, int32_t& index, bool& relative) {
+    if (objIndex < 0) {
+        index = static_cast<int32_t>(localCount) + objIndex;
+        relative = true;
+    } else if (objIndex > 0) {
+        index = objIndex - 1;
+        relative = false;
+    } else {
+        index = NO_INDEX; // 0 is never valid in OBJ
+        relative = false;
+    }
+}
+
+void parseChunk(const char* begin, const char* end, ChunkResult& result) {
+    std::vector<Corner> polygon;
+    const char* p = begin;
+    while (p < end) {
+        skipBlanks(p, end);
+        if (p >= end) break;
+
+        if (p[0] == 'v' && p + 1 < end && isBlank(p[1])) {
+            p += 2;
+            glm::vec3 v;
+            v.x = parseFloat(p, end);
+            v.y = parseFloat(p, end);
+            v.z = parseFloat(p, end);
+            result.positions.push_back(v);
+        } else if (p[0] == 'v' && p + 2 < end && p[1] == 'n' && isBlank(p[2])) {
+            p += 3;
+            glm::vec3 n;
+            n.x = parseFloat(p, end);
+            n.y = parseFloat(p, end);
+            n.z = parseFloat(p, end);
+            result.normals.push_back(n);
+        } else if (p[0] == 'f' && p + 1 < end && isBlank(p[1])) {
+            p += 2;
+            polygon.clear();
+            while (true) {
+                skipBlanks(p, end);
+                int32_t objPosition = 0;
+                if (!parseInt(p, end, objPosition)) break;
+
+                int32_t objNormal = 0;
+                if (p < end && *p == '/') {
+                    ++p;
+                    int32_t ignoredTexCoord;
+                    parseInt(p, end, ignoredTexCoord); // Texture coordinates are not used
+                    if (p < end && *p == '/') {
+                        ++p;
+                        parseInt(p, end, objNormal);
+                    }
+                }
+
+                Corner corner;
+                resolveIndex(objPosition, result.positions.size(), corner.position, corner.positionRelative);
+                resolveIndex(objNormal, result.normals.size(), corner.normal, corner.normalRelative);
+                polygon.push_back(corner);
+            }
+
+            // Fan triangulation (a no-op for triangles)
+            for (size_t i = 2; i < polygon.size(); ++i) {
+                result.corners.push_back(polygon[0]);
+                result.corners.push_back(polygon[i - 1]);
+                result.corners.push_back(polygon[i]);
+            }
+        }
+        skipLine(p, end);
+    }
+}
+
+// Absolute position index of a corner, -1 if it is out of range
+inline int64_t cornerPosition(const Corner& corner, size_t positionOffset, size_t positionCount) {
+    int64_t position = corner.position == NO_INDEX ? -1
+        : corner.position + (corner.positionRelative ? static_cast<int64_t>(positionOffset) : 0);
+    return position < static_cast<int64_t>(positionCount) ? position : -1;
+}
+
+// Area-weighted normal per position for files without vn. Positions with
+// identical coordinates share one normal, so split vertices weld again.
+std::vector<glm::vec3> computeSmoothNormals(const std::vector<ChunkResult>& chunks,
+                                            const std::vector<size_t>& positionOffsets,
+                                            const std::vector<glm::vec3>& positions) {
+    struct PositionHash {
+        size_t operator()(const glm::vec3& p) const {
+            uint32_t bits[3];
+            std::memcpy(bits, &p, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+    std::unordered_map<glm::vec3, uint32_t, PositionHash> firstIndex;
+    firstIndex.reserve(positions.size());
+    std::vector<uint32_t> weld(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        weld[i] = firstIndex.emplace(positions[i], static_cast<uint32_t>(i)).first->second;
+    }
+
+    std::vector<glm::vec3> sums(positions.size(), glm::vec3(0.0f));
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        const std::vector<Corner>& corners = chunks[c].corners;
+        for (size_t t = 0; t + 2 < corners.size(); t += 3) {
+            int64_t index[3];
+            for (int k = 0; k < 3; ++k) {
+                index[k] = cornerPosition(corners[t + k], positionOffsets[c], positions.size());
+            }
+            if (index[0] < 0 || index[1] < 0 || index[2] < 0) {
+                continue;
+            }
+            // Unnormalized cross product: twice the area, so big faces weigh more
+            const glm::vec3 faceNormal = glm::cross(positions[index[1]] - positions[index[0]],
+                                                    positions[index[2]] - positions[index[0]]);
+            for (int k = 0; k < 3; ++k) {
+                sums[weld[index[k]]] += faceNormal;
+            }
+        }
+    }
+
+    std::vector<glm::vec3> normals(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const glm::vec3& sum = sums[weld[i]];
+        const float length = glm::length(sum);
+        normals[i] = length > 0.0f ? sum / length : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+    return normals;
+}
+
+// Turn one chunk's corners into soup vertices; returns the number of valid triangles written.
+// Without normals in the file, smoothNormals (one per position) are used instead.
+size_t buildChunkVertices(const ChunkResult& chunk, size_t positionOffset, size_t normalOffset,
+                          const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                          const std::vector<glm::vec3>& smoothNormals, Vertex* out, size_t& invalidCorners) {
+    size_t written = 0;
+    invalidCorners = 0;
+    for (size_t t = 0; t + 2 < chunk.corners.size(); t += 3) {
+        Vertex triangle[3];
+        bool valid = true;
+        for (int k = 0; k < 3; ++k) {
+            const Corner& corner = chunk.corners[t + k];
+            int64_t position = cornerPosition(corner, positionOffset, positions.size());
+            if (position < 0) {
+                valid = false;
+                invalidCorners++;
+                break;
+            }
+
+            Vertex& vertex = triangle[k];
+            vertex.Position = positions[static_cast<size_t>(position)];
+
+            int64_t normal = corner.normal == NO_INDEX ? -1
+                : corner.normal + (corner.normalRelative ? static_cast<int64_t>(normalOffset) : 0);
+            if (normal >= 0 && normal < static_cast<int64_t>(normals.size())) {
+                vertex.Normal = normals[static_cast<size_t>(normal)];
+            } else if (normals.empty()) {
+                vertex.Normal = smoothNormals[static_cast<size_t>(position)];
+            } else {
+                vertex.Normal = glm::vec3(0.0f, 1.0f, 0.0f);
+            }
+
+            // Same defaults as the original loader
+            vertex.TexCoords = glm::vec2(0.0f);
+            vertex.Tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+            vertex.Bitangent = glm::vec3(0.0f, 0.0f, 1.0f);
+        }
+        if (!valid) {
+            continue;
+        }
+        out[written * 3] = triangle[0];
+        out[written * 3 + 1] = triangle[1];
+        out[written * 3 + 2] = triangle[2];
+        written++;
+    }
+    return written;
+}
+
+template <typename Func>
+void runParallel(size_t count, Func&& func) {
+    if (count == 1) {
+        func(0);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        threads.emplace_back([&func, i]() { func(i); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+bool ObjParser::parse(const std::string& path, std::vector<Vertex>& soup, unsigned int threadCount) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Failed to open OBJ file: " << path << std::endl;
+        return false;
+    }
+    soup.clear();
+    if (file.size() == 0) {
+        return true;
+    }
+
+    // At least ~1MB per chunk so small files don't pay for thread startup
+    const size_t MIN_CHUNK_BYTES = 1 << 20;
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, file.size() / MIN_CHUNK_BYTES));
+
+    // Split at line boundaries
+    const char* data = file.data();
+    const char* fileEnd = data + file.size();
+    std::vector<const char*> bounds(chunkCount + 1);
+    bounds[0] = data;
+    bounds[chunkCount] = fileEnd;
+    for (size_t c = 1; c < chunkCount; ++c) {
+        const char* split = std::max(bounds[c - 1], data + file.size() * c / chunkCount);
+        skipLine(split, fileEnd);
+        bounds[c] = split;
+    }
+
+    std::vector<ChunkResult> chunks(chunkCount);
+    runParallel(chunkCount, [&](size_t c) {
+        parseChunk(bounds[c], bounds[c + 1], chunks[c]);
+    });
+
+    // Prefix sums give every chunk its position/normal/triangle offsets
+    std::vector<size_t> positionOffsets(chunkCount + 1, 0);
+    std::vector<size_t> normalOffsets(chunkCount + 1, 0);
+    std::vector<size_t> cornerOffsets(chunkCount + 1, 0);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        positionOffsets[c + 1] = positionOffsets[c] + chunks[c].positions.size();
+        normalOffsets[c + 1] = normalOffsets[c] + chunks[c].normals.size();
+        cornerOffsets[c + 1] = cornerOffsets[c] + chunks[c].corners.size();
+    }
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    positions.reserve(positionOffsets[chunkCount]);
+    normals.reserve(normalOffsets[chunkCount]);
+    for (const ChunkResult& chunk : chunks) {
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+    }
+
+    // Flat face normals would make every corner unique and leave nothing to deduplicate
+    std::vector<glm::vec3> smoothNormals;
+    if (normals.empty()) {
+        smoothNormals = computeSmoothNormals(chunks, positionOffsets, positions);
+    }
+
+    soup.resize(cornerOffsets[chunkCount]);
+    std::vector<size_t> writtenTriangles(chunkCount, 0);
+    std::vector<size_t> invalidCorners(chunkCount, 0);
+    runParallel(chunkCount, [&](size_t c) {
+        writtenTriangles[c] = buildChunkVertices(chunks[c], positionOffsets[c], normalOffsets[c],
+                                                 positions, normals, smoothNormals,
+                                                 soup.data() + cornerOffsets[c], invalidCorners[c]);
+    });
+
+    // Close the gaps left by skipped triangles
+    size_t total = 0;
+    size_t invalid = 0;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        size_t count = writtenTriangles[c] * 3;
+        if (total != cornerOffsets[c]) {
+            std::copy(soup.begin() + cornerOffsets[c], soup.begin() + cornerOffsets[c] + count, soup.begin() + total);
+        }
+        total += count;
+        invalid += invalidCorners[c];
+    }
+    soup.resize(total);
+
+    if (invalid > 0) {
+        std::cerr << "Skipped " << invalid << " triangles with invalid vertex indices in " << path << std::endl;
+    }
+    return true;
+}
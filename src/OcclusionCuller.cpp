@@ -0,0 +1,236 @@
+// OcclusionCuller.cpp
+#include "../include/OcclusionCuller.h"
+#include "../include/Shader.h"
+#include "../include/FullscreenQuad.h"
+#include "../include/DepthPyramid.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// The snapshot is trusted while the camera stays this close to where it was taken
+const float MAX_SNAPSHOT_MOVEMENT = 0.25f;
+const float MAX_SNAPSHOT_ROTATION = 0.005f;    // 1 - cos(angle), about 6 degrees
+
+// Nearest box depth must exceed the occluder depth by this fraction (readback and precision slack)
+const float DEPTH_BIAS = 1.02f;
+
+const size_t GRID_BYTES = sizeof(float) * OcclusionCuller::GRID_WIDTH * OcclusionCuller::GRID_HEIGHT;
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller()
+    : gridFBO(0), gridTexture(0), nextReadback(0), snapshotViewProjection(1.0f),
+      snapshotPosition(0.0f), snapshotFront(0.0f), hasSnapshot(false), active(false) {
+    glGenTextures(1, &gridTexture);
+    glBindTexture(GL_TEXTURE_2D, gridTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, GRID_WIDTH, GRID_HEIGHT, 0, GL_RED, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenFramebuffers(1, &gridFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, gridFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gridTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Occlusion grid framebuffer incomplete!" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (Readback& readback : readbacks) {
+        glGenBuffers(1, &readback.pixelBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(GRID_BYTES), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // Pyramid down to 1x1
+    int width = GRID_WIDTH, height = GRID_HEIGHT;
+    while (true) {
+        levels.emplace_back(static_cast<size_t>(width) * height, FLT_MAX);
+        if (width == 1 && height == 1) break;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    for (Readback& readback : readbacks) {
+        if (readback.fence) {
+            glDeleteSync(readback.fence);
+        }
+        glDeleteBuffers(1, &readback.pixelBuffer);
+    }
+    glDeleteFramebuffers(1, &gridFBO);
+    glDeleteTextures(1, &gridTexture);
+}
+
+bool OcclusionCuller::beginFrame(const glm::vec3& cameraPosition, const glm::vec3& cameraFront) {
+    // Oldest first, so the newest finished readback ends up as the snapshot
+    for (int i = 0; i < READBACK_FRAMES; ++i) {
+        Readback& readback = readbacks[(nextReadback + i) % READBACK_FRAMES];
+        if (!readback.fence) {
+            continue;
+        }
+        GLenum status = glClientWaitSync(readback.fence, 0, 0); // Poll only, never block
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            consume(readback);
+        }
+    }
+
+    active = hasSnapshot &&
+             glm::length(cameraPosition - snapshotPosition) <= MAX_SNAPSHOT_MOVEMENT &&
+             1.0f - glm::dot(cameraFront, snapshotFront) <= MAX_SNAPSHOT_ROTATION;
+    return active;
+}
+
+void OcclusionCuller::capture(Shader& shader, FullscreenQuad& quad, const DepthPyramid& depthPyramid,
+                              const glm::mat4& viewProjection, const glm::vec3& cameraPosition,
+                              const glm::vec3& cameraFront) {
+    // The coarsest level still covering every grid cell with at least one texel
+    int sourceLevel = 0;
+    while (sourceLevel + 1 < depthPyramid.getLevelCount() &&
+           depthPyramid.getLevelWidth(sourceLevel + 1) >= GRID_WIDTH &&
+           depthPyramid.getLevelHeight(sourceLevel + 1) >= GRID_HEIGHT) {
+        ++sourceLevel;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, gridFBO);
+    glViewport(0, 0, GRID_WIDTH, GRID_HEIGHT);
+    glDisable(GL_DEPTH_TEST);
+
+    shader.use();
+    shader.setVec2("gridSize", glm::vec2(GRID_WIDTH, GRID_HEIGHT));
+    shader.setInt("sourceLevel", sourceLevel);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, depthPyramid.getTexture());
+    shader.setInt("depthPyramid", 0);
+    quad.render();
+    glEnable(GL_DEPTH_TEST);
+
+    // A slot still in flight is overwritten; its snapshot would be the oldest anyway
+    Readback& readback = readbacks[nextReadback];
+    if (readback.fence) {
+        glDeleteSync(readback.fence);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+    glReadPixels(0, 0, GRID_WIDTH, GRID_HEIGHT, GL_RED, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.viewProjection = viewProjection;
+    readback.cameraPosition = cameraPosition;
+    readback.cameraFront = cameraFront;
+    nextReadback = (nextReadback + 1) % READBACK_FRAMES;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void OcclusionCuller::invalidate() {
+    for (Readback& readback : readbacks) {
+        if (readback.fence) {
+            glDeleteSync(readback.fence);
+            readback.fence = nullptr;
+        }
+    }
+    hasSnapshot = false;
+    active = false;
+}
+
+void OcclusionCuller::consume(Readback& readback) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+    const void* data = nullptr;
+    {
+        SyncMonitor::Scope sync("occlusion readback map");
+        data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(GRID_BYTES), GL_MAP_READ_BIT);
+    }
+    if (data) {
+        std::memcpy(levels[0].data(), data, GRID_BYTES);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        buildPyramid();
+        snapshotViewProjection = readback.viewProjection;
+        snapshotPosition = readback.cameraPosition;
+        snapshotFront = readback.cameraFront;
+        hasSnapshot = true;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDeleteSync(readback.fence);
+    readback.fence = nullptr;
+}
+
+void OcclusionCuller::buildPyramid() {
+    int width = GRID_WIDTH, height = GRID_HEIGHT;
+    for (size_t level = 1; level < levels.size(); ++level) {
+        int parentWidth = width, parentHeight = height;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        const std::vector<float>& parent = levels[level - 1];
+        std::vector<float>& target = levels[level];
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int x0 = std::min(x * 2, parentWidth - 1), x1 = std::min(x * 2 + 1, parentWidth - 1);
+                int y0 = std::min(y * 2, parentHeight - 1), y1 = std::min(y * 2 + 1, parentHeight - 1);
+                target[y * width + x] = std::max(std::max(parent[y0 * parentWidth + x0], parent[y0 * parentWidth + x1]),
+                                                 std::max(parent[y1 * parentWidth + x0], parent[y1 * parentWidth + x1]));
+            }
+        }
+    }
+}
+
+float OcclusionCuller::sampleLevel(int level, int x, int y) const {
+    int width = std::max(1, GRID_WIDTH >> level);
+    int height = std::max(1, GRID_HEIGHT >> level);
+    x = std::min(x, width - 1);
+    y = std::min(y, height - 1);
+    return levels[level][y * width + x];
+}
+
+bool OcclusionCuller::isOccluded(const BoundingBox& box) const {
+    if (!active || !box.isValid()) {
+        return false;
+    }
+
+    // Screen rectangle and nearest depth of the box as seen by the snapshot camera
+    glm::vec2 minUV(FLT_MAX), maxUV(-FLT_MAX);
+    float nearestDepth = FLT_MAX;
+    for (int corner = 0; corner < 8; ++corner) {
+        glm::vec3 point((corner & 1) ? box.max.x : box.min.x,
+                        (corner & 2) ? box.max.y : box.min.y,
+                        (corner & 4) ? box.max.z : box.min.z);
+        glm::vec4 clip = snapshotViewProjection * glm::vec4(point, 1.0f);
+        if (clip.w <= 1e-3f) {
+            return false; // Reaches behind the camera: the rectangle is unbounded
+        }
+        glm::vec2 uv = glm::vec2(clip) / clip.w * 0.5f + 0.5f;
+        minUV = glm::min(minUV, uv);
+        maxUV = glm::max(maxUV, uv);
+        nearestDepth = std::min(nearestDepth, clip.w); // Perspective w is the linear view depth
+    }
+    if (maxUV.x < 0.0f || maxUV.y < 0.0f || minUV.x > 1.0f || minUV.y > 1.0f) {
+        return false; // Off the snapshot; frustum culling decides
+    }
+    minUV = glm::clamp(minUV, glm::vec2(0.0f), glm::vec2(1.0f));
+    maxUV = glm::clamp(maxUV, glm::vec2(0.0f), glm::vec2(1.0f));
+
+    int x0 = std::min(static_cast<int>(minUV.x * GRID_WIDTH), GRID_WIDTH - 1);
+    int x1 = std::min(static_cast<int>(maxUV.x * GRID_WIDTH), GRID_WIDTH - 1);
+    int y0 = std::min(static_cast<int>(minUV.y * GRID_HEIGHT), GRID_HEIGHT - 1);
+    int y1 = std::min(static_cast<int>(maxUV.y * GRID_HEIGHT), GRID_HEIGHT - 1);
+
+    // Coarsest useful level: the rectangle covers at most 2x2 cells
+    int level = 0;
+    int lastLevel = static_cast<int>(levels.size()) - 1;
+    while (level < lastLevel && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) {
+        ++level;
+    }
+    float farthest = 0.0f;
+    for (int y = y0 >> level; y <= (y1 >> level); ++y) {
+        for (int x = x0 >> level; x <= (x1 >> level); ++x) {
+            farthest = std::max(farthest, sampleLevel(level, x, y));
+        }
+    }
+    return nearestDepth > farthest * DEPTH_BIAS;
+}
@@ -0,0 +1,79 @@
+// OverdrawMonitor.cpp
+#include "../include/OverdrawMonitor.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+
+OverdrawMonitor::OverdrawMonitor() : frame(0), measuring(false), prepassEnabled(false), overdraw(0.0f) {
+    glGenQueries(QUERY_FRAMES, depthQueries);
+    glGenQueries(QUERY_FRAMES, shadingQueries);
+    for (bool& p : pending) {
+        p = false;
+    }
+}
+
+OverdrawMonitor::~OverdrawMonitor() {
+    glDeleteQueries(QUERY_FRAMES, depthQueries);
+    glDeleteQueries(QUERY_FRAMES, shadingQueries);
+}
+
+bool OverdrawMonitor::beginFrame(int mode) {
+    ++frame;
+
+    // This slot was last written QUERY_FRAMES ago; read it if the GPU is done
+    int current = slot();
+    if (pending[current]) {
+        GLint available = 0;
+        glGetQueryObjectiv(shadingQueries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint depthSamples = 0, shadedSamples = 0;
+            {
+                SyncMonitor::Scope sync("overdraw query result");
+                glGetQueryObjectuiv(depthQueries[current], GL_QUERY_RESULT, &depthSamples);
+                glGetQueryObjectuiv(shadingQueries[current], GL_QUERY_RESULT, &shadedSamples);
+            }
+            if (shadedSamples > 0) {
+                overdraw = static_cast<float>(depthSamples) / static_cast<float>(shadedSamples);
+                if (prepassEnabled && overdraw < DISABLE_OVERDRAW) {
+                    prepassEnabled = false;
+                } else if (!prepassEnabled && overdraw > ENABLE_OVERDRAW) {
+                    prepassEnabled = true;
+                }
+            }
+        }
+        // An unfinished result is dropped; the slot is reused now
+        pending[current] = false;
+    }
+
+    switch (mode) {
+        case 0:  measuring = false; break;
+        case 1:  measuring = true; break;
+        default: measuring = prepassEnabled || frame % PROBE_INTERVAL == 1; break;
+    }
+    return measuring;
+}
+
+void OverdrawMonitor::beginDepthPass() {
+    if (measuring) {
+        glBeginQuery(GL_SAMPLES_PASSED, depthQueries[slot()]);
+    }
+}
+
+void OverdrawMonitor::endDepthPass() {
+    if (measuring) {
+        glEndQuery(GL_SAMPLES_PASSED);
+    }
+}
+
+void OverdrawMonitor::beginShadingPass() {
+    if (measuring) {
+        glBeginQuery(GL_SAMPLES_PASSED, shadingQueries[slot()]);
+    }
+}
+
+void OverdrawMonitor::endShadingPass() {
+    if (measuring) {
+        glEndQuery(GL_SAMPLES_PASSED);
+        pending[slot()] = true;
+    }
+}
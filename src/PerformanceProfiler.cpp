@@ -0,0 +1,379 @@
+// PerformanceProfiler.cpp
+#include "../include/PerformanceProfiler.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> allocationCount(0);
+
+/**
+ * Process-wide scope name table (function-local so ids can be interned from
+ * static initialisers)
+ */
+struct ScopeRegistry {
+    std::mutex mutex;
+    std::deque<std::string> names;     ///< By id; a deque keeps the strings in place as it grows
+    std::unordered_map<std::string, PerformanceProfiler::ScopeId> ids;
+};
+
+ScopeRegistry& scopeRegistry() {
+    static ScopeRegistry* registry = new ScopeRegistry(); // Never destroyed: profilers may outlive statics
+    return *registry;
+}
+
+} // namespace
+
+// Counting replacements of the global allocation functions (see PerformanceProfiler.h);
+// the nothrow and array forms forward here by default
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        if (void* memory = std::malloc(size)) {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void PerformanceProfiler::TimingData::updateStats(float newTime) {
+    lastTime = newTime;
+    minTime = std::min(minTime, newTime);
+    maxTime = std::max(maxTime, newTime);
+
+    // Rolling average
+    sampleCount++;
+    float alpha = std::min(1.0f / sampleCount, 0.1f); // Converge to 10-sample average
+    avgTime = avgTime * (1.0f - alpha) + newTime * alpha;
+}
+
+PerformanceProfiler::PerformanceProfiler() {
+}
+
+PerformanceProfiler::~PerformanceProfiler() {
+    for (auto& scope : scopes) {
+        if (scope.gpuInitialized) {
+            glDeleteQueries(GPU_QUERY_FRAMES, scope.gpu.beginQueries);
+            glDeleteQueries(GPU_QUERY_FRAMES, scope.gpu.endQueries);
+        }
+    }
+}
+
+PerformanceProfiler::ScopeId PerformanceProfiler::getScopeId(const char* name) {
+    ScopeRegistry& registry = scopeRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.ids.find(name);
+    if (it != registry.ids.end()) {
+        return it->second;
+    }
+    const ScopeId id = static_cast<ScopeId>(registry.names.size());
+    registry.names.push_back(name);
+    registry.ids.emplace(name, id);
+    return id;
+}
+
+const char* PerformanceProfiler::getScopeName(ScopeId id) {
+    ScopeRegistry& registry = scopeRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return id >= 0 && id < static_cast<ScopeId>(registry.names.size()) ? registry.names[id].c_str() : "";
+}
+
+uint64_t PerformanceProfiler::getAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+PerformanceProfiler::ScopeId PerformanceProfiler::findId(const char* name) {
+    // A literal keeps its address, so the id is found without hashing the text; the
+    // strcmp catches a reused buffer holding a different name
+    auto it = literalIds.find(name);
+    if (it != literalIds.end() && std::strcmp(it->second.name, name) == 0) {
+        return it->second.id;
+    }
+    const ScopeId id = getScopeId(name);
+    literalIds[name] = {id, getScopeName(id)};
+    return id;
+}
+
+PerformanceProfiler::ScopeData* PerformanceProfiler::findScope(const char* name) {
+    const ScopeId id = findId(name);
+    return id < static_cast<ScopeId>(scopes.size()) && scopes[id].used ? &scopes[id] : nullptr;
+}
+
+void PerformanceProfiler::setHistoryRecording(bool enabled, size_t expectedSamples) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    recordHistory = enabled;
+    expectedHistorySamples = expectedSamples;
+}
+
+void PerformanceProfiler::recordSample(std::vector<float>& history, float sample) {
+    if (history.capacity() == 0) {
+        history.reserve(expectedHistorySamples);
+    }
+    history.push_back(sample);
+}
+
+void PerformanceProfiler::beginFrame() {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    frameStart = std::chrono::high_resolution_clock::now();
+    frameCounter++;
+    const uint64_t allocations = getAllocationCount();
+    frameAllocations = allocations - frameStartAllocations;
+    frameStartAllocations = allocations;
+
+    // Collect finished GPU results; anything not yet available stays pending
+    for (auto& scope : scopes) {
+        if (scope.gpuInitialized) {
+            resolveGpuTimer(scope);
+        }
+    }
+}
+
+void PerformanceProfiler::flushGpuTimers() {
+    {
+        // Deliberate (end of a run), but still a full stall
+        SyncMonitor::Scope sync("profiler flush");
+        glFinish();
+    }
+    std::lock_guard<std::mutex> lock(timerMutex);
+    for (auto& scope : scopes) {
+        if (scope.gpuInitialized) {
+            resolveGpuTimer(scope);
+        }
+    }
+}
+
+void PerformanceProfiler::resolveGpuTimer(ScopeData& scope) {
+    GpuTimer& timer = scope.gpu;
+    for (int slot = 0; slot < GPU_QUERY_FRAMES; ++slot) {
+        if (!timer.pending[slot]) {
+            continue;
+        }
+
+        // The end timestamp is written last, so once it is available both are
+        GLint available = 0;
+        glGetQueryObjectiv(timer.endQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            continue;
+        }
+
+        GLuint64 beginTime = 0, endTime = 0;
+        {
+            SyncMonitor::Scope sync("GPU timer query result");
+            glGetQueryObjectui64v(timer.beginQueries[slot], GL_QUERY_RESULT, &beginTime);
+            glGetQueryObjectui64v(timer.endQueries[slot], GL_QUERY_RESULT, &endTime);
+        }
+        timer.pending[slot] = false;
+
+        if (endTime >= beginTime) {
+            float elapsed = static_cast<float>(endTime - beginTime) / 1000000.0f;
+            timer.stats.updateStats(elapsed);
+            if (recordHistory) {
+                recordSample(scope.gpuHistory, elapsed);
+            }
+        }
+    }
+}
+
+void PerformanceProfiler::beginTimer(const char* name) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    beginScope(findId(name));
+}
+
+void PerformanceProfiler::endTimer(const char* name) {
+    auto end = std::chrono::high_resolution_clock::now();
+    std::lock_guard<std::mutex> lock(timerMutex);
+    endScope(findId(name), end);
+}
+
+void PerformanceProfiler::beginTimer(ScopeId id) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    beginScope(id);
+}
+
+void PerformanceProfiler::endTimer(ScopeId id) {
+    auto end = std::chrono::high_resolution_clock::now();
+    std::lock_guard<std::mutex> lock(timerMutex);
+    endScope(id, end);
+}
+
+void PerformanceProfiler::beginScope(ScopeId id) {
+    if (id >= static_cast<ScopeId>(scopes.size())) {
+        scopes.resize(id + 1);
+    }
+    auto& scope = scopes[id];
+    scope.used = true;
+    scope.start = std::chrono::high_resolution_clock::now();
+
+    if (gpuTimingEnabled) {
+        if (!scope.gpuInitialized) {
+            glGenQueries(GPU_QUERY_FRAMES, scope.gpu.beginQueries);
+            glGenQueries(GPU_QUERY_FRAMES, scope.gpu.endQueries);
+            scope.gpuInitialized = true;
+        }
+
+        // A slot still pending after GPU_QUERY_FRAMES frames is dropped rather than waited on
+        int slot = currentQuerySlot();
+        scope.gpu.pending[slot] = false;
+        glQueryCounter(scope.gpu.beginQueries[slot], GL_TIMESTAMP);
+    }
+}
+
+void PerformanceProfiler::endScope(ScopeId id, std::chrono::high_resolution_clock::time_point end) {
+    if (id >= static_cast<ScopeId>(scopes.size()) || !scopes[id].used) {
+        return; // Never begun
+    }
+
+    auto& scope = scopes[id];
+    float elapsed = std::chrono::duration<float, std::milli>(end - scope.start).count();
+    scope.cpu.updateStats(elapsed);
+    if (recordHistory) {
+        recordSample(scope.cpuHistory, elapsed);
+    }
+
+    if (gpuTimingEnabled && scope.gpuInitialized) {
+        int slot = currentQuerySlot();
+        glQueryCounter(scope.gpu.endQueries[slot], GL_TIMESTAMP);
+        scope.gpu.pending[slot] = true;
+    }
+}
+
+void PerformanceProfiler::logDetailedStats() {
+    std::lock_guard<std::mutex> lock(timerMutex);
+
+    std::cout << "\n=== PERFORMANCE BREAKDOWN (Frame " << frameCounter << ") ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    // Sort by the more expensive side of each scope (highest first)
+    sortScratch.clear();
+    for (ScopeId id = 0; id < static_cast<ScopeId>(scopes.size()); ++id) {
+        if (scopes[id].used) {
+            sortScratch.push_back(id);
+        }
+    }
+    std::sort(sortScratch.begin(), sortScratch.end(),
+        [this](ScopeId a, ScopeId b) {
+            return std::max(scopes[a].cpu.avgTime, scopes[a].gpu.stats.avgTime) >
+                   std::max(scopes[b].cpu.avgTime, scopes[b].gpu.stats.avgTime);
+        });
+
+    float totalTime = 0.0f;
+    for (ScopeId id : sortScratch) {
+        totalTime += scopes[id].cpu.avgTime;
+    }
+
+    std::cout << std::setw(20) << "SCOPE" << "  "
+              << std::setw(38) << std::left << "CPU (submit)" << std::right << " | GPU (execute)" << std::endl;
+    for (ScopeId id : sortScratch) {
+        const TimingData& cpu = scopes[id].cpu;
+        const TimingData& gpu = scopes[id].gpu.stats;
+        float percentage = totalTime > 0.0f ? (cpu.avgTime / totalTime) * 100.0f : 0.0f;
+        std::cout << std::setw(20) << getScopeName(id) << ": "
+                  << std::setw(6) << cpu.avgTime << "ms avg ("
+                  << std::setw(5) << percentage << "%) ["
+                  << std::setw(6) << cpu.minTime << " - "
+                  << std::setw(6) << cpu.maxTime << "ms] | ";
+        if (gpu.sampleCount > 0) {
+            std::cout << std::setw(6) << gpu.avgTime << "ms avg ["
+                      << std::setw(6) << gpu.minTime << " - "
+                      << std::setw(6) << gpu.maxTime << "ms]";
+        } else {
+            std::cout << std::setw(6) << "--";
+        }
+        std::cout << std::endl;
+    }
+
+    auto frameEnd = std::chrono::high_resolution_clock::now();
+    float frameTime = std::chrono::duration<float, std::milli>(frameEnd - frameStart).count();
+    std::cout << std::setw(20) << "TOTAL_FRAME" << ": "
+              << std::setw(6) << frameTime << "ms" << std::endl;
+    std::cout << std::setw(20) << "TARGET_60FPS" << ": "
+              << std::setw(6) << "16.67ms (current: " << (1000.0f / frameTime) << " fps)" << std::endl;
+    std::cout << std::setw(20) << "ALLOCATIONS" << ": "
+              << std::setw(6) << frameAllocations << " last frame" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+}
+
+float PerformanceProfiler::getLastTime(const char* name) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    const ScopeData* scope = findScope(name);
+    return scope ? scope->cpu.lastTime : 0.0f;
+}
+
+float PerformanceProfiler::getAverageTime(const char* name) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    const ScopeData* scope = findScope(name);
+    return scope ? scope->cpu.avgTime : 0.0f;
+}
+
+float PerformanceProfiler::getGpuLastTime(const char* name) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    const ScopeData* scope = findScope(name);
+    return scope ? scope->gpu.stats.lastTime : 0.0f;
+}
+
+float PerformanceProfiler::getGpuAverageTime(const char* name) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    const ScopeData* scope = findScope(name);
+    return scope ? scope->gpu.stats.avgTime : 0.0f;
+}
+
+std::vector<std::string> PerformanceProfiler::getScopeNames() {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    std::vector<std::string> names;
+    for (ScopeId id = 0; id < static_cast<ScopeId>(scopes.size()); ++id) {
+        if (scopes[id].used) {
+            names.push_back(getScopeName(id));
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+std::vector<float> PerformanceProfiler::getCpuHistory(const char* name) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    const ScopeData* scope = findScope(name);
+    return scope ? scope->cpuHistory : std::vector<float>();
+}
+
+std::vector<float> PerformanceProfiler::getGpuHistory(const char* name) {
+    std::lock_guard<std::mutex> lock(timerMutex);
+    const ScopeData* scope = findScope(name);
+    return scope ? scope->gpuHistory : std::vector<float>();
+}
@@ -0,0 +1,41 @@
+// PostChain.cpp
+#include "../include/PostChain.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+
+PostChain::PostChain(RenderTargetPool& targetPool) : pool(targetPool), current(0) {
+}
+
+PostChain::~PostChain() {
+    end();
+}
+
+const RenderTarget& PostChain::begin(int width, int height) {
+    end();
+    current = 0;
+    buffers[current] = pool.acquire(width, height, getFormat());
+    return buffers[current];
+}
+
+const RenderTarget& PostChain::advance(int width, int height) {
+    // The buffer two stages back is free now; a matching size gets the same texture again
+    current = 1 - current;
+    if (buffers[current].isValid()) {
+        pool.release(buffers[current]);
+    }
+    buffers[current] = pool.acquire(width, height, getFormat());
+    return buffers[current];
+}
+
+void PostChain::end() {
+    for (RenderTarget& buffer : buffers) {
+        if (buffer.isValid()) {
+            pool.release(buffer);
+            buffer = RenderTarget();
+        }
+    }
+}
+
+unsigned int PostChain::getFormat() {
+    return GL_R11F_G11F_B10F;
+}
@@ -0,0 +1,156 @@
+// ProbeCache.cpp
+#include "../include/ProbeCache.h"
+#include "../include/Shader.h"
+#include "../include/FullscreenQuad.h"
+#include "../include/RenderTargetPool.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// Probe radiance stays HDR; the L1 alpha holds the sample count (up to 16, exact in half floats)
+const GLenum PROBE_FORMAT = GL_RGBA16F;
+
+// G-buffer units of the update pass (0 and 1 hold the probe history)
+const int NORMAL_UNIT = 2;
+const int ALBEDO_UNIT = 3;
+const int LINEAR_DEPTH_UNIT = 4;
+const int EMISSION_UNIT = 5;
+// Scratch unit for the slice copies (rebinding 0 or 1 would swap the history samplers)
+const int COPY_UNIT = 6;
+
+void setIVec3(const Shader& shader, const char* name, const glm::ivec3& value) {
+    glUniform3i(shader.getUniformLocation(name), value.x, value.y, value.z);
+}
+
+} // namespace
+
+ProbeCache::ProbeCache() : sliceFBO(0), origin(0), hasOrigin(false), nextSlice(0), frame(0) {
+    // Probes start empty (valid = 0); the update pass only ever blends into them
+    std::vector<unsigned short> zeros(static_cast<size_t>(GRID_X) * GRID_Y * GRID_Z * 4, 0);
+    glGenTextures(2, probeTextures);
+    for (unsigned int texture : probeTextures) {
+        glBindTexture(GL_TEXTURE_3D, texture);
+        glTexImage3D(GL_TEXTURE_3D, 0, PROBE_FORMAT, GRID_X, GRID_Y, GRID_Z, 0, GL_RGBA, GL_HALF_FLOAT, zeros.data());
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // Toroidal addressing: world cells wrap onto the texture
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    }
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    glGenTextures(2, sliceTextures);
+    glGenFramebuffers(1, &sliceFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, sliceFBO);
+    for (int i = 0; i < 2; ++i) {
+        glBindTexture(GL_TEXTURE_2D, sliceTextures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, PROBE_FORMAT, GRID_X, GRID_Y, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, sliceTextures[i], 0);
+    }
+    unsigned int attachments[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, attachments);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Probe cache framebuffer incomplete!" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+ProbeCache::~ProbeCache() {
+    glDeleteFramebuffers(1, &sliceFBO);
+    glDeleteTextures(2, sliceTextures);
+    glDeleteTextures(2, probeTextures);
+}
+
+void ProbeCache::update(Shader& shader, FullscreenQuad& quad, const glm::vec3& cameraPosition, const GBufferInputs& gBuffer) {
+    ++frame;
+    const glm::ivec3 gridSize(GRID_X, GRID_Y, GRID_Z);
+    glm::ivec3 cameraCell(static_cast<int>(std::floor(cameraPosition.x / SPACING)),
+                          static_cast<int>(std::floor(cameraPosition.y / SPACING)),
+                          static_cast<int>(std::floor(cameraPosition.z / SPACING)));
+    glm::ivec3 newOrigin = cameraCell - gridSize / 2;
+
+    // Without history every texel counts as recycled: a whole grid away maps every cell elsewhere
+    glm::ivec3 previousOrigin = hasOrigin ? origin : newOrigin + gridSize;
+    const bool scrolled = previousOrigin != newOrigin;
+    origin = newOrigin;
+    hasOrigin = true;
+
+    shader.use();
+    shader.setInt("probeL0", 0);
+    shader.setInt("probeL1", 1);
+    shader.setInt("gNormal", NORMAL_UNIT);
+    shader.setInt("gAlbedo", ALBEDO_UNIT);
+    shader.setInt("gLinearDepth", LINEAR_DEPTH_UNIT);
+    shader.setInt("gEmission", EMISSION_UNIT);
+    setIVec3(shader, "gridOrigin", origin);
+    setIVec3(shader, "previousOrigin", previousOrigin);
+    setIVec3(shader, "gridSize", gridSize);
+    shader.setFloat("spacing", SPACING);
+    shader.setInt("frameIndex", static_cast<int>(frame));
+    const int sliceLocation = shader.getUniformLocation("slice");
+    const int traceRaysLocation = shader.getUniformLocation("traceRays");
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_3D, probeTextures[0]);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, probeTextures[1]);
+    glActiveTexture(GL_TEXTURE0 + NORMAL_UNIT);
+    glBindTexture(GL_TEXTURE_2D, gBuffer.normal);
+    glActiveTexture(GL_TEXTURE0 + ALBEDO_UNIT);
+    glBindTexture(GL_TEXTURE_2D, gBuffer.albedo);
+    glActiveTexture(GL_TEXTURE0 + LINEAR_DEPTH_UNIT);
+    glBindTexture(GL_TEXTURE_2D, gBuffer.linearDepth);
+    glActiveTexture(GL_TEXTURE0 + EMISSION_UNIT);
+    glBindTexture(GL_TEXTURE_2D, gBuffer.emission);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, sliceFBO);
+    glViewport(0, 0, GRID_X, GRID_Y);
+
+    // After a scroll every slice passes through once so recycled texels are
+    // cleared under the old origin; only the scheduled ones also trace rays
+    const int firstTraced = nextSlice;
+    nextSlice = (nextSlice + SLICES_PER_FRAME) % GRID_Z;
+    for (int slice = 0; slice < GRID_Z; ++slice) {
+        const bool traced = (slice - firstTraced + GRID_Z) % GRID_Z < SLICES_PER_FRAME;
+        if (!traced && !scrolled) {
+            continue;
+        }
+        shader.setInt(sliceLocation, slice);
+        shader.setBool(traceRaysLocation, traced);
+        quad.render();
+
+        // The slice is never rendered into the texture it reads, so copy it in afterwards
+        glActiveTexture(GL_TEXTURE0 + COPY_UNIT);
+        for (int i = 0; i < 2; ++i) {
+            glReadBuffer(GL_COLOR_ATTACHMENT0 + i);
+            glBindTexture(GL_TEXTURE_3D, probeTextures[i]);
+            glCopyTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, slice, 0, 0, GRID_X, GRID_Y);
+        }
+    }
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void ProbeCache::bindForSampling(Shader& shader) const {
+    shader.setVec3("probeGridOrigin", glm::vec3(origin));
+    shader.setVec3("probeGridSize", glm::vec3(GRID_X, GRID_Y, GRID_Z));
+    shader.setFloat("probeSpacing", SPACING);
+    for (int i = 0; i < 2; ++i) {
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT + i);
+        glBindTexture(GL_TEXTURE_3D, probeTextures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+size_t ProbeCache::getMemoryUsage() const {
+    const size_t texel = RenderTargetPool::getBytesPerPixel(PROBE_FORMAT);
+    return 2 * texel * (static_cast<size_t>(GRID_X) * GRID_Y * GRID_Z + static_cast<size_t>(GRID_X) * GRID_Y);
+}
@@ -0,0 +1,131 @@
+// ProgramCache.cpp
+#include "../include/ProgramCache.h"
+#include "../include/GLExtensions.h"
+#include "../include/MappedFile.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char* PROGRAM_CACHE_DIRECTORY = "cache/shaders";
+const uint32_t PROGRAM_CACHE_MAGIC = 0x42504756; // "VGPB"
+
+struct ProgramCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint32_t binarySize;
+};
+
+// FNV-1a, as for the scene hashes
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t hashString(uint64_t hash, const char* text) {
+    // Hash the terminator too, so ("ab", "c") and ("a", "bc") differ
+    return hashBytes(hash, text ? text : "", text ? std::strlen(text) + 1 : 1);
+}
+
+} // namespace
+
+uint64_t ProgramCache::makeKey(const std::vector<std::string>& sources) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = hashBytes(hash, &VERSION, sizeof(VERSION));
+    hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+    hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    hash = hashString(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    for (const std::string& source : sources) {
+        hash = hashString(hash, source.c_str());
+    }
+    return hash;
+}
+
+std::string ProgramCache::getCachePath(uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return std::string(PROGRAM_CACHE_DIRECTORY) + "/" + name;
+}
+
+bool ProgramCache::load(uint64_t key, unsigned int program) {
+    if (!GLExtensions::hasProgramBinary()) {
+        return false;
+    }
+    MappedFile file;
+    if (!file.open(getCachePath(key)) || file.size() < sizeof(ProgramCacheHeader)) {
+        return false;
+    }
+    ProgramCacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != PROGRAM_CACHE_MAGIC || header.version != VERSION ||
+        header.binarySize == 0 || header.binarySize > file.size() - sizeof(header)) {
+        return false; // Foreign or truncated file, rebuild
+    }
+
+    GLExtensions::programBinary(program, header.binaryFormat, file.data() + sizeof(header),
+                                static_cast<int>(header.binarySize));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked == GL_TRUE;
+}
+
+bool ProgramCache::save(uint64_t key, unsigned int program) {
+    if (!GLExtensions::hasProgramBinary()) {
+        return false;
+    }
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return false;
+    }
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLint written = 0;
+    GLenum format = 0;
+    GLExtensions::getProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) {
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(PROGRAM_CACHE_DIRECTORY, error);
+    if (error) {
+        std::cerr << "Failed to create shader cache directory: " << error.message() << std::endl;
+        return false;
+    }
+
+    // Write to a temporary file first so a crash never leaves a half-written cache behind
+    ProgramCacheHeader header = {PROGRAM_CACHE_MAGIC, VERSION, format, static_cast<uint32_t>(written)};
+    std::string cachePath = getCachePath(key);
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to write shader cache: " << tempPath << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), written);
+        if (!file) {
+            std::cerr << "Failed to write shader cache: " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error) {
+        std::cerr << "Failed to finalize shader cache " << cachePath << ": " << error.message() << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
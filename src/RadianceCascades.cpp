@@ -4,43 +4,94 @@
 #include <GLFW/glfw3.h>
 #include <random>
 #include <cstdlib>
+#include <algorithm>
+#include <utility>
 #include "../include/FullscreenQuad.h"
+#include "../include/GLExtensions.h"
 
 // Remove global variables that conflict with member variables
 
-RadianceCascades::RadianceCascades(int width, int height, int num, float baseSpacing, float angularBase) : screenWidth(width), screenHeight(height), numCascades(num), probeSpacing(baseSpacing), angularResolution(angularBase), rboDepth(0), useTemporalBuffer(true), frameCounter(0), historyTexture(0) {
+namespace {
+
+// Cascades, their history and blur intermediates share one format so they can swap and alias
+const GLenum CASCADE_FORMAT = GL_RGBA16F;
+
+// Half-resolution size of a reduced-rate trace target (rounded up, so every pixel has a texel)
+int halfSize(int size) {
+    return std::max(1, (size + 1) / 2);
+}
+
+// Single-level target with its framebuffer; R8 (SSAO) or RGBA16F (SSR)
+void createTarget(int width, int height, GLenum internalFormat, GLenum filter, unsigned int& fbo, unsigned int& texture) {
+    const bool singleChannel = internalFormat == GL_R8;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, singleChannel ? GL_RED : GL_RGBA,
+                 singleChannel ? GL_UNSIGNED_BYTE : GL_HALF_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Reduced-rate framebuffer " << width << "x" << height << " incomplete!" << std::endl;
+    }
+}
+
+} // namespace
+
+RadianceCascades::RadianceCascades(int width, int height, int num, float baseSpacing, float angularBase) : screenWidth(width), screenHeight(height), outputWidth(width), outputHeight(height), numCascades(num), probeSpacing(baseSpacing), angularResolution(angularBase), rboDepth(0), useTemporalBuffer(true), frameCounter(0), historyTexture(0), historyFBO(0), ssaoKernelBuffer(sizeof(glm::vec4) * SSAO_KERNEL_SIZE, SSAO_KERNEL_BINDING), postResolution(POST_FULL), taaFBO(0), taaTexture(0) {
     setupGBuffer();
     setupCascades();
-    setupBlurTargets();
     setupTemporalBuffers();
     setupTAA(); // Add TAA setup
     setupSSAO(); // Add SSAO setup
     setupSSR(); // Add SSR setup
+    setupReducedTargets();
 }
 
 RadianceCascades::~RadianceCascades() {
     cleanup();
+    cleanupTAA();
 }
 
 // New TAA setup
 void RadianceCascades::setupTAA() {
+    // Create TAA framebuffer and texture
+    glGenFramebuffers(1, &taaFBO);
+    glGenTextures(1, &taaTexture);
+    
+    glBindTexture(GL_TEXTURE_2D, taaTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, outputWidth, outputHeight, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, taaFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, taaTexture, 0);
+    
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "TAA framebuffer incomplete!" << std::endl;
+    }
+    
     glGenTextures(1, &historyTexture);
     glBindTexture(GL_TEXTURE_2D, historyTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, screenWidth, screenHeight, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, outputWidth, outputHeight, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     
-    // Clear using FBO for compatibility
-    GLuint tempFBO;
-    glGenFramebuffers(1, &tempFBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, tempFBO);
+    // History keeps its framebuffer: it swaps roles with the TAA output every frame
+    glGenFramebuffers(1, &historyFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, historyFBO);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyTexture, 0);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glDeleteFramebuffers(1, &tempFBO);
 }
 
 void RadianceCascades::setupCascades() {
@@ -75,10 +126,8 @@ void RadianceCascades::setupCascades() {
         cascadeHeights[i] = res_y;
 
         glBindTexture(GL_TEXTURE_2D, cascadeTextures[i]);
-        // Use higher precision for first few cascades, 16-bit for others
-        GLenum internalFormat = (i < 2) ? GL_RGBA32F : GL_RGBA16F; // 32-bit for cascade 0-1, 16-bit for others
-        GLenum dataType = (i < 2) ? GL_FLOAT : GL_HALF_FLOAT;
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, res_x, res_y, 0, GL_RGBA, dataType, NULL);
+        // 16-bit is plenty for filtered radiance; alpha carries beta (sky visibility), so no R11G11B10F
+        glTexImage2D(GL_TEXTURE_2D, 0, CASCADE_FORMAT, res_x, res_y, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -98,15 +147,7 @@ void RadianceCascades::setupGBuffer() {
     glGenFramebuffers(1, &gBuffer);
     glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
 
-    // Position buffer (16-bit is sufficient for most scenes)
-    glGenTextures(1, &gPosition);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, screenWidth, screenHeight, 0, GL_RGB, GL_HALF_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
+    // No position buffer: passes rebuild view position from linear depth (shaders/view_position.glsl)
 
     // Normal buffer (RG16F - reconstruct Z component for bandwidth savings)
     glGenTextures(1, &gNormal);
@@ -128,10 +169,10 @@ void RadianceCascades::setupGBuffer() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedo, 0);
 
-    // Linear Depth (16-bit sufficient for depth)
+    // Linear depth (32-bit: positions are reconstructed from it)
     glGenTextures(1, &gDepth);
     glBindTexture(GL_TEXTURE_2D, gDepth);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, screenWidth, screenHeight, 0, GL_RED, GL_HALF_FLOAT, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, screenWidth, screenHeight, 0, GL_RED, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -148,10 +189,10 @@ void RadianceCascades::setupGBuffer() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT4, GL_TEXTURE_2D, gVelocity, 0);
 
-    // Emission buffer (16-bit RGB for HDR emission values)
+    // Emission buffer (packed R11G11B10F, HDR without alpha)
     glGenTextures(1, &gEmission);
     glBindTexture(GL_TEXTURE_2D, gEmission);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, screenWidth, screenHeight, 0, GL_RGB, GL_HALF_FLOAT, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, screenWidth, screenHeight, 0, GL_RGB, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -165,7 +206,8 @@ void RadianceCascades::setupGBuffer() {
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
 
-    unsigned int attachments[6] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5};
+    // Output location 0 (the old position target) is left unbound
+    unsigned int attachments[6] = {GL_NONE, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5};
     glDrawBuffers(6, attachments);
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
@@ -174,32 +216,6 @@ void RadianceCascades::setupGBuffer() {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void RadianceCascades::setupBlurTargets() {
-    tempBlurFBOs.resize(numCascades);
-    tempBlurTextures.resize(numCascades);
-    glGenFramebuffers(numCascades, tempBlurFBOs.data());
-    glGenTextures(numCascades, tempBlurTextures.data());
-
-    for (int i = 0; i < numCascades; ++i) {
-        int res_x = cascadeWidths[i];
-        int res_y = cascadeHeights[i];
-
-        glBindTexture(GL_TEXTURE_2D, tempBlurTextures[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, res_x, res_y, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-        glBindFramebuffer(GL_FRAMEBUFFER, tempBlurFBOs[i]);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tempBlurTextures[i], 0);
-        
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-            std::cerr << "Blur framebuffer " << i << " incomplete!" << std::endl;
-        }
-    }
-}
-
 void RadianceCascades::setupTemporalBuffers() {
     temporalFBOs.resize(numCascades);
     temporalTextures.resize(numCascades);
@@ -230,56 +246,49 @@ void RadianceCascades::setupTemporalBuffers() {
     }
 }
 
-void RadianceCascades::blur(Shader& blurShader, int activeCascades) {
+void RadianceCascades::blur(Shader& blurShader, int activeCascades, unsigned int updateMask) {
     if (activeCascades == -1) activeCascades = numCascades; // Use all cascades by default
     blurShader.use();
-    FullscreenQuad quad;
+    blurShader.setInt("inputTexture", 0);
+    blurShader.setInt("gLinearDepth", 1);
+    blurShader.setInt("gNormal", 2);
+    const int blurDirectionLocation = blurShader.getUniformLocation("blurDirection");
+    
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, gDepth);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, gNormal);
     
     // Apply blur to active cascades for consistent smoothing
     for (int i = 0; i < activeCascades; ++i) {
+        if (!(updateMask & (1u << i))) {
+            continue; // Not recomputed: blurring again would smear last frame's result further
+        }
         int res_x = cascadeWidths[i];
         int res_y = cascadeHeights[i];
         
         // Apply blur to ALL cascades now that we have better resolutions
         // Even small cascades benefit from denoising
         
+        // The intermediate only lives between the two passes, so it comes from the
+        // pool: same-sized cascades share it
+        RenderTarget temp = targetPool.acquire(res_x, res_y, CASCADE_FORMAT);
+        
         // PASS 1: Horizontal blur (cascade -> temp)
-        glBindFramebuffer(GL_FRAMEBUFFER, tempBlurFBOs[i]);
+        glBindFramebuffer(GL_FRAMEBUFFER, temp.fbo);
         glViewport(0, 0, res_x, res_y);
-        glClear(GL_COLOR_BUFFER_BIT);
-        
-        blurShader.setInt("blurDirection", 0); // Horizontal
-        blurShader.setInt("inputTexture", 0);
-        blurShader.setInt("gPosition", 1);
-        blurShader.setInt("gNormal", 2);
-        
+        blurShader.setInt(blurDirectionLocation, 0); // Horizontal
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, cascadeTextures[i]);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
-        
         quad.render();
         
         // PASS 2: Vertical blur (temp -> cascade)
         glBindFramebuffer(GL_FRAMEBUFFER, cascadeFBOs[i]);
-        glViewport(0, 0, res_x, res_y);
-        glClear(GL_COLOR_BUFFER_BIT);
-        
-        blurShader.setInt("blurDirection", 1); // Vertical
-        blurShader.setInt("inputTexture", 0);
-        blurShader.setInt("gPosition", 1);
-        blurShader.setInt("gNormal", 2);
-        
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, tempBlurTextures[i]); // Use temp texture as input
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
-        
+        blurShader.setInt(blurDirectionLocation, 1); // Vertical
+        glBindTexture(GL_TEXTURE_2D, temp.texture); // Use temp texture as input
         quad.render();
+        
+        targetPool.release(temp);
     }
     
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -292,8 +301,6 @@ void RadianceCascades::bindGBufferForWriting() {
 }
 
 void RadianceCascades::bindForReading() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, gNormal);
     glActiveTexture(GL_TEXTURE2);
@@ -306,7 +313,6 @@ void RadianceCascades::bindForReading() {
 
 void RadianceCascades::cleanup() {
     glDeleteFramebuffers(1, &gBuffer);
-    glDeleteTextures(1, &gPosition);
     glDeleteTextures(1, &gNormal);
     glDeleteTextures(1, &gAlbedo);
     glDeleteTextures(1, &gDepth);
@@ -315,11 +321,8 @@ void RadianceCascades::cleanup() {
     glDeleteRenderbuffers(1, &rboDepth);
     glDeleteFramebuffers(numCascades, cascadeFBOs.data());
     glDeleteTextures(numCascades, cascadeTextures.data());
-    glDeleteFramebuffers(numCascades, tempBlurFBOs.data());
-    glDeleteTextures(numCascades, tempBlurTextures.data());
     glDeleteFramebuffers(numCascades, temporalFBOs.data());
     glDeleteTextures(numCascades, temporalTextures.data());
-    glDeleteTextures(1, &historyTexture);
     
     // SSAO cleanup
     glDeleteFramebuffers(1, &ssaoFBO);
@@ -332,9 +335,14 @@ void RadianceCascades::cleanup() {
     glDeleteFramebuffers(1, &ssrFBO);
     glDeleteTextures(1, &ssrTexture);
     
-    // TAA cleanup
+    cleanupReducedTargets();
+}
+
+void RadianceCascades::cleanupTAA() {
     glDeleteFramebuffers(1, &taaFBO);
     glDeleteTextures(1, &taaTexture);
+    glDeleteFramebuffers(1, &historyFBO);
+    glDeleteTextures(1, &historyTexture);
 }
 
 void RadianceCascades::resize(int width, int height) {
@@ -342,33 +350,49 @@ void RadianceCascades::resize(int width, int height) {
     screenHeight = height;
     frameCounter = 0; // Reset temporal accumulation on resize
     cleanup();
+    targetPool.clear(); // Every pooled size is stale now
     setupGBuffer();
     setupCascades();
-    setupBlurTargets();
     setupTemporalBuffers();
-    setupTAA(); // Re-setup TAA on resize
     setupSSAO(); // Re-setup SSAO on resize
     setupSSR(); // Re-setup SSR on resize
+    setupReducedTargets();
+}
+
+void RadianceCascades::setOutputSize(int width, int height) {
+    if (width == outputWidth && height == outputHeight) {
+        return;
+    }
+    outputWidth = width;
+    outputHeight = height;
+    cleanupTAA();
+    setupTAA();
 }
 
-void RadianceCascades::compute(Shader& shader, const glm::mat4& view, const glm::mat4& projection, int activeCascades) {
+void RadianceCascades::compute(Shader& shader, int activeCascades, unsigned int updateMask) {
     if (activeCascades == -1) activeCascades = numCascades; // Use all cascades by default
     shader.use();
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
-    shader.setFloat("time", glfwGetTime());
+    shader.setFloat("time", animationTime);
     shader.setInt("frameCounter", frameCounter);
     shader.setBool("useTemporalAccumulation", useTemporalBuffer && frameCounter > 0);
-    shader.setInt("gPosition", 0);
     shader.setInt("gNormal", 1);
     shader.setInt("gAlbedo", 2);
     shader.setInt("gLinearDepth", 3);
     shader.setInt("gEmission", 6); // Add emission texture for GI calculations (avoid conflict with previousCascade)
+    shader.setInt("gVelocity", 7); // History reprojection
     
     bindForReading();
-    FullscreenQuad quad;
+    glActiveTexture(GL_TEXTURE7);
+    glBindTexture(GL_TEXTURE_2D, gVelocity);
+    swapHistory(activeCascades, updateMask);
+    
+    // Set once per cascade, resolve it up front
+    const int cascadeIndexLocation = shader.getUniformLocation("cascadeIndex");
     
     for (int i = activeCascades - 1; i >= 0; --i) {
+        if (!(updateMask & (1u << i))) {
+            continue;
+        }
         int res_x = cascadeWidths[i];
         int res_y = cascadeHeights[i];
         
@@ -377,9 +401,7 @@ void RadianceCascades::compute(Shader& shader, const glm::mat4& view, const glm:
         glViewport(0, 0, res_x, res_y);
         glClear(GL_COLOR_BUFFER_BIT);
         
-        shader.setInt("cascadeIndex", i);
-        shader.setFloat("minDist", pow(2.0f, float(i)));
-        shader.setFloat("maxDist", pow(2.0f, float(i + 1)));
+        shader.setInt(cascadeIndexLocation, i); // The shader derives its distance band from the index
         
         // Bind previous cascade (spatial hierarchy)
         if (i < numCascades - 1) {
@@ -399,13 +421,6 @@ void RadianceCascades::compute(Shader& shader, const glm::mat4& view, const glm:
         }
         
         quad.render();
-        
-        // Copy result to temporal buffer for next frame
-        if (useTemporalBuffer) {
-            glBindFramebuffer(GL_READ_FRAMEBUFFER, cascadeFBOs[i]);
-            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, temporalFBOs[i]);
-            glBlitFramebuffer(0, 0, res_x, res_y, 0, 0, res_x, res_y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
-        }
     }
     
     frameCounter++;
@@ -413,17 +428,127 @@ void RadianceCascades::compute(Shader& shader, const glm::mat4& view, const glm:
     glViewport(0, 0, screenWidth, screenHeight);
 }
 
+void RadianceCascades::dispatch(Shader& computeShader, int activeCascades, unsigned int updateMask) {
+    if (activeCascades == -1) activeCascades = numCascades;
+    const bool temporal = useTemporalBuffer && frameCounter > 0;
+    computeShader.use();
+    computeShader.setFloat("time", animationTime);
+    computeShader.setInt("frameCounter", frameCounter);
+    computeShader.setBool("useTemporalAccumulation", temporal);
+    computeShader.setInt("gNormal", 1);
+    computeShader.setInt("gAlbedo", 2);
+    computeShader.setInt("gLinearDepth", 3);
+    computeShader.setInt("previousCascade", 4);
+    computeShader.setInt("gEmission", 6);
+    computeShader.setInt("gVelocity", 7);
+    bindForReading();
+    glActiveTexture(GL_TEXTURE7);
+    glBindTexture(GL_TEXTURE_2D, gVelocity);
+    swapHistory(activeCascades, updateMask);
+
+    const int cascadeIndexLocation = computeShader.getUniformLocation("cascadeIndex");
+    const int outputSizeLocation = computeShader.getUniformLocation("outputSize");
+    const int previousSizeLocation = computeShader.getUniformLocation("previousSize");
+    const int hasPreviousLocation = computeShader.getUniformLocation("hasPreviousCascade");
+    const int previousInTileLocation = computeShader.getUniformLocation("previousInTile");
+
+    for (int i = activeCascades - 1; i >= 0; --i) {
+        if (!(updateMask & (1u << i))) {
+            continue;
+        }
+        int res_x = cascadeWidths[i];
+        int res_y = cascadeHeights[i];
+        bool hasPrevious = i < numCascades - 1;
+
+        computeShader.setInt(cascadeIndexLocation, i);
+        glUniform2i(outputSizeLocation, res_x, res_y);
+        computeShader.setBool(hasPreviousLocation, hasPrevious);
+        if (hasPrevious) {
+            int prev_x = cascadeWidths[i + 1];
+            int prev_y = cascadeHeights[i + 1];
+            glUniform2i(previousSizeLocation, prev_x, prev_y);
+            // An 8x8 group reads 8*ratio+2 coarse texels per axis; the tile holds 16
+            bool fits = prev_x * 8 + 2 * res_x <= 16 * res_x && prev_y * 8 + 2 * res_y <= 16 * res_y;
+            computeShader.setBool(previousInTileLocation, fits);
+            glActiveTexture(GL_TEXTURE4);
+            glBindTexture(GL_TEXTURE_2D, cascadeTextures[i + 1]);
+        }
+
+        GLExtensions::bindImageTexture(0, cascadeTextures[i], 0, false, 0, GL_WRITE_ONLY, CASCADE_FORMAT);
+        GLExtensions::bindImageTexture(1, temporalTextures[i], 0, false, 0, GL_READ_ONLY, CASCADE_FORMAT);
+        GLExtensions::dispatchCompute(static_cast<unsigned int>((res_x + 7) / 8),
+                                      static_cast<unsigned int>((res_y + 7) / 8), 1);
+        // The next (finer) cascade samples this one as its merge source
+        GLExtensions::memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    // Later passes sample the cascades, blur renders into them and history may be cleared through its FBOs
+    GLExtensions::memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                                GL_FRAMEBUFFER_BARRIER_BIT);
+    frameCounter++;
+}
+
+void RadianceCascades::swapHistory(int activeCascades, unsigned int updateMask) {
+    // Last frame's (blurred) output becomes this frame's history instead of being copied.
+    // Inactive and skipped cascades keep their textures so merge sources stay stable.
+    if (!useTemporalBuffer) {
+        return;
+    }
+    for (int i = 0; i < activeCascades; ++i) {
+        if (!(updateMask & (1u << i))) {
+            continue;
+        }
+        std::swap(cascadeTextures[i], temporalTextures[i]);
+        std::swap(cascadeFBOs[i], temporalFBOs[i]);
+    }
+}
+
+RadianceCascades::MemoryUsage RadianceCascades::getMemoryUsage(int activeCascades, int blurredCascades) const {
+    const size_t screenPixels = static_cast<size_t>(screenWidth) * screenHeight;
+    const size_t cascadeTexel = RenderTargetPool::getBytesPerPixel(CASCADE_FORMAT);
+    MemoryUsage usage;
+
+    // Normal RG16F, albedo RGBA8, linear depth R32F, velocity RG16F, emission R11G11B10F, depth 24-bit
+    usage.gBuffer = screenPixels * (RenderTargetPool::getBytesPerPixel(GL_RG16F) * 2 +
+                                    RenderTargetPool::getBytesPerPixel(GL_RGBA8) +
+                                    RenderTargetPool::getBytesPerPixel(GL_R32F) +
+                                    RenderTargetPool::getBytesPerPixel(GL_R11F_G11F_B10F) +
+                                    RenderTargetPool::getBytesPerPixel(GL_DEPTH_COMPONENT24));
+
+    // Cascade output and its history (the previous output) per active cascade;
+    // blur intermediates are pooled, so only one per distinct cascade size exists
+    std::vector<std::pair<int, int>> blurSizes;
+    for (int i = 0; i < std::min(activeCascades, numCascades); ++i) {
+        size_t bytes = static_cast<size_t>(cascadeWidths[i]) * cascadeHeights[i] * cascadeTexel;
+        usage.cascades += bytes;
+        usage.history += bytes;
+        std::pair<int, int> size(cascadeWidths[i], cascadeHeights[i]);
+        if (i < blurredCascades && std::find(blurSizes.begin(), blurSizes.end(), size) == blurSizes.end()) {
+            blurSizes.push_back(size);
+            usage.transient += bytes;
+        }
+    }
+
+    // SSAO raw + blurred (R8), SSR (RGBA16F); TAA output + history (RGBA16F) at output resolution
+    const size_t outputPixels = static_cast<size_t>(outputWidth) * outputHeight;
+    const size_t ssaoSsrTexel = RenderTargetPool::getBytesPerPixel(GL_RGBA16F) + RenderTargetPool::getBytesPerPixel(GL_R8);
+    usage.post = screenPixels * (RenderTargetPool::getBytesPerPixel(GL_RGBA16F) +
+                                 RenderTargetPool::getBytesPerPixel(GL_R8) * 2) +
+                 outputPixels * RenderTargetPool::getBytesPerPixel(GL_RGBA16F) * 2;
+    if (postResolution != POST_FULL) {
+        // Half-resolution traces plus a full-resolution history of each
+        const size_t halfPixels = static_cast<size_t>(halfSize(screenWidth)) * halfSize(screenHeight);
+        usage.post += (halfPixels + screenPixels) * ssaoSsrTexel;
+    }
+    return usage;
+}
+
 void RadianceCascades::resetTemporalAccumulation() {
     frameCounter = 0;
-    
-    // Clear all temporal buffers
-    for (int i = 0; i < numCascades; ++i) {
-        glBindFramebuffer(GL_FRAMEBUFFER, temporalFBOs[i]);
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-    }
-    
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    ssaoReduced.historyValid = false;
+    ssrReduced.historyValid = false;
+    // No need to clear the temporal buffers: with frameCounter at 0 neither GI
+    // path reads them (useTemporalAccumulation), and the next frame overwrites them
 }
 
 void RadianceCascades::setTemporalAccumulation(bool enabled) {
@@ -439,8 +564,8 @@ unsigned int RadianceCascades::getTexture(int cascade) const {
 unsigned int RadianceCascades::getCascadeFBO(int cascade) const {
     return cascadeFBOs[cascade];
 }
-unsigned int RadianceCascades::getGPosition() const {
-    return gPosition;
+unsigned int RadianceCascades::getGLinearDepth() const {
+    return gDepth;
 }
 unsigned int RadianceCascades::getGNormal() const {
     return gNormal;
@@ -475,7 +600,7 @@ void RadianceCascades::setupSSAO() {
     // SSAO texture (R8 for occlusion values)
     glGenTextures(1, &ssaoTexture);
     glBindTexture(GL_TEXTURE_2D, ssaoTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, screenWidth, screenHeight, 0, GL_RED, GL_FLOAT, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, screenWidth, screenHeight, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -493,7 +618,7 @@ void RadianceCascades::setupSSAO() {
     // SSAO blur texture
     glGenTextures(1, &ssaoBlurTexture);
     glBindTexture(GL_TEXTURE_2D, ssaoBlurTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, screenWidth, screenHeight, 0, GL_RED, GL_FLOAT, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, screenWidth, screenHeight, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -511,7 +636,7 @@ void RadianceCascades::generateSSAOKernel() {
     ssaoKernel.clear();
     
     // Generate 32 sample points in hemisphere (optimized)
-    for (int i = 0; i < 32; ++i) {
+    for (int i = 0; i < SSAO_KERNEL_SIZE; ++i) {
         glm::vec3 sample(
             ((float)rand() / RAND_MAX) * 2.0f - 1.0f,
             ((float)rand() / RAND_MAX) * 2.0f - 1.0f,
@@ -522,12 +647,15 @@ void RadianceCascades::generateSSAOKernel() {
         sample *= (float)rand() / RAND_MAX;
         
         // Bias samples toward origin for better results
-        float scale = (float)i / 32.0f;
+        float scale = (float)i / (float)SSAO_KERNEL_SIZE;
         scale = 0.1f + scale * scale * (1.0f - 0.1f); // Lerp between 0.1 and 1.0
         sample *= scale;
         
-        ssaoKernel.push_back(sample);
+        ssaoKernel.push_back(glm::vec4(sample, 0.0f));
     }
+    
+    // The kernel only changes here, so it is uploaded once instead of on every computeSSAO()
+    ssaoKernelBuffer.update(ssaoKernel.data(), ssaoKernel.size() * sizeof(glm::vec4));
 }
 
 void RadianceCascades::generateNoiseTexture() {
@@ -552,22 +680,22 @@ void RadianceCascades::generateNoiseTexture() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 } 
 
-void RadianceCascades::computeSSAO(Shader& ssaoShader, const glm::mat4& projection) {
-    glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
-    glClear(GL_COLOR_BUFFER_BIT);
+void RadianceCascades::computeSSAO(Shader& ssaoShader, Shader& reconstructShader) {
+    int checkerParity = -1;
+    if (postResolution == POST_FULL) {
+        glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
+        glClear(GL_COLOR_BUFFER_BIT);
+    } else {
+        checkerParity = beginReducedTrace(ssaoReduced);
+    }
     
     ssaoShader.use();
-    ssaoShader.setMat4("projection", projection);
-    
-    // Send kernel samples to shader
-    for (int i = 0; i < 32; ++i) {
-        ssaoShader.setVec3("samples[" + std::to_string(i) + "]", ssaoKernel[i]);
-    }
+    ssaoShader.setInt("checkerParity", checkerParity);
     
     // Bind G-buffer textures
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    ssaoShader.setInt("gPosition", 0);
+    glBindTexture(GL_TEXTURE_2D, gDepth);
+    ssaoShader.setInt("gLinearDepth", 0);
     
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, gNormal);
@@ -577,9 +705,12 @@ void RadianceCascades::computeSSAO(Shader& ssaoShader, const glm::mat4& projecti
     glBindTexture(GL_TEXTURE_2D, noiseTexture);
     ssaoShader.setInt("texNoise", 2);
     
-    FullscreenQuad quad;
     quad.render();
     
+    if (postResolution != POST_FULL) {
+        reconstruct(reconstructShader, ssaoReduced, checkerParity, ssaoTexture, ssaoFBO);
+    }
+    
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
@@ -592,7 +723,6 @@ void RadianceCascades::blurSSAO(Shader& blurShader) {
     glBindTexture(GL_TEXTURE_2D, ssaoTexture);
     blurShader.setInt("ssaoInput", 0);
     
-    FullscreenQuad quad;
     quad.render();
     
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -618,42 +748,24 @@ void RadianceCascades::setupSSR() {
     }
     
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    
-    // Create TAA framebuffer and texture
-    glGenFramebuffers(1, &taaFBO);
-    glGenTextures(1, &taaTexture);
-    
-    glBindTexture(GL_TEXTURE_2D, taaTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, screenWidth, screenHeight, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    
-    glBindFramebuffer(GL_FRAMEBUFFER, taaFBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, taaTexture, 0);
-    
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "TAA framebuffer incomplete!" << std::endl;
-    }
-    
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void RadianceCascades::computeSSR(Shader& ssrShader, unsigned int colorTexture, const glm::mat4& view, 
-                                  const glm::mat4& projection, const glm::vec3& viewPos) {
-    glBindFramebuffer(GL_FRAMEBUFFER, ssrFBO);
-    glClear(GL_COLOR_BUFFER_BIT);
+void RadianceCascades::computeSSR(Shader& ssrShader, Shader& reconstructShader, unsigned int colorTexture) {
+    int checkerParity = -1;
+    if (postResolution == POST_FULL) {
+        glBindFramebuffer(GL_FRAMEBUFFER, ssrFBO);
+        glClear(GL_COLOR_BUFFER_BIT);
+    } else {
+        checkerParity = beginReducedTrace(ssrReduced);
+    }
     
     ssrShader.use();
-    ssrShader.setMat4("view", view);
-    ssrShader.setMat4("projection", projection);
-    ssrShader.setVec3("viewPos", viewPos);
+    ssrShader.setInt("checkerParity", checkerParity);
     
     // Bind G-buffer textures
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    ssrShader.setInt("gPosition", 0);
+    glBindTexture(GL_TEXTURE_2D, gDepth);
+    ssrShader.setInt("gLinearDepth", 0);
     
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, gNormal);
@@ -667,20 +779,130 @@ void RadianceCascades::computeSSR(Shader& ssrShader, unsigned int colorTexture,
     glBindTexture(GL_TEXTURE_2D, colorTexture);
     ssrShader.setInt("colorTexture", 3);
     
-    FullscreenQuad quad;
     quad.render();
     
+    if (postResolution != POST_FULL) {
+        reconstruct(reconstructShader, ssrReduced, checkerParity, ssrTexture, ssrFBO);
+    }
+    
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void RadianceCascades::applyTAA(Shader& taaShader, unsigned int currentFrame, 
-                                const glm::mat4& currentViewProj, const glm::mat4& previousViewProj) {
+void RadianceCascades::applySSR(Shader& resolveShader, unsigned int colorTexture, unsigned int outputFBO) {
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+    glViewport(0, 0, screenWidth, screenHeight);
+    
+    resolveShader.use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    resolveShader.setInt("colorTexture", 0);
+    
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, ssrTexture);
+    resolveShader.setInt("ssrTexture", 1);
+    
+    quad.render();
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RadianceCascades::setPostResolution(int mode) {
+    mode = std::max(static_cast<int>(POST_FULL), std::min(mode, static_cast<int>(POST_CHECKERBOARD)));
+    if (mode == postResolution) {
+        return;
+    }
+    // Half and checkerboard share targets; only crossing POST_FULL reallocates
+    const bool reallocate = (mode == POST_FULL) != (postResolution == POST_FULL);
+    postResolution = mode;
+    if (reallocate) {
+        cleanupReducedTargets();
+        setupReducedTargets();
+    }
+    ssaoReduced.historyValid = false;
+    ssrReduced.historyValid = false;
+}
+
+void RadianceCascades::setupReducedTargets() {
+    ssaoReduced.historyValid = false;
+    ssrReduced.historyValid = false;
+    if (postResolution == POST_FULL) {
+        return;
+    }
+    const int traceWidth = halfSize(screenWidth);
+    const int traceHeight = halfSize(screenHeight);
+    // Traces are read texel by texel; the histories are sampled at reprojected positions
+    createTarget(traceWidth, traceHeight, GL_R8, GL_NEAREST, ssaoReduced.traceFBO, ssaoReduced.traceTexture);
+    createTarget(screenWidth, screenHeight, GL_R8, GL_NEAREST, ssaoReduced.historyFBO, ssaoReduced.historyTexture);
+    createTarget(traceWidth, traceHeight, GL_RGBA16F, GL_NEAREST, ssrReduced.traceFBO, ssrReduced.traceTexture);
+    createTarget(screenWidth, screenHeight, GL_RGBA16F, GL_LINEAR, ssrReduced.historyFBO, ssrReduced.historyTexture);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RadianceCascades::cleanupReducedTargets() {
+    for (ReducedRateTargets* targets : {&ssaoReduced, &ssrReduced}) {
+        if (targets->traceTexture == 0) {
+            continue;
+        }
+        glDeleteFramebuffers(1, &targets->traceFBO);
+        glDeleteTextures(1, &targets->traceTexture);
+        glDeleteFramebuffers(1, &targets->historyFBO);
+        glDeleteTextures(1, &targets->historyTexture);
+        *targets = ReducedRateTargets();
+    }
+}
+
+int RadianceCascades::beginReducedTrace(ReducedRateTargets& targets) {
+    glBindFramebuffer(GL_FRAMEBUFFER, targets.traceFBO);
+    glViewport(0, 0, halfSize(screenWidth), halfSize(screenHeight));
+    ++targets.frame;
+    // The untraced checkerboard half must hold something from an earlier frame
+    if (postResolution != POST_CHECKERBOARD || !targets.historyValid) {
+        return -1;
+    }
+    return static_cast<int>(targets.frame & 1u);
+}
+
+void RadianceCascades::reconstruct(Shader& reconstructShader, ReducedRateTargets& targets, int checkerParity,
+                                   unsigned int& outputTexture, unsigned int& outputFBO) {
+    // Last frame's result becomes the history and its storage takes this frame's
+    std::swap(outputTexture, targets.historyTexture);
+    std::swap(outputFBO, targets.historyFBO);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+    glViewport(0, 0, screenWidth, screenHeight);
+    
+    reconstructShader.use();
+    reconstructShader.setInt("traceTexture", 0);
+    reconstructShader.setInt("historyTexture", 1);
+    reconstructShader.setInt("gLinearDepth", 2);
+    reconstructShader.setInt("gVelocity", 3);
+    reconstructShader.setInt("checkerParity", checkerParity);
+    reconstructShader.setBool("useHistory", targets.historyValid);
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, targets.traceTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, targets.historyTexture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, gDepth);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, gVelocity);
+    
+    quad.render();
+    targets.historyValid = true;
+}
+
+void RadianceCascades::applyTAA(Shader& taaShader, unsigned int currentFrame) {
+    // Last frame's output becomes the history and its old storage takes this frame's output
+    std::swap(taaTexture, historyTexture);
+    std::swap(taaFBO, historyFBO);
+    
+    // Resolve to the output: the current frame may be smaller and is upsampled by the lookups
     glBindFramebuffer(GL_FRAMEBUFFER, taaFBO);
+    glViewport(0, 0, outputWidth, outputHeight);
     glClear(GL_COLOR_BUFFER_BIT);
     
     taaShader.use();
-    taaShader.setMat4("currentViewProj", currentViewProj);
-    taaShader.setMat4("previousViewProj", previousViewProj);
     taaShader.setFloat("frameCounter", float(frameCounter));
     
     // Bind textures
@@ -696,32 +918,21 @@ void RadianceCascades::applyTAA(Shader& taaShader, unsigned int currentFrame,
     glBindTexture(GL_TEXTURE_2D, gVelocity);
     taaShader.setInt("gVelocity", 2);
     
+    // Disocclusion test and velocity dilation (the history keeps the output's depth in alpha)
     glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    taaShader.setInt("gPosition", 3);
+    glBindTexture(GL_TEXTURE_2D, getGLinearDepth());
+    taaShader.setInt("gLinearDepth", 3);
+    glActiveTexture(GL_TEXTURE0);
     
-    FullscreenQuad quad;
     quad.render();
     
-    // Copy result to history buffer for next frame
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, taaFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-    
-    // Create temporary FBO for history texture
-    GLuint tempFBO;
-    glGenFramebuffers(1, &tempFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, tempFBO);
-    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyTexture, 0);
-    
-    glBlitFramebuffer(0, 0, screenWidth, screenHeight, 0, 0, screenWidth, screenHeight, 
-                      GL_COLOR_BUFFER_BIT, GL_LINEAR);
-    
-    glDeleteFramebuffers(1, &tempFBO);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void RadianceCascades::applyFXAA(Shader& fxaaShader, unsigned int inputTexture) {
-    glBindFramebuffer(GL_FRAMEBUFFER, taaFBO); // Reuse TAA FBO for FXAA output
+void RadianceCascades::applyFXAA(Shader& fxaaShader, unsigned int inputTexture, unsigned int outputFBO) {
+    // The output is the PostChain's, so TAA history survives FXAA frames
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+    glViewport(0, 0, outputWidth, outputHeight);
     glClear(GL_COLOR_BUFFER_BIT);
     
     fxaaShader.use();
@@ -729,7 +940,6 @@ void RadianceCascades::applyFXAA(Shader& fxaaShader, unsigned int inputTexture)
     glBindTexture(GL_TEXTURE_2D, inputTexture);
     fxaaShader.setInt("inputTexture", 0);
     
-    FullscreenQuad quad;
     quad.render();
     
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -0,0 +1,45 @@
+// Registry.cpp
+#include "../include/Registry.h"
+
+EntityId Registry::createEntity() {
+    EntityId entity;
+    if (!freeIds.empty()) {
+        entity = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        entity = static_cast<EntityId>(alive.size());
+        alive.push_back(false);
+    }
+    alive[entity] = true;
+    aliveCount++;
+    return entity;
+}
+
+void Registry::destroyEntity(EntityId entity) {
+    if (!isAlive(entity)) {
+        return;
+    }
+    for (auto& pool : pools) {
+        if (pool) {
+            pool->remove(entity);
+        }
+    }
+    alive[entity] = false;
+    freeIds.push_back(entity);
+    aliveCount--;
+}
+
+bool Registry::isAlive(EntityId entity) const {
+    return entity < alive.size() && alive[entity];
+}
+
+void Registry::clear() {
+    for (auto& pool : pools) {
+        if (pool) {
+            pool->clear();
+        }
+    }
+    alive.clear();
+    freeIds.clear();
+    aliveCount = 0;
+}
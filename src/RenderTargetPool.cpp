@@ -0,0 +1,130 @@
+// RenderTargetPool.cpp
+#include "../include/RenderTargetPool.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <iostream>
+
+namespace {
+
+// Client format/type pair accepted by glTexImage2D for a sized internal format
+void getTransferFormat(GLenum internalFormat, GLenum& format, GLenum& type) {
+    switch (internalFormat) {
+        case GL_R8:             format = GL_RED;  type = GL_UNSIGNED_BYTE; break;
+        case GL_R16F:           format = GL_RED;  type = GL_HALF_FLOAT; break;
+        case GL_R32F:           format = GL_RED;  type = GL_FLOAT; break;
+        case GL_RG16F:          format = GL_RG;   type = GL_HALF_FLOAT; break;
+        case GL_RG32F:          format = GL_RG;   type = GL_FLOAT; break;
+        case GL_R11F_G11F_B10F: format = GL_RGB;  type = GL_FLOAT; break;
+        case GL_RGB16F:         format = GL_RGB;  type = GL_HALF_FLOAT; break;
+        case GL_RGBA16F:        format = GL_RGBA; type = GL_HALF_FLOAT; break;
+        case GL_RGBA32F:        format = GL_RGBA; type = GL_FLOAT; break;
+        default:                format = GL_RGBA; type = GL_UNSIGNED_BYTE; break;
+    }
+}
+
+} // namespace
+
+RenderTargetPool::~RenderTargetPool() {
+    clear();
+}
+
+RenderTarget RenderTargetPool::acquire(int width, int height, unsigned int internalFormat) {
+    for (Entry& entry : entries) {
+        if (!entry.inUse && entry.target.width == width && entry.target.height == height &&
+            entry.target.internalFormat == internalFormat) {
+            entry.inUse = true;
+            entry.idleFrames = 0;
+            return entry.target;
+        }
+    }
+    entries.push_back({create(width, height, internalFormat), true, 0});
+    return entries.back().target;
+}
+
+void RenderTargetPool::release(const RenderTarget& target) {
+    for (Entry& entry : entries) {
+        if (entry.target.texture == target.texture) {
+            entry.inUse = false;
+            entry.idleFrames = 0;
+            return;
+        }
+    }
+}
+
+void RenderTargetPool::beginFrame() {
+    for (size_t i = 0; i < entries.size();) {
+        Entry& entry = entries[i];
+        if (!entry.inUse && ++entry.idleFrames > MAX_IDLE_FRAMES) {
+            destroy(entry.target);
+            entries[i] = entries.back();
+            entries.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void RenderTargetPool::clear() {
+    for (Entry& entry : entries) {
+        destroy(entry.target);
+    }
+    entries.clear();
+}
+
+size_t RenderTargetPool::getAllocatedBytes() const {
+    size_t bytes = 0;
+    for (const Entry& entry : entries) {
+        bytes += static_cast<size_t>(entry.target.width) * entry.target.height *
+                 getBytesPerPixel(entry.target.internalFormat);
+    }
+    return bytes;
+}
+
+size_t RenderTargetPool::getBytesPerPixel(unsigned int internalFormat) {
+    switch (internalFormat) {
+        case GL_R8:                return 1;
+        case GL_R16F:              return 2;
+        case GL_R32F:
+        case GL_RG16F:
+        case GL_R11F_G11F_B10F:
+        case GL_RGBA8:
+        case GL_DEPTH_COMPONENT24: return 4;
+        case GL_RGB16F:            return 6;
+        case GL_RG32F:
+        case GL_RGBA16F:           return 8;
+        case GL_RGBA32F:           return 16;
+        default:                   return 0;
+    }
+}
+
+RenderTarget RenderTargetPool::create(int width, int height, unsigned int internalFormat) {
+    RenderTarget target;
+    target.width = width;
+    target.height = height;
+    target.internalFormat = internalFormat;
+
+    GLenum format, type;
+    getTransferFormat(internalFormat, format, type);
+    glGenTextures(1, &target.texture);
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &target.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Pooled render target " << width << "x" << height << " incomplete!" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return target;
+}
+
+void RenderTargetPool::destroy(RenderTarget& target) {
+    glDeleteFramebuffers(1, &target.fbo);
+    glDeleteTextures(1, &target.texture);
+    target = RenderTarget();
+}
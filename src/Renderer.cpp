@@ -0,0 +1,796 @@
+// Renderer.cpp
+#include "../include/Renderer.h"
+#include "../include/Scene.h"
+#include "../include/TransformComponent.h"
+#include "../include/LightComponent.h"
+#include "../include/PerformanceProfiler.h"
+#include "../include/TextureStreamer.h"
+#include "../include/MeshStreamer.h"
+#include "../include/GLExtensions.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Shadow casters tolerate coarser levels of detail than what the camera sees directly
+const float SHADOW_LOD_ERROR_SCALE = 2.0f;
+
+// Permutation of rc_cascade.frag / rc_cascade.comp (see rc_common.glsl)
+ShaderDefines giDefines(int cascadeCount, bool probeFarField, bool hierarchicalTracing, bool worldSpaceRays) {
+    ShaderDefines defines;
+    defines.set("CASCADE_COUNT", cascadeCount);
+    defines.set("PROBE_FAR_FIELD", probeFarField ? 1 : 0);
+    defines.set("HIERARCHICAL_TRACING", hierarchicalTracing ? 1 : 0);
+    defines.set("WORLD_SPACE_RAYS", worldSpaceRays ? 1 : 0);
+    return defines;
+}
+
+// Radical inverse of index in the given base: the Halton low-discrepancy sequence
+float halton(unsigned int index, unsigned int base) {
+    float result = 0.0f;
+    float fraction = 1.0f;
+    while (index > 0) {
+        fraction /= base;
+        result += fraction * (index % base);
+        index /= base;
+    }
+    return result;
+}
+
+// Sampler units of the GI programs, the same for every variant
+void setGiSamplerUnits(Shader& shader) {
+    shader.setInt("probeL0", ProbeCache::TEXTURE_UNIT);
+    shader.setInt("probeL1", ProbeCache::TEXTURE_UNIT + 1);
+    shader.setInt("depthPyramid", DepthPyramid::TEXTURE_UNIT);
+    shader.setInt("lightClusters", LightClusters::TEXTURE_UNIT);
+    shader.setInt("bvhGeometry", SceneBvh::GEOMETRY_TEXTURE_UNIT);
+    shader.setInt("bvhInstances", SceneBvh::INSTANCE_TEXTURE_UNIT);
+}
+
+void setCompositeSamplerUnits(Shader& shader) {
+    shader.setInt("gLinearDepth", 0);
+    shader.setInt("gNormal", 1);
+    shader.setInt("gAlbedo", 2);
+    shader.setInt("shadowMap", 3);
+    // Only the active cascades exist in a variant; the rest are no-ops
+    for (int i = 0; i < 6; ++i) {
+        shader.setInt("rcTexture[" + std::to_string(i) + "]", 4 + i);
+    }
+    shader.setInt("ssaoTexture", 10);
+    shader.setInt("gEmission", 11);
+    // Probe samplers always get their own units, even while the cache is off, so the
+    // sampler3D never shares a unit with a 2D sampler
+    shader.setInt("probeL0", ProbeCache::TEXTURE_UNIT);
+    shader.setInt("probeL1", ProbeCache::TEXTURE_UNIT + 1);
+    shader.setInt("lightClusters", LightClusters::TEXTURE_UNIT);
+}
+
+} // namespace
+
+Renderer::Renderer(int width, int height)
+    : shadowShader("shaders/shadow_depth.vert", "shaders/shadow_depth.frag"),
+      gBufferShader("shaders/gbuffer.vert", "shaders/gbuffer.frag"),
+      rcVariants("shaders/fullscreen.vert", "shaders/rc_cascade.frag", setGiSamplerUnits),
+      blurShader("shaders/fullscreen.vert", "shaders/blur.frag"),
+      compositeVariants("shaders/fullscreen.vert", "shaders/final_composite.frag", setCompositeSamplerUnits),
+      copyShader("shaders/fullscreen.vert", "shaders/copy.frag"),
+      ssaoShader("shaders/fullscreen.vert", "shaders/ssao.frag"),
+      ssaoBlurShader("shaders/fullscreen.vert", "shaders/ssao_blur.frag"),
+      ssrShader("shaders/fullscreen.vert", "shaders/ssr.frag"),
+      reconstructShader("shaders/fullscreen.vert", "shaders/post_reconstruct.frag"),
+      ssrResolveShader("shaders/fullscreen.vert", "shaders/ssr_resolve.frag"),
+      taaShader("shaders/fullscreen.vert", "shaders/taa.frag"),
+      fxaaShader("shaders/fullscreen.vert", "shaders/fxaa.frag"),
+      occlusionShader("shaders/fullscreen.vert", "shaders/occlusion_depth.frag"),
+      prepassShader("shaders/shadow_depth.vert", "shaders/depth_prepass.frag"),
+      probeUpdateShader("shaders/fullscreen.vert", "shaders/probe_update.frag"),
+      depthPyramidShader("shaders/fullscreen.vert", "shaders/hiz_build.frag"),
+      rc(width, height, 6),
+      postChain(rc.getTargetPool()),
+      jobs(nullptr),
+      frameUniformBuffer(sizeof(FrameUniforms), FRAME_UNIFORMS_BINDING),
+      frameUniforms(),
+      shadowLightSpaceLocation(-1),
+      prepassViewProjLocation(-1),
+      cameraView(0), depthPyramidValid(false),
+      lastWidth(0), lastHeight(0), renderWidth(width), renderHeight(height), firstFrame(true),
+      previousView(1.0f), previousProjection(1.0f), previousViewProj(1.0f), previousJitter(0.0f), jitterIndex(0) {
+    // The context is 3.3 core; programs beyond it are only submitted here, like the
+    // members above (the compute GI variant on its first get() in resolveShaders())
+    GLExtensions::initialize();
+    if (GLExtensions::hasComputeShaders()) {
+        rcComputeVariants.reset(new ShaderVariants("shaders/rc_cascade.comp", setGiSamplerUnits));
+    }
+    if (GLExtensions::hasBindlessTextures()) {
+        gBufferBindlessShader.reset(new Shader("shaders/gbuffer.vert", "shaders/gbuffer_bindless.frag"));
+    }
+    if (GLExtensions::hasMultiDrawIndirect()) {
+        gpuCullShader.reset(new Shader("shaders/gpu_cull.comp"));
+    }
+    resolveShaders();
+}
+
+void Renderer::resolveShaders() {
+    // Take the compute GI path only where the driver offers more. One variant stands
+    // in for all of them: they only differ in constants
+    if (rcComputeVariants && !rcComputeVariants->get(giDefines(getCascadeCountForQuality(4), false, false, false)).isValid()) {
+        rcComputeVariants.reset();
+    }
+    std::cout << "GI path: " << (rcComputeVariants ? "compute" : "fragment") << std::endl;
+    if (gBufferBindlessShader && !gBufferBindlessShader->isValid()) {
+        glDeleteProgram(gBufferBindlessShader->ID);
+        gBufferBindlessShader.reset();
+    }
+    batcher.getMaterialTable().setBindless(gBufferBindlessShader != nullptr);
+    std::cout << "Material textures: " << (gBufferBindlessShader ? "bindless" : "bound per texture set") << std::endl;
+    if (gpuCullShader) {
+        if (gpuCullShader->isValid()) {
+            gpuCuller.reset(new GpuCuller(*gpuCullShader));
+        } else {
+            glDeleteProgram(gpuCullShader->ID);
+            gpuCullShader.reset();
+        }
+    }
+    std::cout << "GPU-driven submission: " << (gpuCuller ? "available" : "unavailable") << std::endl;
+
+    shadowLightSpaceLocation = shadowShader.getUniformLocation("lightSpaceMatrix");
+    prepassViewProjLocation = prepassShader.getUniformLocation("lightSpaceMatrix");
+
+    // Sampler units never change, so assign them once instead of every frame
+    gBufferShader.use();
+    Material::setSamplerUnits(gBufferShader);
+    gBufferShader.setInt("materialTable", MaterialTable::TEXTURE_UNIT);
+    if (gBufferBindlessShader) {
+        gBufferBindlessShader->use();
+        gBufferBindlessShader->setInt("materialTable", MaterialTable::TEXTURE_UNIT);
+    }
+    // (GI and composite variants assign theirs when they are created, setGiSamplerUnits
+    // and setCompositeSamplerUnits)
+    ssrShader.use();
+    ssrShader.setInt("depthPyramid", DepthPyramid::TEXTURE_UNIT);
+    copyShader.use();
+    glUseProgram(0);
+}
+
+void Renderer::resetTemporalAccumulation() {
+    rc.resetTemporalAccumulation();
+    occlusionCuller.invalidate();
+    depthPyramidValid = false;
+    giScheduler.reset();
+    probeCache.reset();
+}
+
+// 5-Level Quality System with increased cascade counts for high-end hardware
+// Super Low (0): 2 cascades,  minimal GI but still good quality
+// Performance (1): 3 cascades, good GI quality with performance focus
+// Balanced (2): 4 cascades, excellent balance of quality/performance
+// High (3): 5 cascades, high quality GI for detailed scenes
+// Ultra (4): 6 cascades, maximum quality GI for ultimate fidelity
+int Renderer::getCascadeCountForQuality(int qualityLevel) {
+    switch (qualityLevel) {
+        case 0: return 2; // Super Low
+        case 1: return 3; // Performance
+        case 2: return 4; // Balanced
+        case 3: return 5; // High
+        case 4: return 6; // Ultra (maximum quality)
+        default: return 4; // Fallback
+    }
+}
+
+// Number of cascades the GI blur pass smooths at each quality level
+int Renderer::getBlurredCascadeCountForQuality(int qualityLevel) {
+    int cascades = getCascadeCountForQuality(qualityLevel);
+    switch (qualityLevel) {
+        case 0: return 0;                         // Super Low: skip blur entirely for maximum performance
+        case 1: return std::min(cascades, 2);     // Performance: only blur first 2 cascades
+        default: return cascades;                 // Balanced and up: blur every active cascade
+    }
+}
+
+RadianceCascades::MemoryUsage Renderer::getMemoryUsageForQuality(int qualityLevel) const {
+    int blurred = getBlurredCascadeCountForQuality(qualityLevel);
+    RadianceCascades::MemoryUsage usage = rc.getMemoryUsage(getCascadeCountForQuality(qualityLevel), blurred);
+    // Post chain: the composite buffer plus its ping-pong partner (SSR resolve or FXAA output)
+    size_t renderPixels = static_cast<size_t>(renderWidth) * renderHeight;
+    size_t outputPixels = static_cast<size_t>(lastWidth) * lastHeight;
+    usage.transient += (renderPixels + std::max(renderPixels, outputPixels)) *
+                       RenderTargetPool::getBytesPerPixel(PostChain::getFormat());
+    return usage;
+}
+
+void Renderer::logMemoryUsage() const {
+    const double MB = 1024.0 * 1024.0;
+    std::cout << "Render target memory at " << lastWidth << "x" << lastHeight << ":" << std::endl;
+    for (int level = 0; level < QUALITY_LEVELS; ++level) {
+        RadianceCascades::MemoryUsage usage = getMemoryUsageForQuality(level);
+        std::cout << "  " << std::left << std::setw(12) << getQualityName(level) << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(7) << usage.total() / MB << " MB"
+                  << "  (G-buffer " << usage.gBuffer / MB
+                  << ", cascades " << usage.cascades / MB
+                  << ", history " << usage.history / MB
+                  << ", post " << usage.post / MB
+                  << ", transient " << usage.transient / MB << ")" << std::endl;
+    }
+    std::cout << "  Probe cache " << std::fixed << std::setprecision(1) << probeCache.getMemoryUsage() / MB
+              << " MB (fixed, world space)" << std::endl;
+    std::cout << "  Depth pyramid " << depthPyramid.getMemoryUsage() / MB
+              << " MB (render resolution, when tracing or occlusion culling use it)" << std::endl;
+    std::cout << "  Scene BVH " << sceneBvh.getMemoryUsage() / MB << " MB ("
+              << sceneBvh.getTriangleCount() << " triangles, when world-space rays are on)" << std::endl;
+    const MeshStreamer& meshes = MeshStreamer::instance();
+    std::cout << "  Mesh levels " << meshes.getResidentBytes() / MB << " of " << meshes.getMemoryBudget() / MB
+              << " MB budget (" << meshes.getResidentLevelCount() << " of " << meshes.getLevelCount()
+              << " levels of detail resident)" << std::endl;
+    if (gpuCuller) {
+        std::cout << "  GPU culling " << gpuCuller->getMemoryUsage() / MB << " MB ("
+                  << gpuCuller->getMeshArena().getMeshCount() << " meshes in the arena, when GPU-driven)" << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+// CORRECTED GI strength: More cascades capture more light, so need LOWER multipliers for visual consistency
+// Ultra mode has additional enhancements (multi-bounce, better upsampling) so needs even lower strength
+float Renderer::getGiStrengthForQuality(int qualityLevel) {
+    switch (qualityLevel) {
+        case 0: return 0.85f; // Super Low (2C): highest strength since fewer cascades
+        case 1: return 0.70f; // Performance (3C): reduced strength for extra cascade
+        case 2: return 0.55f; // Balanced (4C): balanced strength for good coverage
+        case 3: return 0.45f; // High (5C): this looks good - keep as reference
+        case 4: return 0.82f; // Ultra (6C): increased to match High's effective brightness (0.82 × 0.22 = 0.18)
+        default: return 0.55f; // Fallback to balanced
+    }
+}
+
+const char* Renderer::getQualityName(int qualityLevel) {
+    static const char* qualityNames[] = {"Super Low", "Performance", "Balanced", "High", "Ultra"};
+    if (qualityLevel < 0 || qualityLevel >= QUALITY_LEVELS) return "Unknown";
+    return qualityNames[qualityLevel];
+}
+
+float Renderer::getUpscaleRatio(int upscaleMode) {
+    switch (upscaleMode) {
+        case 1: return 0.77f; // Quality
+        case 2: return 0.67f; // Balanced
+        case 3: return 0.58f; // Performance
+        case 4: return 0.50f; // Ultra performance
+        default: return 1.0f; // Native
+    }
+}
+
+const char* Renderer::getUpscaleModeName(int upscaleMode) {
+    static const char* modeNames[] = {"Native", "Quality", "Balanced", "Performance", "Ultra Performance"};
+    if (upscaleMode < 0 || upscaleMode >= UPSCALE_MODES) return "Unknown";
+    return modeNames[upscaleMode];
+}
+
+int Renderer::parseUpscaleMode(const std::string& name) {
+    static const char* optionNames[] = {"native", "quality", "balanced", "performance", "ultra-performance"};
+    for (int mode = 0; mode < UPSCALE_MODES; ++mode) {
+        if (name == optionNames[mode]) {
+            return mode;
+        }
+    }
+    return -1;
+}
+
+void Renderer::render(Scene& scene, const RenderSettings& settings, int width, int height,
+                      float time, PerformanceProfiler& profiler, const std::function<void()>& sceneReleased) {
+    const int qualityLevel = settings.qualityLevel;
+    // Wait here, outside the timers, if the GPU is framesInFlight frames behind;
+    // this frame's streamed data then goes to a ring region the GPU is done with
+    framePacer.beginFrame(settings.framesInFlight);
+    batcher.setFrameRegion(framePacer.getRegion());
+    frameArena.reset();
+    rc.getTargetPool().beginFrame();
+    profiler.beginTimer("renderer_total");
+
+    // Dynamic resolution: feed back the previous frames' cost (GPU time when resolved, CPU otherwise)
+    if (settings.dynamicResolution) {
+        float frameTime = profiler.getGpuLastTime("renderer_total");
+        if (frameTime <= 0.0f) {
+            frameTime = profiler.getLastTime("renderer_total");
+        }
+        budgetController.setTargetFrameTime(settings.targetFrameTimeMs);
+        budgetController.update(frameTime);
+    } else if (budgetController.getRenderScale() < 1.0f || budgetController.getCascadeReduction() > 0) {
+        budgetController.reset();
+    }
+
+    // Upload textures finished by the loader threads (bounded per frame)
+    profiler.beginTimer("texture_upload");
+    TextureStreamer::instance().processUploads();
+    profiler.endTimer("texture_upload");
+
+    // Hand finished mesh loads to their meshes and keep the used levels of detail resident
+    profiler.beginTimer("mesh_upload");
+    MeshStreamer::instance().processUploads();
+    profiler.endTimer("mesh_upload");
+
+    profiler.beginTimer("scene_setup");
+    // Extract light information from ECS for rendering: the primary light is the
+    // shadowed one, every other light goes to the clusters (see LightClusters.h)
+    glm::vec3 lightPos(0.0f);
+    glm::vec3 lightColor(1.0f);
+    float lightRadius = 2.0f; // Default radius for light attenuation
+
+    // Find the primary light in the scene
+    Entity primaryLight = scene.getPrimaryLight();
+    if (primaryLight) {
+        const LightComponent* light = primaryLight.getComponent<LightComponent>();
+        lightPos = primaryLight.getComponent<TransformComponent>()->position;
+        // Apply light toggle - when disabled, lightColor becomes (0,0,0)
+        if (settings.lightEnabled) {
+            lightColor = light->color * light->intensity;
+        } else {
+            lightColor = glm::vec3(0.0f, 0.0f, 0.0f);
+        }
+        lightRadius = light->radius;
+    }
+    localLights.clear();
+    if (settings.lightEnabled) {
+        scene.registry.each<LightComponent, TransformComponent>(
+            [&](EntityId id, LightComponent& light, TransformComponent& transform) {
+                if (id == primaryLight.getId()) {
+                    return;
+                }
+                LightClusters::Light local;
+                local.position = transform.position;
+                local.radius = light.radius;
+                local.color = light.color * light.intensity;
+                localLights.push_back(local);
+            });
+    }
+
+    // Camera and light changes no longer reset the GI history: the cascades reproject it
+    // and giScheduler decides what to recompute (see GiUpdateScheduler.h)
+    const glm::vec3 cameraPosition = scene.camera.position;
+    glm::vec3 currentCameraDirection = scene.camera.front;
+
+    // Shadow resolution and cascade count follow the quality level
+    shadowMap.configure(ShadowMap::getResolutionForQuality(qualityLevel),
+                        ShadowMap::getCascadeCountForQuality(qualityLevel));
+
+    // SSAO/SSR execution rate (their reduced-rate targets are only reallocated on a change)
+    rc.setPostResolution(settings.postResolution);
+
+    // Handle window resizing and render scale changes - only update resources when a size actually changes
+    // (temporal upscaling renders below the output on purpose; TAA reconstructs it)
+    const bool temporalAA = settings.antiAliasingMode == 2;
+    const float renderScale = budgetController.getRenderScale() * (temporalAA ? getUpscaleRatio(settings.upscaleMode) : 1.0f);
+    const int internalWidth = std::max(1, static_cast<int>(width * renderScale + 0.5f));
+    const int internalHeight = std::max(1, static_cast<int>(height * renderScale + 0.5f));
+    const bool outputResized = width != lastWidth || height != lastHeight;
+    if (outputResized || internalWidth != renderWidth || internalHeight != renderHeight) {
+        rc.resize(internalWidth, internalHeight);
+        rc.setOutputSize(width, height);
+        renderWidth = internalWidth;
+        renderHeight = internalHeight;
+        lastWidth = width;
+        lastHeight = height;
+        if (outputResized) {
+            logMemoryUsage();
+        }
+    }
+
+    // Update camera matrices with correct aspect ratio
+    const float nearPlane = 0.1f;
+    const float farPlane = 100.0f;
+    const float fieldOfView = glm::radians(45.0f);
+    float aspectRatio = (float)width / (float)height;
+    glm::mat4 projection = glm::perspective(fieldOfView, aspectRatio, nearPlane, farPlane);
+    glm::mat4 view = scene.camera.getViewMatrix();
+
+    // Fit the shadow cascades to this frame's camera frustum
+    shadowMap.updateCascades(lightPos, view, fieldOfView, aspectRatio, nearPlane, farPlane);
+
+    // TAA jitter: every frame samples another sub-pixel position of the internal
+    // resolution, which the history accumulates into output-resolution detail. The
+    // sequence covers a pixel with ~8 samples per output pixel it upscales to.
+    // Culling and LOD selection use the unjittered matrix: the jitter moves every
+    // frame, but the visible set and the detail needed do not
+    const glm::mat4 cullViewProj = projection * view;
+    glm::vec2 jitter(0.0f);
+    if (temporalAA) {
+        const float ratio = static_cast<float>(renderWidth) / width;
+        const unsigned int phases = static_cast<unsigned int>(std::ceil(8.0f / (ratio * ratio)));
+        const unsigned int index = jitterIndex++ % phases + 1; // Halton index 0 is (0, 0)
+        jitter = (glm::vec2(halton(index, 2), halton(index, 3)) - 0.5f) * 2.0f /
+                 glm::vec2(renderWidth, renderHeight);
+        projection[2][0] += jitter.x;
+        projection[2][1] += jitter.y;
+    }
+
+    // Previous frame matrices start out equal to the current ones
+    if (firstFrame) {
+        previousView = view;
+        previousProjection = projection;
+        previousViewProj = projection * view;
+        previousJitter = jitter;
+        firstFrame = false;
+    }
+    glm::mat4 currentViewProj = projection * view;
+
+    // Everything the passes share goes to the GPU once, in one buffer
+    frameUniforms.view = view;
+    frameUniforms.projection = projection;
+    frameUniforms.invView = glm::inverse(view);
+    frameUniforms.invProjection = glm::inverse(projection);
+    frameUniforms.previousView = previousView;
+    frameUniforms.previousProjection = previousProjection;
+    frameUniforms.currentViewProj = currentViewProj;
+    frameUniforms.previousViewProj = previousViewProj;
+    for (int i = 0; i < ShadowMap::MAX_CASCADES; ++i) {
+        frameUniforms.cascadeMatrices[i] = shadowMap.getCascadeMatrix(i);
+        frameUniforms.cascadeSplits[i] = shadowMap.getCascadeSplit(i);
+    }
+    frameUniforms.shadowParams = glm::vec4(shadowMap.getCascadeCount(),
+                                           std::min(farPlane, ShadowMap::MAX_SHADOW_DISTANCE), 0.0f, 0.0f);
+    frameUniforms.viewPos = scene.camera.position;
+    frameUniforms.nearPlane = nearPlane;
+    frameUniforms.lightPos = lightPos;
+    frameUniforms.lightRadius = lightRadius;
+    frameUniforms.lightColor = lightColor;
+    frameUniforms.farPlane = farPlane;
+    frameUniforms.screenSize = glm::vec4(renderWidth, renderHeight, 1.0f / renderWidth, 1.0f / renderHeight);
+    frameUniforms.jitter = glm::vec4(jitter, previousJitter);
+    frameUniformBuffer.stream(&frameUniforms, sizeof(frameUniforms), framePacer.getRegion());
+
+    // Sort and instance the geometry once; both geometry passes reuse it
+    batcher.setGpuCuller(settings.gpuDriven ? gpuCuller.get() : nullptr);
+    batcher.build(scene.registry, scene.getWorldMatrices());
+    profiler.endTimer("scene_setup");
+
+    // Off-screen geometry for the GI rays; reads the registry, so before the scene is released
+    const bool worldSpaceRays = settings.giEnabled && settings.worldSpaceRays;
+    if (worldSpaceRays) {
+        profiler.beginTimer("bvh_update");
+        sceneBvh.update(scene.registry, scene.getWorldMatrices(), jobs);
+        profiler.endTimer("bvh_update");
+    }
+
+    profiler.beginTimer("light_culling");
+    lightClusters.build(localLights, view, projection, nearPlane, farPlane, frameArena);
+    profiler.endTimer("light_culling");
+
+    // Everything below works on the copies made above (render state double-buffered
+    // against the scene), so the caller may start simulating the next frame now
+    if (sceneReleased) {
+        sceneReleased();
+    }
+
+    // Camera culling: frustum always, occlusion against a recent depth snapshot on request
+    // (on the GPU against last frame's depth pyramid, which is still intact until the G-buffer pass)
+    profiler.beginTimer("culling");
+    if (batcher.isGpuDriven()) {
+        occlusionCuller.invalidate();
+        const HiZOcclusion hiZ = {&depthPyramid, previousView, previousProjection};
+        const bool hiZReady = settings.occlusionCulling && depthPyramidValid;
+        cameraView = batcher.addView(Frustum(cullViewProj), nullptr, hiZReady ? &hiZ : nullptr);
+    } else {
+        bool occlusionReady = false;
+        if (settings.occlusionCulling) {
+            occlusionReady = occlusionCuller.beginFrame(cameraPosition, currentCameraDirection);
+        } else {
+            occlusionCuller.invalidate();
+        }
+        const LodSelection lod = {cullViewProj, static_cast<float>(renderHeight), settings.lodErrorPixels};
+        cameraView = batcher.addView(Frustum(cullViewProj), occlusionReady ? &occlusionCuller : nullptr, nullptr, &lod);
+    }
+    profiler.endTimer("culling");
+
+    /**
+     * RENDERING PIPELINE - Multi-pass deferred rendering with global illumination
+     */
+
+    // PASS 1: SHADOW MAP GENERATION
+    // Render the out-of-date cascades from the light's perspective (cached otherwise)
+    profiler.beginTimer("shadow_total");
+    profiler.beginTimer("shadow_setup");
+    shadowShader.use();
+    profiler.endTimer("shadow_setup");
+
+    profiler.beginTimer("shadow_render");
+    shadowMap.render(batcher, shadowShader, shadowLightSpaceLocation, settings.lodErrorPixels * SHADOW_LOD_ERROR_SCALE);
+    profiler.endTimer("shadow_render");
+    profiler.endTimer("shadow_total");
+
+    // PASS 2: G-BUFFER GENERATION (Deferred Rendering)
+    // Render geometry data (position, normal, albedo, motion vectors) to textures
+    profiler.beginTimer("gbuffer_total");
+    profiler.beginTimer("gbuffer_setup");
+
+    rc.bindGBufferForWriting();
+    glViewport(0, 0, renderWidth, renderHeight);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    const bool depthPrepass = overdrawMonitor.beginFrame(settings.depthPrepassMode);
+    profiler.endTimer("gbuffer_setup");
+
+    // Optional depth pre-pass: lay down depth cheaply so the G-buffer shader
+    // only runs for the visible fragment of each pixel (GL_EQUAL below)
+    if (depthPrepass) {
+        profiler.beginTimer("gbuffer_prepass");
+        prepassShader.use();
+        prepassShader.setMat4(prepassViewProjLocation, currentViewProj);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        overdrawMonitor.beginDepthPass();
+        batcher.drawMeshBatches(prepassShader, BatchFilter::All, cameraView);
+        overdrawMonitor.endDepthPass();
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+        profiler.endTimer("gbuffer_prepass");
+    }
+
+    // Render all scene geometry to G-buffer
+    profiler.beginTimer("gbuffer_render");
+    Shader& gBufferProgram = gBufferBindlessShader ? *gBufferBindlessShader : gBufferShader;
+    gBufferProgram.use();
+    overdrawMonitor.beginShadingPass();
+    batcher.drawMaterialBatches(gBufferProgram, cameraView);
+    overdrawMonitor.endShadingPass();
+    if (depthPrepass) {
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    }
+    profiler.endTimer("gbuffer_render");
+    profiler.endTimer("gbuffer_total");
+
+    // Min/max depth pyramid, built once for every pass that marches or tests against depth
+    const bool hierarchicalTracing = settings.hierarchicalTracing && (settings.giEnabled || settings.ssrEnabled);
+    depthPyramidValid = hierarchicalTracing || settings.occlusionCulling;
+    if (depthPyramidValid) {
+        profiler.beginTimer("depth_pyramid");
+        depthPyramid.resize(renderWidth, renderHeight);
+        depthPyramid.build(depthPyramidShader, quad, rc.getGLinearDepth());
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, renderWidth, renderHeight);
+        profiler.endTimer("depth_pyramid");
+    }
+
+    // Snapshot this frame's depth for the occlusion tests of the next frames
+    if (settings.occlusionCulling && !batcher.isGpuDriven()) {
+        profiler.beginTimer("occlusion_capture");
+        occlusionCuller.capture(occlusionShader, quad, depthPyramid, cullViewProj,
+                                cameraPosition, currentCameraDirection);
+        glViewport(0, 0, renderWidth, renderHeight);
+        profiler.endTimer("occlusion_capture");
+    }
+
+    // PASS 3: SCREEN SPACE AMBIENT OCCLUSION (SSAO)
+    // Compute ambient occlusion for enhanced depth perception (if enabled)
+    // Quality-dependent SSAO: disabled for super low, enabled for others
+    profiler.beginTimer("ssao_total");
+
+    if (settings.ssaoEnabled && qualityLevel > 0) {
+        profiler.beginTimer("ssao_compute");
+        rc.computeSSAO(ssaoShader, reconstructShader);
+        profiler.endTimer("ssao_compute");
+
+        // PASS 4: SSAO BLUR
+        // Quality-dependent blur: skip for performance level, full for others
+        profiler.beginTimer("ssao_blur");
+        if (qualityLevel > 1) {
+            rc.blurSSAO(ssaoBlurShader);
+        }
+        profiler.endTimer("ssao_blur");
+    }
+    profiler.endTimer("ssao_total");
+
+    int activeCascades = settings.giEnabled ? getCascadeCountForQuality(qualityLevel) : 0;
+    // Over budget at minimum scale the controller sheds cascades, keeping at least two
+    activeCascades = std::max(std::min(activeCascades, 2), activeCascades - budgetController.getCascadeReduction());
+    // Clamp to valid range for safety
+    activeCascades = std::max(0, std::min(activeCascades, 6));
+
+    // PASS 5: RADIANCE CASCADES GLOBAL ILLUMINATION
+    // Compute multi-bounce indirect lighting using radiance cascades
+    profiler.beginTimer("gi_total");
+
+    // Only the cascades whose inputs changed are recomputed (0 = last frame's GI is reused)
+    unsigned int giUpdateMask = 0;
+    if (settings.giEnabled) {
+        GiUpdateScheduler::FrameState giState;
+        giState.cameraPosition = cameraPosition;
+        giState.cameraForward = currentCameraDirection;
+        giState.sceneHash = batcher.getSceneHash();
+        giState.lightPosition = lightPos;
+        giState.lightColor = lightColor;
+        giState.lightRadius = lightRadius;
+        giState.localLightHash = lightClusters.getLightHash();
+        giState.activeCascades = activeCascades;
+        giState.width = renderWidth;
+        giState.height = renderHeight;
+        giState.probeFarField = settings.probeCache;
+        giState.worldSpaceRays = worldSpaceRays;
+        giUpdateMask = giScheduler.update(giState);
+    } else {
+        giScheduler.reset(); // Full update when GI comes back
+    }
+
+    // Probes follow the cascades: they trace while GI updates and rest once it has converged
+    const bool probeFarField = settings.giEnabled && settings.probeCache;
+    if (probeFarField && giUpdateMask != 0) {
+        profiler.beginTimer("gi_probes");
+        ProbeCache::GBufferInputs probeInputs;
+        probeInputs.normal = rc.getGNormal();
+        probeInputs.albedo = rc.getGAlbedo();
+        probeInputs.linearDepth = rc.getGLinearDepth();
+        probeInputs.emission = rc.getGEmission();
+        probeCache.update(probeUpdateShader, quad, cameraPosition, probeInputs);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, renderWidth, renderHeight);
+        profiler.endTimer("gi_probes");
+    }
+
+    if (giUpdateMask != 0) {
+        profiler.beginTimer("gi_setup");
+        // Cascade count and tracing features are compiled in, not branched on
+        const bool computeGI = settings.computeGI && rcComputeVariants;
+        const ShaderDefines defines = giDefines(activeCascades, probeFarField, hierarchicalTracing, worldSpaceRays);
+        Shader& giShader = computeGI ? rcComputeVariants->get(defines) : rcVariants.get(defines);
+        giShader.use();
+        if (probeFarField) {
+            probeCache.bindForSampling(giShader);
+        }
+        lightClusters.bindForSampling(giShader);
+        if (hierarchicalTracing) {
+            depthPyramid.bindForSampling(giShader);
+        }
+        if (worldSpaceRays) {
+            sceneBvh.bindForSampling(giShader);
+        }
+        rc.setTime(time);                                // Time for temporal effects
+        profiler.endTimer("gi_setup");
+
+        profiler.beginTimer("gi_compute");
+        if (computeGI) {
+            rc.dispatch(giShader, activeCascades, giUpdateMask);
+        } else {
+            rc.compute(giShader, activeCascades, giUpdateMask);
+        }
+        profiler.endTimer("gi_compute");
+
+        // PASS 6: GI QUALITY-DEPENDENT BLUR
+        // Apply blur based on quality level for optimal performance/quality balance
+        profiler.beginTimer("gi_blur");
+        int blurredCascades = std::min(getBlurredCascadeCountForQuality(qualityLevel), activeCascades);
+        if (blurredCascades > 0) {
+            rc.blur(blurShader, blurredCascades, giUpdateMask);
+        }
+        profiler.endTimer("gi_blur");
+    }
+    profiler.endTimer("gi_total");
+
+    // PASS 7: FINAL COMPOSITE TO OFFSCREEN BUFFER
+    // Combine all lighting contributions into final image
+    profiler.beginTimer("composite_total");
+    profiler.beginTimer("composite_setup");
+
+    // First buffer of the post chain (pooled, returned once the frame is presented)
+    const RenderTarget& compositeTarget = postChain.begin(renderWidth, renderHeight);
+    glBindFramebuffer(GL_FRAMEBUFFER, compositeTarget.fbo);
+    glViewport(0, 0, renderWidth, renderHeight);
+
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+
+    const bool ssaoActive = settings.ssaoEnabled && qualityLevel > 0;
+    ShaderDefines compositeDefines;
+    compositeDefines.set("CASCADE_COUNT", activeCascades);
+    compositeDefines.set("PROBE_FAR_FIELD", probeFarField ? 1 : 0);
+    compositeDefines.set("USE_SSAO", ssaoActive ? 1 : 0);
+    Shader& compositeShader = compositeVariants.get(compositeDefines);
+    compositeShader.use();
+    float giStrength = settings.giEnabled ? getGiStrengthForQuality(qualityLevel) : 0.0f;
+    compositeShader.setFloat("ssgiStrength", giStrength);
+    compositeShader.setFloat("ambientStrength", settings.ambientEnabled ? 0.08f : 0.0f); // Reduced ambient
+    compositeShader.setFloat("ssaoStrength", ssaoActive ? 1.0f : 0.0f); // Conditional SSAO contribution
+    if (probeFarField) {
+        probeCache.bindForSampling(compositeShader);
+    }
+    lightClusters.bindForSampling(compositeShader);
+
+    // Sampler units are fixed per variant (setCompositeSamplerUnits); a variant only
+    // declares its active cascades, so unused cascade units need no placeholder
+    profiler.endTimer("composite_setup");
+
+    // Activate and bind all required textures
+    profiler.beginTimer("composite_textures");
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, rc.getGLinearDepth());
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, rc.getGNormal());
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, rc.getGAlbedo());
+    shadowMap.bindForReading(3);
+
+    // Bind SSAO texture
+    if (ssaoActive) {
+        glActiveTexture(GL_TEXTURE10);
+        glBindTexture(GL_TEXTURE_2D, rc.getSSAOBlurTexture());
+    }
+
+    // Bind emission texture
+    glActiveTexture(GL_TEXTURE11);
+    glBindTexture(GL_TEXTURE_2D, rc.getGEmission());
+
+    // Bind all cascade textures for GI sampling - only active cascades
+    for (int i = 0; i < activeCascades; ++i) {
+        glActiveTexture(GL_TEXTURE4 + i);
+        glBindTexture(GL_TEXTURE_2D, rc.getTexture(i));
+    }
+
+    profiler.endTimer("composite_textures");
+
+    // Render fullscreen quad to perform lighting calculations
+    profiler.beginTimer("composite_render");
+    quad.render();
+    profiler.endTimer("composite_render");
+    profiler.endTimer("composite_total");
+
+    glEnable(GL_DEPTH_TEST);
+
+    // PASS 8: SCREEN SPACE REFLECTIONS (Optional)
+    if (settings.ssrEnabled) {
+        profiler.beginTimer("ssr_total");
+        ssrShader.use();
+        ssrShader.setBool("useDepthPyramid", hierarchicalTracing);
+        if (hierarchicalTracing) {
+            depthPyramid.bindForSampling(ssrShader);
+        }
+        rc.computeSSR(ssrShader, reconstructShader, postChain.getCurrent().texture);
+        rc.applySSR(ssrResolveShader, postChain.getCurrent().texture, postChain.advance(renderWidth, renderHeight).fbo);
+        profiler.endTimer("ssr_total");
+    }
+
+    // PASS 9: ANTI-ALIASING (FXAA or TAA), resolving to the output resolution
+    unsigned int finalTexture = postChain.getCurrent().texture;
+
+    if (settings.antiAliasingMode == 1) { // FXAA
+        profiler.beginTimer("fxaa_total");
+        const RenderTarget& fxaaTarget = postChain.advance(width, height);
+        rc.applyFXAA(fxaaShader, postChain.getInputTexture(), fxaaTarget.fbo);
+        finalTexture = fxaaTarget.texture;
+        profiler.endTimer("fxaa_total");
+    } else if (settings.antiAliasingMode == 2) { // TAA
+        profiler.beginTimer("taa_total");
+        rc.applyTAA(taaShader, finalTexture);
+        finalTexture = rc.getTAATexture();
+        profiler.endTimer("taa_total");
+    }
+    previousViewProj = currentViewProj;
+
+    // PASS 10: FINAL OUTPUT TO SCREEN (bilinear upscale when no AA pass resolved the frame)
+    profiler.beginTimer("output_copy");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+
+    copyShader.use();
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, finalTexture);
+
+    quad.render();
+
+    glEnable(GL_DEPTH_TEST);
+    postChain.end();
+    profiler.endTimer("output_copy");
+    profiler.endTimer("renderer_total");
+    framePacer.endFrame();
+    SyncMonitor::endFrame();
+
+    // Store matrices for next frame
+    previousView = view;
+    previousProjection = projection;
+    previousJitter = jitter;
+}
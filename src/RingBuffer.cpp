@@ -0,0 +1,92 @@
+// RingBuffer.cpp
+#include "../include/RingBuffer.h"
+#include "../include/FramePacer.h"
+#include "../include/GLExtensions.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+RingBuffer::RingBuffer(unsigned int target, size_t initialRegionSize, size_t alignment)
+    : target(target), buffer(0), regionSize(0), alignment(std::max<size_t>(alignment, 1)),
+      currentRegion(-1), cursor(0), mapped(nullptr) {
+    GLExtensions::initialize();
+    allocate(std::max<size_t>(initialRegionSize, 1));
+}
+
+RingBuffer::~RingBuffer() {
+    if (mapped) {
+        glBindBuffer(target, buffer);
+        glUnmapBuffer(target);
+        glBindBuffer(target, 0);
+    }
+    glDeleteBuffers(1, &buffer);
+}
+
+void RingBuffer::allocate(size_t newRegionSize) {
+    if (mapped) {
+        glBindBuffer(target, buffer);
+        glUnmapBuffer(target);
+        mapped = nullptr;
+    }
+    if (buffer) {
+        glDeleteBuffers(1, &buffer);
+    }
+    regionSize = alignUp(newRegionSize, alignment);
+    const GLsizeiptr totalSize = static_cast<GLsizeiptr>(regionSize * FramePacer::MAX_FRAMES_IN_FLIGHT);
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    if (GLExtensions::hasBufferStorage()) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLExtensions::bufferStorage(target, totalSize, nullptr, flags);
+        mapped = glMapBufferRange(target, 0, totalSize, flags);
+    }
+    if (!mapped) {
+        // Mapped per write instead; a failed persistent mapping leaves immutable storage, so start over
+        if (GLExtensions::hasBufferStorage()) {
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(target, buffer);
+        }
+        glBufferData(target, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(target, 0);
+}
+
+size_t RingBuffer::write(int region, const void* data, size_t size) {
+    if (region != currentRegion) {
+        currentRegion = region;
+        cursor = 0;
+    }
+    if (cursor + size > regionSize) {
+        allocate(std::max(regionSize * 2, cursor + size));
+    }
+    const size_t offset = static_cast<size_t>(region) * regionSize + cursor;
+    cursor = alignUp(cursor + size, alignment);
+
+    if (mapped) {
+        std::memcpy(static_cast<char*>(mapped) + offset, data, size);
+        return offset;
+    }
+    SyncMonitor::Scope scope("ring buffer map");
+    glBindBuffer(target, buffer);
+    // The frame limit keeps the GPU out of this region, so skip the driver's synchronisation
+    void* destination = glMapBufferRange(target, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size),
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (destination) {
+        std::memcpy(destination, data, size);
+        glUnmapBuffer(target);
+    }
+    glBindBuffer(target, 0);
+    return offset;
+}
@@ -23,10 +23,13 @@
 #include "../include/MeshComponent.h"
 #include "../include/MaterialComponent.h"
 #include "../include/LightComponent.h"
+#include "../include/JobSystem.h"
 #include "../scripts/Behaviour.h"
 #include "../scripts/RotationComponent.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 /**
@@ -45,6 +48,135 @@ Scene::Scene() : camera(glm::vec3(0.0f, 0.0f, 5.0f)) {
     // loadDefaultLightbox();   // Basic geometry for simple lighting tests
 }
 
+Scene::Scene(const std::string& sceneName) : camera(glm::vec3(0.0f, 0.0f, 5.0f)) {
+    if (!loadByName(sceneName)) {
+        std::cerr << "Unknown scene '" << sceneName << "', loading teapot lightbox" << std::endl;
+        loadTeapotLightbox();
+    }
+}
+
+/**
+ * Load a Scene by Name
+ * 
+ * Maps scene names (short form or loader function name) to the loaders below,
+ * so tools like the benchmark can select scenes from the command line.
+ */
+namespace {
+struct SceneEntry {
+    const char* shortName;
+    const char* loaderName;
+    void (Scene::*load)();
+};
+
+const SceneEntry sceneTable[] = {
+    {"teapot",  "loadTeapotLightbox",  &Scene::loadTeapotLightbox},
+    {"stone",   "loadStoneFloorScene", &Scene::loadStoneFloorScene},
+    {"shadow",  "loadShadowTestScene", &Scene::loadShadowTestScene},
+    {"default", "loadDefaultLightbox", &Scene::loadDefaultLightbox},
+    {"lights",  "loadManyLightsScene", &Scene::loadManyLightsScene},
+};
+
+const SceneEntry* findScene(const std::string& sceneName) {
+    for (const auto& entry : sceneTable) {
+        if (sceneName == entry.shortName || sceneName == entry.loaderName) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+} // namespace
+
+bool Scene::loadByName(const std::string& sceneName) {
+    const SceneEntry* entry = findScene(sceneName);
+    if (!entry) {
+        return false;
+    }
+    (this->*(entry->load))();
+    return true;
+}
+
+std::vector<std::string> Scene::getSceneNames() {
+    std::vector<std::string> names;
+    for (const auto& entry : sceneTable) {
+        names.push_back(entry.shortName);
+    }
+    return names;
+}
+
+bool Scene::isSceneName(const std::string& sceneName) {
+    return findScene(sceneName) != nullptr;
+}
+
+Entity Scene::getPrimaryLight() {
+    const auto& lights = registry.pool<LightComponent>().entities();
+    for (EntityId id : lights) {
+        if (registry.has<TransformComponent>(id)) {
+            return Entity(&registry, id);
+        }
+    }
+    return Entity();
+}
+
+void Scene::updateBehaviours(float deltaTime, JobSystem* jobs) {
+    if (jobs) {
+        jobs->wait(updateBehavioursAsync(*jobs, deltaTime));
+        return;
+    }
+    startBehaviours();
+    for (auto& behaviour : registry.pool<std::unique_ptr<Behaviour>>()) {
+        behaviour->Update(deltaTime);
+    }
+}
+
+JobHandle Scene::updateBehavioursAsync(JobSystem& jobs, float deltaTime) {
+    startBehaviours();
+    std::unique_ptr<Behaviour>* behaviours = registry.pool<std::unique_ptr<Behaviour>>().data();
+    size_t count = registry.pool<std::unique_ptr<Behaviour>>().size();
+    return jobs.parallelFor(count, BEHAVIOUR_GRAIN, [behaviours, deltaTime](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            behaviours[i]->Update(deltaTime);
+        }
+    });
+}
+
+void Scene::startBehaviours() {
+    // Start() may add components or entities, so it always runs on the calling thread.
+    // It may also add behaviours and reallocate the pool: walk a copy of the owners and
+    // look every behaviour up again, repeating until the ones added meanwhile started too.
+    ComponentPool<std::unique_ptr<Behaviour>>& behaviours = registry.pool<std::unique_ptr<Behaviour>>();
+    auto unstarted = [](const std::unique_ptr<Behaviour>& behaviour) { return !behaviour->hasStarted(); };
+    // Usually everything started long ago: no copy then
+    while (std::any_of(behaviours.begin(), behaviours.end(), unstarted)) {
+        const std::vector<EntityId> owners = behaviours.entities();
+        for (EntityId owner : owners) {
+            std::unique_ptr<Behaviour>* slot = behaviours.get(owner);
+            // The Behaviour itself stays put when Start() moves the slot
+            Behaviour* behaviour = slot ? slot->get() : nullptr;
+            if (behaviour && !behaviour->hasStarted()) {
+                behaviour->Start();
+                behaviour->markStarted();
+            }
+        }
+    }
+}
+
+void Scene::updateWorldMatrices(JobSystem* jobs) {
+    ComponentPool<TransformComponent>& transforms = registry.pool<TransformComponent>();
+    worldMatrices.resize(transforms.size());
+    const TransformComponent* source = transforms.data();
+    glm::mat4* target = worldMatrices.data();
+    auto compute = [source, target](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            target[i] = source[i].getModelMatrix();
+        }
+    };
+    if (jobs) {
+        jobs->wait(jobs->parallelFor(transforms.size(), TRANSFORM_GRAIN, compute));
+    } else {
+        compute(0, transforms.size());
+    }
+}
+
 /**
  * Load Default Lightbox Scene
  * 
@@ -54,7 +186,7 @@ Scene::Scene() : camera(glm::vec3(0.0f, 0.0f, 5.0f)) {
  */
 void Scene::loadDefaultLightbox() {
     // Clear any existing entities
-    entities.clear();
+    registry.clear();
 
     // Define cube geometry with positions and normals
     // Using triangle list format for maximum compatibility
@@ -110,53 +242,46 @@ void Scene::loadDefaultLightbox() {
     cubeMesh = std::make_unique<Mesh>(cubeVertices);
 
     // Floor
-    auto floor = std::make_unique<Entity>();
-    floor->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, -2.0f, 0.0f), glm::vec3(0.0f), glm::vec3(10.0f, 0.1f, 10.0f)));
-    floor->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f)));
-    entities.push_back(std::move(floor));
+    Entity floor = createEntity();
+    floor.addComponent<TransformComponent>(glm::vec3(0.0f, -2.0f, 0.0f), glm::vec3(0.0f), glm::vec3(10.0f, 0.1f, 10.0f));
+    floor.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f));
 
     // Ceiling
-    auto ceiling = std::make_unique<Entity>();
-    ceiling->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f), glm::vec3(10.0f, 0.1f, 10.0f)));
-    ceiling->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f)));
-    entities.push_back(std::move(ceiling));
+    Entity ceiling = createEntity();
+    ceiling.addComponent<TransformComponent>(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f), glm::vec3(10.0f, 0.1f, 10.0f));
+    ceiling.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f));
 
     // Left wall (red)
-    auto leftWall = std::make_unique<Entity>();
-    leftWall->addComponent(std::make_unique<TransformComponent>(glm::vec3(-5.1f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.1f, 4.0f, 10.0f)));
-    leftWall->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.0f, 1.0f, 0.0f)));
-    entities.push_back(std::move(leftWall));
+    Entity leftWall = createEntity();
+    leftWall.addComponent<TransformComponent>(glm::vec3(-5.1f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.1f, 4.0f, 10.0f));
+    leftWall.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.0f, 1.0f, 0.0f));
 
     // Right wall (green)
-    auto rightWall = std::make_unique<Entity>();
-    rightWall->addComponent(std::make_unique<TransformComponent>(glm::vec3(5.1f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.1f, 4.0f, 10.0f)));
-    rightWall->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 0.0f, 0.0f)));
-    entities.push_back(std::move(rightWall));
+    Entity rightWall = createEntity();
+    rightWall.addComponent<TransformComponent>(glm::vec3(5.1f, 0.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.1f, 4.0f, 10.0f));
+    rightWall.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 0.0f, 0.0f));
 
     // Back wall
-    auto backWall = std::make_unique<Entity>();
-    backWall->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, 0.0f, -5.1f), glm::vec3(0.0f), glm::vec3(10.0f, 4.0f, 0.1f)));
-    backWall->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f)));
-    entities.push_back(std::move(backWall));
+    Entity backWall = createEntity();
+    backWall.addComponent<TransformComponent>(glm::vec3(0.0f, 0.0f, -5.1f), glm::vec3(0.0f), glm::vec3(10.0f, 4.0f, 0.1f));
+    backWall.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f));
 
     // Short box
-    auto shortBox = std::make_unique<Entity>();
-    shortBox->addComponent(std::make_unique<TransformComponent>(glm::vec3(2.0f, -1.5f, -2.0f), glm::vec3(0.0f, 18.0f, 0.0f), glm::vec3(2.0f, 1.0f, 2.0f)));
-    shortBox->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f)));
-    entities.push_back(std::move(shortBox));
+    Entity shortBox = createEntity();
+    shortBox.addComponent<TransformComponent>(glm::vec3(2.0f, -1.5f, -2.0f), glm::vec3(0.0f, 18.0f, 0.0f), glm::vec3(2.0f, 1.0f, 2.0f));
+    shortBox.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f));
 
     // Tall box
-    auto tallBox = std::make_unique<Entity>();
-    tallBox->addComponent(std::make_unique<TransformComponent>(glm::vec3(-2.0f, -0.5f, 2.0f), glm::vec3(0.0f, -15.0f, 0.0f), glm::vec3(2.0f, 3.0f, 2.0f)));
-    tallBox->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f)));
-    entities.push_back(std::move(tallBox));
+    Entity tallBox = createEntity();
+    tallBox.addComponent<TransformComponent>(glm::vec3(-2.0f, -0.5f, 2.0f), glm::vec3(0.0f, -15.0f, 0.0f), glm::vec3(2.0f, 3.0f, 2.0f));
+    tallBox.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f));
 
     // Light
-    auto light = std::make_unique<Entity>();
-    light->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, 0.0f, 0.0f)));
-    light->addComponent(std::make_unique<LightComponent>(glm::vec3(1.0f, 1.0f, 1.0f), 3.0f));
-    light->addComponent(std::make_unique<MeshComponent>(Mesh::createSphere(0.1f, 20, 20).get(), glm::vec3(1.0f, 1.0f, 1.0f)));
-    entities.push_back(std::move(light));
+    Entity light = createEntity();
+    light.addComponent<TransformComponent>(glm::vec3(0.0f, 0.0f, 0.0f));
+    light.addComponent<LightComponent>(glm::vec3(1.0f, 1.0f, 1.0f), 3.0f);
+    lightMesh = Mesh::createSphere(0.1f, 20, 20);
+    light.addComponent<MeshComponent>(lightMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f));
 
     // Position camera inside the box
     camera.position = glm::vec3(0.0f, 0.0f, 8.0f);
@@ -166,7 +291,7 @@ void Scene::loadDefaultLightbox() {
 }
 
 void Scene::loadShadowTestScene() {
-    entities.clear();
+    registry.clear();
 
     std::vector<Vertex> cubeVertices = {
         // positions          // normals
@@ -215,34 +340,29 @@ void Scene::loadShadowTestScene() {
     cubeMesh = std::make_unique<Mesh>(cubeVertices);
 
     // Large ground plane
-    auto ground = std::make_unique<Entity>();
-    ground->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, -2.0f, 0.0f), glm::vec3(0.0f), glm::vec3(8.0f, 0.1f, 8.0f)));
-    ground->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.8f, 0.8f, 0.8f))); // Light gray ground
-    entities.push_back(std::move(ground));
+    Entity ground = createEntity();
+    ground.addComponent<TransformComponent>(glm::vec3(0.0f, -2.0f, 0.0f), glm::vec3(0.0f), glm::vec3(8.0f, 0.1f, 8.0f));
+    ground.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.8f, 0.8f, 0.8f)); // Light gray ground
 
     // Floating box (shadow caster)
-    auto floatingBox = std::make_unique<Entity>();
-    floatingBox->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, 0.5f, 0.0f), glm::vec3(0.0f, 45.0f, 0.0f), glm::vec3(1.5f, 1.5f, 1.5f)));
-    floatingBox->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.7f, 0.3f, 0.3f))); // Reddish box
-    entities.push_back(std::move(floatingBox));
+    Entity floatingBox = createEntity();
+    floatingBox.addComponent<TransformComponent>(glm::vec3(0.0f, 0.5f, 0.0f), glm::vec3(0.0f, 45.0f, 0.0f), glm::vec3(1.5f, 1.5f, 1.5f));
+    floatingBox.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.7f, 0.3f, 0.3f)); // Reddish box
 
     // Additional smaller box for more shadows
-    auto smallBox = std::make_unique<Entity>();
-    smallBox->addComponent(std::make_unique<TransformComponent>(glm::vec3(-2.0f, -0.5f, 1.0f), glm::vec3(0.0f, 30.0f, 0.0f), glm::vec3(0.8f, 1.0f, 0.8f)));
-    smallBox->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.3f, 0.7f, 0.3f))); // Greenish box
-    entities.push_back(std::move(smallBox));
+    Entity smallBox = createEntity();
+    smallBox.addComponent<TransformComponent>(glm::vec3(-2.0f, -0.5f, 1.0f), glm::vec3(0.0f, 30.0f, 0.0f), glm::vec3(0.8f, 1.0f, 0.8f));
+    smallBox.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.3f, 0.7f, 0.3f)); // Greenish box
 
     // Another box for more interesting shadows
-    auto tallBox = std::make_unique<Entity>();
-    tallBox->addComponent(std::make_unique<TransformComponent>(glm::vec3(2.5f, 0.0f, -1.5f), glm::vec3(0.0f, -20.0f, 0.0f), glm::vec3(1.0f, 2.5f, 1.0f)));
-    tallBox->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.3f, 0.3f, 0.7f))); // Bluish box
-    entities.push_back(std::move(tallBox));
+    Entity tallBox = createEntity();
+    tallBox.addComponent<TransformComponent>(glm::vec3(2.5f, 0.0f, -1.5f), glm::vec3(0.0f, -20.0f, 0.0f), glm::vec3(1.0f, 2.5f, 1.0f));
+    tallBox.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.3f, 0.3f, 0.7f)); // Bluish box
 
     // Offset light source for dramatic shadows
-    auto light = std::make_unique<Entity>();
-    light->addComponent(std::make_unique<TransformComponent>(glm::vec3(3.0f, 4.0f, 2.0f))); // Offset light position
-    light->addComponent(std::make_unique<LightComponent>(glm::vec3(1.0f, 1.0f, 0.9f), 4.0f, 5.0f)); // Larger radius for softer light
-    entities.push_back(std::move(light));
+    Entity light = createEntity();
+    light.addComponent<TransformComponent>(glm::vec3(3.0f, 4.0f, 2.0f)); // Offset light position
+    light.addComponent<LightComponent>(glm::vec3(1.0f, 1.0f, 0.9f), 4.0f, 5.0f); // Larger radius for softer light
 
     // Position camera for best shadow viewing (moved back for better view)
     camera.position = glm::vec3(-4.0f, 2.5f, 8.0f);
@@ -251,166 +371,43 @@ void Scene::loadShadowTestScene() {
     camera.updateCameraVectors();
 }
 
-void Scene::loadTeapotLightbox() {
-    entities.clear();
-
-    std::cout << "Loading teapot lightbox scene..." << std::endl;
+void Scene::loadManyLightsScene() {
+    loadShadowTestScene();
 
-    // Load the teapot mesh
-    std::cout << "Attempting to load teapot model from: models/teapot.obj" << std::endl;
-    teapotMesh = Mesh::loadFromOBJ("models/teapot.obj");
-    if (!teapotMesh) {
-        std::cerr << "Failed to load teapot model, falling back to cube" << std::endl;
-        // Fallback to a simple cube if teapot loading fails
-        std::vector<Vertex> cubeVertices = {
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f,  0.0f, -1.0f)},
-
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(0.0f,  0.0f, 1.0f)},
-
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f, -1.0f,  0.0f)},
-
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(0.0f,  1.0f,  0.0f)}
-        };
-        teapotMesh = std::make_unique<Mesh>(cubeVertices);
+    // The shadowed primary light only fills in; the local lights carry the scene
+    if (Entity primaryLight = getPrimaryLight()) {
+        primaryLight.getComponent<LightComponent>()->intensity = 0.5f;
     }
 
-    // Load the bunny mesh
-    std::cout << "Attempting to load bunny model from: models/bunny.obj" << std::endl;
-    bunnyMesh = Mesh::loadFromOBJ("models/bunny.obj");
-    if (!bunnyMesh) {
-        std::cerr << "Failed to load bunny model, falling back to cube" << std::endl;
-        // Fallback to a simple cube if bunny loading fails
-        std::vector<Vertex> cubeVertices = {
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f,  0.0f, -1.0f)},
-
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(0.0f,  0.0f, 1.0f)},
-
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f, -1.0f,  0.0f)},
-
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(0.0f,  1.0f,  0.0f)}
-        };
-        bunnyMesh = std::make_unique<Mesh>(cubeVertices);
+    // 12 x 12 lights just above the ground, hue cycling across the grid
+    const int GRID = 12;
+    const float SPACING = 8.0f / GRID;
+    for (int z = 0; z < GRID; ++z) {
+        for (int x = 0; x < GRID; ++x) {
+            float hue = static_cast<float>(x + z * GRID) / (GRID * GRID) * 6.0f;
+            glm::vec3 color = glm::clamp(glm::vec3(std::abs(hue - 3.0f) - 1.0f,
+                                                   2.0f - std::abs(hue - 2.0f),
+                                                   2.0f - std::abs(hue - 4.0f)), 0.0f, 1.0f);
+            Entity light = createEntity();
+            light.addComponent<TransformComponent>(glm::vec3(-4.0f + (x + 0.5f) * SPACING, -1.6f,
+                                                             -4.0f + (z + 0.5f) * SPACING));
+            light.addComponent<LightComponent>(color, 2.0f, 0.5f);
+        }
     }
+}
 
-    // Load the dragon mesh
-    std::cout << "Attempting to load dragon model from: models/dragon.obj" << std::endl;
-    dragonMesh = Mesh::loadFromOBJ("models/dragon.obj");
-    if (!dragonMesh) {
-        std::cerr << "Failed to load dragon model, falling back to cube" << std::endl;
-        // Fallback to a simple cube if dragon loading fails
-        std::vector<Vertex> cubeVertices = {
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(0.0f,  0.0f, -1.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f,  0.0f, -1.0f)},
-
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(0.0f,  0.0f, 1.0f)},
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(0.0f,  0.0f, 1.0f)},
-
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(-1.0f, 0.0f,  0.0f)},
-
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(1.0f,  0.0f,  0.0f)},
-
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f, -0.5f),   glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(0.5f, -0.5f,  0.5f),   glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f,  0.5f),  glm::vec3(0.0f, -1.0f,  0.0f)},
-            {glm::vec3(-0.5f, -0.5f, -0.5f),  glm::vec3(0.0f, -1.0f,  0.0f)},
-
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f, -0.5f),   glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(0.5f,  0.5f,  0.5f),   glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f,  0.5f),  glm::vec3(0.0f,  1.0f,  0.0f)},
-            {glm::vec3(-0.5f,  0.5f, -0.5f),  glm::vec3(0.0f,  1.0f,  0.0f)}
-        };
-        dragonMesh = std::make_unique<Mesh>(cubeVertices);
-    }
+void Scene::loadTeapotLightbox() {
+    registry.clear();
+
+    std::cout << "Loading teapot lightbox scene..." << std::endl;
+
+    // Stream the models in: the scene fills in as they load, and a model that
+    // fails to load becomes a cube (see MeshStreamer.h)
+    std::cout << "Streaming teapot, bunny and dragon models from models/" << std::endl;
+    teapotMesh = Mesh::loadAsync("models/teapot.obj", VertexFormat::Packed);
+    bunnyMesh = Mesh::loadAsync("models/bunny.obj", VertexFormat::Packed);
+    // Full precision: the dragon's coordinates reach ~100 units where half floats step by 0.06
+    dragonMesh = Mesh::loadAsync("models/dragon.obj");
 
     // Create cube mesh for walls
     std::vector<Vertex> cubeVertices = {
@@ -461,104 +458,92 @@ void Scene::loadTeapotLightbox() {
 
     // Floor with stone texture - larger lightbox
     floorMesh = Mesh::createPlane(25.0f, 25.0f, 8, 8); // Much larger floor for bigger lightbox
-    auto floor = std::make_unique<Entity>();
-    floor->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, -3.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f))); // No rotation - plane should be horizontal by default
-    floor->addComponent(std::make_unique<MeshComponent>(floorMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f))); // White base color, will be overridden by material
+    Entity floor = createEntity();
+    floor.addComponent<TransformComponent>(glm::vec3(0.0f, -3.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f)); // No rotation - plane should be horizontal by default
+    floor.addComponent<MeshComponent>(floorMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f)); // White base color, will be overridden by material
     auto stoneMaterial = MaterialComponent::createPBR("stone", glm::vec2(5.0f, 5.0f), 0.025f); // More tiling for larger floor
-    floor->addComponent(std::move(stoneMaterial));
-    entities.push_back(std::move(floor));
+    floor.addComponent<MaterialComponent>(std::move(stoneMaterial));
 
     // Ceiling (light gray) - much larger and higher
-    auto ceiling = std::make_unique<Entity>();
-    ceiling->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, 5.0f, 0.0f), glm::vec3(0.0f), glm::vec3(25.0f, 0.1f, 25.0f))); // Much bigger and higher
-    ceiling->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.9f, 0.9f, 0.9f)));
-    entities.push_back(std::move(ceiling));
+    Entity ceiling = createEntity();
+    ceiling.addComponent<TransformComponent>(glm::vec3(0.0f, 5.0f, 0.0f), glm::vec3(0.0f), glm::vec3(25.0f, 0.1f, 25.0f)); // Much bigger and higher
+    ceiling.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.9f, 0.9f, 0.9f));
 
     // Left wall (green) - much taller and longer
-    auto leftWall = std::make_unique<Entity>();
-    leftWall->addComponent(std::make_unique<TransformComponent>(glm::vec3(-12.6f, 1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.1f, 8.0f, 25.0f))); // Much taller and longer
-    leftWall->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.12f, 0.45f, 0.15f))); // Classic green
-    entities.push_back(std::move(leftWall));
+    Entity leftWall = createEntity();
+    leftWall.addComponent<TransformComponent>(glm::vec3(-12.6f, 1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.1f, 8.0f, 25.0f)); // Much taller and longer
+    leftWall.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.12f, 0.45f, 0.15f)); // Classic green
 
     // Right wall (red) - much taller and longer
-    auto rightWall = std::make_unique<Entity>();
-    rightWall->addComponent(std::make_unique<TransformComponent>(glm::vec3(12.6f, 1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.1f, 8.0f, 25.0f))); // Much taller and longer
-    rightWall->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.7f, 0.12f, 0.15f))); // Classic red
-    entities.push_back(std::move(rightWall));
+    Entity rightWall = createEntity();
+    rightWall.addComponent<TransformComponent>(glm::vec3(12.6f, 1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.1f, 8.0f, 25.0f)); // Much taller and longer
+    rightWall.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.7f, 0.12f, 0.15f)); // Classic red
 
     // Back wall (white) - much taller and wider
-    auto backWall = std::make_unique<Entity>();
-    backWall->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, 1.0f, -12.6f), glm::vec3(0.0f), glm::vec3(25.0f, 8.0f, 0.1f))); // Much taller and wider
-    backWall->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.9f, 0.9f, 0.9f)));
-    entities.push_back(std::move(backWall));
+    Entity backWall = createEntity();
+    backWall.addComponent<TransformComponent>(glm::vec3(0.0f, 1.0f, -12.6f), glm::vec3(0.0f), glm::vec3(25.0f, 8.0f, 0.1f)); // Much taller and wider
+    backWall.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.9f, 0.9f, 0.9f));
 
     // Center teapot (main subject) - larger scale for bigger room
-    auto centerTeapot = std::make_unique<Entity>();
-    centerTeapot->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, -1.8f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.2f, 1.2f, 1.2f))); // Larger scale
-    centerTeapot->addComponent(std::make_unique<MeshComponent>(teapotMesh.get(), glm::vec3(0.7f, 0.7f, 0.9f))); // Light blue
-    entities.push_back(std::move(centerTeapot));
+    Entity centerTeapot = createEntity();
+    centerTeapot.addComponent<TransformComponent>(glm::vec3(0.0f, -1.8f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.2f, 1.2f, 1.2f)); // Larger scale
+    centerTeapot.addComponent<MeshComponent>(teapotMesh.get(), glm::vec3(0.7f, 0.7f, 0.9f)); // Light blue
 
     // Left bunny (yellow, scaled up 2x larger)
-    auto leftBunny = std::make_unique<Entity>();
-    leftBunny->addComponent(std::make_unique<TransformComponent>(glm::vec3(-3.5f, -2.0f, -1.5f), glm::vec3(0.0f, 30.0f, 0.0f), glm::vec3(1.8f, 1.8f, 1.8f))); // 2x larger than before
-    leftBunny->addComponent(std::make_unique<MeshComponent>(bunnyMesh.get(), glm::vec3(1.0f, 1.0f, 0.0f))); // Yellow
-    entities.push_back(std::move(leftBunny));
+    Entity leftBunny = createEntity();
+    leftBunny.addComponent<TransformComponent>(glm::vec3(-3.5f, -2.0f, -1.5f), glm::vec3(0.0f, 30.0f, 0.0f), glm::vec3(1.8f, 1.8f, 1.8f)); // 2x larger than before
+    leftBunny.addComponent<MeshComponent>(bunnyMesh.get(), glm::vec3(1.0f, 1.0f, 0.0f)); // Yellow
 
     // Right teapot (scaled up for bigger room)
-    auto rightTeapot = std::make_unique<Entity>();
-    rightTeapot->addComponent(std::make_unique<TransformComponent>(glm::vec3(3.5f, -2.0f, 1.5f), glm::vec3(0.0f, -45.0f, 0.0f), glm::vec3(0.9f, 0.9f, 0.9f))); // Larger
-    rightTeapot->addComponent(std::make_unique<MeshComponent>(teapotMesh.get(), glm::vec3(0.3f, 0.8f, 0.4f))); // Green
-    entities.push_back(std::move(rightTeapot));
+    Entity rightTeapot = createEntity();
+    rightTeapot.addComponent<TransformComponent>(glm::vec3(3.5f, -2.0f, 1.5f), glm::vec3(0.0f, -45.0f, 0.0f), glm::vec3(0.9f, 0.9f, 0.9f)); // Larger
+    rightTeapot.addComponent<MeshComponent>(teapotMesh.get(), glm::vec3(0.3f, 0.8f, 0.4f)); // Green
 
     // Back teapot (larger for bigger room)
-    auto backTeapot = std::make_unique<Entity>();
-    backTeapot->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, -2.2f, -3.5f), glm::vec3(0.0f, 180.0f, 0.0f), glm::vec3(0.7f, 0.7f, 0.7f))); // Larger
-    backTeapot->addComponent(std::make_unique<MeshComponent>(teapotMesh.get(), glm::vec3(0.8f, 0.3f, 0.8f))); // Purple
-    entities.push_back(std::move(backTeapot));
+    Entity backTeapot = createEntity();
+    backTeapot.addComponent<TransformComponent>(glm::vec3(0.0f, -2.2f, -3.5f), glm::vec3(0.0f, 180.0f, 0.0f), glm::vec3(0.7f, 0.7f, 0.7f)); // Larger
+    backTeapot.addComponent<MeshComponent>(teapotMesh.get(), glm::vec3(0.8f, 0.3f, 0.8f)); // Purple
 
     // Tiny green dragon with rotation behavior
-    auto dragon = std::make_unique<Entity>();
-    dragon->addComponent(std::make_unique<TransformComponent>(glm::vec3(6.0f, -1.5f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.03f, 0.03f, 0.03f))); // Tiny scale to fit properly in room
-    dragon->addComponent(std::make_unique<MeshComponent>(dragonMesh.get(), glm::vec3(0.4f, 0.8f, 0.2f))); // Green dragon
-    dragon->addComponent(std::make_unique<RotationComponent>(20.0f, glm::vec3(0.0f, 1.0f, 0.0f))); // Rotate slowly around Y-axis at 20 degrees/second
-    entities.push_back(std::move(dragon));
+    Entity dragon = createEntity();
+    dragon.addComponent<TransformComponent>(glm::vec3(6.0f, -1.5f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.03f, 0.03f, 0.03f)); // Tiny scale to fit properly in room
+    dragon.addComponent<MeshComponent>(dragonMesh.get(), glm::vec3(0.4f, 0.8f, 0.2f)); // Green dragon
+    dragon.addBehaviour(std::make_unique<RotationComponent>(20.0f, glm::vec3(0.0f, 1.0f, 0.0f))); // Rotate slowly around Y-axis at 20 degrees/second
 
     // Emissive blue cube - glowing light source
-    auto emissiveCube = std::make_unique<Entity>();
-    emissiveCube->addComponent(std::make_unique<TransformComponent>(glm::vec3(-5.0f, 0.5f, 4.0f), glm::vec3(0.0f, 45.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f))); // Position and slight rotation
-    emissiveCube->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f))); // White base color (will be overridden by material)
+    Entity emissiveCube = createEntity();
+    emissiveCube.addComponent<TransformComponent>(glm::vec3(-5.0f, 0.5f, 4.0f), glm::vec3(0.0f, 45.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f)); // Position and slight rotation
+    emissiveCube.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f)); // White base color (will be overridden by material)
     auto emissiveMaterial = MaterialComponent::createEmissive(
         glm::vec3(0.3f, 0.3f, 0.8f),   // Base color (darker blue, less overwhelming)
         glm::vec3(1.5f, 4.0f, 10.0f),  // Emission (higher values for stronger GI, dimmer surface display)
         0.1f,                          // Low roughness (slightly shiny)
         0.0f                           // Non-metallic
     );
-    emissiveCube->addComponent(std::move(emissiveMaterial));
-    entities.push_back(std::move(emissiveCube));
+    emissiveCube.addComponent<MaterialComponent>(std::move(emissiveMaterial));
 
     // Large bright white ceiling light bar for general illumination
-    auto ceilingLightBar = std::make_unique<Entity>();
-    ceilingLightBar->addComponent(std::make_unique<TransformComponent>(
+    Entity ceilingLightBar = createEntity();
+    ceilingLightBar.addComponent<TransformComponent>(
         glm::vec3(0.0f, 4.0f, 0.0f),        // Ceiling position
         glm::vec3(0.0f, 0.0f, 0.0f),        // No rotation
         glm::vec3(6.0f, 0.15f, 1.5f)        // Long bar shape (6x0.15x1.5)
-    ));
-    ceilingLightBar->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f))); // White base color
+    );
+    ceilingLightBar.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f)); // White base color
     auto ceilingLightMaterial = MaterialComponent::createEmissive(
         glm::vec3(0.98f, 0.98f, 0.98f),     // Very bright white base color
         glm::vec3(50.0f, 50.0f, 50.0f),     // Extremely strong white emission for long-range room lighting
         0.0f,                               // Very rough (non-reflective surface)
         0.0f                                // Non-metallic
     );
-    ceilingLightBar->addComponent(std::move(ceilingLightMaterial));
-    entities.push_back(std::move(ceilingLightBar));
+    ceilingLightBar.addComponent<MaterialComponent>(std::move(ceilingLightMaterial));
 
     // Powerful overhead light source for large room
-    auto light = std::make_unique<Entity>();
-    light->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, 2.2f, 0.0f))); // Higher position
-    light->addComponent(std::make_unique<LightComponent>(glm::vec3(1.0f, 1.0f, 0.95f), 12.0f, 8.0f)); // Large radius for very soft light
-    light->addComponent(std::make_unique<MeshComponent>(Mesh::createSphere(0.15f, 20, 20).get(), glm::vec3(1.0f, 1.0f, 1.0f))); // Larger sphere
-    entities.push_back(std::move(light));
+    Entity light = createEntity();
+    light.addComponent<TransformComponent>(glm::vec3(0.0f, 2.2f, 0.0f)); // Higher position
+    light.addComponent<LightComponent>(glm::vec3(1.0f, 1.0f, 0.95f), 12.0f, 8.0f); // Large radius for very soft light
+    lightMesh = Mesh::createSphere(0.15f, 20, 20); // Larger sphere
+    light.addComponent<MeshComponent>(lightMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f));
 
     // Position camera for optimal viewing of larger lightbox with all objects
     camera.position = glm::vec3(0.0f, 2.0f, 18.0f); // Much farther back and higher for larger room
@@ -568,16 +553,12 @@ void Scene::loadTeapotLightbox() {
 }
 
 void Scene::loadStoneFloorScene() {
-    entities.clear();
+    registry.clear();
 
     std::cout << "Loading stone floor scene with PBR materials..." << std::endl;
 
-    // Load the teapot mesh for test objects
-    teapotMesh = Mesh::loadFromOBJ("models/teapot.obj");
-    if (!teapotMesh) {
-        std::cerr << "Failed to load teapot model, using cube instead" << std::endl;
-        teapotMesh = Mesh::createCube();
-    }
+    // Stream the teapot for test objects (a cube if it fails to load)
+    teapotMesh = Mesh::loadAsync("models/teapot.obj", VertexFormat::Packed);
 
     // Create a large tiled stone floor using plane mesh
     floorMesh = Mesh::createPlane(20.0f, 20.0f, 10, 10); // Large floor with many segments for tiling
@@ -586,70 +567,62 @@ void Scene::loadStoneFloorScene() {
     auto stoneMaterial = MaterialComponent::createPBR("stone", glm::vec2(4.0f, 4.0f), 0.03f);
     
     // Create floor entity with stone material
-    auto floor = std::make_unique<Entity>();
-    floor->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, -2.0f, 0.0f), glm::vec3(0.0f), glm::vec3(1.0f, 1.0f, 1.0f)));
-    floor->addComponent(std::make_unique<MeshComponent>(floorMesh.get(), glm::vec3(1.0f))); // White base color, will be overridden by material
-    floor->addComponent(std::move(stoneMaterial));
-    entities.push_back(std::move(floor));
+    Entity floor = createEntity();
+    floor.addComponent<TransformComponent>(glm::vec3(0.0f, -2.0f, 0.0f), glm::vec3(0.0f), glm::vec3(1.0f, 1.0f, 1.0f));
+    floor.addComponent<MeshComponent>(floorMesh.get(), glm::vec3(1.0f)); // White base color, will be overridden by material
+    floor.addComponent<MaterialComponent>(std::move(stoneMaterial));
 
     // Add test objects on the floor
     
     // Central teapot
-    auto centerTeapot = std::make_unique<Entity>();
-    centerTeapot->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.5f, 1.5f, 1.5f)));
-    centerTeapot->addComponent(std::make_unique<MeshComponent>(teapotMesh.get(), glm::vec3(0.8f, 0.2f, 0.2f))); // Red teapot
-    entities.push_back(std::move(centerTeapot));
+    Entity centerTeapot = createEntity();
+    centerTeapot.addComponent<TransformComponent>(glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.5f, 1.5f, 1.5f));
+    centerTeapot.addComponent<MeshComponent>(teapotMesh.get(), glm::vec3(0.8f, 0.2f, 0.2f)); // Red teapot
 
     // Left teapot (blue, metallic)
-    auto leftTeapot = std::make_unique<Entity>();
-    leftTeapot->addComponent(std::make_unique<TransformComponent>(glm::vec3(-4.0f, -1.0f, -2.0f), glm::vec3(0.0f, 30.0f, 0.0f), glm::vec3(1.2f, 1.2f, 1.2f)));
-    leftTeapot->addComponent(std::make_unique<MeshComponent>(teapotMesh.get(), glm::vec3(0.2f, 0.4f, 0.8f))); // Blue teapot
+    Entity leftTeapot = createEntity();
+    leftTeapot.addComponent<TransformComponent>(glm::vec3(-4.0f, -1.0f, -2.0f), glm::vec3(0.0f, 30.0f, 0.0f), glm::vec3(1.2f, 1.2f, 1.2f));
+    leftTeapot.addComponent<MeshComponent>(teapotMesh.get(), glm::vec3(0.2f, 0.4f, 0.8f)); // Blue teapot
     auto metallicMaterial = MaterialComponent::createSolid(glm::vec3(0.2f, 0.4f, 0.8f), 0.1f, 0.8f); // Low roughness, high metallic
-    leftTeapot->addComponent(std::move(metallicMaterial));
-    entities.push_back(std::move(leftTeapot));
+    leftTeapot.addComponent<MaterialComponent>(std::move(metallicMaterial));
 
     // Right teapot (green, rough)
-    auto rightTeapot = std::make_unique<Entity>();
-    rightTeapot->addComponent(std::make_unique<TransformComponent>(glm::vec3(4.0f, -1.0f, 2.0f), glm::vec3(0.0f, -45.0f, 0.0f), glm::vec3(1.2f, 1.2f, 1.2f)));
-    rightTeapot->addComponent(std::make_unique<MeshComponent>(teapotMesh.get(), glm::vec3(0.2f, 0.8f, 0.3f))); // Green teapot
+    Entity rightTeapot = createEntity();
+    rightTeapot.addComponent<TransformComponent>(glm::vec3(4.0f, -1.0f, 2.0f), glm::vec3(0.0f, -45.0f, 0.0f), glm::vec3(1.2f, 1.2f, 1.2f));
+    rightTeapot.addComponent<MeshComponent>(teapotMesh.get(), glm::vec3(0.2f, 0.8f, 0.3f)); // Green teapot
     auto roughMaterial = MaterialComponent::createSolid(glm::vec3(0.2f, 0.8f, 0.3f), 0.9f, 0.0f); // High roughness, no metallic
-    rightTeapot->addComponent(std::move(roughMaterial));
-    entities.push_back(std::move(rightTeapot));
+    rightTeapot.addComponent<MaterialComponent>(std::move(roughMaterial));
 
     // Back teapot (gold, medium properties)
-    auto backTeapot = std::make_unique<Entity>();
-    backTeapot->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, -1.2f, -4.0f), glm::vec3(0.0f, 180.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f)));
-    backTeapot->addComponent(std::make_unique<MeshComponent>(teapotMesh.get(), glm::vec3(1.0f, 0.8f, 0.2f))); // Gold teapot
+    Entity backTeapot = createEntity();
+    backTeapot.addComponent<TransformComponent>(glm::vec3(0.0f, -1.2f, -4.0f), glm::vec3(0.0f, 180.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f));
+    backTeapot.addComponent<MeshComponent>(teapotMesh.get(), glm::vec3(1.0f, 0.8f, 0.2f)); // Gold teapot
     auto goldMaterial = MaterialComponent::createSolid(glm::vec3(1.0f, 0.8f, 0.2f), 0.3f, 0.7f); // Medium roughness, high metallic
-    backTeapot->addComponent(std::move(goldMaterial));
-    entities.push_back(std::move(backTeapot));
+    backTeapot.addComponent<MaterialComponent>(std::move(goldMaterial));
 
     // Add some cubes for variety
     cubeMesh = Mesh::createCube();
     
     // Cube 1 - Rough plastic
-    auto cube1 = std::make_unique<Entity>();
-    cube1->addComponent(std::make_unique<TransformComponent>(glm::vec3(-2.0f, -1.5f, 3.0f), glm::vec3(0.0f, 25.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f)));
-    cube1->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.9f, 0.1f, 0.9f))); // Purple
+    Entity cube1 = createEntity();
+    cube1.addComponent<TransformComponent>(glm::vec3(-2.0f, -1.5f, 3.0f), glm::vec3(0.0f, 25.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f));
+    cube1.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.9f, 0.1f, 0.9f)); // Purple
     auto plasticMaterial = MaterialComponent::createSolid(glm::vec3(0.9f, 0.1f, 0.9f), 0.8f, 0.0f);
-    cube1->addComponent(std::move(plasticMaterial));
-    entities.push_back(std::move(cube1));
+    cube1.addComponent<MaterialComponent>(std::move(plasticMaterial));
     
     // Cube 2 - Smooth metal
-    auto cube2 = std::make_unique<Entity>();
-    cube2->addComponent(std::make_unique<TransformComponent>(glm::vec3(2.5f, -1.5f, -3.5f), glm::vec3(0.0f, -15.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f)));
-    cube2->addComponent(std::make_unique<MeshComponent>(cubeMesh.get(), glm::vec3(0.7f, 0.7f, 0.8f))); // Silver
+    Entity cube2 = createEntity();
+    cube2.addComponent<TransformComponent>(glm::vec3(2.5f, -1.5f, -3.5f), glm::vec3(0.0f, -15.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f));
+    cube2.addComponent<MeshComponent>(cubeMesh.get(), glm::vec3(0.7f, 0.7f, 0.8f)); // Silver
     auto metalMaterial = MaterialComponent::createSolid(glm::vec3(0.7f, 0.7f, 0.8f), 0.05f, 0.95f);
-    cube2->addComponent(std::move(metalMaterial));
-    entities.push_back(std::move(cube2));
+    cube2.addComponent<MaterialComponent>(std::move(metalMaterial));
 
     // Strong overhead light to show off the materials
-    auto light = std::make_unique<Entity>();
-    light->addComponent(std::make_unique<TransformComponent>(glm::vec3(0.0f, 3.0f, 0.0f)));
-    light->addComponent(std::make_unique<LightComponent>(glm::vec3(1.0f, 1.0f, 0.95f), 15.0f, 10.0f)); // Strong, slightly warm light
-    auto lightMesh = Mesh::createSphere(0.2f, 20, 20);
-    light->addComponent(std::make_unique<MeshComponent>(lightMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f)));
-    entities.push_back(std::move(light));
+    Entity light = createEntity();
+    light.addComponent<TransformComponent>(glm::vec3(0.0f, 3.0f, 0.0f));
+    light.addComponent<LightComponent>(glm::vec3(1.0f, 1.0f, 0.95f), 15.0f, 10.0f); // Strong, slightly warm light
+    lightMesh = Mesh::createSphere(0.2f, 20, 20);
+    light.addComponent<MeshComponent>(lightMesh.get(), glm::vec3(1.0f, 1.0f, 1.0f));
 
     // Position camera for good overview of the scene
     camera.position = glm::vec3(0.0f, 2.0f, 8.0f);
@@ -657,5 +630,5 @@ void Scene::loadStoneFloorScene() {
     camera.pitch = -15.0f; // Look down slightly
     camera.updateCameraVectors();
     
-    std::cout << "Stone floor scene loaded with " << entities.size() << " entities." << std::endl;
+    std::cout << "Stone floor scene loaded with " << getEntityCount() << " entities." << std::endl;
 } 
\ No newline at end of file
@@ -0,0 +1,447 @@
+// SceneBvh.cpp
+#include "../include/SceneBvh.h"
+#include "../include/Registry.h"
+#include "../include/MeshComponent.h"
+#include "../include/MaterialComponent.h"
+#include "../include/TransformComponent.h"
+#include "../include/BoundsComponent.h"
+#include "../include/Shader.h"
+#include "../include/JobSystem.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+static_assert(sizeof(SceneBvh::Node) == 2 * sizeof(glm::vec4), "Node must be two texels");
+
+const int BINS = 16;
+
+float bitsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// FNV-1a, as for DrawBatcher's scene hash
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+float surfaceArea(const BoundingBox& box) {
+    const glm::vec3 size = glm::max(box.max - box.min, glm::vec3(0.0f));
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+void expandBox(BoundingBox& box, const BoundingBox& other) {
+    box.min = glm::min(box.min, other.min);
+    box.max = glm::max(box.max, other.max);
+}
+
+/**
+ * Shared by every subtree of one build; nodes is sized for the largest
+ * possible tree and handed out two children at a time
+ */
+struct BuildContext {
+    const std::vector<BoundingBox>* boxes;
+    std::vector<glm::vec3> centroids;
+    std::vector<uint32_t>* order;
+    std::vector<SceneBvh::Node> nodes;
+    std::atomic<uint32_t> nodeCount;
+    int maxLeaf;
+    JobSystem* jobs;
+};
+
+void makeLeaf(SceneBvh::Node& node, uint32_t begin, uint32_t end) {
+    node.first = begin;
+    node.count = end - begin;
+}
+
+void buildNode(BuildContext& context, uint32_t nodeIndex, uint32_t begin, uint32_t end, int depth) {
+    const std::vector<BoundingBox>& boxes = *context.boxes;
+    uint32_t* order = context.order->data();
+    BoundingBox bounds;
+    BoundingBox centroidBounds;
+    for (uint32_t i = begin; i < end; ++i) {
+        expandBox(bounds, boxes[order[i]]);
+        centroidBounds.expand(context.centroids[order[i]]);
+    }
+    SceneBvh::Node& node = context.nodes[nodeIndex];
+    node.min = bounds.min;
+    node.max = bounds.max;
+    const uint32_t count = end - begin;
+    if (count == 1 || depth + 1 >= SceneBvh::MAX_DEPTH) {
+        makeLeaf(node, begin, end);
+        return;
+    }
+
+    // Binned SAH over every axis with extent: cost of a split at bin boundary b
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    int bestSplit = 0;
+    const glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (extent[axis] <= 0.0f) {
+            continue;
+        }
+        BoundingBox binBoxes[BINS];
+        uint32_t binCounts[BINS] = {};
+        const float scale = BINS / extent[axis];
+        for (uint32_t i = begin; i < end; ++i) {
+            const uint32_t primitive = order[i];
+            const int bin = std::min(BINS - 1, static_cast<int>((context.centroids[primitive][axis] - centroidBounds.min[axis]) * scale));
+            ++binCounts[bin];
+            expandBox(binBoxes[bin], boxes[primitive]);
+        }
+        float leftCosts[BINS];
+        BoundingBox left;
+        uint32_t leftCount = 0;
+        for (int b = 0; b < BINS - 1; ++b) {
+            expandBox(left, binBoxes[b]);
+            leftCount += binCounts[b];
+            leftCosts[b] = leftCount > 0 ? leftCount * surfaceArea(left) : 0.0f;
+        }
+        BoundingBox right;
+        uint32_t rightCount = 0;
+        for (int b = BINS - 1; b > 0; --b) {
+            expandBox(right, binBoxes[b]);
+            rightCount += binCounts[b];
+            const float cost = leftCosts[b - 1] + (rightCount > 0 ? rightCount * surfaceArea(right) : 0.0f);
+            if (cost < bestCost && rightCount > 0 && rightCount < count) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    // Traversal costs one box test, a primitive one; keep the leaf when splitting costs more
+    const float area = surfaceArea(bounds);
+    const float splitCost = area > 0.0f ? 1.0f + bestCost / area : 1.0f;
+    if (count <= static_cast<uint32_t>(context.maxLeaf) && (bestAxis < 0 || splitCost >= static_cast<float>(count))) {
+        makeLeaf(node, begin, end);
+        return;
+    }
+
+    uint32_t mid = begin + count / 2;   // Coincident centroids: any halving is as good
+    if (bestAxis >= 0) {
+        const float scale = BINS / extent[bestAxis];
+        const float axisMin = centroidBounds.min[bestAxis];
+        uint32_t* split = std::partition(order + begin, order + end, [&](uint32_t primitive) {
+            return std::min(BINS - 1, static_cast<int>((context.centroids[primitive][bestAxis] - axisMin) * scale)) < bestSplit;
+        });
+        mid = static_cast<uint32_t>(split - order);
+    }
+
+    const uint32_t children = context.nodeCount.fetch_add(2, std::memory_order_relaxed);
+    node.first = children;
+    node.count = 0;
+    if (context.jobs && count > SceneBvh::PARALLEL_PRIMITIVES) {
+        BuildContext* shared = &context;
+        JobHandle leftBuild = context.jobs->submit([shared, children, begin, mid, depth]() {
+            buildNode(*shared, children, begin, mid, depth + 1);
+        });
+        buildNode(context, children + 1, mid, end, depth + 1);
+        context.jobs->wait(leftBuild);
+    } else {
+        buildNode(context, children, begin, mid, depth + 1);
+        buildNode(context, children + 1, mid, end, depth + 1);
+    }
+}
+
+} // namespace
+
+SceneBvh::SceneBvh()
+    : triangleCount(0), geometryBytes(0), instanceBytes(0), maxTexels(0), builtCost(0.0f),
+      instanceHash(0), contentHash(0), rebuilt(false) {
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    glGenBuffers(2, buffers);
+    glGenTextures(2, textures);
+    for (int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4), nullptr, GL_STATIC_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffers[i]);
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+SceneBvh::~SceneBvh() {
+    glDeleteTextures(2, textures);
+    glDeleteBuffers(2, buffers);
+}
+
+std::vector<SceneBvh::Node> SceneBvh::build(const std::vector<BoundingBox>& boxes, std::vector<uint32_t>& order,
+                                            int maxLeaf, JobSystem* jobs) {
+    const uint32_t count = static_cast<uint32_t>(boxes.size());
+    order.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    if (count == 0) {
+        return {};
+    }
+
+    BuildContext context;
+    context.boxes = &boxes;
+    context.centroids.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        context.centroids[i] = boxes[i].getCenter();
+    }
+    context.order = &order;
+    context.nodes.resize(static_cast<size_t>(count) * 2 - 1);
+    context.nodeCount = 1;
+    context.maxLeaf = std::max(1, maxLeaf);
+    context.jobs = jobs;
+    buildNode(context, 0, 0, count, 0);
+
+    // Children are always allocated after their parent, so the used nodes are contiguous
+    context.nodes.resize(context.nodeCount.load());
+    return std::move(context.nodes);
+}
+
+float SceneBvh::computeCost(const std::vector<Node>& nodes) {
+    if (nodes.empty()) {
+        return 0.0f;
+    }
+    float cost = 0.0f;
+    for (const Node& node : nodes) {
+        const float area = surfaceArea(BoundingBox(node.min, node.max));
+        cost += node.count > 0 ? area * node.count : area;
+    }
+    const float rootArea = surfaceArea(BoundingBox(nodes[0].min, nodes[0].max));
+    return rootArea > 0.0f ? cost / rootArea : 0.0f;
+}
+
+void SceneBvh::update(Registry& registry, const std::vector<glm::mat4>& worldMatrices, JobSystem* jobs) {
+    ComponentPool<MaterialComponent>& materials = registry.pool<MaterialComponent>();
+    ComponentPool<BoundsComponent>& bounds = registry.pool<BoundsComponent>();
+    ComponentPool<TransformComponent>& transforms = registry.pool<TransformComponent>();
+    const bool matricesValid = worldMatrices.size() == transforms.size();
+    instances.clear();
+    registry.each<MeshComponent, TransformComponent>(
+        [&](EntityId entity, MeshComponent& meshComp, TransformComponent& transform) {
+            if (!meshComp.mesh || meshComp.mesh->getTriangleCount() == 0) {
+                return;
+            }
+            Instance instance;
+            instance.mesh = meshComp.mesh;
+            instance.model = matricesValid ? worldMatrices[&transform - transforms.data()] : transform.getModelMatrix();
+            const BoundsComponent* worldBounds = bounds.get(entity);
+            instance.box = worldBounds ? worldBounds->box : meshComp.mesh->getBoundingBox().transformed(instance.model);
+            const MaterialComponent* materialComp = materials.get(entity);
+            const Material* material = materialComp ? materialComp->material.get() : nullptr;
+            instance.albedo = material ? material->baseColor : meshComp.color;
+            instance.emission = material ? material->emission : glm::vec3(0.0f);
+            instances.push_back(instance);
+        });
+
+    frameMeshes.clear();
+    for (const Instance& instance : instances) {
+        if (std::find(frameMeshes.begin(), frameMeshes.end(), instance.mesh) == frameMeshes.end()) {
+            frameMeshes.push_back(instance.mesh);
+        }
+    }
+    // Meshes that did not fit are not built again until the buffer is rebuilt
+    std::vector<const Mesh*> newMeshes;
+    size_t tracedMeshes = 0;
+    for (const Mesh* mesh : frameMeshes) {
+        if (rejectedMeshes.count(mesh->getSerial()) > 0) {
+            continue;
+        }
+        tracedMeshes++;
+        if (meshTrees.find(mesh->getSerial()) == meshTrees.end()) {
+            newMeshes.push_back(mesh);
+        }
+    }
+    if (!newMeshes.empty()) {
+        // The buffer is re-uploaded anyway: drop the trees of meshes that are gone
+        if (meshTrees.size() + newMeshes.size() > tracedMeshes) {
+            clearGeometry();
+            newMeshes = frameMeshes;
+        }
+        addMeshes(newMeshes, jobs);
+    }
+    // Meshes that did not fit the geometry buffer are not traced
+    instances.erase(std::remove_if(instances.begin(), instances.end(), [&](const Instance& instance) {
+        return meshTrees.find(instance.mesh->getSerial()) == meshTrees.end();
+    }), instances.end());
+
+    uint64_t topology = 14695981039346656037ull;
+    for (const Instance& instance : instances) {
+        const uint64_t serial = instance.mesh->getSerial();
+        topology = hashBytes(topology, &serial, sizeof(serial));
+    }
+    rebuilt = topology != instanceHash || topNodes.empty() != instances.empty();
+    if (!rebuilt) {
+        refit();
+        rebuilt = computeCost(topNodes) > builtCost * REBUILD_COST_RATIO;
+    }
+    if (rebuilt) {
+        instanceHash = topology;
+        instanceBoxes.clear();
+        for (const Instance& instance : instances) {
+            instanceBoxes.push_back(instance.box);
+        }
+        // One instance per leaf: instances are few, and a leaf test is a full bottom-level traversal
+        topNodes = build(instanceBoxes, instanceOrder, 1, nullptr);
+        builtCost = computeCost(topNodes);
+    }
+    uploadInstances();
+}
+
+void SceneBvh::refit() {
+    // Children come after their parent, so one backwards pass sees them first
+    for (size_t i = topNodes.size(); i-- > 0;) {
+        Node& node = topNodes[i];
+        BoundingBox box;
+        if (node.count > 0) {
+            for (uint32_t k = 0; k < node.count; ++k) {
+                expandBox(box, instances[instanceOrder[node.first + k]].box);
+            }
+        } else {
+            expandBox(box, BoundingBox(topNodes[node.first].min, topNodes[node.first].max));
+            expandBox(box, BoundingBox(topNodes[node.first + 1].min, topNodes[node.first + 1].max));
+        }
+        node.min = box.min;
+        node.max = box.max;
+    }
+}
+
+void SceneBvh::addMeshes(const std::vector<const Mesh*>& meshes, JobSystem* jobs) {
+    struct MeshBuild {
+        std::vector<Node> nodes;
+        std::vector<uint32_t> order;
+    };
+    std::vector<MeshBuild> builds(meshes.size());
+    auto buildMesh = [&](size_t index) {
+        const Mesh& mesh = *meshes[index];
+        std::vector<BoundingBox> boxes(mesh.getTriangleCount());
+        for (size_t t = 0; t < boxes.size(); ++t) {
+            for (int corner = 0; corner < 3; ++corner) {
+                boxes[t].expand(mesh.vertices[mesh.indices[t * 3 + corner]].Position);
+            }
+        }
+        builds[index].nodes = build(boxes, builds[index].order, MAX_LEAF_TRIANGLES, jobs);
+    };
+    if (jobs) {
+        jobs->wait(jobs->parallelFor(meshes.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                buildMesh(i);
+            }
+        }));
+    } else {
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            buildMesh(i);
+        }
+    }
+
+    // Concatenate, rebasing child links on the node offset and leaves on the triangle offset
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh& mesh = *meshes[i];
+        const MeshBuild& meshBuild = builds[i];
+        const size_t texels = (geometryNodes.size() + meshBuild.nodes.size()) * 2 +
+                              (triangleCount + meshBuild.order.size()) * 3;
+        if (texels > static_cast<size_t>(maxTexels)) {
+            std::cerr << "SceneBvh: " << mesh.getTriangleCount()
+                      << " triangles exceed the texture buffer limit, mesh not traced" << std::endl;
+            rejectedMeshes.insert(mesh.getSerial());
+            continue;
+        }
+        const uint32_t nodeOffset = static_cast<uint32_t>(geometryNodes.size());
+        const uint32_t triangleOffset = static_cast<uint32_t>(triangleCount);
+        for (Node node : meshBuild.nodes) {
+            node.first += node.count > 0 ? triangleOffset : nodeOffset;
+            geometryNodes.push_back(node);
+        }
+        for (uint32_t triangle : meshBuild.order) {
+            const glm::vec3& v0 = mesh.vertices[mesh.indices[triangle * 3]].Position;
+            const glm::vec3& v1 = mesh.vertices[mesh.indices[triangle * 3 + 1]].Position;
+            const glm::vec3& v2 = mesh.vertices[mesh.indices[triangle * 3 + 2]].Position;
+            triangles.emplace_back(v0, 0.0f);
+            triangles.emplace_back(v1 - v0, 0.0f);
+            triangles.emplace_back(v2 - v0, 0.0f);
+        }
+        triangleCount += meshBuild.order.size();
+        meshTrees[mesh.getSerial()] = MeshTree{nodeOffset};
+    }
+
+    // The node block grew, so the triangles move: upload both
+    const size_t nodeBytes = geometryNodes.size() * sizeof(Node);
+    geometryBytes = nodeBytes + triangles.size() * sizeof(glm::vec4);
+    glBindBuffer(GL_TEXTURE_BUFFER, buffers[0]);
+    glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(std::max(geometryBytes, sizeof(glm::vec4))), nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, static_cast<GLsizeiptr>(nodeBytes), geometryNodes.data());
+    glBufferSubData(GL_TEXTURE_BUFFER, static_cast<GLintptr>(nodeBytes),
+                    static_cast<GLsizeiptr>(triangles.size() * sizeof(glm::vec4)), triangles.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void SceneBvh::clearGeometry() {
+    meshTrees.clear();
+    rejectedMeshes.clear();
+    geometryNodes.clear();
+    triangles.clear();
+    triangleCount = 0;
+}
+
+void SceneBvh::uploadInstances() {
+    instanceData.clear();
+    for (const Node& node : topNodes) {
+        instanceData.emplace_back(node.min, bitsFloat(node.first));
+        instanceData.emplace_back(node.max, bitsFloat(node.count));
+    }
+    // Records in leaf order, so a leaf's first indexes them directly
+    for (uint32_t index : instanceOrder) {
+        const Instance& instance = instances[index];
+        const glm::mat4 worldToObject = glm::inverse(instance.model);
+        for (int row = 0; row < 3; ++row) {
+            instanceData.emplace_back(worldToObject[0][row], worldToObject[1][row], worldToObject[2][row], worldToObject[3][row]);
+        }
+        instanceData.emplace_back(instance.albedo, bitsFloat(meshTrees[instance.mesh->getSerial()].root));
+        instanceData.emplace_back(instance.emission, 0.0f);
+    }
+
+    const uint64_t hash = hashBytes(14695981039346656037ull, instanceData.data(), instanceData.size() * sizeof(glm::vec4));
+    if (hash == contentHash && !rebuilt) {
+        return;
+    }
+    contentHash = hash;
+    instanceBytes = instanceData.size() * sizeof(glm::vec4);
+    if (instanceBytes / sizeof(glm::vec4) > static_cast<size_t>(maxTexels)) {
+        std::cerr << "SceneBvh: " << instances.size() << " instances exceed the texture buffer limit" << std::endl;
+        instanceBytes = 0;
+        return;
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, buffers[1]);
+    SyncMonitor::Scope sync("scene BVH upload");
+    glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(std::max(instanceBytes, sizeof(glm::vec4))),
+                 instanceData.empty() ? nullptr : instanceData.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void SceneBvh::bindForSampling(Shader& shader) const {
+    shader.setInt("bvhInstanceCount", instanceBytes > 0 ? getInstanceCount() : 0);
+    shader.setInt("bvhTriangleBase", getTriangleBase());
+    shader.setInt("bvhInstanceBase", getInstanceBase());
+    glActiveTexture(GL_TEXTURE0 + GEOMETRY_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, textures[0]);
+    glActiveTexture(GL_TEXTURE0 + INSTANCE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, textures[1]);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+size_t SceneBvh::getMemoryUsage() const {
+    return geometryBytes + instanceBytes;
+}
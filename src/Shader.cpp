@@ -1,114 +1,341 @@
 
 // Shader.cpp
 #include "../include/Shader.h"
+#include "../include/UniformBuffer.h"
+#include "../include/GLExtensions.h"
+#include "../include/ProgramCache.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 #include <GLFW/glfw3.h> // For OpenGL types
 #include <OpenGL/gl3.h>
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath) {
-    // 1. retrieve the vertex/fragment source code from filePath
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    // ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    try 
-    {
-        // open files
-        std::cout << "Attempting to open vertex shader: " << vertexPath << std::endl;
-        vShaderFile.open(vertexPath);
-        if (!vShaderFile.is_open()) {
-            std::cout << "Failed to open vertex shader file: " << vertexPath << std::endl;
+ShaderDefines& ShaderDefines::set(const char* name, int value) {
+    int index = 0;
+    while (index < count && std::strcmp(values[index].name, name) < 0) {
+        ++index;
+    }
+    if (index < count && std::strcmp(values[index].name, name) == 0) {
+        values[index].value = value;
+        return *this;
+    }
+    if (count == MAX_DEFINES) {
+        std::cerr << "ShaderDefines: more than " << MAX_DEFINES << " defines, ignoring " << name << std::endl;
+        return *this;
+    }
+    for (int i = count; i > index; --i) {
+        values[i] = values[i - 1];
+    }
+    values[index] = {name, value};
+    ++count;
+    return *this;
+}
+
+std::string ShaderDefines::getSource() const {
+    std::string source;
+    for (int i = 0; i < count; ++i) {
+        source += "#define " + std::string(values[i].name) + " " + std::to_string(values[i].value) + "\n";
+    }
+    return source;
+}
+
+bool ShaderDefines::operator<(const ShaderDefines& other) const {
+    for (int i = 0; i < count && i < other.count; ++i) {
+        const int order = std::strcmp(values[i].name, other.values[i].name);
+        if (order != 0) {
+            return order < 0;
         }
-        std::cout << "Attempting to open fragment shader: " << fragmentPath << std::endl;
-        fShaderFile.open(fragmentPath);
-        if (!fShaderFile.is_open()) {
-            std::cout << "Failed to open fragment shader file: " << fragmentPath << std::endl;
+        if (values[i].value != other.values[i].value) {
+            return values[i].value < other.values[i].value;
         }
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();		
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // convert stream into string
-        vertexCode   = vShaderStream.str();
-        fragmentCode = fShaderStream.str();		
-    }
-    catch (std::ifstream::failure& e)
-    {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-    }
-    const char* vShaderCode = vertexCode.c_str();
-    const char * fShaderCode = fragmentCode.c_str();
-    // 2. compile shaders
-    unsigned int vertex, fragment;
-    // vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
-    // fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
-    // shader Program
+    }
+    return count < other.count;
+}
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const ShaderDefines& defines) {
+    GLExtensions::initialize();
+    // 1. retrieve the vertex/fragment source code from filePath, expanding #include
+    std::cout << "Attempting to open vertex shader: " << vertexPath << std::endl;
+    std::string vertexCode = loadSource(vertexPath);
+    std::cout << "Attempting to open fragment shader: " << fragmentPath << std::endl;
+    std::string fragmentCode = loadSource(fragmentPath);
+    injectDefines(vertexCode, defines);
+    injectDefines(fragmentCode, defines);
+    // 2. load the cached binary or start compiling; errors are checked on first use
+    submit({GL_VERTEX_SHADER, GL_FRAGMENT_SHADER}, {"VERTEX", "FRAGMENT"}, {vertexCode, fragmentCode});
+    if (fromCache) {
+        std::cout << "Loaded program binary from cache" << std::endl;
+    }
+}
+
+Shader::Shader(const char* computePath, const ShaderDefines& defines) {
+    GLExtensions::initialize();
+    std::cout << "Attempting to open compute shader: " << computePath << std::endl;
+    std::string computeCode = loadSource(computePath);
+    injectDefines(computeCode, defines);
+    submit({GL_COMPUTE_SHADER}, {"COMPUTE"}, {computeCode});
+    if (fromCache) {
+        std::cout << "Loaded program binary from cache" << std::endl;
+    }
+}
+
+void Shader::submit(const std::vector<unsigned int>& types, const std::vector<const char*>& names,
+                    const std::vector<std::string>& sources) {
     ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
+    cacheKey = ProgramCache::makeKey(sources);
+    pending = true;
+    if (ProgramCache::load(cacheKey, ID)) {
+        fromCache = true;
+        return;
+    }
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const char* code = sources[i].c_str();
+        unsigned int shader = glCreateShader(types[i]);
+        glShaderSource(shader, 1, &code, NULL);
+        glCompileShader(shader);
+        glAttachShader(ID, shader);
+        pendingStages.push_back({shader, names[i]});
+    }
+    if (GLExtensions::hasProgramBinary()) {
+        GLExtensions::programParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(ID);
-    checkCompileErrors(ID, "PROGRAM");
-    // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+}
+
+void Shader::resolve() const {
+    if (!pending) {
+        return;
+    }
+    pending = false;
+    if (!fromCache) {
+        for (const PendingStage& stage : pendingStages) {
+            checkCompileErrors(stage.shader, stage.type);
+        }
+        checkCompileErrors(ID, "PROGRAM");
+        // delete the shaders as they're linked into our program now and no longer necessary
+        for (const PendingStage& stage : pendingStages) {
+            glDeleteShader(stage.shader);
+        }
+        pendingStages.clear();
+        if (valid) {
+            ProgramCache::save(cacheKey, ID);
+        }
+    }
+    // 3. reflect the linked program once so setters never query the driver
+    reflectUniforms();
+    bindUniformBlocks();
+}
+
+bool Shader::isValid() const {
+    resolve();
+    return valid;
+}
+
+bool Shader::isReady() const {
+    if (!pending || !GLExtensions::hasParallelShaderCompile()) {
+        return true;
+    }
+    GLint complete = GL_FALSE;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+std::string Shader::loadSource(const std::string& path, int depth) {
+    if (depth > 8) {
+        std::cout << "ERROR::SHADER::INCLUDE_TOO_DEEP: " << path << std::endl;
+        return std::string();
+    }
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+        return std::string();
+    }
+
+    // Included files are resolved relative to the including file
+    size_t slash = path.find_last_of("/\\");
+    std::string directory = slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+
+    std::stringstream source;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, 8, "#include") != 0) {
+            source << line << '\n';
+            continue;
+        }
+        size_t open = line.find('"', start);
+        size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+        if (close == std::string::npos) {
+            std::cout << "ERROR::SHADER::MALFORMED_INCLUDE: " << path << ":" << lineNumber << std::endl;
+            continue;
+        }
+        source << loadSource(directory + line.substr(open + 1, close - open - 1), depth + 1);
+        // Keep compiler messages pointing at the right line of this file
+        source << "#line " << lineNumber + 1 << '\n';
+    }
+    return source.str();
+}
+
+void Shader::injectDefines(std::string& source, const ShaderDefines& defines) {
+    if (defines.empty()) {
+        return;
+    }
+    // Skip the leading #version / #extension lines (and blank lines between them)
+    size_t position = 0;
+    int lineCount = 0;
+    while (position < source.size()) {
+        size_t end = source.find('\n', position);
+        if (end == std::string::npos) {
+            break;
+        }
+        size_t start = source.find_first_not_of(" \t", position);
+        bool blank = start == end;
+        bool header = !blank &&
+                      (source.compare(start, 8, "#version") == 0 || source.compare(start, 10, "#extension") == 0);
+        if (!blank && !header) {
+            break;
+        }
+        position = end + 1;
+        ++lineCount;
+    }
+    source.insert(position, defines.getSource() + "#line " + std::to_string(lineCount + 1) + "\n");
+}
+
+void Shader::reflectUniforms() const {
+    uniformLocations.clear();
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> nameBuffer(std::max(maxLength, 1));
+
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, static_cast<GLuint>(i), maxLength, &length, &size, &type, nameBuffer.data());
+        std::string name(nameBuffer.data(), length);
+        GLint location = glGetUniformLocation(ID, name.c_str());
+        if (location < 0) {
+            continue; // Uniform block member, set through its buffer
+        }
+        uniformLocations[name] = location;
+
+        // Arrays are reported as "name[0]": register the bare name and every element
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+            std::string base = name.substr(0, name.size() - 3);
+            uniformLocations[base] = location;
+            for (GLint element = 1; element < size; ++element) {
+                std::string elementName = base + "[" + std::to_string(element) + "]";
+                uniformLocations[elementName] = glGetUniformLocation(ID, elementName.c_str());
+            }
+        }
+    }
+}
+
+void Shader::bindUniformBlocks() const {
+    GLint count = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    char name[256];
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        glGetActiveUniformBlockName(ID, static_cast<GLuint>(i), sizeof(name), &length, name);
+        int binding = UniformBuffer::getBlockBinding(std::string(name, length));
+        if (binding >= 0) {
+            glUniformBlockBinding(ID, static_cast<GLuint>(i), static_cast<GLuint>(binding));
+        } else {
+            std::cout << "Warning: uniform block " << std::string(name, length) << " has no binding point" << std::endl;
+        }
+    }
+}
+
+int Shader::getUniformLocation(std::string_view name) const {
+    resolve();
+    auto it = uniformLocations.find(name);
+    return it == uniformLocations.end() ? -1 : it->second;
 }
 
 void Shader::use() {
+    resolve();
     glUseProgram(ID);
 }
 
-void Shader::setBool(const std::string &name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+void Shader::setBool(std::string_view name, bool value) const {
+    glUniform1i(getUniformLocation(name), (int)value);
+}
+
+void Shader::setInt(std::string_view name, int value) const {
+    glUniform1i(getUniformLocation(name), value);
+}
+
+void Shader::setFloat(std::string_view name, float value) const {
+    glUniform1f(getUniformLocation(name), value);
+}
+
+void Shader::setVec2(std::string_view name, const glm::vec2 &value) const {
+    glUniform2fv(getUniformLocation(name), 1, &value[0]);
+}
+
+void Shader::setVec3(std::string_view name, const glm::vec3 &value) const {
+    glUniform3fv(getUniformLocation(name), 1, &value[0]);
+}
+
+void Shader::setMat4(std::string_view name, const glm::mat4 &mat) const {
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setBool(int location, bool value) const {
+    glUniform1i(location, (int)value);
+}
+
+void Shader::setInt(int location, int value) const {
+    glUniform1i(location, value);
+}
+
+void Shader::setFloat(int location, float value) const {
+    glUniform1f(location, value);
 }
 
-void Shader::setInt(const std::string &name, int value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setVec2(int location, const glm::vec2 &value) const {
+    glUniform2fv(location, 1, &value[0]);
 }
 
-void Shader::setFloat(const std::string &name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setVec3(int location, const glm::vec3 &value) const {
+    glUniform3fv(location, 1, &value[0]);
 }
 
-void Shader::setVec2(const std::string &name, const glm::vec2 &value) const {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+void Shader::setMat4(int location, const glm::mat4 &mat) const {
+    glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::setVec3(const std::string &name, const glm::vec3 &value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+void Shader::setVec3Array(int location, const glm::vec3* values, int count) const {
+    glUniform3fv(location, count, &values[0][0]);
 }
 
-void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void Shader::setVec4Array(int location, const glm::vec4* values, int count) const {
+    glUniform4fv(location, count, &values[0][0]);
 }
 
-void Shader::checkCompileErrors(unsigned int shader, std::string type) {
+void Shader::checkCompileErrors(unsigned int shader, std::string type) const {
     int success;
     char infoLog[1024];
     if (type != "PROGRAM") {
         glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
         if (!success) {
+            valid = false;
             glGetShaderInfoLog(shader, 1024, NULL, infoLog);
             std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
         }
     } else {
         glGetProgramiv(shader, GL_LINK_STATUS, &success);
         if (!success) {
+            valid = false;
             glGetProgramInfoLog(shader, 1024, NULL, infoLog);
             std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
         }
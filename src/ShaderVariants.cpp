@@ -0,0 +1,35 @@
+// ShaderVariants.cpp
+#include "../include/ShaderVariants.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+
+ShaderVariants::ShaderVariants(const char* vertexPath, const char* fragmentPath, Setup setup)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath), setup(setup) {
+}
+
+ShaderVariants::ShaderVariants(const char* computePath, Setup setup)
+    : vertexPath(nullptr), fragmentPath(computePath), setup(setup) {
+}
+
+ShaderVariants::~ShaderVariants() {
+    for (auto& variant : variants) {
+        glDeleteProgram(variant.second->ID);
+    }
+}
+
+Shader& ShaderVariants::get(const ShaderDefines& defines) {
+    auto it = variants.find(defines);
+    if (it != variants.end()) {
+        return *it->second;
+    }
+
+    std::unique_ptr<Shader> shader(vertexPath ? new Shader(vertexPath, fragmentPath, defines)
+                                              : new Shader(fragmentPath, defines));
+    if (setup && shader->isValid()) {
+        shader->use();
+        setup(*shader);
+    }
+    Shader& variant = *shader;
+    variants.emplace(defines, std::move(shader));
+    return variant;
+}
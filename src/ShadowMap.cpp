@@ -1,67 +1,277 @@
 // ShadowMap.cpp
 #include "../include/ShadowMap.h"
+#include "../include/DrawBatcher.h"
+#include "../include/Shader.h"
+#include "../include/UniformBuffer.h"
+#include "../include/Bounds.h"
 #include <GLFW/glfw3.h>
 #include <OpenGL/gl3.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
-ShadowMap::ShadowMap() {
+namespace {
+
+// Depth range of every light frustum (distance from the light)
+const float LIGHT_NEAR_PLANE = 1.0f;
+const float LIGHT_FAR_PLANE = 25.0f;
+
+// 0 = uniform splits, 1 = logarithmic splits
+const float CASCADE_SPLIT_LAMBDA = 0.75f;
+
+glm::mat4 getLightView(const glm::vec3& lightPos) {
+    // Look at the scene center (origin); pick another up vector when looking straight down/up
+    glm::vec3 direction = glm::vec3(0.0f) - lightPos;
+    if (glm::length(direction) < 1e-4f) {
+        direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    }
+    glm::vec3 up = std::abs(glm::normalize(direction).y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    return glm::lookAt(lightPos, lightPos + direction, up);
+}
+
+static_assert(sizeof(FrameUniforms::cascadeMatrices) / sizeof(glm::mat4) == ShadowMap::MAX_CASCADES,
+              "FrameUniforms must hold one matrix per shadow cascade");
+
+} // namespace
+
+ShadowMap::ShadowMap()
+    : depthMapFBO(0), depthMap(0), resolution(getResolutionForQuality(2)), cascadeCount(getCascadeCountForQuality(2)),
+      staticDepthMap(0), staticFBO(0), cacheHasDynamic(false), cachedStaticHash(0), cascadesRendered(0) {
+    for (int i = 0; i < MAX_CASCADES; ++i) {
+        cascadeMatrices[i] = glm::mat4(1.0f);
+        cachedMatrices[i] = glm::mat4(1.0f);
+        cascadeSplits[i] = MAX_SHADOW_DISTANCE;
+    }
     setupShadowMap();
 }
 
 ShadowMap::~ShadowMap() {
+    releaseTextures();
     glDeleteFramebuffers(1, &depthMapFBO);
-    glDeleteTextures(1, &depthMap);
+    glDeleteFramebuffers(1, &staticFBO);
 }
 
-void ShadowMap::setupShadowMap() {
-    glGenFramebuffers(1, &depthMapFBO);
-    
-    glGenTextures(1, &depthMap);
-    glBindTexture(GL_TEXTURE_2D, depthMap);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, 
-                 SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER); 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    
+// Super Low/Performance: 1024², Balanced/High: 2048², Ultra: 4096²
+unsigned int ShadowMap::getResolutionForQuality(int qualityLevel) {
+    switch (qualityLevel) {
+        case 0: return 1024;
+        case 1: return 1024;
+        case 2: return 2048;
+        case 3: return 2048;
+        case 4: return 4096;
+        default: return 2048;
+    }
+}
+
+int ShadowMap::getCascadeCountForQuality(int qualityLevel) {
+    switch (qualityLevel) {
+        case 0: return 2;
+        case 1: return 3;
+        case 2: return 3;
+        case 3: return 4;
+        case 4: return 4;
+        default: return 3;
+    }
+}
+
+unsigned int ShadowMap::createDepthArray() const {
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24,
+                 resolution, resolution, MAX_CASCADES, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+
     float borderColor[] = { 1.0, 1.0, 1.0, 1.0 };
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-    
-    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
-    glDrawBuffer(GL_NONE);
-    glReadBuffer(GL_NONE);
-    
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return texture;
+}
+
+void ShadowMap::attachLayer(unsigned int target, unsigned int fbo, unsigned int texture, int layer) const {
+    glBindFramebuffer(target, fbo);
+    glFramebufferTextureLayer(target, GL_DEPTH_ATTACHMENT, texture, 0, layer);
+}
+
+void ShadowMap::setupShadowMap() {
+    if (depthMapFBO == 0) {
+        glGenFramebuffers(1, &depthMapFBO);
+        glGenFramebuffers(1, &staticFBO);
+        // Depth only: no color buffers to draw or read
+        for (unsigned int fbo : {depthMapFBO, staticFBO}) {
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+    }
+
+    depthMap = createDepthArray();
+    attachLayer(GL_FRAMEBUFFER, depthMapFBO, depthMap, 0);
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         std::cout << "ERROR::SHADOWMAP::FRAMEBUFFER_NOT_COMPLETE" << std::endl;
     }
-    
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    std::cout << "Shadow maps: " << cascadeCount << " cascades at " << resolution << "x" << resolution
+              << " (" << (static_cast<size_t>(resolution) * resolution * 4 * MAX_CASCADES >> 20) << " MB per array)" << std::endl;
+    invalidate();
+}
+
+void ShadowMap::releaseTextures() {
+    glDeleteTextures(1, &depthMap);
+    depthMap = 0;
+    if (staticDepthMap != 0) {
+        glDeleteTextures(1, &staticDepthMap);
+        staticDepthMap = 0;
+    }
+}
+
+void ShadowMap::configure(unsigned int newResolution, int newCascadeCount) {
+    newCascadeCount = std::max(1, std::min(newCascadeCount, MAX_CASCADES));
+    if (newResolution == resolution && newCascadeCount == cascadeCount) {
+        return;
+    }
+    cascadeCount = newCascadeCount;
+    if (newResolution != resolution) {
+        resolution = newResolution;
+        releaseTextures();
+        setupShadowMap();
+    }
+    invalidate();
 }
 
-void ShadowMap::bindForWriting() {
-    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-    glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-    glClear(GL_DEPTH_BUFFER_BIT);
+void ShadowMap::invalidate() {
+    for (int i = 0; i < MAX_CASCADES; ++i) {
+        cacheValid[i] = false;
+    }
+}
+
+void ShadowMap::updateCascades(const glm::vec3& lightPos, const glm::mat4& cameraView,
+                               float fovY, float aspect, float nearPlane, float farPlane) {
+    glm::mat4 lightView = getLightView(lightPos);
+    glm::mat4 invView = glm::inverse(cameraView);
+    float shadowFar = std::min(farPlane, MAX_SHADOW_DISTANCE);
+    float tanHalfY = std::tan(fovY * 0.5f);
+    float tanHalfX = tanHalfY * aspect;
+
+    float sliceNear = nearPlane;
+    for (int i = 0; i < cascadeCount; ++i) {
+        // Practical split scheme
+        float p = static_cast<float>(i + 1) / static_cast<float>(cascadeCount);
+        float logSplit = nearPlane * std::pow(shadowFar / nearPlane, p);
+        float uniformSplit = nearPlane + (shadowFar - nearPlane) * p;
+        float sliceFar = CASCADE_SPLIT_LAMBDA * logSplit + (1.0f - CASCADE_SPLIT_LAMBDA) * uniformSplit;
+
+        // World space corners of this slice of the camera frustum
+        glm::vec3 corners[8];
+        glm::vec3 center(0.0f);
+        for (int k = 0; k < 8; ++k) {
+            float depth = k < 4 ? sliceNear : sliceFar;
+            float x = ((k & 1) ? 1.0f : -1.0f) * tanHalfX * depth;
+            float y = ((k & 2) ? 1.0f : -1.0f) * tanHalfY * depth;
+            corners[k] = glm::vec3(invView * glm::vec4(x, y, -depth, 1.0f));
+            center += corners[k];
+        }
+        center /= 8.0f;
+
+        // A bounding sphere keeps the frustum size fixed while the camera rotates
+        float radius = 0.0f;
+        for (const glm::vec3& corner : corners) {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        // Snap to whole texels so the map does not shimmer (and stays cacheable) under small moves
+        float texelSize = 2.0f * radius / static_cast<float>(resolution);
+        glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+        lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+
+        glm::mat4 lightProjection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+                                               lightCenter.y - radius, lightCenter.y + radius,
+                                               LIGHT_NEAR_PLANE, LIGHT_FAR_PLANE);
+        cascadeMatrices[i] = lightProjection * lightView;
+        cascadeSplits[i] = sliceFar;
+        sliceNear = sliceFar;
+    }
+}
+
+void ShadowMap::render(DrawBatcher& batcher, const Shader& depthShader, int lightSpaceLocation, float lodErrorTexels) {
+    cascadesRendered = 0;
+
+    // Moving, adding or removing static geometry (or switching cache mode) drops the cache
+    bool dynamic = batcher.hasDynamicInstances();
+    if (dynamic != cacheHasDynamic || batcher.getStaticHash() != cachedStaticHash) {
+        invalidate();
+        cacheHasDynamic = dynamic;
+        cachedStaticHash = batcher.getStaticHash();
+    }
+    if (dynamic && staticDepthMap == 0) {
+        staticDepthMap = createDepthArray();
+    }
+    unsigned int cacheFBO = dynamic ? staticFBO : depthMapFBO;
+    unsigned int cacheTexture = dynamic ? staticDepthMap : depthMap;
+
+    // Cull casters per cascade; the light frustum spans near to far plane, so anything
+    // outside it would be clipped anyway. All views are added before the first draw
+    // so the batcher uploads its instances once. Casters pick their levels of detail
+    // per cascade, by their error in that cascade's texels.
+    int views[MAX_CASCADES];
+    bool upToDate[MAX_CASCADES];
+    for (int i = 0; i < cascadeCount; ++i) {
+        upToDate[i] = cacheValid[i] && cachedMatrices[i] == cascadeMatrices[i];
+        const LodSelection lod = {cascadeMatrices[i], static_cast<float>(resolution), lodErrorTexels};
+        views[i] = (upToDate[i] && !dynamic) ? 0 : batcher.addView(Frustum(cascadeMatrices[i]), nullptr, nullptr, &lod);
+    }
+
+    glViewport(0, 0, resolution, resolution);
+    // Slope-scaled bias adapts to each cascade's texel size
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.5f, 2.0f);
+
+    for (int i = 0; i < cascadeCount; ++i) {
+        if (upToDate[i] && !dynamic) {
+            continue;
+        }
+        depthShader.setMat4(lightSpaceLocation, cascadeMatrices[i]);
+
+        if (!upToDate[i]) {
+            attachLayer(GL_FRAMEBUFFER, cacheFBO, cacheTexture, i);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            batcher.drawMeshBatches(depthShader, BatchFilter::Static, views[i]);
+            cachedMatrices[i] = cascadeMatrices[i];
+            cacheValid[i] = true;
+        }
+
+        if (dynamic) {
+            // Start from the cached static depth, then add the moving casters
+            attachLayer(GL_FRAMEBUFFER, depthMapFBO, depthMap, i);
+            attachLayer(GL_READ_FRAMEBUFFER, staticFBO, staticDepthMap, i);
+            glBlitFramebuffer(0, 0, resolution, resolution, 0, 0, resolution, resolution,
+                              GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, depthMapFBO);
+            batcher.drawMeshBatches(depthShader, BatchFilter::Dynamic, views[i]);
+        }
+        cascadesRendered++;
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void ShadowMap::bindForReading(unsigned int textureUnit) {
     glActiveTexture(GL_TEXTURE0 + textureUnit);
-    glBindTexture(GL_TEXTURE_2D, depthMap);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthMap);
 }
 
 glm::mat4 ShadowMap::getLightSpaceMatrix(const glm::vec3& lightPos, float lightRadius) {
-    float near_plane = 1.0f, far_plane = 25.0f; // Increased far plane
-    
     // Much larger projection bounds based on light radius to eliminate cutoffs
     float projectionSize = 15.0f + lightRadius * 3.0f; // Base 15 units + radius scaling
-    glm::mat4 lightProjection = glm::ortho(-projectionSize, projectionSize, -projectionSize, projectionSize, near_plane, far_plane);
-    
-    // Look at the scene center (origin) instead of a hardcoded point
-    glm::vec3 sceneCenter = glm::vec3(0.0f, 0.0f, 0.0f);
-    glm::mat4 lightView = glm::lookAt(lightPos, sceneCenter, glm::vec3(0.0, 1.0, 0.0));
-    glm::mat4 lightSpaceMatrix = lightProjection * lightView;
-    return lightSpaceMatrix;
-} 
\ No newline at end of file
+    glm::mat4 lightProjection = glm::ortho(-projectionSize, projectionSize, -projectionSize, projectionSize,
+                                           LIGHT_NEAR_PLANE, LIGHT_FAR_PLANE);
+    return lightProjection * getLightView(lightPos);
+}
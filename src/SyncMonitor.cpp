@@ -0,0 +1,77 @@
+// SyncMonitor.cpp
+#include "../include/SyncMonitor.h"
+#include "../include/GLExtensions.h"
+#include <iomanip>
+#include <iostream>
+
+bool SyncMonitor::enabled = false;
+int SyncMonitor::stallCount = 0;
+float SyncMonitor::stallTime = 0.0f;
+float SyncMonitor::pacingWait = 0.0f;
+int SyncMonitor::lastStallCount = 0;
+float SyncMonitor::lastStallTime = 0.0f;
+float SyncMonitor::lastPacingWait = 0.0f;
+int SyncMonitor::driverWarnings = 0;
+long long SyncMonitor::frame = 0;
+
+SyncMonitor::Scope::Scope(const char* name) : name(name), timing(SyncMonitor::enabled) {
+    if (timing) {
+        start = std::chrono::high_resolution_clock::now();
+    }
+}
+
+SyncMonitor::Scope::~Scope() {
+    if (!timing) {
+        return;
+    }
+    float elapsed = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    if (elapsed > STALL_THRESHOLD_MS) {
+        SyncMonitor::reportStall(name, elapsed);
+    }
+}
+
+void SyncMonitor::setEnabled(bool enable) {
+    if (enable == enabled) {
+        return;
+    }
+    enabled = enable;
+    GLExtensions::initialize();
+    GLExtensions::setPerformanceMessageHandler(enable ? driverMessage : nullptr);
+    if (enable) {
+        driverWarnings = 0;
+        std::cout << "Sync stall detection on (threshold " << STALL_THRESHOLD_MS << " ms, driver warnings: "
+                  << (GLExtensions::hasDebugOutput() ? "yes" : "unavailable") << ")" << std::endl;
+    }
+}
+
+void SyncMonitor::reportStall(const char* name, float milliseconds) {
+    if (!enabled) {
+        return;
+    }
+    ++stallCount;
+    stallTime += milliseconds;
+    std::cerr << "Sync stall (frame " << frame << "): " << name << " blocked for "
+              << std::fixed << std::setprecision(2) << milliseconds << " ms" << std::endl;
+    std::cerr.unsetf(std::ios::floatfield);
+}
+
+void SyncMonitor::reportPacingWait(float milliseconds) {
+    if (enabled) {
+        pacingWait += milliseconds;
+    }
+}
+
+void SyncMonitor::endFrame() {
+    lastStallCount = stallCount;
+    lastStallTime = stallTime;
+    lastPacingWait = pacingWait;
+    stallCount = 0;
+    stallTime = 0.0f;
+    pacingWait = 0.0f;
+    ++frame;
+}
+
+void SyncMonitor::driverMessage(const char* message) {
+    ++driverWarnings;
+    std::cerr << "Driver performance warning (frame " << frame << "): " << message << std::endl;
+}
@@ -0,0 +1,239 @@
+// TextureCache.cpp
+#include "../include/TextureCache.h"
+#include "../include/MappedFile.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const unsigned char KTX_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+const uint32_t KTX_ENDIANNESS = 0x04030201;
+const char* TEXTURE_CACHE_DIRECTORY = "cache/textures";
+const char* SOURCE_KEY = "vibegi.source";
+
+struct KTXHeader {
+    unsigned char identifier[12];
+    uint32_t endianness;
+    uint32_t glType;
+    uint32_t glTypeSize;
+    uint32_t glFormat;
+    uint32_t glInternalFormat;
+    uint32_t glBaseInternalFormat;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t numberOfArrayElements;
+    uint32_t numberOfFaces;
+    uint32_t numberOfMipmapLevels;
+    uint32_t bytesOfKeyValueData;
+};
+static_assert(sizeof(KTXHeader) == 64, "KTXHeader must match the KTX 1.1 layout");
+
+inline size_t padTo4(size_t size) {
+    return (size + 3) & ~static_cast<size_t>(3);
+}
+
+const char* getEncodingName(TextureEncoding encoding) {
+    switch (encoding) {
+        case TextureEncoding::BC1: return "bc1";
+        case TextureEncoding::BC4: return "bc4";
+        case TextureEncoding::BC5: return "bc5";
+        default: return "rgba8";
+    }
+}
+
+uint32_t getBaseInternalFormat(TextureEncoding encoding) {
+    switch (encoding) {
+        case TextureEncoding::BC1: return GL_RGB;
+        case TextureEncoding::BC4: return GL_RED;
+        case TextureEncoding::BC5: return GL_RG;
+        default: return GL_RGBA;
+    }
+}
+
+bool getSourceStamp(const std::string& sourcePath, std::string& stamp) {
+    uint64_t size;
+    int64_t time;
+    if (!MappedFile::getFileStamp(sourcePath, size, time)) {
+        return false;
+    }
+    stamp = std::to_string(size) + " " + std::to_string(time) + " " + std::to_string(TextureCache::VERSION);
+    return true;
+}
+
+// Append one KTX key/value pair (key and value are both NUL terminated)
+void appendKeyValue(std::vector<unsigned char>& out, const std::string& key, const std::string& value) {
+    uint32_t byteSize = static_cast<uint32_t>(key.size() + 1 + value.size() + 1);
+    const unsigned char* sizeBytes = reinterpret_cast<const unsigned char*>(&byteSize);
+    out.insert(out.end(), sizeBytes, sizeBytes + sizeof(byteSize));
+    out.insert(out.end(), key.begin(), key.end());
+    out.push_back(0);
+    out.insert(out.end(), value.begin(), value.end());
+    out.push_back(0);
+    out.resize(padTo4(out.size()), 0);
+}
+
+// Find a key in the key/value block; returns false if absent or malformed
+bool findKeyValue(const unsigned char* data, size_t size, const std::string& key, std::string& value) {
+    size_t offset = 0;
+    while (offset + 4 <= size) {
+        uint32_t byteSize;
+        std::memcpy(&byteSize, data + offset, sizeof(byteSize));
+        offset += 4;
+        if (byteSize > size - offset) {
+            return false;
+        }
+        const char* pair = reinterpret_cast<const char*>(data + offset);
+        size_t keyLength = strnlen(pair, byteSize);
+        if (keyLength < byteSize && key.compare(0, std::string::npos, pair, keyLength) == 0) {
+            const char* valueStart = pair + keyLength + 1;
+            value.assign(valueStart, strnlen(valueStart, byteSize - keyLength - 1));
+            return true;
+        }
+        offset += padTo4(byteSize);
+    }
+    return false;
+}
+
+} // namespace
+
+std::string TextureCache::getCachePath(const std::string& sourcePath, TextureEncoding encoding) {
+    // Flatten the source path into a single file name
+    std::string name = sourcePath;
+    for (char& c : name) {
+        if (c == '/' || c == '\\' || c == ':') c = '_';
+    }
+    return std::string(TEXTURE_CACHE_DIRECTORY) + "/" + name + "." + getEncodingName(encoding) + ".ktx";
+}
+
+bool TextureCache::load(const std::string& sourcePath, TextureEncoding encoding, TextureImage& image) {
+    std::string stamp;
+    if (!getSourceStamp(sourcePath, stamp)) {
+        return false;
+    }
+
+    std::string cachePath = getCachePath(sourcePath, encoding);
+    MappedFile file;
+    if (!file.open(cachePath) || file.size() < sizeof(KTXHeader)) {
+        return false;
+    }
+
+    KTXHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0 ||
+        header.endianness != KTX_ENDIANNESS ||
+        header.glInternalFormat != TextureCompressor::getInternalFormat(encoding) ||
+        header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth != 0 ||
+        header.numberOfFaces != 1 || header.numberOfMipmapLevels == 0 ||
+        header.bytesOfKeyValueData > file.size() - sizeof(KTXHeader)) {
+        return false; // Foreign or incompatible file, rebuild
+    }
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(file.data());
+    std::string cachedStamp;
+    if (!findKeyValue(bytes + sizeof(KTXHeader), header.bytesOfKeyValueData, SOURCE_KEY, cachedStamp) ||
+        cachedStamp != stamp) {
+        return false; // Stale cache, rebuild
+    }
+
+    image = TextureImage();
+    image.encoding = encoding;
+    image.width = static_cast<int>(header.pixelWidth);
+    image.height = static_cast<int>(header.pixelHeight);
+
+    size_t offset = sizeof(KTXHeader) + header.bytesOfKeyValueData;
+    size_t dataSize = 0;
+    int width = image.width;
+    int height = image.height;
+    for (uint32_t level = 0; level < header.numberOfMipmapLevels; ++level) {
+        uint32_t imageSize;
+        if (offset + sizeof(imageSize) > file.size()) {
+            std::cerr << "Truncated texture cache: " << cachePath << std::endl;
+            return false;
+        }
+        std::memcpy(&imageSize, bytes + offset, sizeof(imageSize));
+        offset += sizeof(imageSize);
+        if (imageSize != TextureCompressor::getLevelSize(encoding, width, height) || offset + imageSize > file.size()) {
+            std::cerr << "Corrupt texture cache: " << cachePath << std::endl;
+            return false;
+        }
+        image.levels.push_back({width, height, dataSize, imageSize});
+        image.data.insert(image.data.end(), bytes + offset, bytes + offset + imageSize);
+        dataSize += imageSize;
+        offset += padTo4(imageSize);
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return true;
+}
+
+bool TextureCache::save(const std::string& sourcePath, const TextureImage& image) {
+    std::string stamp;
+    if (!getSourceStamp(sourcePath, stamp)) {
+        return false;
+    }
+
+    std::vector<unsigned char> keyValues;
+    appendKeyValue(keyValues, "KTXorientation", "S=r,T=u");
+    appendKeyValue(keyValues, SOURCE_KEY, stamp);
+
+    bool compressed = TextureCompressor::isCompressed(image.encoding);
+    KTXHeader header = {};
+    std::memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+    header.endianness = KTX_ENDIANNESS;
+    header.glType = compressed ? 0 : GL_UNSIGNED_BYTE;
+    header.glTypeSize = 1;
+    header.glFormat = compressed ? 0 : GL_RGBA;
+    header.glInternalFormat = TextureCompressor::getInternalFormat(image.encoding);
+    header.glBaseInternalFormat = getBaseInternalFormat(image.encoding);
+    header.pixelWidth = static_cast<uint32_t>(image.width);
+    header.pixelHeight = static_cast<uint32_t>(image.height);
+    header.numberOfFaces = 1;
+    header.numberOfMipmapLevels = static_cast<uint32_t>(image.levels.size());
+    header.bytesOfKeyValueData = static_cast<uint32_t>(keyValues.size());
+
+    std::error_code error;
+    std::filesystem::create_directories(TEXTURE_CACHE_DIRECTORY, error);
+    if (error) {
+        std::cerr << "Failed to create texture cache directory: " << error.message() << std::endl;
+        return false;
+    }
+
+    // Write to a temporary file first so a crash never leaves a half-written cache behind
+    std::string cachePath = getCachePath(sourcePath, image.encoding);
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to write texture cache: " << tempPath << std::endl;
+            return false;
+        }
+        const char padding[4] = {0, 0, 0, 0};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(keyValues.data()), static_cast<std::streamsize>(keyValues.size()));
+        for (const TextureMipLevel& level : image.levels) {
+            uint32_t imageSize = static_cast<uint32_t>(level.size);
+            file.write(reinterpret_cast<const char*>(&imageSize), sizeof(imageSize));
+            file.write(reinterpret_cast<const char*>(image.data.data() + level.offset), static_cast<std::streamsize>(level.size));
+            file.write(padding, static_cast<std::streamsize>(padTo4(level.size) - level.size));
+        }
+        if (!file) {
+            std::cerr << "Failed to write texture cache: " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error) {
+        std::cerr << "Failed to finalize texture cache " << cachePath << ": " << error.message() << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
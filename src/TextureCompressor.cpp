@@ -0,0 +1,243 @@
+// TextureCompressor.cpp
+#include "../include/TextureCompressor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <cstring>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RED_RGTC1
+#define GL_COMPRESSED_RED_RGTC1 0x8DBB
+#endif
+#ifndef GL_COMPRESSED_RG_RGTC2
+#define GL_COMPRESSED_RG_RGTC2 0x8DBD
+#endif
+
+namespace {
+
+// Next level of a mip chain with a 2x2 box filter (odd edges reuse the last texel)
+std::vector<unsigned char> downsample(const unsigned char* src, int width, int height, int& outWidth, int& outHeight) {
+    outWidth = std::max(1, width / 2);
+    outHeight = std::max(1, height / 2);
+    std::vector<unsigned char> dst(static_cast<size_t>(outWidth) * outHeight * 4);
+    for (int y = 0; y < outHeight; ++y) {
+        int y0 = std::min(y * 2, height - 1);
+        int y1 = std::min(y * 2 + 1, height - 1);
+        for (int x = 0; x < outWidth; ++x) {
+            int x0 = std::min(x * 2, width - 1);
+            int x1 = std::min(x * 2 + 1, width - 1);
+            for (int c = 0; c < 4; ++c) {
+                int sum = src[(static_cast<size_t>(y0) * width + x0) * 4 + c] +
+                          src[(static_cast<size_t>(y0) * width + x1) * 4 + c] +
+                          src[(static_cast<size_t>(y1) * width + x0) * 4 + c] +
+                          src[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+                dst[(static_cast<size_t>(y) * outWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+// Gather a 4x4 block, replicating edge texels for levels smaller than 4 pixels
+void fetchBlock(const unsigned char* src, int width, int height, int blockX, int blockY, unsigned char block[16][4]) {
+    for (int y = 0; y < 4; ++y) {
+        int sy = std::min(blockY * 4 + y, height - 1);
+        for (int x = 0; x < 4; ++x) {
+            int sx = std::min(blockX * 4 + x, width - 1);
+            std::memcpy(block[y * 4 + x], src + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+        }
+    }
+}
+
+inline uint16_t packRGB565(int r, int g, int b) {
+    return static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+inline void unpackRGB565(uint16_t c, int rgb[3]) {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// BC1: endpoints from the inset color bounding box, always in 4-color mode
+void encodeBC1(const unsigned char block[16][4], unsigned char* out) {
+    int minColor[3] = {255, 255, 255};
+    int maxColor[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            minColor[c] = std::min(minColor[c], static_cast<int>(block[i][c]));
+            maxColor[c] = std::max(maxColor[c], static_cast<int>(block[i][c]));
+        }
+    }
+    // Pull the endpoints in slightly, the lines through the box are rarely hit at the corners
+    for (int c = 0; c < 3; ++c) {
+        int inset = (maxColor[c] - minColor[c]) >> 4;
+        minColor[c] = std::min(255, minColor[c] + inset);
+        maxColor[c] = std::max(0, maxColor[c] - inset);
+    }
+
+    uint16_t color0 = packRGB565(maxColor[0], maxColor[1], maxColor[2]);
+    uint16_t color1 = packRGB565(minColor[0], minColor[1], minColor[2]);
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            int bestError = 1 << 30;
+            for (int p = 0; p < 4; ++p) {
+                int dr = block[i][0] - palette[p][0];
+                int dg = block[i][1] - palette[p][1];
+                int db = block[i][2] - palette[p][2];
+                int error = dr * dr + dg * dg + db * db;
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (i * 2);
+        }
+    }
+
+    out[0] = static_cast<unsigned char>(color0 & 0xFF);
+    out[1] = static_cast<unsigned char>(color0 >> 8);
+    out[2] = static_cast<unsigned char>(color1 & 0xFF);
+    out[3] = static_cast<unsigned char>(color1 >> 8);
+    for (int b = 0; b < 4; ++b) {
+        out[4 + b] = static_cast<unsigned char>((indices >> (b * 8)) & 0xFF);
+    }
+}
+
+// BC4: one channel, endpoints at the block range, 8-value mode
+void encodeBC4(const unsigned char block[16][4], int channel, unsigned char* out) {
+    int minValue = 255;
+    int maxValue = 0;
+    for (int i = 0; i < 16; ++i) {
+        minValue = std::min(minValue, static_cast<int>(block[i][channel]));
+        maxValue = std::max(maxValue, static_cast<int>(block[i][channel]));
+    }
+
+    uint64_t indices = 0;
+    if (maxValue != minValue) {
+        int palette[8];
+        palette[0] = maxValue;
+        palette[1] = minValue;
+        for (int p = 2; p < 8; ++p) {
+            palette[p] = ((8 - p) * maxValue + (p - 1) * minValue) / 7;
+        }
+        for (int i = 0; i < 16; ++i) {
+            int value = block[i][channel];
+            int best = 0;
+            int bestError = 256;
+            for (int p = 0; p < 8; ++p) {
+                int error = std::abs(value - palette[p]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint64_t>(best) << (i * 3);
+        }
+    }
+
+    out[0] = static_cast<unsigned char>(maxValue);
+    out[1] = static_cast<unsigned char>(minValue);
+    for (int b = 0; b < 6; ++b) {
+        out[2 + b] = static_cast<unsigned char>((indices >> (b * 8)) & 0xFF);
+    }
+}
+
+void encodeLevel(const unsigned char* rgba, int width, int height, TextureEncoding encoding, unsigned char* out) {
+    if (encoding == TextureEncoding::RGBA8) {
+        std::memcpy(out, rgba, static_cast<size_t>(width) * height * 4);
+        return;
+    }
+
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    size_t blockBytes = encoding == TextureEncoding::BC5 ? 16 : 8;
+    unsigned char block[16][4];
+    for (int by = 0; by < blocksY; ++by) {
+        for (int bx = 0; bx < blocksX; ++bx) {
+            fetchBlock(rgba, width, height, bx, by, block);
+            unsigned char* dst = out + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+            switch (encoding) {
+                case TextureEncoding::BC1:
+                    encodeBC1(block, dst);
+                    break;
+                case TextureEncoding::BC4:
+                    encodeBC4(block, 0, dst);
+                    break;
+                case TextureEncoding::BC5:
+                    encodeBC4(block, 0, dst);
+                    encodeBC4(block, 1, dst + 8);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+} // namespace
+
+TextureImage TextureCompressor::build(const unsigned char* rgba, int width, int height, TextureEncoding encoding) {
+    TextureImage image;
+    image.encoding = encoding;
+    image.width = width;
+    image.height = height;
+
+    // Lay out the full chain first so data is allocated once
+    int levelWidth = width;
+    int levelHeight = height;
+    size_t offset = 0;
+    while (true) {
+        size_t size = getLevelSize(encoding, levelWidth, levelHeight);
+        image.levels.push_back({levelWidth, levelHeight, offset, size});
+        offset += size;
+        if (levelWidth == 1 && levelHeight == 1) break;
+        levelWidth = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+    }
+    image.data.resize(offset);
+
+    std::vector<unsigned char> current(rgba, rgba + static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i < image.levels.size(); ++i) {
+        const TextureMipLevel& level = image.levels[i];
+        encodeLevel(current.data(), level.width, level.height, encoding, image.data.data() + level.offset);
+        if (i + 1 < image.levels.size()) {
+            int nextWidth, nextHeight;
+            current = downsample(current.data(), level.width, level.height, nextWidth, nextHeight);
+        }
+    }
+    return image;
+}
+
+unsigned int TextureCompressor::getInternalFormat(TextureEncoding encoding) {
+    switch (encoding) {
+        case TextureEncoding::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TextureEncoding::BC4: return GL_COMPRESSED_RED_RGTC1;
+        case TextureEncoding::BC5: return GL_COMPRESSED_RG_RGTC2;
+        default: return GL_RGBA8;
+    }
+}
+
+size_t TextureCompressor::getLevelSize(TextureEncoding encoding, int width, int height) {
+    if (encoding == TextureEncoding::RGBA8) {
+        return static_cast<size_t>(width) * height * 4;
+    }
+    size_t blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+    return blocks * (encoding == TextureEncoding::BC5 ? 16 : 8);
+}
@@ -0,0 +1,254 @@
+// TextureStreamer.cpp
+#include "../include/TextureStreamer.h"
+#include "../include/Material.h"
+#include "../include/TextureCache.h"
+#include "../include/GLExtensions.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "stb_image.h"
+
+namespace {
+
+const char* getEncodingLabel(TextureEncoding encoding) {
+    switch (encoding) {
+        case TextureEncoding::BC1: return "BC1";
+        case TextureEncoding::BC4: return "BC4";
+        case TextureEncoding::BC5: return "BC5";
+        default: return "RGBA8";
+    }
+}
+
+} // namespace
+
+TextureStreamer& TextureStreamer::instance() {
+    static TextureStreamer streamer;
+    return streamer;
+}
+
+TextureStreamer::~TextureStreamer() {
+    // No GL calls here: the context is usually gone by static destruction time
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void TextureStreamer::startWorkers() {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    unsigned int count = std::min(4u, hardwareThreads > 1 ? hardwareThreads - 1 : 1u);
+    for (unsigned int i = 0; i < count; ++i) {
+        workers.emplace_back(&TextureStreamer::workerLoop, this);
+    }
+}
+
+TextureEncoding TextureStreamer::chooseEncoding(TextureUsage usage) {
+    switch (usage) {
+        case TextureUsage::Normal:
+            return TextureEncoding::BC5;
+        case TextureUsage::Grayscale:
+            return TextureEncoding::BC4;
+        case TextureUsage::Color:
+        default:
+            // RGTC is core since GL 3.0, S3TC is an extension (present on all desktop drivers we know of)
+            if (s3tcSupported < 0) {
+                s3tcSupported = GLExtensions::hasExtension("GL_EXT_texture_compression_s3tc") ? 1 : 0;
+            }
+            return s3tcSupported ? TextureEncoding::BC1 : TextureEncoding::RGBA8;
+    }
+}
+
+void TextureStreamer::request(Texture* texture, const std::string& path, TextureUsage usage) {
+    TextureEncoding encoding = chooseEncoding(usage);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (workers.empty()) {
+            startWorkers();
+        }
+        uint64_t ticket = nextTicket++;
+        if (tickets.find(texture) == tickets.end()) {
+            pending++;
+        }
+        tickets[texture] = ticket; // A newer request replaces an older one
+        jobs.push_back({ticket, texture, path, encoding});
+    }
+    jobAvailable.notify_one();
+}
+
+void TextureStreamer::cancel(Texture* texture) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tickets.erase(texture) > 0) {
+        pending--;
+    }
+}
+
+size_t TextureStreamer::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
+
+void TextureStreamer::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+
+            auto it = tickets.find(job.texture);
+            if (it == tickets.end() || it->second != job.ticket) {
+                continue; // Cancelled or superseded before we got to it
+            }
+        }
+
+        Result result;
+        result.ticket = job.ticket;
+        result.texture = job.texture;
+        result.path = job.path;
+        loadImage(job, result);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(std::move(result));
+        }
+        resultAvailable.notify_all();
+    }
+}
+
+void TextureStreamer::loadImage(const Job& job, Result& result) {
+    auto start = std::chrono::high_resolution_clock::now();
+    result.fromCache = TextureCache::load(job.path, job.encoding, result.image);
+    result.success = result.fromCache;
+
+    if (!result.success) {
+        // Same orientation as Texture::loadFromFile, without touching the global flag
+        stbi_set_flip_vertically_on_load_thread(1);
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(job.path.c_str(), &width, &height, &channels, 4);
+        if (pixels) {
+            result.image = TextureCompressor::build(pixels, width, height, job.encoding);
+            stbi_image_free(pixels);
+            TextureCache::save(job.path, result.image);
+            result.success = true;
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    result.loadTimeMs = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+bool TextureStreamer::upload(Texture* texture, const TextureImage& image) {
+    if (uploadBuffers[0] == 0) {
+        glGenBuffers(2, uploadBuffers);
+    }
+
+    // Orphan and refill the next staging buffer; the previous one may still be in flight
+    GLuint buffer = uploadBuffers[nextUploadBuffer];
+    nextUploadBuffer = 1 - nextUploadBuffer;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    void* mapped = nullptr;
+    {
+        SyncMonitor::Scope sync("texture staging map");
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(image.data.size()), nullptr, GL_STREAM_DRAW);
+        mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(image.data.size()),
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    }
+    if (!mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    std::memcpy(mapped, image.data.data(), image.data.size());
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    GLenum internalFormat = TextureCompressor::getInternalFormat(image.encoding);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (size_t i = 0; i < image.levels.size(); ++i) {
+        const TextureMipLevel& level = image.levels[i];
+        const void* offset = reinterpret_cast<const void*>(level.offset);
+        if (TextureCompressor::isCompressed(image.encoding)) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, level.width, level.height, 0,
+                                   static_cast<GLsizei>(level.size), offset);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internalFormat, level.width, level.height, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, offset);
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size()) - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    texture->width = image.width;
+    texture->height = image.height;
+    texture->resident = true;
+    return true;
+}
+
+void TextureStreamer::processUploads(size_t budgetBytes) {
+    size_t uploadedBytes = 0;
+    bool first = true;
+    while (first || uploadedBytes < budgetBytes) {
+        Result result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (results.empty()) {
+                return;
+            }
+            if (!first && results.front().image.data.size() > budgetBytes - uploadedBytes) {
+                return; // Leave it for the next frame
+            }
+            result = std::move(results.front());
+            results.pop_front();
+
+            // Drop results for textures that were destroyed or re-requested meanwhile
+            auto it = tickets.find(result.texture);
+            if (it == tickets.end() || it->second != result.ticket) {
+                continue;
+            }
+            tickets.erase(it);
+            pending--;
+        }
+        first = false;
+
+        // The texture outlives this call: ~Texture cancels on the GL thread, which is us
+        if (!result.success) {
+            std::cerr << "Failed to load texture: " << result.path << std::endl;
+            continue;
+        }
+        if (!upload(result.texture, result.image)) {
+            std::cerr << "Failed to upload texture: " << result.path << std::endl;
+            continue;
+        }
+        uploadedBytes += result.image.data.size();
+
+        std::cout << "Loaded texture: " << result.path << " (" << result.image.width << "x" << result.image.height
+                  << ", " << getEncodingLabel(result.image.encoding) << ", " << result.image.levels.size() << " mips, "
+                  << (result.fromCache ? "cached" : "encoded") << " in " << result.loadTimeMs << " ms)" << std::endl;
+    }
+}
+
+void TextureStreamer::finishAll() {
+    while (getPendingCount() > 0) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            resultAvailable.wait(lock, [this]() { return !results.empty() || pending == 0; });
+        }
+        processUploads(SIZE_MAX);
+    }
+}
@@ -0,0 +1,52 @@
+// UniformBuffer.cpp
+#include "../include/UniformBuffer.h"
+#include "../include/SyncMonitor.h"
+#include <GLFW/glfw3.h>
+#include <OpenGL/gl3.h>
+
+UniformBuffer::UniformBuffer(size_t size, unsigned int binding)
+    : ubo(0), bindingPoint(binding), capacity(size), streamedOffset(0), streamedSize(0) {
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    bind();
+}
+
+UniformBuffer::~UniformBuffer() {
+    glDeleteBuffers(1, &ubo);
+}
+
+void UniformBuffer::update(const void* data, size_t size) {
+    SyncMonitor::Scope scope("uniform buffer orphan");
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(size < capacity ? size : capacity), data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBuffer::stream(const void* data, size_t size, int region) {
+    if (!ring) {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        ring.reset(new RingBuffer(GL_UNIFORM_BUFFER, capacity, static_cast<size_t>(alignment)));
+    }
+    streamedSize = size < capacity ? size : capacity;
+    streamedOffset = ring->write(region, data, streamedSize);
+    bind();
+}
+
+void UniformBuffer::bind() const {
+    if (ring) {
+        glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, ring->getBuffer(),
+                          static_cast<GLintptr>(streamedOffset), static_cast<GLsizeiptr>(streamedSize));
+    } else {
+        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ubo);
+    }
+}
+
+int UniformBuffer::getBlockBinding(const std::string& blockName) {
+    if (blockName == "FrameUniforms") return FRAME_UNIFORMS_BINDING;
+    if (blockName == "SSAOKernel") return SSAO_KERNEL_BINDING;
+    return -1;
+}
@@ -4,7 +4,7 @@
 #include <stdexcept>
 #include <iostream>
 
-Window::Window(int width, int height, const char* title) {
+Window::Window(int width, int height, const char* title, bool visible) {
     if (!glfwInit()) {
         throw std::runtime_error("Failed to initialize GLFW");
     }
@@ -15,6 +15,7 @@ Window::Window(int width, int height, const char* title) {
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
 
     window = glfwCreateWindow(width, height, title, nullptr, nullptr);
     if (!window) {
@@ -33,8 +33,10 @@
  * - F: Toggle screen space reflections
  * - C: Cycle anti-aliasing (None/FXAA/TAA)
  * - Z: Cycle quality levels
+ * - B: Toggle dynamic resolution (holds the target frame time)
+ * - N: Cycle temporal upscaling (Native/Quality/Balanced/Performance/Ultra Performance, TAA only)
  * - R: Reset temporal accumulation
- * - X: Show performance breakdown
+ * - X: Show performance breakdown (CPU and GPU timings per pass)
  * - Space: Pause/unpause
  * - ESC: Exit
  */
@@ -49,8 +51,11 @@
 #include <future>
 #include <unordered_map>
 #include <chrono>
+#include <functional>
 #include <cfloat>
 #include <iomanip>
+#include <cstdio>
+#include <cstdlib>
 
 // Core rendering components
 #include "../include/Window.h"
@@ -65,6 +70,7 @@
 #include "../include/MaterialComponent.h"
 #include "../include/LightComponent.h"
 #include "../include/Scene.h"
+#include "../include/JobSystem.h"
 #include "../scripts/Behaviour.h"
 #include "../scripts/RotationComponent.h"
 
@@ -75,6 +81,11 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include "../include/RadianceCascades.h"
+#include "../include/PerformanceProfiler.h"
+#include "../include/Renderer.h"
+#include "../include/SyncMonitor.h"
+#include "../include/MeshStreamer.h"
+#include "../include/CameraPath.h"
 
 #include <string>
 #include <GLFW/glfw3.h>
@@ -88,98 +99,6 @@
 #define BUILD_NUMBER "24001"
 #define BUILD_DATE __DATE__
 
-// Enhanced performance profiler with detailed logging
-class PerformanceProfiler {
-private:
-    struct TimingData {
-        std::chrono::time_point<std::chrono::high_resolution_clock> start;
-        float lastTime = 0.0f;
-        float minTime = FLT_MAX;
-        float maxTime = 0.0f;
-        float avgTime = 0.0f;
-        int sampleCount = 0;
-        
-        void updateStats(float newTime) {
-            lastTime = newTime;
-            minTime = std::min(minTime, newTime);
-            maxTime = std::max(maxTime, newTime);
-            
-            // Rolling average
-            sampleCount++;
-            float alpha = std::min(1.0f / sampleCount, 0.1f); // Converge to 10-sample average
-            avgTime = avgTime * (1.0f - alpha) + newTime * alpha;
-        }
-    };
-    
-    std::unordered_map<std::string, TimingData> cpuTimers;
-    std::mutex timerMutex;
-    int frameCounter = 0;
-    std::chrono::time_point<std::chrono::high_resolution_clock> frameStart;
-    
-public:
-    void beginFrame() {
-        frameStart = std::chrono::high_resolution_clock::now();
-        frameCounter++;
-    }
-    
-    void beginTimer(const std::string& name) {
-        std::lock_guard<std::mutex> lock(timerMutex);
-        cpuTimers[name].start = std::chrono::high_resolution_clock::now();
-    }
-    
-    void endTimer(const std::string& name) {
-        auto end = std::chrono::high_resolution_clock::now();
-        std::lock_guard<std::mutex> lock(timerMutex);
-        
-        auto& timer = cpuTimers[name];
-        float elapsed = std::chrono::duration<float, std::milli>(end - timer.start).count();
-        timer.updateStats(elapsed);
-    }
-    
-    void logDetailedStats() {
-        std::lock_guard<std::mutex> lock(timerMutex);
-        
-        std::cout << "\n=== PERFORMANCE BREAKDOWN (Frame " << frameCounter << ") ===" << std::endl;
-        std::cout << std::fixed << std::setprecision(2);
-        
-        // Sort by average time (highest first)
-        std::vector<std::pair<std::string, TimingData*>> sortedTimers;
-        for (auto& [name, data] : cpuTimers) {
-            sortedTimers.push_back({name, &data});
-        }
-        std::sort(sortedTimers.begin(), sortedTimers.end(), 
-            [](const auto& a, const auto& b) { return a.second->avgTime > b.second->avgTime; });
-        
-        float totalTime = 0.0f;
-        for (const auto& [name, data] : sortedTimers) {
-            totalTime += data->avgTime;
-        }
-        
-        for (const auto& [name, data] : sortedTimers) {
-            float percentage = (data->avgTime / totalTime) * 100.0f;
-            std::cout << std::setw(20) << name << ": " 
-                     << std::setw(6) << data->avgTime << "ms avg (" 
-                     << std::setw(5) << percentage << "%) [" 
-                     << std::setw(6) << data->minTime << " - " 
-                     << std::setw(6) << data->maxTime << "ms]" << std::endl;
-        }
-        
-        auto frameEnd = std::chrono::high_resolution_clock::now();
-        float frameTime = std::chrono::duration<float, std::milli>(frameEnd - frameStart).count();
-        std::cout << std::setw(20) << "TOTAL_FRAME" << ": " 
-                 << std::setw(6) << frameTime << "ms" << std::endl;
-        std::cout << std::setw(20) << "TARGET_60FPS" << ": " 
-                 << std::setw(6) << "16.67ms (current: " << (1000.0f / frameTime) << " fps)" << std::endl;
-        std::cout << "========================================\n" << std::endl;
-    }
-    
-    float getLastTime(const std::string& name) {
-        std::lock_guard<std::mutex> lock(timerMutex);
-        auto it = cpuTimers.find(name);
-        return (it != cpuTimers.end()) ? it->second.lastTime : 0.0f;
-    }
-};
-
 // Input processing thread data
 struct InputData {
     std::atomic<bool> moveForward{false};
@@ -191,6 +110,8 @@ struct InputData {
     std::atomic<bool> ssaoToggle{false};
     std::atomic<bool> lightToggle{false};      // V key - toggle main light
     std::atomic<bool> qualityToggle{false};
+    std::atomic<bool> dynamicResolutionToggle{false}; // B key - toggle dynamic resolution
+    std::atomic<bool> upscaleToggle{false};    // N key - cycle temporal upscaling modes
     std::atomic<bool> resetTemporal{false};
     std::atomic<bool> pauseToggle{false};
     std::atomic<bool> exitRequested{false};
@@ -271,7 +192,7 @@ void inputProcessingThread(GLFWwindow* window, InputData& inputData, std::atomic
         if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS) inputData.lightRadiusDelta = -lightSpeed;
         
         // Toggle states (handled with static debouncing)
-        static bool lastM = false, lastG = false, lastT = false, lastV = false, lastZ = false, lastR = false, lastSpace = false, lastF = false, lastC = false, lastX = false;
+        static bool lastM = false, lastG = false, lastT = false, lastV = false, lastZ = false, lastR = false, lastSpace = false, lastF = false, lastC = false, lastX = false, lastB = false, lastN = false;
         
         bool currentM = glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS;
         if (!lastM && currentM) inputData.ambientToggle = true;
@@ -293,6 +214,14 @@ void inputProcessingThread(GLFWwindow* window, InputData& inputData, std::atomic
         if (!lastZ && currentZ) inputData.qualityToggle = true;
         lastZ = currentZ;
         
+        bool currentB = glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS;
+        if (!lastB && currentB) inputData.dynamicResolutionToggle = true;
+        lastB = currentB;
+        
+        bool currentN = glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS;
+        if (!lastN && currentN) inputData.upscaleToggle = true;
+        lastN = currentN;
+        
         bool currentR = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
         if (!lastR && currentR) inputData.resetTemporal = true;
         lastR = currentR;
@@ -333,8 +262,87 @@ void performanceMonitoringThread(PerformanceData& perfData, std::atomic<bool>& r
  * 
  * Initializes the rendering system, sets up the complete graphics pipeline,
  * and runs the main game loop with real-time global illumination.
+ * 
+ * Command line options:
+ *   --scene <name>        Scene to load (teapot, stone, shadow, default, lights)
+ *   --record-path <file>  Record the camera/light path for vibe-gi-bench playback
+ *   --target-fps <n>      Frame rate dynamic resolution holds (default 60)
+ *   --occlusion-culling   Also cull objects hidden behind others (last frames' depth)
+ *   --depth-prepass <m>   Depth pre-pass: off, on, auto (default, from measured overdraw)
+ *   --probe-cache         World-space irradiance probes as the GI far field
+ *   --post-resolution <m> SSAO/SSR rate: full, half (default), checkerboard
+ *   --ray-march <m>       SSR/GI ray marching: hiz (default, depth pyramid) or linear
+ *   --world-rays          GI rays the screen misses continue through the scene BVH
+ *   --gpu-driven          Cull on the GPU and draw with multi-draw-indirect (GL 4.3)
+ *   --upscale <m>         Temporal upscaling with TAA: native (default), quality, balanced,
+ *                         performance, ultra-performance
+ *   --frames-in-flight <n> Frames the CPU may run ahead of the GPU, 1-3 (default 2)
+ *   --debug-sync          Report GL calls that block on the GPU
+ *   --lod-error <px>      Largest on-screen simplification error of a level of detail (default 1)
+ *   --no-lod              Always draw meshes at full detail (same as --lod-error 0)
+ *   --mesh-budget <MB>    GPU memory for mesh levels of detail before unused ones are released (default 512)
  */
-int main() {
+int main(int argc, char** argv) {
+    std::string sceneName = "teapot";
+    std::string recordPathFile;
+    float targetFps = 60.0f;
+    bool occlusionCulling = false;
+    int depthPrepassMode = 2;
+    bool probeCache = false;
+    int postResolution = 1;
+    bool hierarchicalTracing = true;
+    bool worldSpaceRays = false;
+    bool gpuDriven = false;
+    int upscaleMode = 0;
+    int framesInFlight = 2;
+    bool debugSync = false;
+    float lodErrorPixels = 1.0f;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--scene" && i + 1 < argc) {
+            sceneName = argv[++i];
+        } else if (arg == "--record-path" && i + 1 < argc) {
+            recordPathFile = argv[++i];
+        } else if (arg == "--occlusion-culling") {
+            occlusionCulling = true;
+        } else if (arg == "--target-fps" && i + 1 < argc) {
+            targetFps = std::max(1.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--depth-prepass" && i + 1 < argc &&
+                   (std::string(argv[i + 1]) == "off" || std::string(argv[i + 1]) == "on" || std::string(argv[i + 1]) == "auto")) {
+            std::string mode = argv[++i];
+            depthPrepassMode = mode == "off" ? 0 : (mode == "on" ? 1 : 2);
+        } else if (arg == "--probe-cache") {
+            probeCache = true;
+        } else if (arg == "--post-resolution" && i + 1 < argc &&
+                   (std::string(argv[i + 1]) == "full" || std::string(argv[i + 1]) == "half" || std::string(argv[i + 1]) == "checkerboard")) {
+            std::string mode = argv[++i];
+            postResolution = mode == "full" ? 0 : (mode == "half" ? 1 : 2);
+        } else if (arg == "--ray-march" && i + 1 < argc &&
+                   (std::string(argv[i + 1]) == "hiz" || std::string(argv[i + 1]) == "linear")) {
+            hierarchicalTracing = std::string(argv[++i]) == "hiz";
+        } else if (arg == "--world-rays") {
+            worldSpaceRays = true;
+        } else if (arg == "--gpu-driven") {
+            gpuDriven = true;
+        } else if (arg == "--upscale" && i + 1 < argc && Renderer::parseUpscaleMode(argv[i + 1]) >= 0) {
+            upscaleMode = Renderer::parseUpscaleMode(argv[++i]);
+        } else if (arg == "--frames-in-flight" && i + 1 < argc) {
+            framesInFlight = std::max(1, std::min(std::atoi(argv[++i]), FramePacer::MAX_FRAMES_IN_FLIGHT));
+        } else if (arg == "--debug-sync") {
+            debugSync = true;
+        } else if (arg == "--lod-error" && i + 1 < argc) {
+            lodErrorPixels = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--no-lod") {
+            lodErrorPixels = 0.0f;
+        } else if (arg == "--mesh-budget" && i + 1 < argc) {
+            MeshStreamer::instance().setMemoryBudget(static_cast<size_t>(std::max(1, std::atoi(argv[++i]))) * 1024 * 1024);
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            std::cerr << "Usage: vibe-gi [--scene <name>] [--record-path <file>] [--target-fps <n>] [--occlusion-culling] [--depth-prepass off|on|auto] [--probe-cache] [--post-resolution full|half|checkerboard] [--ray-march hiz|linear] [--world-rays] [--gpu-driven] [--upscale native|quality|balanced|performance|ultra-performance] [--frames-in-flight <n>] [--debug-sync] [--lod-error <px>] [--no-lod] [--mesh-budget <MB>]" << std::endl;
+            return 1;
+        }
+    }
+
     // Multithreading setup (declared outside try block for proper cleanup)
     InputData inputData;
     std::atomic<bool> inputThreadRunning{false};
@@ -359,20 +367,6 @@ int main() {
         // Disable vsync for maximum performance
         glfwSwapInterval(0);
 
-        // Initialize all shaders for the rendering pipeline
-        Shader lightingShader("shaders/lighting.vert", "shaders/lighting.frag");           // Forward lighting (legacy)
-        Shader shadowShader("shaders/shadow_depth.vert", "shaders/shadow_depth.frag");     // Shadow map generation
-        Shader gBufferShader("shaders/gbuffer.vert", "shaders/gbuffer.frag");             // Deferred geometry pass
-        Shader rcShader("shaders/fullscreen.vert", "shaders/rc_cascade.frag");            // Radiance cascades computation
-        Shader blurShader("shaders/fullscreen.vert", "shaders/blur.frag");                // GI temporal blur
-        Shader compositeShader("shaders/fullscreen.vert", "shaders/final_composite.frag"); // Final lighting composite
-
-        Shader copyShader("shaders/fullscreen.vert", "shaders/copy.frag");               // Direct copy (no AA)
-        Shader ssaoShader("shaders/fullscreen.vert", "shaders/ssao.frag");                // Screen-space ambient occlusion
-        Shader ssaoBlurShader("shaders/fullscreen.vert", "shaders/ssao_blur.frag");       // SSAO blur for noise reduction
-        Shader ssrShader("shaders/fullscreen.vert", "shaders/ssr.frag");                  // Screen-space reflections
-        Shader taaShader("shaders/fullscreen.vert", "shaders/taa.frag");                  // Temporal anti-aliasing
-        Shader fxaaShader("shaders/fullscreen.vert", "shaders/fxaa.frag");                // Fast approximate anti-aliasing
         // Initialize ImGui for ultra-fast UI rendering
         IMGUI_CHECKVERSION();
         ImGui::CreateContext();
@@ -386,54 +380,51 @@ int main() {
         ImGui_ImplGlfw_InitForOpenGL(window.getGLFWWindow(), true);
         ImGui_ImplOpenGL3_Init("#version 330");
 
-        // Initialize core rendering systems
-        ShadowMap shadowMap;                                    // Directional light shadow mapping
-        RadianceCascades rc(1280, 800, 6);                     // 6-cascade radiance cascade GI system (high quality)
-        FullscreenQuad quad;                                    // Fullscreen quad for post-processing
-
-        // Create offscreen framebuffer for composite pass (before TAA)
-        // This allows us to apply temporal anti-aliasing as a final step
-        unsigned int compositeFBO;
-        unsigned int compositeTexture;
-        glGenFramebuffers(1, &compositeFBO);
-        glGenTextures(1, &compositeTexture);
-        glBindTexture(GL_TEXTURE_2D, compositeTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1280, 800, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        glBindFramebuffer(GL_FRAMEBUFFER, compositeFBO);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, compositeTexture, 0);
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-            std::cerr << "Composite FBO incomplete!" << std::endl;
-        }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        // Initialize the rendering pipeline (shaders, shadow map, GI and post-processing targets)
+        Renderer renderer(1280, 800);
+        SyncMonitor::setEnabled(debugSync);
 
         // Create scene with ECS architecture
-        Scene scene;
+        Scene scene(sceneName);
+        
+        // Behaviour and transform updates run on the job system; the next frame's
+        // simulation overlaps this frame's GL submission (declared after the scene
+        // so in-flight jobs finish before it is destroyed)
+        JobSystem jobs;
+        JobHandle simulation;
+        renderer.setJobSystem(&jobs);
+        
+        // Optional camera/light path recording (replayed by vibe-gi-bench)
+        CameraPath recordedPath;
+        float recordTime = 0.0f;
+        float nextRecordTime = 0.0f;
 
         // Set up camera for mouse input
         glfwSetWindowUserPointer(window.getGLFWWindow(), &scene.camera);
 
         // Timing and performance tracking variables
         // Main rendering settings and toggles
-        bool ambientEnabled = false;    // Toggle for ambient lighting (default off)
-        bool giEnabled = true;          // Toggle for global illumination (default on)
-        bool ssaoEnabled = false;       // Toggle for screen space ambient occlusion (default off)
-        bool ssrEnabled = false;        // Toggle for screen space reflections (default off)
-        bool lightEnabled = true;       // Toggle for main light (default on)
+        RenderSettings settings;        // GI on, TAA, balanced quality; ambient/SSAO/SSR off
+        settings.dynamicResolution = true;  // Interactive use holds the frame rate instead of a fixed resolution
+        settings.targetFrameTimeMs = 1000.0f / targetFps;
+        settings.occlusionCulling = occlusionCulling;
+        settings.depthPrepassMode = depthPrepassMode;
+        settings.probeCache = probeCache;
+        settings.postResolution = postResolution;
+        settings.hierarchicalTracing = hierarchicalTracing;
+        settings.worldSpaceRays = worldSpaceRays;
+        settings.gpuDriven = gpuDriven;
+        settings.upscaleMode = upscaleMode;
+        settings.framesInFlight = framesInFlight;
+        settings.lodErrorPixels = lodErrorPixels;
         bool paused = false;            // Toggle for pause state
         float pausedTime = 0.0f;        // Time accumulator for pause system
-        int antiAliasingMode = 2;       // AA mode: 0=none, 1=FXAA, 2=TAA (default TAA)
-        int qualityLevel = 2;           // Quality level: 0=super low, 1=performance, 2=balanced, 3=high, 4=ultra
 
         float deltaTime = 0.0f;         // Frame time delta
         float lastFrame = 0.0f;         // Previous frame timestamp
         int frameCount = 0;             // Frame counter for FPS calculation
         float fpsTimer = 0.0f;          // FPS calculation timer
         int fps = 0;                    // Current FPS
-        static int lastWidth = 0;       // Previous frame width (for resize detection)
-        static int lastHeight = 0;      // Previous frame height (for resize detection)
 
         // Enhanced performance profiler
         PerformanceProfiler profiler;
@@ -454,6 +445,15 @@ int main() {
         float giTime = 0.0f;
         float compositeTime = 0.0f;
 
+        // Once the renderer has copied the scene out, the behaviours advance to the
+        // next frame on the workers (with this frame's delta time) while GL is submitted.
+        // Built once: a capturing lambda this size would allocate as a std::function every frame
+        std::function<void()> releaseScene = [&]() {
+            if (!paused) {
+                simulation = scene.updateBehavioursAsync(jobs, deltaTime);
+            }
+        };
+
         /**
          * MAIN RENDER LOOP
          * 
@@ -481,16 +481,35 @@ int main() {
             }
             profiler.endTimer("frame_setup");
             
-            // UI cache variables - accessible from both input handling and UI rendering
+            // UI cache variables - accessible from both input handling and UI rendering.
+            // Fixed buffers filled with snprintf, so refreshing them never allocates
             static int uiFrameCounter = 0;
-            static std::string cachedFpsText = "FPS: 0";
-            static std::string cachedQualityText = "Quality: Balanced (3C)";
-            static std::string cachedGiStatusText = "GI: ON";
-            static std::string cachedSsaoStatusText = "SSAO: ON";
-            static std::string cachedSsrStatusText = "SSR: OFF";
-            static std::string cachedAaStatusText = "AA: TAA";
+            static const char* qualityNames[] = {"Super Low", "Performance", "Balanced", "High", "Ultra"};
+            static const char* cascadeCounts[] = {"2C", "3C", "4C", "5C", "6C"};
+            static const char* aaNames[] = {"None", "FXAA", "TAA"};
+            static char cachedFpsText[32] = "FPS: 0";
+            static char cachedQualityText[64] = "Quality: Balanced (3C)";
+            static char cachedGiStatusText[32] = "GI: ON";
+            static char cachedSsaoStatusText[32] = "SSAO: ON";
+            static char cachedSsrStatusText[32] = "SSR: OFF";
+            static char cachedAaStatusText[32] = "AA: TAA";
+            static char cachedResolutionText[128] = "Resolution: dynamic";
+            static char cachedCullingText[128] = "Drawn: 0/0 objects";
+            static char cachedPrepassText[128] = "Depth pre-pass: AUTO (off), overdraw 0.00x";
+            static char cachedGiUpdateText[128] = "GI update: view moved, 0 cascades recomputed";
+            static char cachedLightText[128] = "Local lights: 0/0 visible, at most 0 per cluster";
+            static char cachedPacingText[128] = "Frames in flight: 2, GPU wait 0.00ms";
+            static char cachedAllocationText[128] = "Allocations: 0 per frame";
+            static char cachedPassTimingText[24][96];
+            static int cachedPassTimingCount = 0;
             uiFrameCounter++;
             
+            // The simulation started during the previous frame's submission must be
+            // complete before input or the renderer touch the scene again
+            profiler.beginTimer("simulation_wait");
+            jobs.wait(simulation);
+            profiler.endTimer("simulation_wait");
+            
             profiler.beginTimer("input_processing");
             // Process input from async thread
             if (inputData.exitRequested) {
@@ -499,48 +518,52 @@ int main() {
             
             // Handle toggle states
             if (inputData.ambientToggle.exchange(false)) {
-                ambientEnabled = !ambientEnabled;
+                settings.ambientEnabled = !settings.ambientEnabled;
             }
             if (inputData.giToggle.exchange(false)) {
-                giEnabled = !giEnabled;
-                perfData.giEnabled = giEnabled; // Update performance thread
+                settings.giEnabled = !settings.giEnabled;
+                perfData.giEnabled = settings.giEnabled; // Update performance thread
                 
                 // Immediately update UI cache for responsive feedback
-                cachedGiStatusText = "GI: " + std::string(giEnabled ? "ON" : "OFF");
+                snprintf(cachedGiStatusText, sizeof(cachedGiStatusText), "GI: %s", settings.giEnabled ? "ON" : "OFF");
             }
             if (inputData.ssaoToggle.exchange(false)) {
-                ssaoEnabled = !ssaoEnabled;
-                perfData.ssaoEnabled = ssaoEnabled; // Update performance thread
+                settings.ssaoEnabled = !settings.ssaoEnabled;
+                perfData.ssaoEnabled = settings.ssaoEnabled; // Update performance thread
                 
                 // Immediately update UI cache for responsive feedback
-                cachedSsaoStatusText = "SSAO: " + std::string(ssaoEnabled ? "ON" : "OFF");
+                snprintf(cachedSsaoStatusText, sizeof(cachedSsaoStatusText), "SSAO: %s", settings.ssaoEnabled ? "ON" : "OFF");
             }
             if (inputData.lightToggle.exchange(false)) {
-                lightEnabled = !lightEnabled;
+                settings.lightEnabled = !settings.lightEnabled;
                 // Reset temporal accumulation when light state changes
-                rc.resetTemporalAccumulation();
+                renderer.resetTemporalAccumulation();
             }
             if (inputData.ssrToggle.exchange(false)) {
-                ssrEnabled = !ssrEnabled;
-                cachedSsrStatusText = "SSR: " + std::string(ssrEnabled ? "ON" : "OFF");
+                settings.ssrEnabled = !settings.ssrEnabled;
+                snprintf(cachedSsrStatusText, sizeof(cachedSsrStatusText), "SSR: %s", settings.ssrEnabled ? "ON" : "OFF");
             }
             if (inputData.antiAliasingToggle.exchange(false)) {
-                antiAliasingMode = (antiAliasingMode + 1) % 3; // Cycle: None -> FXAA -> TAA -> None
-                std::string aaNames[] = {"None", "FXAA", "TAA"};
-                cachedAaStatusText = "AA: " + aaNames[antiAliasingMode];
+                settings.antiAliasingMode = (settings.antiAliasingMode + 1) % 3; // Cycle: None -> FXAA -> TAA -> None
+                snprintf(cachedAaStatusText, sizeof(cachedAaStatusText), "AA: %s", aaNames[settings.antiAliasingMode]);
             }
             if (inputData.qualityToggle.exchange(false)) {
-                qualityLevel = (qualityLevel + 1) % 5; // 5 quality levels: 0-4
-                perfData.qualityLevel = qualityLevel; // Update performance thread
+                settings.qualityLevel = (settings.qualityLevel + 1) % 5; // 5 quality levels: 0-4
+                perfData.qualityLevel = settings.qualityLevel; // Update performance thread
                 
                 // Immediately update UI cache for responsive feedback
-                std::string qualityNames[] = {"Super Low", "Performance", "Balanced", "High", "Ultra"};
-                std::string cascadeCounts[] = {"2C", "3C", "4C", "5C", "6C"};
-                cachedQualityText = "Quality: " + qualityNames[qualityLevel] + " (" + cascadeCounts[qualityLevel] + ")";
+                snprintf(cachedQualityText, sizeof(cachedQualityText), "Quality: %s (%s)",
+                         qualityNames[settings.qualityLevel], cascadeCounts[settings.qualityLevel]);
+            }
+            if (inputData.dynamicResolutionToggle.exchange(false)) {
+                settings.dynamicResolution = !settings.dynamicResolution;
+            }
+            if (inputData.upscaleToggle.exchange(false)) {
+                settings.upscaleMode = (settings.upscaleMode + 1) % Renderer::UPSCALE_MODES;
             }
 
             if (inputData.resetTemporal.exchange(false)) {
-                rc.resetTemporalAccumulation();
+                renderer.resetTemporalAccumulation();
             }
             if (inputData.pauseToggle.exchange(false)) {
                 paused = !paused;
@@ -552,471 +575,72 @@ int main() {
                 }
             }
             
-            // Process camera movement (only when not paused)
+            // Process camera movement (only when not paused). GI history is reprojected,
+            // so movement does not reset it (see GiUpdateScheduler.h)
             if (!paused) {
-                bool anyMovement = false;
-                if (inputData.moveForward) { scene.camera.processKeyboard(0, deltaTime); anyMovement = true; }
-                if (inputData.moveBackward) { scene.camera.processKeyboard(1, deltaTime); anyMovement = true; }
-                if (inputData.moveLeft) { scene.camera.processKeyboard(2, deltaTime); anyMovement = true; }
-                if (inputData.moveRight) { scene.camera.processKeyboard(3, deltaTime); anyMovement = true; }
-                
-                // Reset temporal accumulation immediately on any movement input
-                if (anyMovement) {
-                    rc.resetTemporalAccumulation();
-                }
+                if (inputData.moveForward) { scene.camera.processKeyboard(0, deltaTime); }
+                if (inputData.moveBackward) { scene.camera.processKeyboard(1, deltaTime); }
+                if (inputData.moveLeft) { scene.camera.processKeyboard(2, deltaTime); }
+                if (inputData.moveRight) { scene.camera.processKeyboard(3, deltaTime); }
             }
 
-            // Process light controls from async input (only when not paused)
+            // Process light controls from async input (only when not paused); the renderer
+            // tracks light changes itself and recomputes the GI they affect
             if (!paused) {
-                bool anyLightMovement = false;
-                for (const auto& entity : scene.entities) {
-                    if (auto light = entity->getComponent<LightComponent>()) {
-                        if (auto transform = entity->getComponent<TransformComponent>()) {
-                            // Apply light movement from async input
-                            if (inputData.lightMoveX != 0.0f || inputData.lightMoveZ != 0.0f || inputData.lightMoveY != 0.0f) {
-                                transform->position.x += inputData.lightMoveX * deltaTime * 60.0f; // Scale by frame rate
-                                transform->position.z += inputData.lightMoveZ * deltaTime * 60.0f;
-                                transform->position.y += inputData.lightMoveY * deltaTime * 60.0f;
-                                anyLightMovement = true;
-                            }
-                            
-                            // Apply light property changes
-                            if (inputData.lightIntensityDelta != 0.0f) {
-                                light->intensity += inputData.lightIntensityDelta * deltaTime * 60.0f;
-                                light->intensity = std::max(0.0f, light->intensity);
-                                anyLightMovement = true;
-                            }
-                            
-                            if (inputData.lightRadiusDelta != 0.0f) {
-                                light->radius += inputData.lightRadiusDelta * deltaTime * 60.0f;
-                                light->radius = std::max(0.5f, light->radius);
-                                anyLightMovement = true;
-                            }
+                scene.registry.each<LightComponent, TransformComponent>(
+                    [&](EntityId, LightComponent& light, TransformComponent& transform) {
+                        // Apply light movement from async input
+                        if (inputData.lightMoveX != 0.0f || inputData.lightMoveZ != 0.0f || inputData.lightMoveY != 0.0f) {
+                            transform.position.x += inputData.lightMoveX * deltaTime * 60.0f; // Scale by frame rate
+                            transform.position.z += inputData.lightMoveZ * deltaTime * 60.0f;
+                            transform.position.y += inputData.lightMoveY * deltaTime * 60.0f;
                         }
-                    }
-                }
-                
-                // Reset temporal accumulation immediately on any light changes
-                if (anyLightMovement) {
-                    rc.resetTemporalAccumulation();
-                }
-                
-                // Update all behaviour components (only when not paused)
-                for (const auto& entity : scene.entities) {
-                    if (auto behaviour = entity->getComponent<Behaviour>()) {
-                        if (!behaviour->hasStarted()) {
-                            behaviour->Start();
-                            behaviour->markStarted();
+                        
+                        // Apply light property changes
+                        if (inputData.lightIntensityDelta != 0.0f) {
+                            light.intensity += inputData.lightIntensityDelta * deltaTime * 60.0f;
+                            light.intensity = std::max(0.0f, light.intensity);
                         }
-                        behaviour->Update(deltaTime);
-                    }
-                }
-            }
-            profiler.endTimer("input_processing");
-            
-            profiler.beginTimer("scene_setup");
-            // Extract light information from ECS for rendering
-            // In a real engine, this would support multiple lights
-            glm::vec3 lightPos(0.0f);
-            glm::vec3 lightColor(1.0f);
-            float lightRadius = 2.0f; // Default radius for light attenuation
-            static glm::vec3 lastLightPos(0.0f);
-            static bool firstFrame = true;
-            
-            // Find the primary light in the scene
-            for (const auto& entity : scene.entities) {
-                if (auto light = entity->getComponent<LightComponent>()) {
-                    if (auto transform = entity->getComponent<TransformComponent>()) {
-                        lightPos = transform->position;
-                        // Apply light toggle - when disabled, lightColor becomes (0,0,0)
-                        if (lightEnabled) {
-                            lightColor = light->color * light->intensity;
-                        } else {
-                            lightColor = glm::vec3(0.0f, 0.0f, 0.0f);
+                        
+                        if (inputData.lightRadiusDelta != 0.0f) {
+                            light.radius += inputData.lightRadiusDelta * deltaTime * 60.0f;
+                            light.radius = std::max(0.5f, light.radius);
                         }
-                        lightRadius = light->radius;
-                    }
-                }
+                    });
             }
+            profiler.endTimer("input_processing");
             
-            // Initialize light position tracking on first frame
-            if (firstFrame) {
-                lastLightPos = lightPos;
-                firstFrame = false;
-            }
-            
-            // Reset temporal accumulation if camera moved significantly
-            // This prevents ghosting artifacts when camera moves
-            static glm::vec3 lastCameraPos(0.0f);
-            static glm::vec3 lastCameraDirection(0.0f);
-            static bool firstCameraFrame = true;
-            
-            glm::vec3 currentCameraDirection = scene.camera.front;
-            float cameraMovement = glm::length(scene.camera.position - lastCameraPos);
-            float cameraRotation = 1.0f - glm::dot(currentCameraDirection, lastCameraDirection);
-            
-            if (firstCameraFrame) {
-                lastCameraPos = scene.camera.position;
-                lastCameraDirection = currentCameraDirection;
-                firstCameraFrame = false;
-            } else if (cameraMovement > 0.05f || cameraRotation > 0.01f) { // Much more sensitive - any camera movement resets
-                rc.resetTemporalAccumulation();
-                lastCameraPos = scene.camera.position;
-                lastCameraDirection = currentCameraDirection;
-            }
+            // World matrices once per frame, after the last transform change (simulation and input)
+            profiler.beginTimer("world_matrices");
+            scene.updateWorldMatrices(&jobs);
+            profiler.endTimer("world_matrices");
             
-            // Reset temporal accumulation if light moved significantly
-            // This prevents ghosting artifacts when lighting changes rapidly
-            float lightMovement = glm::length(lightPos - lastLightPos);
-            if (lightMovement > 0.01f) { // Much more sensitive threshold for light movement
-                rc.resetTemporalAccumulation();
-                lastLightPos = lightPos;
-            }
-
-            // Calculate light space matrix for shadow mapping
-            // This defines the light's view for shadow map generation
-            glm::mat4 lightSpaceMatrix = shadowMap.getLightSpaceMatrix(lightPos, lightRadius);
+            // Poll window events (input, resize, etc.)
+            window.pollEvents();
 
-            // Handle window resizing - only update resources when size actually changes
+            // Current framebuffer size - the renderer reallocates its targets when it changes
             int width, height;
             glfwGetFramebufferSize(window.getGLFWWindow(), &width, &height);
-            if (width != lastWidth || height != lastHeight) {
-                rc.resize(width, height);
-                lastWidth = width;
-                lastHeight = height;
-                glViewport(0, 0, width, height);
-            }
-
-            // Update camera matrices with correct aspect ratio
-            float aspectRatio = (float)width / (float)height;
-            glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 100.0f);
-            glm::mat4 view = scene.camera.getViewMatrix();
-
-            // No more jittering - clean, stable rendering
-            
-            // Store previous frame matrices (for potential future effects)
-            static glm::mat4 previousView = view;
-            static glm::mat4 previousProjection = projection;
-
-            // Poll window events (input, resize, etc.)
-            window.pollEvents();
-            profiler.endTimer("scene_setup");
 
             /**
              * RENDERING PIPELINE - Multi-pass deferred rendering with global illumination
              */
-
             profiler.beginTimer("rendering_pipeline");
             auto passStart = std::chrono::high_resolution_clock::now();
 
-            // PASS 1: SHADOW MAP GENERATION
-            // Render scene from light's perspective to generate shadow map
-            profiler.beginTimer("shadow_total");
-            profiler.beginTimer("shadow_setup");
-            shadowShader.use();
-            shadowShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
-            shadowMap.bindForWriting();
-            profiler.endTimer("shadow_setup");
-            
-            profiler.beginTimer("shadow_render");
-            for (const auto& entity : scene.entities) {
-                auto meshComp = entity->getComponent<MeshComponent>();
-                if (meshComp) {
-                    auto transform = entity->getComponent<TransformComponent>();
-                    if (transform) {
-                        shadowShader.setMat4("model", transform->getModelMatrix());
-                        meshComp->mesh->Draw(shadowShader.ID);
-                    }
-                }
-            }
-            profiler.endTimer("shadow_render");
-            profiler.endTimer("shadow_total");
-            
-            shadowTime = profiler.getLastTime("shadow_total");
-            perfData.shadowTime = shadowTime; // Feed to performance thread
+            renderer.render(scene, settings, width, height, currentFrame, profiler, releaseScene);
 
-            // PASS 2: G-BUFFER GENERATION (Deferred Rendering)
-            // Render geometry data (position, normal, albedo, motion vectors) to textures
-            profiler.beginTimer("gbuffer_total");
-            profiler.beginTimer("gbuffer_setup");
-            
-            rc.bindGBufferForWriting();
-            gBufferShader.use();
-            gBufferShader.setMat4("projection", projection);
-            gBufferShader.setMat4("view", view);
-            gBufferShader.setMat4("previousProjection", previousProjection);
-            gBufferShader.setMat4("previousView", previousView);
-            glViewport(0, 0, width, height);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            profiler.endTimer("gbuffer_setup");
-
-            // Render all scene geometry to G-buffer
-            profiler.beginTimer("gbuffer_render");
-            for (const auto& entity : scene.entities) {
-                auto meshComp = entity->getComponent<MeshComponent>();
-                auto transformComp = entity->getComponent<TransformComponent>();
-                auto materialComp = entity->getComponent<MaterialComponent>();
-
-                if (meshComp && transformComp && meshComp->mesh) {
-                    gBufferShader.setMat4("model", transformComp->getModelMatrix());
-                    gBufferShader.setVec3("objectColor", meshComp->color);
-                    
-                    // Apply PBR material properties if available
-                    if (materialComp && materialComp->material) {
-                        materialComp->material->setUniforms(gBufferShader.ID);
-                        materialComp->material->bindTextures();
-                    } else {
-                        // Set default material parameters when no material is present
-                        gBufferShader.setBool("hasMaterial", false);
-                    }
-                    
-                    meshComp->mesh->Draw(gBufferShader.ID);
-                    
-                    // Clean up texture bindings
-                    if (materialComp && materialComp->material) {
-                        materialComp->material->unbindTextures();
-                    }
-                }
-            }
-            profiler.endTimer("gbuffer_render");
-            profiler.endTimer("gbuffer_total");
-            
+            // Feed pass timings to performance thread
+            shadowTime = profiler.getLastTime("shadow_total");
             gbufferTime = profiler.getLastTime("gbuffer_total");
-            perfData.gbufferTime = gbufferTime; // Feed to performance thread
-            
-            // PASS 3: SCREEN SPACE AMBIENT OCCLUSION (SSAO)
-            // Compute ambient occlusion for enhanced depth perception (if enabled)
-            // Quality-dependent SSAO: disabled for super low, enabled for others
-            profiler.beginTimer("ssao_total");
-            
-            if (ssaoEnabled && qualityLevel > 0) {
-                profiler.beginTimer("ssao_compute");
-                rc.computeSSAO(ssaoShader, projection);
-                profiler.endTimer("ssao_compute");
-                
-                // PASS 4: SSAO BLUR
-                // Quality-dependent blur: skip for performance level, full for others
-                profiler.beginTimer("ssao_blur");
-                if (qualityLevel > 1) {
-                    rc.blurSSAO(ssaoBlurShader);
-                }
-                profiler.endTimer("ssao_blur");
-            }
-            profiler.endTimer("ssao_total");
-            
             ssaoTime = profiler.getLastTime("ssao_total");
-            perfData.ssaoTime = ssaoTime; // Feed to performance thread
-            
-            // 5-Level Quality System with increased cascade counts for high-end hardware
-            // Super Low (0): 2 cascades,  minimal GI but still good quality
-            // Performance (1): 3 cascades, good GI quality with performance focus
-            // Balanced (2): 4 cascades, excellent balance of quality/performance  
-            // High (3): 5 cascades, high quality GI for detailed scenes
-            // Ultra (4): 6 cascades, maximum quality GI for ultimate fidelity
-            int activeCascades = 0;
-            if (giEnabled) {
-                switch (qualityLevel) {
-                    case 0: activeCascades = 2; break; // Super Low
-                    case 1: activeCascades = 3; break; // Performance  
-                    case 2: activeCascades = 4; break; // Balanced
-                    case 3: activeCascades = 5; break; // High
-                    case 4: activeCascades = 6; break; // Ultra (maximum quality)
-                    default: activeCascades = 4; break; // Fallback
-                }
-            }
-            // Clamp to valid range for safety
-            activeCascades = std::max(0, std::min(activeCascades, 6));
-            
-            // PASS 5: RADIANCE CASCADES GLOBAL ILLUMINATION
-            // Compute multi-bounce indirect lighting using radiance cascades
-            profiler.beginTimer("gi_total");
-            
-            if (giEnabled) {
-                profiler.beginTimer("gi_setup");
-                rcShader.use();
-                rcShader.setMat4("invView", glm::inverse(view)); // For world space calculations
-                rcShader.setVec3("lightPos", lightPos);          // World space light position
-                rcShader.setVec3("lightColor", lightColor);      // Light color and intensity
-                rcShader.setFloat("lightRadius", lightRadius);   // Light attenuation radius
-                rcShader.setFloat("time", glfwGetTime());         // Time for temporal effects
-                rcShader.setInt("activeCascades", activeCascades); // Dynamic cascade count for quality-aware computation
-                profiler.endTimer("gi_setup");
-                
-                profiler.beginTimer("gi_compute");
-                rc.compute(rcShader, view, projection, activeCascades);
-                profiler.endTimer("gi_compute");
-                
-                // PASS 6: GI QUALITY-DEPENDENT BLUR
-                // Apply blur based on quality level for optimal performance/quality balance
-                profiler.beginTimer("gi_blur");
-                switch (qualityLevel) {
-                    case 0: // Super Low: minimal blur for performance
-                        // Skip blur entirely for maximum performance
-                        break;
-                    case 1: // Performance: reduced blur (only blur first 2 cascades)
-                        if (activeCascades >= 2) {
-                            rc.blur(blurShader, 2); // Only blur first 2 cascades for performance
-                        } else {
-                            rc.blur(blurShader, activeCascades);
-                        }
-                        break;
-                    case 2: // Balanced: standard blur
-                        rc.blur(blurShader, activeCascades);
-                        break;
-                    case 3: // High: enhanced blur
-                        rc.blur(blurShader, activeCascades);
-                        break;
-                    case 4: // Ultra: maximum quality blur (could be multi-pass in future)
-                        rc.blur(blurShader, activeCascades);
-                        break;
-                }
-                profiler.endTimer("gi_blur");
-            }
-            profiler.endTimer("gi_total");
-            
             giTime = profiler.getLastTime("gi_total");
-            perfData.giTime = giTime; // Feed to performance thread
-            
-            // PASS 7: FINAL COMPOSITE TO OFFSCREEN BUFFER
-            // Combine all lighting contributions into final image
-            profiler.beginTimer("composite_total");
-            profiler.beginTimer("composite_setup");
-            
-            glBindFramebuffer(GL_FRAMEBUFFER, compositeFBO);
-            glViewport(0, 0, width, height);
-
-            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glDisable(GL_DEPTH_TEST);
-            
-            compositeShader.use();
-            compositeShader.setMat4("view", view);
-            compositeShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
-            compositeShader.setVec3("lightPos", lightPos);
-            compositeShader.setVec3("lightColor", lightColor);
-            compositeShader.setVec3("viewPos", scene.camera.position);
-            compositeShader.setFloat("lightRadius", lightRadius);
-            // CORRECTED GI strength: More cascades capture more light, so need LOWER multipliers for visual consistency
-            // Ultra mode has additional enhancements (multi-bounce, better upsampling) so needs even lower strength
-            float giStrength = 0.0f;
-            if (giEnabled) {
-                switch (qualityLevel) {
-                    case 0: giStrength = 0.85f; break; // Super Low (2C): highest strength since fewer cascades
-                    case 1: giStrength = 0.70f; break; // Performance (3C): reduced strength for extra cascade
-                    case 2: giStrength = 0.55f; break; // Balanced (4C): balanced strength for good coverage
-                    case 3: giStrength = 0.45f; break; // High (5C): this looks good - keep as reference
-                    case 4: giStrength = 0.82f; break; // Ultra (6C): increased to match High's effective brightness (0.82 × 0.22 = 0.18)
-                    default: giStrength = 0.55f; break; // Fallback to balanced
-                }
-            }
-            compositeShader.setFloat("ssgiStrength", giStrength);
-            compositeShader.setFloat("ambientStrength", ambientEnabled ? 0.08f : 0.0f); // Reduced ambient
-            compositeShader.setFloat("ssaoStrength", (ssaoEnabled && qualityLevel > 0) ? 1.0f : 0.0f); // Conditional SSAO contribution
-            compositeShader.setInt("activeCascades", activeCascades); // Pass cascade count for quality-aware processing
-            
-            // Bind all G-buffer textures for lighting calculations
-            compositeShader.setInt("gPosition", 0);
-            compositeShader.setInt("gNormal", 1);
-            compositeShader.setInt("gAlbedo", 2);
-            compositeShader.setInt("gEmission", 11); // New: emission texture
-            compositeShader.setInt("shadowMap", 3);
-            compositeShader.setInt("ssaoTexture", 10);
-            
-            // Bind radiance cascade textures (multi-scale GI data) - only active cascades
-            for (int i = 0; i < activeCascades; ++i) {
-                compositeShader.setInt("rcTexture[" + std::to_string(i) + "]", 4 + i);
-            }
-            // Ensure unused cascade slots are set to safe values
-            for (int i = activeCascades; i < 6; ++i) {
-                compositeShader.setInt("rcTexture[" + std::to_string(i) + "]", 0); // Bind to position texture as safe fallback
-            }
-            compositeShader.setInt("activeCascades", activeCascades);
-            profiler.endTimer("composite_setup");
-            
-            // Activate and bind all required textures
-            profiler.beginTimer("composite_textures");
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, rc.getGPosition());
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, rc.getGNormal());
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, rc.getGAlbedo());
-            glActiveTexture(GL_TEXTURE3);
-            glBindTexture(GL_TEXTURE_2D, shadowMap.depthMap);
-            
-            // Bind SSAO texture
-            glActiveTexture(GL_TEXTURE10);
-            glBindTexture(GL_TEXTURE_2D, rc.getSSAOBlurTexture());
-            
-            // Bind emission texture
-            glActiveTexture(GL_TEXTURE11);
-            glBindTexture(GL_TEXTURE_2D, rc.getGEmission());
-            
-            // Bind all cascade textures for GI sampling - only active cascades
-            for (int i = 0; i < activeCascades; ++i) {
-                glActiveTexture(GL_TEXTURE4 + i);
-                glBindTexture(GL_TEXTURE_2D, rc.getTexture(i));
-            }
-            // Bind safe fallback textures to unused cascade slots
-            for (int i = activeCascades; i < 6; ++i) {
-                glActiveTexture(GL_TEXTURE4 + i);
-                glBindTexture(GL_TEXTURE_2D, rc.getGPosition()); // Safe fallback texture
-            }
-
-            profiler.endTimer("composite_textures");
-
-            // Render fullscreen quad to perform lighting calculations
-            profiler.beginTimer("composite_render");
-            quad.render();
-            profiler.endTimer("composite_render");
-            profiler.endTimer("composite_total");
-            
             compositeTime = profiler.getLastTime("composite_total");
-            perfData.compositeTime = compositeTime; // Feed to performance thread
-            
-            glEnable(GL_DEPTH_TEST);
-
-            // PASS 8: SCREEN SPACE REFLECTIONS (Optional)
-            if (ssrEnabled) {
-                profiler.beginTimer("ssr_total");
-                rc.computeSSR(ssrShader, compositeTexture, view, projection, scene.camera.position);
-                profiler.endTimer("ssr_total");
-            }
-
-            // PASS 9: ANTI-ALIASING (Optional) - DISABLED TO FIX TEXTURE ISSUE
-            unsigned int finalTexture = compositeTexture;
-            
-            // TEMPORARILY DISABLE AA TO ISOLATE TEXTURE ISSUE
-            // PASS 9: ANTI-ALIASING (FXAA or TAA)
-            if (antiAliasingMode == 1) { // FXAA
-                profiler.beginTimer("fxaa_total");
-                rc.applyFXAA(fxaaShader, finalTexture);
-                finalTexture = rc.getTAATexture(); // Reuse TAA texture for FXAA output
-                profiler.endTimer("fxaa_total");
-            } else if (antiAliasingMode == 2) { // TAA
-                profiler.beginTimer("taa_total");
-                glm::mat4 currentViewProj = projection * view;
-                static glm::mat4 previousViewProj = currentViewProj;
-                rc.applyTAA(taaShader, finalTexture, currentViewProj, previousViewProj);
-                finalTexture = rc.getTAATexture();
-                previousViewProj = currentViewProj;
-                profiler.endTimer("taa_total");
-            }
-
-            // PASS 10: FINAL OUTPUT TO SCREEN
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glDisable(GL_DEPTH_TEST);
-
-            copyShader.use();
-            copyShader.setInt("inputTexture", 0);
-
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, finalTexture);
-
-            quad.render();
-
-            glEnable(GL_DEPTH_TEST);
+            perfData.shadowTime = shadowTime;
+            perfData.gbufferTime = gbufferTime;
+            perfData.ssaoTime = ssaoTime;
+            perfData.giTime = giTime;
+            perfData.compositeTime = compositeTime;
 
             // PASS 9: FULLY STABLE UI RENDERING (NO FLICKERING)
             // All text always visible, with cached strings updated at different frequencies
@@ -1032,16 +656,83 @@ int main() {
             // PROBE 1: Update FPS every 3 frames (high frequency for responsiveness)
             profiler.beginTimer("ui_cache_update");
             if (uiFrameCounter % 3 == 0) {
-                cachedFpsText = "FPS: " + std::to_string(fps);
+                snprintf(cachedFpsText, sizeof(cachedFpsText), "FPS: %d", fps);
             }
             
             // PROBE 2: Update quality status every 6 frames (medium frequency)
             if (uiFrameCounter % 6 == 0) {
-                std::string qualityNames[] = {"Super Low", "Performance", "Balanced", "High", "Ultra"};
-                std::string cascadeCounts[] = {"2C", "3C", "4C", "5C", "6C"};
-                cachedQualityText = "Quality: " + qualityNames[qualityLevel] + " (" + cascadeCounts[qualityLevel] + ")";
-                cachedGiStatusText = "GI: " + std::string(giEnabled ? "ON" : "OFF");
-                cachedSsaoStatusText = "SSAO: " + std::string(ssaoEnabled ? "ON" : "OFF");
+                snprintf(cachedQualityText, sizeof(cachedQualityText), "Quality: %s (%s)",
+                         qualityNames[settings.qualityLevel], cascadeCounts[settings.qualityLevel]);
+                snprintf(cachedGiStatusText, sizeof(cachedGiStatusText), "GI: %s", settings.giEnabled ? "ON" : "OFF");
+                snprintf(cachedSsaoStatusText, sizeof(cachedSsaoStatusText), "SSAO: %s", settings.ssaoEnabled ? "ON" : "OFF");
+                
+                const FrameBudgetController& budget = renderer.getBudgetController();
+                snprintf(cachedResolutionText, sizeof(cachedResolutionText), "Resolution: %dx%d (%d%%%s), -%d cascades, upscaling %s",
+                         renderer.getRenderWidth(), renderer.getRenderHeight(),
+                         static_cast<int>(budget.getRenderScale() * 100.0f + 0.5f),
+                         settings.dynamicResolution ? ", dynamic" : "", budget.getCascadeReduction(),
+                         settings.antiAliasingMode == 2 ? Renderer::getUpscaleModeName(settings.upscaleMode) : "off");
+                if (renderer.isGpuDriven()) {
+                    // Survivors are only counted on the GPU
+                    snprintf(cachedCullingText, sizeof(cachedCullingText), "Drawn: %zu objects, GPU culled%s",
+                             renderer.getTotalInstanceCount(), settings.occlusionCulling ? " (Hi-Z occlusion)" : "");
+                } else {
+                    snprintf(cachedCullingText, sizeof(cachedCullingText), "Drawn: %zu/%zu objects%s",
+                             renderer.getVisibleInstanceCount(), renderer.getTotalInstanceCount(),
+                             settings.occlusionCulling ? " (occlusion culling)" : "");
+                }
+                const OverdrawMonitor& overdraw = renderer.getOverdrawMonitor();
+                snprintf(cachedPrepassText, sizeof(cachedPrepassText), "Depth pre-pass: %s, overdraw %.2fx",
+                         settings.depthPrepassMode == 0 ? "OFF" :
+                         settings.depthPrepassMode == 1 ? "ON" : (overdraw.isPrepassEnabled() ? "AUTO (on)" : "AUTO (off)"),
+                         overdraw.getOverdraw());
+                const GiUpdateScheduler& giScheduler = renderer.getGiScheduler();
+                unsigned int giMask = giScheduler.getUpdateMask();
+                int updatedCascades = 0;
+                for (; giMask != 0; giMask &= giMask - 1) {
+                    ++updatedCascades;
+                }
+                snprintf(cachedGiUpdateText, sizeof(cachedGiUpdateText), "GI update: %s, %d cascades recomputed%s",
+                         !settings.giEnabled ? "off" :
+                         giScheduler.isViewChanged() ? "view moved" :
+                         giScheduler.isSceneChanged() ? "scene changed" :
+                         updatedCascades > 0 ? "converging" : "converged", updatedCascades,
+                         settings.worldSpaceRays ? (settings.probeCache ? " (world rays, probe far field)" : " (world rays)") :
+                         settings.probeCache ? " (probe far field)" : "");
+                const LightClusters& lightClusters = renderer.getLightClusters();
+                snprintf(cachedLightText, sizeof(cachedLightText), "Local lights: %d/%d visible, at most %d per cluster",
+                         lightClusters.getVisibleLightCount(), lightClusters.getLightCount(),
+                         lightClusters.getMaxClusterLights());
+                const float pacingWait = renderer.getFramePacer().getLastWaitTime();
+                if (SyncMonitor::isEnabled()) {
+                    snprintf(cachedPacingText, sizeof(cachedPacingText), "Frames in flight: %d, GPU wait %.2fms, %d stalls (%.2fms)",
+                             settings.framesInFlight, pacingWait, SyncMonitor::getStallCount(), SyncMonitor::getStallTime());
+                } else {
+                    snprintf(cachedPacingText, sizeof(cachedPacingText), "Frames in flight: %d, GPU wait %.2fms",
+                             settings.framesInFlight, pacingWait);
+                }
+                snprintf(cachedAllocationText, sizeof(cachedAllocationText), "Allocations: %llu last frame, frame arena %zu KB peak",
+                         static_cast<unsigned long long>(profiler.getFrameAllocations()),
+                         renderer.getFrameArena().getHighWater() / 1024);
+            }
+            
+            // PROBE 3: Update per-pass CPU/GPU timings every 15 frames (averages change slowly)
+            if (uiFrameCounter % 15 == 0) {
+                static const char* passNames[][2] = {
+                    {"shadow_total", "Shadow"}, {"gbuffer_total", "G-Buffer"}, {"gbuffer_prepass", "Pre-pass"}, {"depth_pyramid", "Depth Pyramid"}, {"light_culling", "Light Culling"}, {"ssao_total", "SSAO"},
+                    {"bvh_update", "Scene BVH"}, {"gi_probes", "GI Probes"}, {"gi_compute", "GI Cascades"}, {"gi_blur", "GI Blur"}, {"composite_total", "Composite"},
+                    {"ssr_total", "SSR"}, {"fxaa_total", "FXAA"}, {"taa_total", "TAA"}, {"culling", "Culling"},
+                    {"ui_total", "UI"}
+                };
+                cachedPassTimingCount = 0;
+                for (const auto& pass : passNames) {
+                    float cpuMs = profiler.getAverageTime(pass[0]);
+                    float gpuMs = profiler.getGpuAverageTime(pass[0]);
+                    if (cpuMs <= 0.0f && gpuMs <= 0.0f) continue; // Pass never ran
+                    snprintf(cachedPassTimingText[cachedPassTimingCount], sizeof(cachedPassTimingText[0]),
+                             "%-12s CPU %6.2fms  GPU %6.2fms", pass[1], cpuMs, gpuMs);
+                    ++cachedPassTimingCount;
+                }
             }
             profiler.endTimer("ui_cache_update");
             
@@ -1062,21 +753,37 @@ int main() {
                 ImGui::Text("M: Toggle Ambient, G: Toggle GI, T: Toggle SSAO");
                 ImGui::Text("F: Toggle SSR, C: Cycle AA (None/FXAA/TAA)");
                 ImGui::Text("Z: Quality Level (5 levels), X: Show Performance");
+                ImGui::Text("B: Toggle Dynamic Resolution, N: Cycle Upscaling (TAA)");
                 ImGui::Text("Arrow Keys: Move Light, K/L: Height");
                 ImGui::Text("O/P: Light Intensity, I/U: Light Radius");
                 
                 ImGui::Separator();
                 
                 // Status line with cached values
-                ImGui::Text("%s", cachedFpsText.c_str());
+                ImGui::Text("%s", cachedFpsText);
                 ImGui::SameLine();
-                ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%s", cachedQualityText.c_str());
+                ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%s", cachedQualityText);
                 ImGui::SameLine();
-                ImGui::TextColored(giEnabled ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", cachedGiStatusText.c_str());
+                ImGui::TextColored(settings.giEnabled ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", cachedGiStatusText);
                 ImGui::SameLine();
-                ImGui::TextColored(ssaoEnabled ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", cachedSsaoStatusText.c_str());
-                ImGui::TextColored(ssrEnabled ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", cachedSsrStatusText.c_str());
-                ImGui::TextColored(antiAliasingMode > 0 ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(0.8f, 0.8f, 0.8f, 1.0f), "%s", cachedAaStatusText.c_str());
+                ImGui::TextColored(settings.ssaoEnabled ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", cachedSsaoStatusText);
+                ImGui::TextColored(settings.ssrEnabled ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", cachedSsrStatusText);
+                ImGui::TextColored(settings.antiAliasingMode > 0 ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(0.8f, 0.8f, 0.8f, 1.0f), "%s", cachedAaStatusText);
+                ImGui::TextColored(settings.dynamicResolution ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(0.8f, 0.8f, 0.8f, 1.0f), "%s", cachedResolutionText);
+                ImGui::Text("%s", cachedCullingText);
+                ImGui::Text("%s", cachedPrepassText);
+                ImGui::Text("%s", cachedGiUpdateText);
+                ImGui::Text("%s", cachedLightText);
+                ImGui::Text("%s", cachedPacingText);
+                ImGui::Text("%s", cachedAllocationText);
+                
+                // Per-pass timings: CPU = command submission, GPU = actual execution
+                if (cachedPassTimingCount > 0) {
+                    ImGui::Separator();
+                    for (int line = 0; line < cachedPassTimingCount; ++line) {
+                        ImGui::Text("%s", cachedPassTimingText[line]);
+                    }
+                }
             }
             ImGui::End();
             profiler.endTimer("ui_render");
@@ -1092,10 +799,6 @@ int main() {
             float uiTime = profiler.getLastTime("ui_total");
             perfData.uiTime = uiTime; // Feed to performance thread
 
-            // Store matrices for next frame
-            previousView = view;
-            previousProjection = projection;
-
             // Present final frame to screen
             profiler.beginTimer("buffer_swap");
             window.swapBuffers();
@@ -1112,6 +815,28 @@ int main() {
             if (inputData.showPerformance.exchange(false)) { // Only log if requested
                 profiler.logDetailedStats();
             }
+            
+            // Record a camera/light keyframe at 10 Hz (paused time is skipped)
+            if (!recordPathFile.empty() && !paused) {
+                if (recordTime >= nextRecordTime) {
+                    jobs.wait(simulation); // Behaviours may be moving the light
+                    CameraKeyframe keyframe;
+                    keyframe.time = recordTime;
+                    keyframe.cameraPosition = scene.camera.position;
+                    keyframe.yaw = scene.camera.yaw;
+                    keyframe.pitch = scene.camera.pitch;
+                    if (Entity light = scene.getPrimaryLight()) {
+                        keyframe.lightPosition = light.getComponent<TransformComponent>()->position;
+                    }
+                    recordedPath.addKeyframe(keyframe);
+                    nextRecordTime += 0.1f;
+                }
+                recordTime += deltaTime;
+            }
+        }
+        
+        if (!recordPathFile.empty() && recordedPath.saveToFile(recordPathFile)) {
+            std::cout << "Recorded " << recordedPath.getKeyframes().size() << " keyframes to " << recordPathFile << std::endl;
         }
 
         // Clean up multithreading resources
@@ -1264,43 +989,39 @@ void processInput(GLFWwindow *window, Camera& camera, Scene& scene, RadianceCasc
         // Light movement controls
         float lightSpeed = 3.0f * deltaTime;
         
-        // Find the light entity and update its position
-        for (const auto& entity : scene.entities) {
-            if (auto light = entity->getComponent<LightComponent>()) {
-                if (auto transform = entity->getComponent<TransformComponent>()) {
-                    // Arrow keys for X/Z movement (horizontal plane)
-                    if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
-                        transform->position.x -= lightSpeed;
-                    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
-                        transform->position.x += lightSpeed;
-                    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
-                        transform->position.z -= lightSpeed;
-                    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
-                        transform->position.z += lightSpeed;
-                        
-                    // K/L keys for Y movement (vertical)
-                    if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS)
-                        transform->position.y += lightSpeed;
-                    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS)
-                        transform->position.y -= lightSpeed;
-                        
-                    // O/P keys for light intensity adjustment
-                    float intensitySpeed = 1.0f * deltaTime;
-                    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS)
-                        light->intensity += intensitySpeed;
-                    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
-                        light->intensity = std::max(0.0f, light->intensity - intensitySpeed);
-                        
-                    // I/U keys for light radius (size/attenuation)
-                    float radiusSpeed = 1.0f * deltaTime;
-                    if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS)
-                        light->radius += radiusSpeed;
-                    if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS)
-                        light->radius = std::max(0.5f, light->radius - radiusSpeed);
-                        
-                    break; // Only move the first light found
-                }
-            }
+        // Find the primary light entity and update its position
+        if (Entity primaryLight = scene.getPrimaryLight()) {
+            auto light = primaryLight.getComponent<LightComponent>();
+            auto transform = primaryLight.getComponent<TransformComponent>();
+            // Arrow keys for X/Z movement (horizontal plane)
+            if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+                transform->position.x -= lightSpeed;
+            if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+                transform->position.x += lightSpeed;
+            if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+                transform->position.z -= lightSpeed;
+            if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+                transform->position.z += lightSpeed;
+                
+            // K/L keys for Y movement (vertical)
+            if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS)
+                transform->position.y += lightSpeed;
+            if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS)
+                transform->position.y -= lightSpeed;
+                
+            // O/P keys for light intensity adjustment
+            float intensitySpeed = 1.0f * deltaTime;
+            if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS)
+                light->intensity += intensitySpeed;
+            if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS)
+                light->intensity = std::max(0.0f, light->intensity - intensitySpeed);
+                
+            // I/U keys for light radius (size/attenuation)
+            float radiusSpeed = 1.0f * deltaTime;
+            if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS)
+                light->radius += radiusSpeed;
+            if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS)
+                light->radius = std::max(0.5f, light->radius - radiusSpeed);
         }
     }
 }